@@ -0,0 +1,211 @@
+/**
+ * @file bench_event_queue.cpp
+ * @brief Throughput and latency of SpscEventQueue / MpscEventQueue vs. a mutex + condvar deque
+ *
+ * Usage: bench_event_queue [events]   (default 1000000)
+ *
+ * Throughput: producers push pre-built events as fast as possible while one consumer drains.
+ * Latency: one producer pushes an event every few microseconds; the consumer records the
+ * push-to-pop delay. Lock-free consumers busy-poll, the mutex queue consumer blocks on its
+ * condition variable, as a typical hand-written queue would.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/event_queue.h"
+
+using namespace agui;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+constexpr size_t kQueueCapacity = 4096;
+
+struct TimedEvent {
+    std::unique_ptr<Event> event;
+    Clock::time_point pushedAt;
+};
+
+// Baseline: bounded deque guarded by a mutex, consumer sleeps on a condition variable
+template <typename T>
+class MutexQueue {
+public:
+    explicit MutexQueue(size_t capacity) : m_capacity(capacity) {}
+
+    bool tryPush(T&& value) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (m_items.size() >= m_capacity) {
+                return false;
+            }
+            m_items.push_back(std::move(value));
+        }
+        m_notEmpty.notify_one();
+        return true;
+    }
+
+    std::optional<T> pop() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_notEmpty.wait(lock, [this]() { return !m_items.empty(); });
+        T value = std::move(m_items.front());
+        m_items.pop_front();
+        return value;
+    }
+
+private:
+    size_t m_capacity;
+    std::mutex m_mutex;
+    std::condition_variable m_notEmpty;
+    std::deque<T> m_items;
+};
+
+template <typename Queue>
+auto popNext(Queue& queue) {
+    for (;;) {
+        if (auto value = queue.tryPop()) {
+            return value;
+        }
+        std::this_thread::yield();
+    }
+}
+
+template <typename T>
+std::optional<T> popNext(MutexQueue<T>& queue) {
+    return queue.pop();
+}
+
+template <typename Queue, typename T>
+void pushBlocking(Queue& queue, T&& value) {
+    while (!queue.tryPush(std::move(value))) {
+        std::this_thread::yield();
+    }
+}
+
+std::vector<std::unique_ptr<Event>> makeEvents(size_t count) {
+    std::vector<std::unique_ptr<Event>> events;
+    events.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        auto event = std::make_unique<TextMessageContentEvent>();
+        event->messageId = "m1";
+        event->delta = "token";
+        events.push_back(std::move(event));
+    }
+    return events;
+}
+
+// Returns events per second
+template <typename Queue>
+double measureThroughput(size_t events, int producers) {
+    Queue queue(kQueueCapacity);
+    const size_t perProducer = events / producers;
+    std::vector<std::vector<std::unique_ptr<Event>>> inputs;
+    for (int p = 0; p < producers; ++p) {
+        inputs.push_back(makeEvents(perProducer));
+    }
+
+    const auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&queue, &input = inputs[p]]() {
+            for (auto& event : input) {
+                pushBlocking(queue, std::move(event));
+            }
+        });
+    }
+    size_t received = 0;
+    const size_t total = perProducer * producers;
+    while (received < total) {
+        auto event = popNext(queue);
+        if (event && *event) {
+            ++received;
+        }
+    }
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    return total / elapsed;
+}
+
+struct LatencyResult {
+    double p50Us;
+    double p99Us;
+    double maxUs;
+};
+
+template <typename Queue>
+LatencyResult measureLatency(size_t events) {
+    Queue queue(kQueueCapacity);
+    auto inputs = makeEvents(events);
+    std::vector<double> samples;
+    samples.reserve(events);
+
+    std::thread producer([&]() {
+        for (auto& event : inputs) {
+            const auto due = Clock::now() + std::chrono::microseconds(2);
+            pushBlocking(queue, TimedEvent{std::move(event), Clock::now()});
+            while (Clock::now() < due) {
+            }
+        }
+    });
+    for (size_t i = 0; i < events; ++i) {
+        auto item = popNext(queue);
+        samples.push_back(std::chrono::duration<double, std::micro>(Clock::now() - item->pushedAt).count());
+    }
+    producer.join();
+
+    std::sort(samples.begin(), samples.end());
+    return {samples[samples.size() / 2], samples[samples.size() * 99 / 100], samples.back()};
+}
+
+void printRow(const std::string& name, double throughput) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(2) << throughput / 1e6 << " M events/s" << std::endl;
+}
+
+void printRow(const std::string& name, const LatencyResult& latency) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::fixed << std::setprecision(2)
+              << "p50 " << std::setw(8) << latency.p50Us << " us   p99 " << std::setw(8) << latency.p99Us
+              << " us   max " << std::setw(10) << latency.maxUs << " us" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t events = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1000000;
+    const size_t latencyEvents = std::min<size_t>(events, 200000);
+
+    std::cout << "Event queue benchmark (" << events << " events, capacity " << kQueueCapacity << ")\n" << std::endl;
+    if (std::thread::hardware_concurrency() < 2) {
+        std::cout << "Warning: fewer than 2 hardware threads; busy-polling consumers and the paced\n"
+                     "producer share a core, so latency figures are not meaningful.\n" << std::endl;
+    }
+
+    std::cout << "Throughput, 1 producer:" << std::endl;
+    printRow("SpscEventQueue", measureThroughput<SpscEventQueue>(events, 1));
+    printRow("MpscEventQueue", measureThroughput<MpscEventQueue>(events, 1));
+    printRow("mutex + condvar", measureThroughput<MutexQueue<std::unique_ptr<Event>>>(events, 1));
+
+    std::cout << "\nThroughput, 4 producers:" << std::endl;
+    printRow("MpscEventQueue", measureThroughput<MpscEventQueue>(events, 4));
+    printRow("mutex + condvar", measureThroughput<MutexQueue<std::unique_ptr<Event>>>(events, 4));
+
+    std::cout << "\nLatency, 1 producer, one event every 2 us (" << latencyEvents << " events):" << std::endl;
+    printRow("SpscRingBuffer", measureLatency<SpscRingBuffer<TimedEvent>>(latencyEvents));
+    printRow("MpscRingBuffer", measureLatency<MpscRingBuffer<TimedEvent>>(latencyEvents));
+    printRow("mutex + condvar", measureLatency<MutexQueue<TimedEvent>>(latencyEvents));
+
+    return 0;
+}
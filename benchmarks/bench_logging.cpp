@@ -0,0 +1,142 @@
+/**
+ * @file bench_logging.cpp
+ * @brief Cost per log call on the calling thread: Logger::infof (ostringstream formatting,
+ *        synchronous or asynchronous delivery) vs. BinaryLog (deferred formatting)
+ *
+ * Usage: bench_logging [calls per thread] [threads]   (default 200000 calls, 1 thread)
+ *
+ * Every call logs the same message with a string, two integers and a double. Logger's
+ * callback only counts the messages, so the synchronous figure is formatting plus
+ * delivery. The asynchronous variants are timed on the calling threads; the time the
+ * background thread needs to catch up is reported separately as "drain".
+ */
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/binary_log.h"
+#include "core/logger.h"
+
+using namespace agui;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+std::atomic<uint64_t> g_delivered{0};
+
+struct Result {
+    double nsPerCall;
+    double drainMillis;
+};
+
+// Runs calls iterations of logOnce on each thread; finish() waits for background work
+Result measure(size_t calls, size_t threads, const std::function<void(const std::string&, size_t)>& logOnce,
+               const std::function<void()>& finish) {
+    std::vector<std::thread> workers;
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    std::vector<double> elapsed(threads);
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t] {
+            const std::string runId = "run-" + std::to_string(t);
+            ready.fetch_add(1);
+            while (!go.load()) {
+                std::this_thread::yield();
+            }
+            const auto start = Clock::now();
+            for (size_t i = 0; i < calls; ++i) {
+                logOnce(runId, i);
+            }
+            elapsed[t] = std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        });
+    }
+    while (ready.load() < threads) {
+        std::this_thread::yield();
+    }
+    go.store(true);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    const auto drainStart = Clock::now();
+    finish();
+    const double drain = std::chrono::duration<double, std::milli>(Clock::now() - drainStart).count();
+
+    double total = 0;
+    for (double value : elapsed) {
+        total += value;
+    }
+    return {total / static_cast<double>(calls * threads), drain};
+}
+
+void printRow(const std::string& name, const Result& result, const std::string& note = "") {
+    std::cout << "  " << std::left << std::setw(30) << name << std::right << std::setw(9) << std::fixed
+              << std::setprecision(1) << result.nsPerCall << " ns/call" << std::setw(10) << result.drainMillis
+              << " ms drain  " << note << std::endl;
+}
+
+void logWithLogger(const std::string& runId, size_t i) {
+    Logger::infof("Run ", runId, " event ", i, " of type ", "TEXT_MESSAGE_CONTENT", " took ", i * 0.25, " ms");
+}
+
+void logWithBinaryLog(const std::string& runId, size_t i) {
+    AGUI_BLOG_INFO("Run {} event {} of type {} took {} ms", runId, i, "TEXT_MESSAGE_CONTENT", i * 0.25);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t calls = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 200000;
+    const size_t threads = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 1;
+    const std::string path = "bench_logging.blog";
+    const auto noop = [] {};
+
+    std::cout << "Logging benchmark (" << calls << " calls x " << threads << " threads)\n" << std::endl;
+
+    Logger::setCallback([](LogLevel, const std::string&) { g_delivered.fetch_add(1, std::memory_order_relaxed); });
+    Logger::setMinLevel(LogLevel::Info);
+
+    printRow("Logger::debugf, disabled", measure(calls, threads, [](const std::string& runId, size_t i) {
+                 Logger::debugf("Run ", runId, " event ", i);
+             }, noop));
+    printRow("AGUI_BLOG_DEBUG, disabled", measure(calls, threads, [](const std::string& runId, size_t i) {
+                 AGUI_BLOG_DEBUG("Run {} event {}", runId, i);
+             }, noop));
+
+    printRow("Logger::infof, sync", measure(calls, threads, logWithLogger, noop));
+
+    Logger::enableAsync(1 << 16);
+    const uint64_t loggerDropped = Logger::droppedMessages();
+    const Result async = measure(calls, threads, logWithLogger, [] { Logger::flush(); });
+    printRow("Logger::infof, async", async, std::to_string(Logger::droppedMessages() - loggerDropped) + " dropped");
+    Logger::disableAsync();
+
+    BinaryLog::Options options;
+    options.path = path;
+    options.threadBufferBytes = 8 * 1024 * 1024;
+    options.flushInterval = std::chrono::milliseconds(5);
+    std::remove(path.c_str());
+    BinaryLog::start(options);
+    uint64_t dropped = BinaryLog::droppedRecords();
+    const Result toFile = measure(calls, threads, logWithBinaryLog, [] { BinaryLog::flush(); });
+    printRow("AGUI_BLOG_INFO, file", toFile, std::to_string(BinaryLog::droppedRecords() - dropped) + " dropped");
+
+    options.path.clear();
+    options.forwardToLogger = true;
+    BinaryLog::start(options);
+    dropped = BinaryLog::droppedRecords();
+    const Result toLogger = measure(calls, threads, logWithBinaryLog, [] { BinaryLog::flush(); });
+    printRow("AGUI_BLOG_INFO, to Logger", toLogger, std::to_string(BinaryLog::droppedRecords() - dropped) + " dropped");
+    BinaryLog::stop();
+    std::remove(path.c_str());
+
+    std::cout << "\nMessages delivered to the Logger callback: " << g_delivered.load() << std::endl;
+    return 0;
+}
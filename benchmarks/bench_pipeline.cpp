@@ -0,0 +1,532 @@
+/**
+ * @file bench_pipeline.cpp
+ * @brief Event pipeline benchmarks: every stage on its own, and recorded streams replayed
+ *        end to end through HttpAgent, with machine-readable results
+ *
+ * Usage: bench_pipeline [--json FILE] [--filter TEXT] [--min-time MS] [--repetitions N] [stream.sse...]
+ *
+ * Benchmarks:
+ *   sse_parser/feed/STREAM/chunk=N     SseParser::feed + nextEvent over a recorded stream, in N-byte chunks
+ *   event_parser/parse/TYPE            EventParser::parse of one event of each type
+ *   event_handler/handle_event/...     EventHandler::handleEvent with 0, 1 and 10 subscribers
+ *   state_manager/apply_patch/keys=N   StateManager::applyPatch on states of N entries
+ *   middleware_chain/process_event/... MiddlewareChain::processEvent through 0, 1 and 4 middlewares
+ *   replay/STREAM/MODE                 HttpAgent::runAgent over a recorded stream, sequential and pipelined
+ *
+ * Streams are the .sse files in benchmarks/streams plus any given on the command line, replayed
+ * in 1400-byte chunks. Each benchmark is calibrated to run for at least --min-time (default
+ * 200 ms), then repeated (default 5 times); the median and the fastest repetition are
+ * reported. --json writes the results as one JSON document for regression tracking.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "agent/http_agent.h"
+#include "core/event.h"
+#include "core/state.h"
+#include "core/subscriber.h"
+#include "middleware/middleware.h"
+#include "stream/sse_parser.h"
+
+#ifndef AGUI_BENCH_STREAMS_DIR
+#define AGUI_BENCH_STREAMS_DIR "benchmarks/streams"
+#endif
+#ifndef AGUI_BENCH_VERSION
+#define AGUI_BENCH_VERSION "unknown"
+#endif
+
+using namespace agui;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// Keeps results alive so the compiler cannot drop the measured work
+volatile size_t g_sink = 0;
+
+struct Config {
+    std::string jsonPath;
+    std::string filter;
+    std::chrono::nanoseconds minTime = std::chrono::milliseconds(200);
+    int repetitions = 5;
+};
+
+struct Result {
+    std::string name;
+    uint64_t iterations = 0;  ///< Operations per repetition
+    double nsPerOp = 0;       ///< Median over repetitions
+    double nsPerOpMin = 0;
+    double itemsPerOp = 1;    ///< Events (or other items) per operation
+    double bytesPerOp = 0;
+};
+
+// Runs `iterations` operations and returns the time spent in the measured part
+using Body = std::function<std::chrono::nanoseconds(uint64_t iterations)>;
+
+class Runner {
+public:
+    explicit Runner(Config config) : m_config(std::move(config)) {}
+
+    void run(const std::string& name, double itemsPerOp, double bytesPerOp, const Body& body) {
+        if (!m_config.filter.empty() && name.find(m_config.filter) == std::string::npos) {
+            return;
+        }
+
+        // Grow the iteration count until one repetition takes at least minTime
+        uint64_t iterations = 1;
+        for (;;) {
+            const auto elapsed = body(iterations);
+            if (elapsed >= m_config.minTime || iterations >= (uint64_t(1) << 32)) {
+                break;
+            }
+            const double scale = elapsed.count() > 0 ? 1.2 * m_config.minTime.count() / elapsed.count() : 10.0;
+            iterations = std::max(iterations + 1, static_cast<uint64_t>(iterations * std::min(scale, 10.0)));
+        }
+
+        std::vector<double> samples;
+        for (int i = 0; i < m_config.repetitions; ++i) {
+            samples.push_back(static_cast<double>(body(iterations).count()) / static_cast<double>(iterations));
+        }
+        std::sort(samples.begin(), samples.end());
+
+        Result result;
+        result.name = name;
+        result.iterations = iterations;
+        result.nsPerOp = samples[samples.size() / 2];
+        result.nsPerOpMin = samples.front();
+        result.itemsPerOp = itemsPerOp;
+        result.bytesPerOp = bytesPerOp;
+        print(result);
+        m_results.push_back(result);
+    }
+
+    void writeJson() const {
+        if (m_config.jsonPath.empty()) {
+            return;
+        }
+        // Ordered, so that each result reads name first
+        nlohmann::ordered_json results = nlohmann::ordered_json::array();
+        for (const auto& result : m_results) {
+            nlohmann::ordered_json entry = {
+                {"name", result.name},
+                {"iterations", result.iterations},
+                {"ns_per_op", result.nsPerOp},
+                {"ns_per_op_min", result.nsPerOpMin},
+                {"items_per_op", result.itemsPerOp},
+                {"items_per_second", result.itemsPerOp * 1e9 / result.nsPerOp},
+            };
+            if (result.bytesPerOp > 0) {
+                entry["bytes_per_op"] = result.bytesPerOp;
+                entry["bytes_per_second"] = result.bytesPerOp * 1e9 / result.nsPerOp;
+            }
+            results.push_back(std::move(entry));
+        }
+
+        char date[32];
+        const std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+        const nlohmann::ordered_json document = {
+            {"suite", "ag-ui-cpp/pipeline"},
+            {"version", AGUI_BENCH_VERSION},
+            {"date", date},
+            {"compiler", compiler()},
+            {"min_time_ms", std::chrono::duration_cast<std::chrono::milliseconds>(m_config.minTime).count()},
+            {"repetitions", m_config.repetitions},
+            {"results", std::move(results)},
+        };
+        std::ofstream out(m_config.jsonPath);
+        if (!out) {
+            std::cerr << "Cannot write " << m_config.jsonPath << std::endl;
+            std::exit(1);
+        }
+        out << document.dump(2) << '\n';
+        std::cout << "\nResults written to " << m_config.jsonPath << std::endl;
+    }
+
+private:
+    static std::string compiler() {
+#if defined(__clang__)
+        return "clang " __clang_version__;
+#elif defined(__GNUC__)
+        return "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+        return "msvc " + std::to_string(_MSC_VER);
+#else
+        return "unknown";
+#endif
+    }
+
+    static void print(const Result& result) {
+        std::cout << "  " << std::left << std::setw(52) << result.name << std::right << std::setw(12) << std::fixed
+                  << std::setprecision(1) << result.nsPerOp << " ns/op";
+        if (result.itemsPerOp != 1) {
+            std::cout << std::setw(10) << std::setprecision(1) << result.nsPerOp / result.itemsPerOp << " ns/event";
+        }
+        if (result.bytesPerOp > 0) {
+            std::cout << std::setw(10) << std::setprecision(1) << result.bytesPerOp * 1e3 / result.nsPerOp << " MB/s";
+        }
+        std::cout << std::endl;
+    }
+
+    Config m_config;
+    std::vector<Result> m_results;
+};
+
+// Times a loop body that needs no per-operation setup
+template <typename Operation>
+Body timed(Operation operation) {
+    return [operation](uint64_t iterations) mutable {
+        const auto start = Clock::now();
+        for (uint64_t i = 0; i < iterations; ++i) {
+            operation(i);
+        }
+        return Clock::now() - start;
+    };
+}
+
+struct Stream {
+    std::string name;
+    std::string bytes;
+    std::vector<nlohmann::json> events;
+};
+
+Stream loadStream(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot read " << path << std::endl;
+        std::exit(1);
+    }
+    Stream stream;
+    const size_t slash = path.find_last_of("/\\");
+    stream.name = path.substr(slash == std::string::npos ? 0 : slash + 1);
+    stream.name = stream.name.substr(0, stream.name.rfind('.'));
+    stream.bytes.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    SseParser parser;
+    parser.feed(stream.bytes);
+    parser.flush();
+    while (parser.hasEvent()) {
+        stream.events.push_back(nlohmann::json::parse(parser.nextEvent()));
+    }
+    return stream;
+}
+
+std::vector<std::string> chunk(const std::string& bytes, size_t size) {
+    std::vector<std::string> chunks;
+    for (size_t offset = 0; offset < bytes.size(); offset += size) {
+        chunks.push_back(bytes.substr(offset, size));
+    }
+    return chunks;
+}
+
+// One event of every type
+std::vector<nlohmann::json> sampleEvents() {
+    const char* samples[] = {
+        R"({"type":"TEXT_MESSAGE_START","messageId":"msg-1","role":"assistant","timestamp":1760000000000})",
+        R"({"type":"TEXT_MESSAGE_CONTENT","messageId":"msg-1","delta":" streamed token text"})",
+        R"({"type":"TEXT_MESSAGE_END","messageId":"msg-1"})",
+        R"({"type":"TEXT_MESSAGE_CHUNK","messageId":"msg-1","role":"assistant","delta":" chunk"})",
+        R"({"type":"THINKING_TEXT_MESSAGE_START"})",
+        R"({"type":"THINKING_TEXT_MESSAGE_CONTENT","delta":" considering the request"})",
+        R"({"type":"THINKING_TEXT_MESSAGE_END"})",
+        R"({"type":"TOOL_CALL_START","toolCallId":"call-1","toolCallName":"get_forecast","parentMessageId":"msg-1"})",
+        R"({"type":"TOOL_CALL_ARGS","toolCallId":"call-1","delta":"{\"city\":\"San "})",
+        R"({"type":"TOOL_CALL_END","toolCallId":"call-1"})",
+        R"({"type":"TOOL_CALL_CHUNK","toolCallId":"call-1","toolCallName":"get_forecast","delta":"{}"})",
+        R"({"type":"TOOL_CALL_RESULT","messageId":"tool-1","toolCallId":"call-1","content":"[{\"day\":0,\"high\":18}]",
+            "role":"tool"})",
+        R"({"type":"THINKING_START","title":"Planning"})",
+        R"({"type":"THINKING_END"})",
+        R"({"type":"STATE_SNAPSHOT","snapshot":{"items":[{"id":1,"title":"Task 1","done":false},
+            {"id":2,"title":"Task 2","done":true}],"progress":1}})",
+        R"({"type":"STATE_DELTA","delta":[{"op":"replace","path":"/progress","value":2},
+            {"op":"add","path":"/log/-","value":"completed 2"}]})",
+        R"({"type":"MESSAGES_SNAPSHOT","messages":[{"id":"u1","role":"user","content":"Weather in SF?"},
+            {"id":"a1","role":"assistant","content":"Sunny, 18 degrees."}]})",
+        R"({"type":"ACTIVITY_SNAPSHOT","messageId":"activity-1","activityType":"progress",
+            "content":{"done":1,"total":3}})",
+        R"({"type":"ACTIVITY_DELTA","messageId":"activity-1","activityType":"progress",
+            "patch":[{"op":"replace","path":"/done","value":2}]})",
+        R"({"type":"RUN_STARTED","threadId":"thread-1","runId":"run-1"})",
+        R"({"type":"RUN_FINISHED","threadId":"thread-1","runId":"run-1","result":{"ok":true}})",
+        R"({"type":"RUN_ERROR","message":"model overloaded","code":"overloaded"})",
+        R"({"type":"STEP_STARTED","stepName":"plan"})",
+        R"({"type":"STEP_FINISHED","stepName":"plan"})",
+        R"({"type":"RAW","event":{"provider":"example","payload":[1,2,3]},"source":"upstream"})",
+        R"({"type":"CUSTOM","name":"ui.highlight","value":{"target":"forecast"}})",
+    };
+    std::vector<nlohmann::json> events;
+    for (const char* sample : samples) {
+        events.push_back(nlohmann::json::parse(sample));
+    }
+    return events;
+}
+
+class CountingSubscriber : public IAgentSubscriber {
+public:
+    AgentStateMutation onEvent(const Event&, const AgentSubscriberParams&) override {
+        ++m_events;
+        return {};
+    }
+
+    AgentStateMutation onTextMessageContent(const TextMessageContentEvent&, const std::string& buffer,
+                                            const AgentSubscriberParams&) override {
+        m_bytes += buffer.size();
+        return {};
+    }
+
+private:
+    size_t m_events = 0;
+    size_t m_bytes = 0;
+};
+
+class PassThroughMiddleware : public IMiddleware {
+public:
+    uint32_t eventHooks() const override { return HookOnEvent; }
+
+    std::unique_ptr<Event> onEvent(std::unique_ptr<Event> event, MiddlewareContext&) override { return event; }
+};
+
+// Delivers a recorded stream synchronously, as fast as the agent consumes it
+class ReplayHttpService : public IHttpService {
+public:
+    explicit ReplayHttpService(const std::vector<std::string>& chunks) : m_chunks(chunks) {}
+
+    void sendRequest(const HttpRequest&, HttpResponseCallback, HttpErrorCallback) override {}
+
+    void sendSseRequest(const HttpRequest&, SseDataCallback, SseCompleteCallback, HttpErrorCallback) override {}
+
+    void streamSseRequest(const HttpRequest&, SseChunkCallback onChunk, SseCompleteCallback onComplete,
+                          HttpErrorCallback) override {
+        for (const auto& chunk : m_chunks) {
+            onChunk(chunk);
+        }
+        HttpResponse response;
+        response.statusCode = 200;
+        onComplete(response);
+    }
+
+private:
+    const std::vector<std::string>& m_chunks;
+};
+
+// Events of one streamed assistant message: start, content deltas, end
+std::vector<nlohmann::json> messageEvents(size_t deltas) {
+    std::vector<nlohmann::json> events;
+    events.push_back({{"type", "TEXT_MESSAGE_START"}, {"messageId", "msg"}, {"role", "assistant"}});
+    for (size_t i = 0; i < deltas; ++i) {
+        events.push_back({{"type", "TEXT_MESSAGE_CONTENT"}, {"messageId", "msg"}, {"delta", " token"}});
+    }
+    events.push_back({{"type", "TEXT_MESSAGE_END"}, {"messageId", "msg"}});
+    return events;
+}
+
+void benchSseParser(Runner& runner, const Stream& stream) {
+    for (size_t chunkSize : {64, 1400, 16384}) {
+        const std::vector<std::string> chunks = chunk(stream.bytes, chunkSize);
+        runner.run("sse_parser/feed/" + stream.name + "/chunk=" + std::to_string(chunkSize),
+                   static_cast<double>(stream.events.size()), static_cast<double>(stream.bytes.size()),
+                   timed([&chunks](uint64_t) {
+                       SseParser parser;
+                       size_t bytes = 0;
+                       for (const auto& chunk : chunks) {
+                           parser.feed(chunk);
+                           while (parser.hasEvent()) {
+                               bytes += parser.nextEvent().size();
+                           }
+                       }
+                       g_sink = bytes;
+                   }));
+    }
+}
+
+void benchEventParser(Runner& runner) {
+    for (const auto& sample : sampleEvents()) {
+        runner.run("event_parser/parse/" + sample["type"].get<std::string>(), 1, 0, timed([&sample](uint64_t) {
+                       g_sink = static_cast<size_t>(EventParser::parse(sample)->type());
+                   }));
+    }
+}
+
+void benchEventHandler(Runner& runner) {
+    constexpr size_t kBatch = 1024;
+    const std::vector<nlohmann::json> message = messageEvents(kBatch - 2);
+    for (size_t subscriberCount : {0, 1, 10}) {
+        runner.run("event_handler/handle_event/subscribers=" + std::to_string(subscriberCount), 1, 0,
+                   [&](uint64_t iterations) {
+                       std::vector<std::shared_ptr<IAgentSubscriber>> subscribers;
+                       for (size_t i = 0; i < subscriberCount; ++i) {
+                           subscribers.push_back(std::make_shared<CountingSubscriber>());
+                       }
+                       std::chrono::nanoseconds elapsed{0};
+                       std::vector<std::unique_ptr<Event>> events;
+                       for (uint64_t done = 0; done < iterations;) {
+                           // One message per handler, so its content does not grow without bound
+                           const size_t count = static_cast<size_t>(std::min<uint64_t>(kBatch, iterations - done));
+                           EventHandler handler({}, nlohmann::json::object(), subscribers);
+                           events.clear();
+                           for (size_t i = 0; i < count; ++i) {
+                               events.push_back(EventParser::parse(message[i]));
+                           }
+                           const auto start = Clock::now();
+                           for (auto& event : events) {
+                               AgentStateMutation mutation = handler.handleEvent(std::move(event));
+                               if (mutation.hasChanges()) {
+                                   handler.applyMutation(mutation);
+                               }
+                           }
+                           elapsed += Clock::now() - start;
+                           g_sink = handler.messages().size();
+                           done += count;
+                       }
+                       return elapsed;
+                   });
+    }
+}
+
+void benchStateManager(Runner& runner) {
+    for (size_t keys : {10, 100, 1000, 10000}) {
+        nlohmann::json items = nlohmann::json::object();
+        for (size_t i = 0; i < keys; ++i) {
+            items["item-" + std::to_string(i)] = {
+                {"id", i}, {"title", "Task " + std::to_string(i)}, {"done", false}, {"tags", {"backlog"}}};
+        }
+        auto state = std::make_shared<StateManager>(nlohmann::json{{"items", std::move(items)}, {"progress", 0}});
+        runner.run("state_manager/apply_patch/keys=" + std::to_string(keys), 1, 0,
+                   timed([state, keys](uint64_t i) {
+                       const nlohmann::json patch = {
+                           {{"op", "replace"}, {"path", "/progress"}, {"value", i}},
+                           {{"op", "replace"}, {"path", "/items/item-" + std::to_string(i % keys) + "/done"},
+                            {"value", i % 2 == 0}}};
+                       state->applyPatch(patch);
+                   }));
+    }
+}
+
+void benchMiddlewareChain(Runner& runner) {
+    constexpr size_t kBatch = 1024;
+    const nlohmann::json content = {{"type", "TEXT_MESSAGE_CONTENT"}, {"messageId", "msg"}, {"delta", " token"}};
+    for (size_t middlewareCount : {0, 1, 4}) {
+        runner.run("middleware_chain/process_event/middlewares=" + std::to_string(middlewareCount), 1, 0,
+                   [&](uint64_t iterations) {
+                       MiddlewareChain chain;
+                       for (size_t i = 0; i < middlewareCount; ++i) {
+                           chain.addMiddleware(std::make_shared<PassThroughMiddleware>());
+                       }
+                       RunAgentInput input;
+                       RunAgentResult result;
+                       MiddlewareContext context(&input, &result);
+                       std::vector<std::unique_ptr<Event>> events;
+                       std::vector<std::unique_ptr<Event>> out;
+                       std::chrono::nanoseconds elapsed{0};
+                       for (uint64_t done = 0; done < iterations;) {
+                           const size_t count = static_cast<size_t>(std::min<uint64_t>(kBatch, iterations - done));
+                           events.clear();
+                           for (size_t i = 0; i < count; ++i) {
+                               events.push_back(EventParser::parse(content));
+                           }
+                           out.clear();
+                           const auto start = Clock::now();
+                           for (auto& event : events) {
+                               chain.processEvent(std::move(event), context, out);
+                           }
+                           elapsed += Clock::now() - start;
+                           g_sink = out.size();
+                           done += count;
+                       }
+                       return elapsed;
+                   });
+    }
+}
+
+void benchReplay(Runner& runner, const Stream& stream) {
+    const std::vector<std::string> chunks = chunk(stream.bytes, 1400);
+    for (bool pipelined : {false, true}) {
+        runner.run("replay/" + stream.name + (pipelined ? "/pipelined" : "/sequential"),
+                   static_cast<double>(stream.events.size()), static_cast<double>(stream.bytes.size()),
+                   [&](uint64_t iterations) {
+                       auto service = std::make_shared<ReplayHttpService>(chunks);
+                       std::chrono::nanoseconds elapsed{0};
+                       for (uint64_t i = 0; i < iterations; ++i) {
+                           // A fresh agent per run, so the message history does not grow across runs
+                           HttpAgent::Builder builder = HttpAgent::builder().withUrl("http://localhost");
+                           if (pipelined) {
+                               builder.withPipelinedProcessing();
+                           }
+                           auto agent = builder.build();
+                           agent->setHttpService(service);
+                           bool succeeded = false;
+                           std::string error;
+                           const auto start = Clock::now();
+                           agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; },
+                                           [&](const std::string& message) { error = message; });
+                           elapsed += Clock::now() - start;
+                           if (!succeeded) {
+                               std::cerr << "Replay of " << stream.name << " failed: " << error << std::endl;
+                               std::exit(1);
+                           }
+                           g_sink = agent->messages().size();
+                       }
+                       return elapsed;
+                   });
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Config config;
+    std::vector<std::string> paths = {std::string(AGUI_BENCH_STREAMS_DIR) + "/chat_tool_call.sse",
+                                      std::string(AGUI_BENCH_STREAMS_DIR) + "/shared_state.sse"};
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const bool hasValue = i + 1 < argc;
+        if (arg == "--json" && hasValue) {
+            config.jsonPath = argv[++i];
+        } else if (arg == "--filter" && hasValue) {
+            config.filter = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            config.minTime = std::chrono::milliseconds(std::strtoll(argv[++i], nullptr, 10));
+        } else if (arg == "--repetitions" && hasValue) {
+            config.repetitions = std::max(1, std::atoi(argv[++i]));
+        } else if (!arg.empty() && arg[0] != '-') {
+            paths.push_back(arg);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--json FILE] [--filter TEXT] [--min-time MS] [--repetitions N] [stream.sse...]"
+                      << std::endl;
+            return 2;
+        }
+    }
+
+    std::vector<Stream> streams;
+    for (const auto& path : paths) {
+        streams.push_back(loadStream(path));
+    }
+
+    std::cout << "Event pipeline benchmark (median of " << config.repetitions << " repetitions)\n" << std::endl;
+    Runner runner(config);
+    for (const auto& stream : streams) {
+        benchSseParser(runner, stream);
+    }
+    benchEventParser(runner);
+    benchEventHandler(runner);
+    benchStateManager(runner);
+    benchMiddlewareChain(runner);
+    for (const auto& stream : streams) {
+        benchReplay(runner, stream);
+    }
+    runner.writeJson();
+    return 0;
+}
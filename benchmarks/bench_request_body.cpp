@@ -0,0 +1,144 @@
+/**
+ * @file bench_request_body.cpp
+ * @brief Request body build time: toJson().dump() vs. RunAgentInput::appendJson(), with and
+ *        without a MessageJsonCache and a pre-serialized ToolSchemaSet
+ *
+ * Usage: bench_request_body [messages] [turns] [tools]   (default 500 messages, 200 turns, 50 tools)
+ *
+ * Each turn appends one assistant message with a tool call and one tool message to the
+ * history, like a tool loop, then builds the request body. The cached variant keeps one
+ * MessageJsonCache across turns, as HttpAgent does. Tools are passed per run, except in the
+ * last variant, which registers them once as HttpAgent::registerTool() does.
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "core/session_types.h"
+
+using namespace agui;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+Message historyMessage(size_t index) {
+    const MessageRole role = index % 2 == 0 ? MessageRole::User : MessageRole::Assistant;
+    std::string content = "Message " + std::to_string(index) + ": ";
+    while (content.size() < 400) {
+        content += "some \"quoted\" text with a newline\n and unicode caf\xc3\xa9. ";
+    }
+    return Message::createWithId("msg-" + std::to_string(index), role, content);
+}
+
+std::vector<Tool> makeTools(size_t count) {
+    std::vector<Tool> tools;
+    for (size_t i = 0; i < count; ++i) {
+        Tool tool;
+        tool.name = "tool_" + std::to_string(i);
+        tool.description = "Looks things up in source " + std::to_string(i) + " and returns matching records";
+        tool.parameters = {{"type", "object"},
+                           {"properties",
+                            {{"query", {{"type", "string"}, {"description", "Search terms"}}},
+                             {"limit", {{"type", "integer"}, {"minimum", 1}, {"maximum", 100}}},
+                             {"filters", {{"type", "array"}, {"items", {{"type", "string"}}}}}}},
+                           {"required", {"query"}}};
+        tools.push_back(tool);
+    }
+    return tools;
+}
+
+RunAgentInput baseInput(size_t messages, const std::vector<Tool>& tools) {
+    RunAgentInput input;
+    input.threadId = "thread";
+    input.runId = "run";
+    input.state = {{"step", 1}, {"items", {"a", "b", "c"}}};
+    for (size_t i = 0; i < messages; ++i) {
+        input.messages.push_back(historyMessage(i));
+    }
+    input.tools = tools;
+    return input;
+}
+
+void addTurn(RunAgentInput& input, size_t turn) {
+    const std::string id = std::to_string(turn);
+    Message assistant = Message::createWithId("call-msg-" + id, MessageRole::Assistant);
+    ToolCall call;
+    call.id = "call-" + id;
+    call.function = FunctionCall("lookup", R"({"q":"turn )" + id + R"("})");
+    assistant.addToolCall(call);
+    input.messages.push_back(assistant);
+    input.messages.push_back(Message::createWithId("tool-msg-" + id, MessageRole::Tool, "result " + id, "", call.id));
+}
+
+// Mean microseconds per body build over turns
+double measure(size_t messages, size_t turns, const std::vector<Tool>& tools,
+               std::shared_ptr<const ToolSchemaSet> toolSchemas,
+               const std::function<void(const RunAgentInput&, std::string&)>& build, size_t& bodySize) {
+    RunAgentInput input = baseInput(messages, tools);
+    input.toolSchemas = std::move(toolSchemas);
+    std::string body;
+    std::chrono::nanoseconds total{0};
+    for (size_t turn = 0; turn < turns; ++turn) {
+        addTurn(input, turn);
+        const auto start = Clock::now();
+        build(input, body);
+        total += Clock::now() - start;
+    }
+    bodySize = body.size();
+    return std::chrono::duration<double, std::micro>(total).count() / static_cast<double>(turns);
+}
+
+void printRow(const std::string& name, double micros) {
+    std::cout << "  " << std::left << std::setw(28) << name << std::right << std::setw(10) << std::fixed
+              << std::setprecision(1) << micros << " us/request" << std::endl;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    const size_t messages = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 500;
+    const size_t turns = argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 200;
+    const std::vector<Tool> tools = makeTools(argc > 3 ? std::strtoull(argv[3], nullptr, 10) : 50);
+
+    size_t bodySize = 0;
+    const double dump = measure(messages, turns, tools, nullptr,
+                                [](const RunAgentInput& input, std::string& body) { body = input.toJson().dump(); },
+                                bodySize);
+    const double direct = measure(messages, turns, tools, nullptr,
+                                  [](const RunAgentInput& input, std::string& body) {
+                                      body.clear();
+                                      input.appendJson(body);
+                                  },
+                                  bodySize);
+    MessageJsonCache cache;
+    const double cached = measure(messages, turns, tools, nullptr,
+                                  [&cache](const RunAgentInput& input, std::string& body) {
+                                      body.clear();
+                                      input.appendJson(body, &cache);
+                                  },
+                                  bodySize);
+    MessageJsonCache registryCache;
+    const double registered = measure(messages, turns, {}, std::make_shared<const ToolSchemaSet>(tools),
+                                      [&registryCache](const RunAgentInput& input, std::string& body) {
+                                          body.clear();
+                                          input.appendJson(body, &registryCache);
+                                      },
+                                      bodySize);
+
+    std::cout << "Request body benchmark (" << messages << " messages + 2 per turn, " << tools.size() << " tools, "
+              << turns << " turns, last body "
+              << bodySize / 1024 << " KiB)\n"
+              << std::endl;
+    printRow("toJson().dump()", dump);
+    printRow("appendJson()", direct);
+    printRow("appendJson() + cache", cached);
+    printRow("+ registered tools", registered);
+    std::cout << "\nCache: " << cache.hits() << " hits, " << cache.misses() << " misses" << std::endl;
+    return 0;
+}
@@ -0,0 +1,196 @@
+#include "agent/agent_pool.h"
+
+#include "core/error.h"
+#include "core/logger.h"
+
+namespace agui {
+
+namespace {
+
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start,
+                                       std::chrono::steady_clock::time_point end) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+}
+
+}  // namespace
+
+AgentPool::AgentPool(AgentPoolOptions options)
+    : m_options(std::move(options)), m_executor(m_options.workerThreads) {
+    if (!m_options.httpService) {
+        m_options.httpService = std::make_shared<HttpService>();
+    }
+}
+
+AgentPool::~AgentPool() {
+    waitIdle();
+}
+
+std::string AgentPool::backendKey(const std::string& url) {
+    const size_t schemeEnd = url.find("://");
+    const size_t authorityStart = schemeEnd == std::string::npos ? 0 : schemeEnd + 3;
+    const size_t authorityEnd = url.find_first_of("/?#", authorityStart);
+    return url.substr(0, authorityEnd);
+}
+
+HttpAgent& AgentPool::addSession(const std::string& sessionId, std::unique_ptr<HttpAgent> agent) {
+    if (sessionId.empty()) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Session ID must not be empty");
+    }
+    if (!agent) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Session agent must not be null");
+    }
+
+    auto session = std::make_shared<Session>();
+    session->id = sessionId;
+    session->backend = backendKey(agent->baseUrl());
+    agent->setHttpService(m_options.httpService);
+    session->agent = std::move(agent);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_sessions.emplace(sessionId, session).second) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Session already exists: " + sessionId);
+    }
+    return *session->agent;
+}
+
+bool AgentPool::removeSession(const std::string& sessionId) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end() || it->second->running || !it->second->pending.empty()) {
+        return false;
+    }
+    m_sessions.erase(it);
+    return true;
+}
+
+HttpAgent* AgentPool::session(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sessions.find(sessionId);
+    return it == m_sessions.end() ? nullptr : it->second->agent.get();
+}
+
+size_t AgentPool::sessionCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sessions.size();
+}
+
+void AgentPool::submitRun(const std::string& sessionId, const RunAgentParams& params,
+                          AgentSuccessCallback onSuccess, AgentErrorCallback onError) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Unknown session: " + sessionId);
+    }
+    const std::shared_ptr<Session>& session = it->second;
+
+    session->pending.push_back(PendingRun{params, std::move(onSuccess), std::move(onError), Clock::now()});
+    session->metrics.runsSubmitted++;
+    session->metrics.runsQueued++;
+    m_unfinishedRuns++;
+
+    Backend& backend = m_backends[session->backend];
+    if (!session->running && !session->ready) {
+        session->ready = true;
+        backend.ready.push_back(session);
+    }
+    schedule(backend);
+}
+
+void AgentPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idleCondition.wait(lock, [this]() { return m_unfinishedRuns == 0; });
+}
+
+SessionMetrics AgentPool::sessionMetrics(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Unknown session: " + sessionId);
+    }
+    return it->second->metrics;
+}
+
+size_t AgentPool::activeRuns(const std::string& url) const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_backends.find(backendKey(url));
+    return it == m_backends.end() ? 0 : it->second.active;
+}
+
+void AgentPool::schedule(Backend& backend) {
+    const size_t cap = m_options.maxConcurrentRunsPerBackend;
+    while ((cap == 0 || backend.active < cap) && !backend.ready.empty()) {
+        std::shared_ptr<Session> session = std::move(backend.ready.front());
+        backend.ready.pop_front();
+        session->ready = false;
+
+        PendingRun run = std::move(session->pending.front());
+        session->pending.pop_front();
+        session->running = true;
+        session->metrics.running = true;
+        session->metrics.runsQueued--;
+        session->metrics.totalQueueTime += elapsedSince(run.submittedAt, Clock::now());
+        backend.active++;
+
+        m_executor.submit([this, session, run = std::move(run)]() mutable { execute(session, std::move(run)); });
+    }
+}
+
+void AgentPool::execute(const std::shared_ptr<Session>& session, PendingRun run) {
+    const Clock::time_point startedAt = Clock::now();
+    bool succeeded = false;
+    bool reported = false;
+    try {
+        session->agent->runAgent(
+            run.params,
+            [&](const RunAgentResult& result) {
+                succeeded = true;
+                reported = true;
+                if (run.onSuccess) {
+                    run.onSuccess(result);
+                }
+            },
+            [&](const std::string& error) {
+                reported = true;
+                if (run.onError) {
+                    run.onError(error);
+                }
+            });
+    } catch (const std::exception& e) {
+        Logger::errorf("[AgentPool] run for session ", session->id, " threw: ", e.what());
+        if (!reported && run.onError) {
+            try {
+                run.onError(e.what());
+            } catch (...) {
+            }
+        }
+    } catch (...) {
+        Logger::errorf("[AgentPool] run for session ", session->id, " threw unknown exception");
+    }
+    const std::chrono::microseconds runTime = elapsedSince(startedAt, Clock::now());
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    SessionMetrics& metrics = session->metrics;
+    if (succeeded) {
+        metrics.runsSucceeded++;
+    } else {
+        metrics.runsFailed++;
+    }
+    metrics.running = false;
+    metrics.totalRunTime += runTime;
+    metrics.lastRunTime = runTime;
+    session->running = false;
+
+    Backend& backend = m_backends[session->backend];
+    backend.active--;
+    if (!session->pending.empty()) {
+        session->ready = true;
+        backend.ready.push_back(session);
+    }
+    schedule(backend);
+
+    if (--m_unfinishedRuns == 0) {
+        m_idleCondition.notify_all();
+    }
+}
+
+}  // namespace agui
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+#include "agent/http_agent.h"
+#include "core/executor.h"
+#include "http/http_service.h"
+
+namespace agui {
+
+struct AgentPoolOptions {
+    // Worker threads running agent runs; 0 uses std::thread::hardware_concurrency()
+    size_t workerThreads = 0;
+    // Runs in flight per backend (scheme://host[:port] of the agent URL); 0 means unlimited
+    size_t maxConcurrentRunsPerBackend = 0;
+    // Shared by every session; nullptr creates one HttpService for the pool
+    std::shared_ptr<IHttpService> httpService;
+};
+
+// Counters for one AgentPool session
+struct SessionMetrics {
+    uint64_t runsSubmitted = 0;
+    uint64_t runsSucceeded = 0;
+    uint64_t runsFailed = 0;
+    size_t runsQueued = 0;  ///< Submitted but not started
+    bool running = false;
+    std::chrono::microseconds totalQueueTime{0};  ///< Submission to start
+    std::chrono::microseconds totalRunTime{0};
+    std::chrono::microseconds lastRunTime{0};
+};
+
+/**
+ * @brief Owns many HttpAgent sessions and runs them on a shared worker pool
+ *
+ * Sessions share one IHttpService and one WorkStealingExecutor instead of each agent
+ * bringing its own service and threads; idle sessions hold no thread. This is not a
+ * non-blocking run path: every streaming run still holds a worker (see below). Runs of
+ * one session execute one at a time in submission order (HttpAgent is not thread-safe);
+ * runs of different sessions execute in parallel, up to the per-backend cap. Runs over
+ * the cap wait in a FIFO queue per backend.
+ *
+ * Callbacks run on a pool thread.
+ *
+ * Concurrency ceiling: runAgent() is synchronous and HttpService uses blocking libcurl
+ * transfers, so a run occupies its worker thread from the request until the stream ends.
+ * At most maxConcurrentRuns() (= workerThreads) runs stream at once across all backends;
+ * further runs wait in the queue even when their backend is under its cap. Idle sessions
+ * cost no threads, so the pool scales with the number of sessions, but concurrent streams
+ * scale only with workerThreads. Size it for the expected number of simultaneous streams.
+ *
+ * All methods are thread-safe.
+ */
+class AgentPool {
+public:
+    explicit AgentPool(AgentPoolOptions options = AgentPoolOptions());
+    // Waits for submitted runs to finish
+    ~AgentPool();
+
+    AgentPool(const AgentPool&) = delete;
+    AgentPool& operator=(const AgentPool&) = delete;
+
+    /**
+     * @brief Take ownership of an agent and attach the pool's HTTP service to it
+     * @throws AgentError if the session ID is empty or already in use
+     */
+    HttpAgent& addSession(const std::string& sessionId, std::unique_ptr<HttpAgent> agent);
+    /**
+     * @brief Destroy an idle session
+     * @return false if the session does not exist or has runs in flight or queued
+     */
+    bool removeSession(const std::string& sessionId);
+    // nullptr if not found. Only touch the agent while none of its runs are in flight.
+    HttpAgent* session(const std::string& sessionId) const;
+    size_t sessionCount() const;
+
+    /**
+     * @brief Queue a run; returns immediately
+     * @throws AgentError if the session does not exist
+     */
+    void submitRun(const std::string& sessionId, const RunAgentParams& params, AgentSuccessCallback onSuccess,
+                   AgentErrorCallback onError);
+    // Blocks until every submitted run has finished. Must not be called from a callback.
+    void waitIdle();
+
+    // Throws AgentError if the session does not exist
+    SessionMetrics sessionMetrics(const std::string& sessionId) const;
+    // Runs in flight against the backend serving `url`
+    size_t activeRuns(const std::string& url) const;
+    // Upper bound on runs streaming at once, across all backends: the executor's thread count
+    size_t maxConcurrentRuns() const { return m_executor.threadCount(); }
+    const WorkStealingExecutor& executor() const { return m_executor; }
+
+    // "scheme://host[:port]" part of a URL, used to group sessions for the concurrency cap
+    static std::string backendKey(const std::string& url);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct PendingRun {
+        RunAgentParams params;
+        AgentSuccessCallback onSuccess;
+        AgentErrorCallback onError;
+        Clock::time_point submittedAt;
+    };
+
+    struct Session {
+        std::string id;
+        std::unique_ptr<HttpAgent> agent;
+        std::string backend;
+        std::deque<PendingRun> pending;
+        bool running = false;
+        bool ready = false;  // queued in its backend's ready list
+        SessionMetrics metrics;
+    };
+
+    struct Backend {
+        size_t active = 0;
+        // Sessions with a pending run and none in flight, in the order they became ready
+        std::deque<std::shared_ptr<Session>> ready;
+    };
+
+    // Starts ready sessions while the backend is under its cap. Requires m_mutex.
+    void schedule(Backend& backend);
+    // Runs on a worker and holds it until runAgent() returns, i.e. for the whole stream
+    void execute(const std::shared_ptr<Session>& session, PendingRun run);
+
+    AgentPoolOptions m_options;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_idleCondition;
+    std::unordered_map<std::string, std::shared_ptr<Session>> m_sessions;
+    std::unordered_map<std::string, Backend> m_backends;
+    size_t m_unfinishedRuns = 0;
+
+    // Declared last: destroyed first, so its workers finish while the pool is still intact
+    WorkStealingExecutor m_executor;
+};
+
+}  // namespace agui
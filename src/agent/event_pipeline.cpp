@@ -0,0 +1,123 @@
+#include "agent/event_pipeline.h"
+
+#include <chrono>
+
+#include "core/logger.h"
+
+namespace agui {
+
+namespace {
+
+constexpr int kSpinIterations = 64;
+
+}  // namespace
+
+EventPipeline::EventPipeline(size_t capacity, PipelineBackpressure backpressure, ItemHandler handler)
+    : m_queue(capacity), m_backpressure(backpressure), m_handler(std::move(handler)) {
+    m_worker = std::thread([this]() { run(); });
+}
+
+EventPipeline::~EventPipeline() {
+    abort();
+}
+
+bool EventPipeline::push(Item item) {
+    if (workerStopped()) {
+        return false;
+    }
+
+    if (!m_queue.tryPush(std::move(item))) {
+        if (m_backpressure == PipelineBackpressure::Fail) {
+            return false;
+        }
+        waitUntil([&]() { return workerStopped() || m_queue.tryPush(std::move(item)); });
+        if (workerStopped()) {
+            return false;
+        }
+    }
+
+    notifyWaiters();
+    return true;
+}
+
+void EventPipeline::finish() {
+    m_closed.store(true, std::memory_order_release);
+    notifyWaiters();
+    if (m_worker.joinable()) {
+        m_worker.join();
+    }
+}
+
+void EventPipeline::abort() {
+    m_aborted.store(true, std::memory_order_release);
+    finish();
+}
+
+void EventPipeline::run() {
+    while (!m_aborted.load(std::memory_order_acquire)) {
+        std::optional<Item> item = m_queue.tryPop();
+        if (!item) {
+            // Closed is checked before the final pop so nothing pushed before finish() is lost
+            if (m_closed.load(std::memory_order_acquire)) {
+                item = m_queue.tryPop();
+                if (!item) {
+                    break;
+                }
+            } else {
+                waitUntil([this]() {
+                    return !m_queue.empty() || m_closed.load(std::memory_order_acquire) ||
+                           m_aborted.load(std::memory_order_acquire);
+                });
+                continue;
+            }
+        }
+
+        notifyWaiters();  // the producer may be blocked on a full queue
+
+        bool keepGoing = false;
+        try {
+            keepGoing = m_handler(*item);
+        } catch (const std::exception& e) {
+            // Handlers record their own errors; this only guards the thread
+            Logger::errorf("[EventPipeline] handler threw: ", e.what());
+        } catch (...) {
+            Logger::errorf("[EventPipeline] handler threw unknown exception");
+        }
+
+        if (!keepGoing) {
+            m_workerStopped.store(true, std::memory_order_release);
+            notifyWaiters();
+            break;
+        }
+    }
+}
+
+void EventPipeline::notifyWaiters() {
+    // Pairs with the fence in waitUntil(): either the waiter sees our update, or we see it waiting
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_waiters.load(std::memory_order_relaxed) > 0) {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_waitCondition.notify_all();
+    }
+}
+
+template <typename Predicate>
+void EventPipeline::waitUntil(Predicate ready) {
+    for (int i = 0; i < kSpinIterations; ++i) {
+        if (ready()) {
+            return;
+        }
+        std::this_thread::yield();
+    }
+
+    std::unique_lock<std::mutex> lock(m_waitMutex);
+    m_waiters.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    // The timeout only bounds the cost of a missed wakeup; notifyWaiters() normally wakes us
+    while (!ready()) {
+        m_waitCondition.wait_for(lock, std::chrono::milliseconds(10));
+    }
+    m_waiters.fetch_sub(1, std::memory_order_relaxed);
+}
+
+}  // namespace agui
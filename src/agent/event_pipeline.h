@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "core/event.h"
+#include "core/spsc_ring_buffer.h"
+#include "middleware/middleware.h"
+
+namespace agui {
+
+// What the producer does when the pipeline queue is full
+enum class PipelineBackpressure {
+    Block,  ///< Wait for the worker to make room (memory stays bounded; the socket read stalls)
+    Fail    ///< Fail the run immediately
+};
+
+/**
+ * @brief Hands decoded events from the network thread to a dedicated processing thread
+ *
+ * One producer (the thread delivering SSE data) pushes items into a bounded
+ * SpscRingBuffer; one worker thread, started by the constructor, pops them in order and
+ * passes them to the handler. Events from one stream are therefore processed strictly in
+ * the order they were received, but slow processing no longer blocks the socket read
+ * until the queue fills up.
+ */
+class EventPipeline {
+public:
+    struct Item {
+        // nullptr marks the end of a network read
+        std::unique_ptr<Event> event;
+        // For end-of-read markers: EndOfRead, or EndOfStream for the final one
+        FlushReason boundary = FlushReason::EndOfRead;
+    };
+
+    // Runs on the worker thread. Returning false stops the worker (the run failed);
+    // items still queued are discarded.
+    using ItemHandler = std::function<bool(Item&)>;
+
+    EventPipeline(size_t capacity, PipelineBackpressure backpressure, ItemHandler handler);
+    // Aborts the worker if finish() was not called
+    ~EventPipeline();
+
+    EventPipeline(const EventPipeline&) = delete;
+    EventPipeline& operator=(const EventPipeline&) = delete;
+
+    /**
+     * @brief Queue an item for the worker (producer thread only)
+     * @return false if the worker has stopped, or if the queue is full under
+     *         PipelineBackpressure::Fail; the item is dropped
+     */
+    bool push(Item item);
+
+    // Lets the worker drain the queue, then joins it (producer thread only)
+    void finish();
+    // Stops the worker after its current item and joins it, discarding queued items
+    void abort();
+
+    // True once the handler has returned false
+    bool workerStopped() const { return m_workerStopped.load(std::memory_order_acquire); }
+    size_t capacity() const { return m_queue.capacity(); }
+
+private:
+    void run();
+    void notifyWaiters();
+    // Sleeps until `ready` holds; spins briefly first since the other side is usually fast
+    template <typename Predicate>
+    void waitUntil(Predicate ready);
+
+    SpscRingBuffer<Item> m_queue;
+    PipelineBackpressure m_backpressure;
+    ItemHandler m_handler;
+
+    std::atomic<bool> m_closed{false};
+    std::atomic<bool> m_aborted{false};
+    std::atomic<bool> m_workerStopped{false};
+
+    std::mutex m_waitMutex;
+    std::condition_variable m_waitCondition;
+    std::atomic<int> m_waiters{0};
+
+    std::thread m_worker;
+};
+
+}  // namespace agui
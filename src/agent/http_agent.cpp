@@ -1,5 +1,6 @@
 #include "http_agent.h"
 
+#include <algorithm>
 #include <nlohmann/json.hpp>
 #include <set>
 
@@ -9,6 +10,33 @@
 
 namespace agui {
 
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+// Adds the time until it goes out of scope to *total; does nothing if total is null
+class StageTimer {
+public:
+    explicit StageTimer(std::chrono::nanoseconds* total) : m_total(total) {
+        if (m_total) {
+            m_start = Clock::now();
+        }
+    }
+    ~StageTimer() {
+        if (m_total) {
+            *m_total += Clock::now() - m_start;
+        }
+    }
+    StageTimer(const StageTimer&) = delete;
+    StageTimer& operator=(const StageTimer&) = delete;
+
+private:
+    std::chrono::nanoseconds* m_total;
+    Clock::time_point m_start;
+};
+
+}  // namespace
+
 // Builder Implementation
 
 HttpAgent::Builder::Builder() : m_timeout(30) {}
@@ -48,6 +76,49 @@ HttpAgent::Builder& HttpAgent::Builder::withInitialState(const nlohmann::json& s
     return *this;
 }
 
+HttpAgent::Builder& HttpAgent::Builder::withBatchedEventProcessing(bool enabled) {
+    m_batchedProcessing = enabled;
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withPipelinedProcessing(size_t queueCapacity,
+                                                                PipelineBackpressure backpressure) {
+    m_pipelineCapacity = queueCapacity == 0 ? 1 : queueCapacity;
+    m_pipelineBackpressure = backpressure;
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withReaderSnapshots(bool enabled) {
+    m_readerSnapshots = enabled;
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withTools(const std::vector<Tool>& tools) {
+    m_tools.insert(m_tools.end(), tools.begin(), tools.end());
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withToolSchemaHash(bool enabled) {
+    m_toolSchemaHash = enabled;
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withMetricsSink(std::shared_ptr<IMetricsSink> sink) {
+    m_metricsSink = std::move(sink);
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withTraceSink(std::shared_ptr<ITraceSink> sink) {
+    m_traceSink = std::move(sink);
+    return *this;
+}
+
+HttpAgent::Builder& HttpAgent::Builder::withVerificationLevel(VerificationLevel level, uint32_t sampleInterval) {
+    m_verificationLevel = level;
+    m_sampleInterval = sampleInterval == 0 ? 1 : sampleInterval;
+    return *this;
+}
+
 std::unique_ptr<HttpAgent> HttpAgent::Builder::build() {
     if (m_url.empty()) {
         throw AgentError(ErrorType::Validation, ErrorCode::ValidationError, "Base URL is required");
@@ -58,8 +129,23 @@ std::unique_ptr<HttpAgent> HttpAgent::Builder::build() {
         m_headers["Content-Type"] = "application/json";
     }
 
-    return std::make_unique<HttpAgent>(ConstructorAccess{}, m_url, m_headers, m_agentId,
-                                        m_initialMessages, m_initialState, m_timeout);
+    auto agent = std::make_unique<HttpAgent>(ConstructorAccess{}, m_url, m_headers, m_agentId,
+                                             m_initialMessages, m_initialState, m_timeout);
+    agent->m_verificationLevel = m_verificationLevel;
+    agent->m_sampleInterval = m_sampleInterval;
+    agent->m_batchedProcessing = m_batchedProcessing;
+    agent->m_pipelineCapacity = m_pipelineCapacity;
+    agent->m_pipelineBackpressure = m_pipelineBackpressure;
+    if (m_readerSnapshots) {
+        agent->m_eventHandler->enableSnapshots();
+    }
+    if (!m_tools.empty()) {
+        agent->m_toolSchemas = std::make_shared<ToolSchemaSet>(m_tools);
+    }
+    agent->m_sendToolSchemaHash = m_toolSchemaHash;
+    agent->m_metricsSink = m_metricsSink;
+    agent->m_traceSink = m_traceSink;
+    return agent;
 }
 
 HttpAgent::Builder HttpAgent::builder() {
@@ -73,7 +159,7 @@ HttpAgent::HttpAgent(Builder::ConstructorAccess,
                      const AgentId& agentId, const std::vector<Message>& initialMessages,
                      const nlohmann::json& initialState, uint32_t timeoutSeconds)
     : m_baseUrl(baseUrl), m_headers(headers), m_agentId(agentId), m_timeoutSeconds(timeoutSeconds) {
-    m_httpService = std::make_unique<HttpService>();
+    m_httpService = std::make_shared<HttpService>();
     m_sseParser = std::make_unique<SseParser>();
 
     m_eventHandler = std::make_shared<EventHandler>(initialMessages, initialState,
@@ -98,6 +184,10 @@ const nlohmann::json& HttpAgent::state() const {
     return m_eventHandler->state();
 }
 
+std::shared_ptr<const EventHandlerSnapshot> HttpAgent::snapshot() const {
+    return m_eventHandler->snapshot();
+}
+
 // State modification (delegated to EventHandler)
 
 void HttpAgent::addMessage(const Message& message) {
@@ -156,7 +246,19 @@ MiddlewareChain& HttpAgent::middlewareChain() {
     return m_middlewareChain;
 }
 
-void HttpAgent::setHttpService(std::unique_ptr<IHttpService> service) {
+void HttpAgent::registerTool(const Tool& tool) {
+    m_toolSchemas = m_toolSchemas->with(tool);
+}
+
+bool HttpAgent::unregisterTool(const std::string& name) {
+    if (!m_toolSchemas->contains(name)) {
+        return false;
+    }
+    m_toolSchemas = m_toolSchemas->without(name);
+    return true;
+}
+
+void HttpAgent::setHttpService(std::shared_ptr<IHttpService> service) {
     m_httpService = std::move(service);
 }
 
@@ -171,6 +273,21 @@ void HttpAgent::cancelRun() {
 void HttpAgent::runAgent(const RunAgentParams& params, AgentSuccessCallback onSuccess, AgentErrorCallback onError) {
     Logger::info("Starting agent run");
 
+    m_collectMetrics = m_metricsSink != nullptr;
+    if (m_collectMetrics) {
+        m_runMetrics = RunMetrics();
+        m_runMetrics.agentId = m_agentId;
+        m_runStartedAt = Clock::now();
+    }
+    m_runSucceeded = false;
+
+    m_runTraceSink = m_traceSink;
+    Span runSpan(m_runTraceSink.get(), "agui.run");
+    m_runSpanContext = runSpan.context();
+    if (runSpan) {
+        runSpan.setAttribute("agui.agent_id", m_agentId);
+    }
+
     m_runErrorOccurred = false;
     m_runErrorMessage.clear();
     m_runError.reset();
@@ -202,12 +319,18 @@ void HttpAgent::runAgent(const RunAgentParams& params, AgentSuccessCallback onSu
         input.messages.push_back(msg);
     }
     input.tools = params.tools;
+    input.toolSchemas = m_toolSchemas;
     input.context = params.context;
     input.forwardedProps = params.forwardedProps;
 
     Logger::debugf("Thread ID: ", input.threadId);
     Logger::debugf("Run ID: ", input.runId);
     Logger::debugf("Messages count: ", input.messages.size());
+    if (runSpan) {
+        runSpan.setAttribute("agui.thread_id", input.threadId);
+        runSpan.setAttribute("agui.run_id", input.runId);
+        runSpan.setAttribute("agui.messages", static_cast<int64_t>(input.messages.size()));
+    }
 
     // Process request through middleware
     MiddlewareContext middlewareContext(&input, nullptr);
@@ -217,20 +340,25 @@ void HttpAgent::runAgent(const RunAgentParams& params, AgentSuccessCallback onSu
     if (!m_middlewareChain.empty()) {
         Logger::infof("Processing request through ", m_middlewareChain.size(), " middlewares");
         try {
+            Span middlewareSpan("agui.middleware.request_chain");
             input = m_middlewareChain.processRequest(input, middlewareContext);
         } catch (const std::exception& e) {
             Logger::errorf("Request middleware failed: ", e.what());
+            m_runErrorMessage = std::string("Request middleware failed: ") + e.what();
             if (onError) {
-                invokeErrorCallback(onError, std::string("Request middleware failed: ") + e.what());
+                invokeErrorCallback(onError, m_runErrorMessage);
             }
+            finishRun(runSpan);
             return;
         }
 
         if (!middlewareContext.shouldContinue) {
             Logger::errorf("Middleware stopped execution");
+            m_runErrorMessage = "Middleware stopped execution";
             if (onError) {
-                invokeErrorCallback(onError, "Middleware stopped execution");
+                invokeErrorCallback(onError, m_runErrorMessage);
             }
+            finishRun(runSpan);
             return;
         }
     }
@@ -248,29 +376,64 @@ void HttpAgent::runAgent(const RunAgentParams& params, AgentSuccessCallback onSu
     // Wrapped so serialisation exceptions still clean up subscribers and invoke onError.
     try {
         HttpRequest request;
-        request.url = m_baseUrl;
-        request.method = HttpMethod::POST;
-        request.headers = m_headers;
-        request.body = input.toJson().dump();
+        {
+            Span buildSpan("agui.request.build");
+            request.url = m_baseUrl;
+            request.method = HttpMethod::POST;
+            request.headers = m_headers;
+            if (m_sendToolSchemaHash && input.toolSchemas && !input.toolSchemas->empty()) {
+                request.headers[kToolSchemaHashHeader] = input.toolSchemas->hashHex();
+            }
+            m_requestBody.clear();
+            input.appendJson(m_requestBody, &m_messageJsonCache);
+            request.body.swap(m_requestBody);
+            if (buildSpan) {
+                buildSpan.setAttribute("agui.body_bytes", static_cast<int64_t>(request.body.size()));
+            }
+        }
         // Clamp before multiply to avoid signed integer overflow (max ~24.8 days).
         static constexpr uint32_t kMaxTimeoutSeconds = 2'147'483u;
         request.timeoutMs = static_cast<int>(std::min(m_timeoutSeconds, kMaxTimeoutSeconds)) * 1000;
         request.cancelKey = m_currentRunKey;
 
+        if (m_pipelineCapacity > 0) {
+            m_pipeline = std::make_unique<EventPipeline>(
+                m_pipelineCapacity, m_pipelineBackpressure,
+                [this, context = MiddlewareContext(&m_currentInput, nullptr)](EventPipeline::Item& item) mutable {
+                    context.currentMessages = &m_eventHandler->messages();
+                    context.currentState = &m_eventHandler->state();
+                    return processPipelineItem(item, context);
+                });
+        }
+
+        if (m_collectMetrics) {
+            m_runMetrics.threadId = input.threadId;
+            m_runMetrics.runId = input.runId;
+            m_runMetrics.requestBuild = Clock::now() - m_runStartedAt;
+        }
+
         Logger::debugf("Sending request to ", m_baseUrl);
         Logger::debugf("Request body size: ", request.body.size(), " bytes");
 
-        m_httpService->sendSseRequest(
+        Span httpSpan("agui.http");
+        if (httpSpan) {
+            httpSpan.setAttribute("http.url", m_baseUrl);
+            m_httpSpanContext = httpSpan.context();
+            m_httpSpan = &httpSpan;
+            m_httpStartedAt = std::chrono::system_clock::now();
+        }
+        m_httpService->streamSseRequest(
             request,
-            // onData: Incremental processing of SSE chunks
-            [this](const HttpResponse& response) {
-                this->handleStreamData(response);
+            // onData: Incremental processing of SSE chunks, straight from the transport buffer
+            [this](std::string_view chunk) {
+                this->handleStreamData(chunk);
             },
             // onComplete: Final processing when stream ends
             [this, onSuccess, onError](const HttpResponse& response) {
                 this->handleStreamComplete(response, onSuccess, onError);
             },
             [this, onSuccess, onError](const AgentError& error) {
+                abortPipeline();
                 Logger::errorf("SSE request error: ", error.fullMessage());
                 if (!m_middlewareChain.empty()) {
                     MiddlewareContext ctx(&m_currentInput, nullptr);
@@ -281,11 +444,17 @@ void HttpAgent::runAgent(const RunAgentParams& params, AgentSuccessCallback onSu
                 m_eventHandler->notifyRunFailed(error);
                 m_eventHandler->notifyRunFinalized();
                 cleanupPerRunSubscribers();
+                m_runErrorMessage = error.what();
                 if (onError) {
                     invokeErrorCallback(onError, error.fullMessage());
                 }
             });
+        m_httpSpan = nullptr;
+        m_requestBody.swap(request.body);
     } catch (const std::exception& e) {
+        m_httpSpan = nullptr;
+        m_runErrorMessage = std::string("Failed to start agent run: ") + e.what();
+        abortPipeline();
         Logger::errorf("Failed to build or send request: ", e.what());
         AgentError buildErr(ErrorType::Execution, ErrorCode::ExecutionAgentFailed,
                             std::string("Failed to start agent run: ") + e.what());
@@ -296,6 +465,61 @@ void HttpAgent::runAgent(const RunAgentParams& params, AgentSuccessCallback onSu
             invokeErrorCallback(onError, std::string("Failed to start agent run: ") + e.what());
         }
     }
+    finishRun(runSpan);
+}
+
+void HttpAgent::recordDecodedEvent(const Event& event) {
+    const auto now = Clock::now();
+    if (m_runMetrics.events++ > 0) {
+        m_runMetrics.eventGaps.record(now - m_lastEventAt);
+    }
+    m_lastEventAt = now;
+    const EventType type = event.type();
+    if (type == EventType::RunStarted && !m_runMetrics.timeToRunStarted) {
+        m_runMetrics.timeToRunStarted = now - m_runStartedAt;
+    } else if ((type == EventType::TextMessageContent || type == EventType::TextMessageChunk) &&
+               !m_runMetrics.timeToFirstContent) {
+        m_runMetrics.timeToFirstContent = now - m_runStartedAt;
+    }
+}
+
+void HttpAgent::finishRun(Span& runSpan) {
+    if (runSpan) {
+        runSpan.setAttribute("agui.outcome", m_runSucceeded ? "success" : "failure");
+        if (!m_runSucceeded) {
+            runSpan.setError(m_runErrorMessage.empty() ? "Run failed" : m_runErrorMessage);
+        }
+    }
+    m_runTraceSink.reset();
+    m_runSpanContext = SpanContext();
+    m_httpSpanContext = SpanContext();
+    publishRunMetrics();
+}
+
+void HttpAgent::publishRunMetrics() {
+    if (!m_collectMetrics) {
+        return;
+    }
+    m_collectMetrics = false;
+    m_runMetrics.succeeded = m_runSucceeded;
+    m_runMetrics.duration = Clock::now() - m_runStartedAt;
+    try {
+        m_metricsSink->onRunCompleted(m_runMetrics);
+    } catch (const std::exception& e) {
+        Logger::errorf("Metrics sink threw: ", e.what());
+    }
+}
+
+void HttpAgent::recordHttpPhases(const HttpTimings& timings) {
+    ITraceSink* sink = m_runTraceSink.get();
+    const auto at = [this](std::chrono::microseconds offset) { return m_httpStartedAt + offset; };
+    Span::record(sink, "agui.http.dns", m_httpSpanContext, at({}), at(timings.nameLookup));
+    Span::record(sink, "agui.http.connect", m_httpSpanContext, at(timings.nameLookup), at(timings.connect));
+    const auto connected = std::max(timings.connect, timings.tlsHandshake);
+    if (timings.tlsHandshake.count() > 0) {
+        Span::record(sink, "agui.http.tls", m_httpSpanContext, at(timings.connect), at(connected));
+    }
+    Span::record(sink, "agui.http.first_byte", m_httpSpanContext, at(connected), at(timings.firstByte));
 }
 
 void HttpAgent::cleanupPerRunSubscribers() {
@@ -305,29 +529,56 @@ void HttpAgent::cleanupPerRunSubscribers() {
     m_perRunSubscribers.clear();
 }
 
-void HttpAgent::handleStreamData(const HttpResponse& response) {
-    if (m_runErrorOccurred) {
+void HttpAgent::handleStreamData(std::string_view chunk) {
+    if (m_pipeline && m_pipeline->workerStopped()) {
+        closePipeline();
+    }
+    // Run error state belongs to the worker while a pipeline is active
+    if (!m_pipeline && m_runErrorOccurred) {
         Logger::warning("Ignoring SSE chunk after run entered error state");
         return;
     }
 
+    Span chunkSpan(m_runTraceSink.get(), "agui.sse.chunk", m_httpSpanContext);
+    if (chunkSpan) {
+        chunkSpan.setAttribute("agui.bytes", static_cast<int64_t>(chunk.size()));
+    }
+
+    if (m_collectMetrics) {
+        if (m_runMetrics.chunks++ == 0) {
+            m_runMetrics.timeToFirstChunk = Clock::now() - m_runStartedAt;
+        }
+        m_runMetrics.bytes += chunk.size();
+    }
+
     try {
-        m_sseParser->feed(response.content);
-        processAvailableEvents();
+        {
+            StageTimer parseTimer(m_collectMetrics ? &m_runMetrics.parseTime : nullptr);
+            m_sseParser->feed(chunk);
+        }
+        if (m_pipeline) {
+            feedPipeline(FlushReason::EndOfRead);
+        } else {
+            processAvailableEvents();
+        }
     } catch (const AgentError& e) {
         Logger::errorf("Fatal error feeding SSE data: ", e.what());
-        m_runErrorOccurred = true;
-        m_runErrorMessage = e.what();
-        m_runError = e;  // preserve original type/code for notifyRunFailed
+        closePipeline();
+        recordRunError(e);
     } catch (const std::exception& e) {
         Logger::errorf("Fatal error feeding SSE data: ", e.what());
-        m_runErrorOccurred = true;
-        m_runErrorMessage = std::string("SSE stream error: ") + e.what();
+        closePipeline();
+        recordRunError(std::string("SSE stream error: ") + e.what());
     }
 }
 
 bool HttpAgent::processSingleEvent(std::unique_ptr<Event> event, MiddlewareContext& middlewareContext) {
-    m_eventVerifier.verify(*event);
+    const bool verifyLifecycle = m_verificationLevel != VerificationLevel::Off;
+    if (verifyLifecycle) {
+        Span verifySpan("agui.event.verify");
+        m_eventVerifier.verify(*event);
+        ++m_verificationStats.eventsVerified;
+    }
 
     bool isRunError = (event->type() == EventType::RunError);
     bool isRunFinished = (event->type() == EventType::RunFinished);
@@ -342,14 +593,19 @@ bool HttpAgent::processSingleEvent(std::unique_ptr<Event> event, MiddlewareConte
         }
     }
 
-    AgentStateMutation mutation = m_eventHandler->handleEvent(std::move(event));
+    AgentStateMutation mutation;
+    {
+        Span handleSpan("agui.event.handle");
+        mutation = m_eventHandler->handleEvent(std::move(event));
+    }
     if (mutation.hasChanges()) {
+        Span applySpan("agui.event.apply");
         m_eventHandler->applyMutation(mutation);
         middlewareContext.currentMessages = &m_eventHandler->messages();
         middlewareContext.currentState = &m_eventHandler->state();
     }
 
-    if (isRunFinished && !m_eventVerifier.isComplete()) {
+    if (isRunFinished && verifyLifecycle && !m_eventVerifier.isComplete()) {
         std::string details;
         const auto incompleteMessages = m_eventVerifier.getIncompleteMessages();
         const auto incompleteToolCalls = m_eventVerifier.getIncompleteToolCalls();
@@ -413,67 +669,261 @@ std::unique_ptr<Event> HttpAgent::parseSseEventData(const std::string& eventData
     return event;
 }
 
-void HttpAgent::processAvailableEvents() {
+bool HttpAgent::shouldValidateEvent() {
+    switch (m_verificationLevel) {
+        case VerificationLevel::Full:
+            return true;
+        case VerificationLevel::Sampled:
+            return m_sampleCounter++ % m_sampleInterval == 0;
+        case VerificationLevel::LifecycleOnly:
+        case VerificationLevel::Off:
+            return false;
+    }
+    return true;
+}
+
+void HttpAgent::processAvailableEvents(FlushReason flushReason) {
     // Prepare middleware context — pass m_currentInput so middleware can access the run input
     MiddlewareContext middlewareContext(&m_currentInput, nullptr);
     middlewareContext.currentMessages = &m_eventHandler->messages();
     middlewareContext.currentState = &m_eventHandler->state();
 
-    while (m_sseParser->hasEvent()) {
-        if (!processNextEvent(middlewareContext)) {
-            break;
+    // In batched mode every event decoded from this read forms one group, so
+    // onMessagesChanged/onStateChanged fire at most once for the whole chunk
+    if (m_batchedProcessing) {
+        m_eventHandler->beginBatch();
+    }
+
+    bool keepGoing = true;
+    while (keepGoing && m_sseParser->hasEvent()) {
+        keepGoing = processNextEvent(middlewareContext);
+    }
+
+    finishRead(middlewareContext, keepGoing, flushReason);
+}
+
+void HttpAgent::finishRead(MiddlewareContext& middlewareContext, bool keepGoing, FlushReason flushReason) {
+    // Coalescing middlewares may still hold events from this read
+    if (keepGoing && !m_middlewareChain.empty()) {
+        flushMiddlewareEvents(middlewareContext, flushReason);
+    }
+
+    if (m_batchedProcessing) {
+        try {
+            m_eventHandler->endBatch();
+        } catch (const AgentError& e) {
+            Logger::errorf("Fatal error delivering batched notifications: ", e.what());
+            recordRunError(e);
+        } catch (const std::exception& e) {
+            Logger::errorf("Fatal error delivering batched notifications: ", e.what());
+            recordRunError(std::string("Event processing error: ") + e.what());
         }
     }
 }
 
 bool HttpAgent::processNextEvent(MiddlewareContext& middlewareContext) {
+    Span eventSpan("agui.event");
     try {
-        const std::string& eventData = m_sseParser->nextEvent();
-        if (eventData.empty()) {
-            return true;
+        std::unique_ptr<Event> event = decodeNextEvent();
+        if (eventSpan && event) {
+            eventSpan.setAttribute("agui.event_type", EventParser::eventTypeToString(event->type()));
         }
+        return !event || dispatchEvent(std::move(event), middlewareContext);
+    } catch (const AgentError& e) {
+        Logger::errorf("Fatal error processing event: ", e.what());
+        eventSpan.setError(e.what());
+        m_runErrorOccurred = true;
+        m_runErrorMessage = e.what();
+        m_runError = e;  // preserve original type/code for notifyRunFailed
+        return false;
+    } catch (const std::exception& e) {
+        Logger::errorf("Fatal error processing event: ", e.what());
+        eventSpan.setError(e.what());
+        m_runErrorOccurred = true;
+        m_runErrorMessage = std::string("Event processing error: ") + e.what();
+        return false;
+    }
+}
 
-        std::unique_ptr<Event> event = parseSseEventData(eventData);
-        if (!event) {
-            // Unknown-but-well-formed event type (forward-compatibility): skip and continue.
-            // Truly malformed events throw instead of returning nullptr.
-            return true;
-        }
+std::unique_ptr<Event> HttpAgent::decodeNextEvent() {
+    StageTimer parseTimer(m_collectMetrics ? &m_runMetrics.parseTime : nullptr);
+    Span parseSpan("agui.event.parse");
+    const std::string& eventData = m_sseParser->nextEvent();
+    if (eventData.empty()) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Event> event = parseSseEventData(eventData);
+    if (!event) {
+        // Unknown-but-well-formed event type (forward-compatibility): skip and continue.
+        // Truly malformed events throw instead of returning nullptr.
+        return nullptr;
+    }
+    ++m_verificationStats.eventsSeen;
+    if (shouldValidateEvent()) {
         event->validate();
+        ++m_verificationStats.eventsValidated;
+    }
+    if (m_collectMetrics) {
+        recordDecodedEvent(*event);
+    }
+    return event;
+}
 
-        std::vector<std::unique_ptr<Event>> eventsToProcess;
-        if (!m_middlewareChain.empty()) {
-            eventsToProcess = m_middlewareChain.processEvent(std::move(event), middlewareContext);
-        } else {
-            eventsToProcess.push_back(std::move(event));
+bool HttpAgent::dispatchEvent(std::unique_ptr<Event> event, MiddlewareContext& middlewareContext) {
+    StageTimer dispatchTimer(m_collectMetrics ? &m_runMetrics.dispatchTime : nullptr);
+    if (m_middlewareChain.empty()) {
+        return !processSingleEvent(std::move(event), middlewareContext);
+    }
+
+    // Reuse the buffer's capacity across events. It is moved out while in use so a
+    // nested call cannot clobber it; an exception merely drops the capacity.
+    std::vector<std::unique_ptr<Event>> eventsToProcess = std::move(m_middlewareOutput);
+    eventsToProcess.clear();
+    m_middlewareChain.processEvent(std::move(event), middlewareContext, eventsToProcess);
+
+    bool keepGoing = true;
+    for (auto& processedEvent : eventsToProcess) {
+        if (processSingleEvent(std::move(processedEvent), middlewareContext)) {
+            keepGoing = false;
+            break;
         }
+    }
+    eventsToProcess.clear();
+    m_middlewareOutput = std::move(eventsToProcess);
+    return keepGoing;
+}
 
-        for (auto& processedEvent : eventsToProcess) {
-            if (processSingleEvent(std::move(processedEvent), middlewareContext)) {
+bool HttpAgent::flushMiddlewareEvents(MiddlewareContext& middlewareContext, FlushReason reason) {
+    StageTimer dispatchTimer(m_collectMetrics ? &m_runMetrics.dispatchTime : nullptr);
+    try {
+        for (auto& flushedEvent : m_middlewareChain.flushEvents(reason, middlewareContext)) {
+            if (processSingleEvent(std::move(flushedEvent), middlewareContext)) {
                 return false;
             }
         }
         return true;
     } catch (const AgentError& e) {
         Logger::errorf("Fatal error processing event: ", e.what());
-        m_runErrorOccurred = true;
-        m_runErrorMessage = e.what();
-        m_runError = e;  // preserve original type/code for notifyRunFailed
+        recordRunError(e);
         return false;
     } catch (const std::exception& e) {
         Logger::errorf("Fatal error processing event: ", e.what());
-        m_runErrorOccurred = true;
-        m_runErrorMessage = std::string("Event processing error: ") + e.what();
+        recordRunError(std::string("Event processing error: ") + e.what());
         return false;
     }
 }
 
+void HttpAgent::recordRunError(const AgentError& error) {
+    if (!m_runErrorOccurred) {
+        m_runErrorOccurred = true;
+        m_runErrorMessage = error.what();
+        m_runError = error;  // preserve original type/code for notifyRunFailed
+    }
+}
+
+void HttpAgent::recordRunError(const std::string& message) {
+    if (!m_runErrorOccurred) {
+        m_runErrorOccurred = true;
+        m_runErrorMessage = message;
+    }
+}
+
+void HttpAgent::feedPipeline(FlushReason boundary) {
+    bool queued = true;
+    while (queued && m_sseParser->hasEvent()) {
+        std::unique_ptr<Event> event = decodeNextEvent();
+        if (event) {
+            queued = m_pipeline->push({std::move(event), boundary});
+        }
+    }
+    if (queued) {
+        queued = m_pipeline->push({nullptr, boundary});
+    }
+
+    // A stopped worker has recorded its own error; otherwise the queue was full
+    if (!queued && !m_pipeline->workerStopped()) {
+        throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed,
+                         "Event pipeline queue full (capacity " + std::to_string(m_pipeline->capacity()) + ")");
+    }
+}
+
+bool HttpAgent::processPipelineItem(EventPipeline::Item& item, MiddlewareContext& middlewareContext) {
+    // A read's batch opens with its first item and closes at its end-of-read marker
+    if (m_batchedProcessing && !m_eventHandler->inBatch()) {
+        m_eventHandler->beginBatch();
+    }
+
+    if (item.event) {
+        // Decoded on the network thread; this span covers the rest of the event's processing
+        Span eventSpan(m_runTraceSink.get(), "agui.event", m_runSpanContext);
+        if (eventSpan) {
+            eventSpan.setAttribute("agui.event_type", EventParser::eventTypeToString(item.event->type()));
+        }
+        try {
+            if (dispatchEvent(std::move(item.event), middlewareContext)) {
+                return true;
+            }
+        } catch (const AgentError& e) {
+            Logger::errorf("Fatal error processing event: ", e.what());
+            eventSpan.setError(e.what());
+            recordRunError(e);
+        } catch (const std::exception& e) {
+            Logger::errorf("Fatal error processing event: ", e.what());
+            eventSpan.setError(e.what());
+            recordRunError(std::string("Event processing error: ") + e.what());
+        }
+    }
+
+    finishRead(middlewareContext, !m_runErrorOccurred, item.boundary);
+    return !m_runErrorOccurred;
+}
+
+void HttpAgent::closePipeline() {
+    if (m_pipeline) {
+        m_pipeline->finish();
+        m_pipeline.reset();
+    }
+    // A decode error ends the stream before the read's end-of-read marker is queued
+    endOpenBatch();
+}
+
+void HttpAgent::abortPipeline() {
+    if (m_pipeline) {
+        m_pipeline->abort();
+        m_pipeline.reset();
+    }
+    // The worker may have stopped in the middle of a read
+    endOpenBatch();
+}
+
+void HttpAgent::endOpenBatch() {
+    if (m_eventHandler->inBatch()) {
+        try {
+            m_eventHandler->endBatch();
+        } catch (const std::exception& e) {
+            Logger::warningf("Error delivering batched notifications: ", e.what());
+        }
+    }
+}
+
 void HttpAgent::handleStreamComplete(const HttpResponse& response, AgentSuccessCallback onSuccess,
                                      AgentErrorCallback onError) {
+    if (m_collectMetrics) {
+        m_runMetrics.http = response.timings;
+    }
+    if (m_httpSpan) {
+        m_httpSpan->setAttribute("http.status_code", static_cast<int64_t>(response.statusCode));
+        if (response.timings) {
+            recordHttpPhases(*response.timings);
+        }
+    }
     if (response.cancelled) {
+        abortPipeline();
         Logger::info("Agent run was cancelled by user");
         AgentError cancelErr(ErrorType::Execution, ErrorCode::ExecutionCancelled,
                              "Agent run was cancelled by user");
+        m_runErrorMessage = cancelErr.what();
         if (!m_middlewareChain.empty()) {
             MiddlewareContext ctx(&m_currentInput, nullptr);
             ctx.currentMessages = &m_eventHandler->messages();
@@ -490,9 +940,11 @@ void HttpAgent::handleStreamComplete(const HttpResponse& response, AgentSuccessC
     }
 
     if (!response.isSuccess()) {
+        abortPipeline();
         Logger::errorf("HTTP request failed with status: ", response.statusCode);
         AgentError httpErr(ErrorType::Network, ErrorCode::NetworkInvalidResponse,
                            "HTTP request failed with status: " + std::to_string(response.statusCode));
+        m_runErrorMessage = httpErr.what();
         if (!m_middlewareChain.empty()) {
             MiddlewareContext ctx(&m_currentInput, nullptr);
             ctx.currentMessages = &m_eventHandler->messages();
@@ -509,21 +961,26 @@ void HttpAgent::handleStreamComplete(const HttpResponse& response, AgentSuccessC
     }
 
     Logger::info("Stream complete, flushing remaining data");
+    const bool pipelined = m_pipeline != nullptr;
     try {
         m_sseParser->flush();
+        if (m_pipeline) {
+            feedPipeline(FlushReason::EndOfStream);
+        }
     } catch (const AgentError& e) {
         Logger::errorf("Fatal error during SSE flush: ", e.what());
-        m_runErrorOccurred = true;
-        m_runErrorMessage = e.what();
-        m_runError = e;
+        closePipeline();
+        recordRunError(e);
     } catch (const std::exception& e) {
         Logger::errorf("Fatal error during SSE flush: ", e.what());
-        m_runErrorOccurred = true;
-        m_runErrorMessage = std::string("SSE flush error: ") + e.what();
+        closePipeline();
+        recordRunError(std::string("SSE flush error: ") + e.what());
     }
+    // Wait for the worker to process everything queued
+    closePipeline();
 
-    if (!m_runErrorOccurred) {
-        processAvailableEvents();
+    if (!pipelined && !m_runErrorOccurred) {
+        processAvailableEvents(FlushReason::EndOfStream);
     }
 
     if (m_runErrorOccurred) {
@@ -558,6 +1015,7 @@ void HttpAgent::handleStreamComplete(const HttpResponse& response, AgentSuccessC
             MiddlewareContext middlewareContext(&m_currentInput, &result);
             middlewareContext.currentMessages = &m_eventHandler->messages();
             middlewareContext.currentState = &m_eventHandler->state();
+            Span middlewareSpan("agui.middleware.response_chain");
             result = m_middlewareChain.processResponse(result, middlewareContext);
         }
     } catch (const std::exception& e) {
@@ -576,6 +1034,7 @@ void HttpAgent::handleStreamComplete(const HttpResponse& response, AgentSuccessC
     m_eventHandler->notifyRunFinalized();
     cleanupPerRunSubscribers();
 
+    m_runSucceeded = true;
     if (onSuccess) {
         try {
             onSuccess(result);
@@ -1,17 +1,22 @@
 #pragma once
 
+#include <chrono>
 #include <map>
 #include <memory>
 #include <optional>
 #include <set>
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "agent.h"
+#include "agent/event_pipeline.h"
 #include "core/event.h"
 #include "core/event_verifier.h"
+#include "core/metrics.h"
 #include "core/session_types.h"
 #include "core/subscriber.h"
+#include "core/tracing.h"
 #include "http/http_service.h"
 #include "stream/sse_parser.h"
 #include "middleware/middleware.h"
@@ -41,6 +46,49 @@ public:
         Builder& withAgentId(const AgentId& id);
         Builder& withInitialMessages(const std::vector<Message>& messages);
         Builder& withInitialState(const nlohmann::json& state);
+        /**
+         * @brief Choose how much per-event checking to perform (default: Full)
+         * @param sampleInterval For VerificationLevel::Sampled, validate one event in this many
+         */
+        Builder& withVerificationLevel(VerificationLevel level, uint32_t sampleInterval = 16);
+        /**
+         * @brief Process all events decoded from one network read as a group (default: off)
+         *
+         * onMessagesChanged/onStateChanged are then delivered at most once per read
+         * instead of once per event; per-event callbacks are unchanged.
+         */
+        Builder& withBatchedEventProcessing(bool enabled = true);
+        /**
+         * @brief Process events on a dedicated thread per run (default: off)
+         *
+         * The thread delivering network data then only decodes events and queues them;
+         * middleware, verification and subscriber callbacks run on a worker thread in
+         * stream order. Subscribers must therefore tolerate being called from that thread.
+         * onSuccess/onError are still invoked on the runAgent() thread.
+         *
+         * @param queueCapacity Events that may be decoded ahead of processing
+         * @param backpressure What happens when the queue is full
+         */
+        Builder& withPipelinedProcessing(size_t queueCapacity = 1024,
+                                         PipelineBackpressure backpressure = PipelineBackpressure::Block);
+        /**
+         * @brief Publish immutable snapshots of messages and state for other threads (default: off)
+         *
+         * See HttpAgent::snapshot(). Use this when a UI or other reader thread needs the
+         * conversation while a run is streaming; messages()/state() are not safe for that.
+         */
+        Builder& withReaderSnapshots(bool enabled = true);
+        // Tools sent with every run; see HttpAgent::registerTool()
+        Builder& withTools(const std::vector<Tool>& tools);
+        /**
+         * @brief Send the registered tools' ToolSchemaSet::hashHex() in the
+         *        X-AGUI-Tool-Schema-Hash header of every request (default: off)
+         */
+        Builder& withToolSchemaHash(bool enabled = true);
+        // Collect RunMetrics for every run and report them to sink; see HttpAgent::setMetricsSink()
+        Builder& withMetricsSink(std::shared_ptr<IMetricsSink> sink);
+        // Trace every run and report its spans to sink; see HttpAgent::setTraceSink()
+        Builder& withTraceSink(std::shared_ptr<ITraceSink> sink);
         std::unique_ptr<HttpAgent> build();
 
     private:
@@ -50,6 +98,16 @@ public:
         AgentId m_agentId;
         std::vector<Message> m_initialMessages;
         nlohmann::json m_initialState = nlohmann::json::object();
+        VerificationLevel m_verificationLevel = VerificationLevel::Full;
+        uint32_t m_sampleInterval = 16;
+        bool m_batchedProcessing = false;
+        size_t m_pipelineCapacity = 0;
+        PipelineBackpressure m_pipelineBackpressure = PipelineBackpressure::Block;
+        bool m_readerSnapshots = false;
+        std::vector<Tool> m_tools;
+        bool m_toolSchemaHash = false;
+        std::shared_ptr<IMetricsSink> m_metricsSink;
+        std::shared_ptr<ITraceSink> m_traceSink;
     };
 
     // Allow Builder class to access private constructor
@@ -78,10 +136,16 @@ public:
     void runAgent(const RunAgentParams& params, AgentSuccessCallback onSuccess, AgentErrorCallback onError) override;
 
     AgentId agentId() const override;
+    const std::string& baseUrl() const { return m_baseUrl; }
 
     // State access and modification (delegated to EventHandler)
     const std::vector<Message>& messages() const;
     const nlohmann::json& state() const;
+    /**
+     * @brief Latest published snapshot of messages and state; safe to call from any thread
+     * @return nullptr unless built with Builder::withReaderSnapshots()
+     */
+    std::shared_ptr<const EventHandlerSnapshot> snapshot() const;
     void addMessage(const Message& message);
     void setMessages(const std::vector<Message>& messages);
     void setState(const nlohmann::json& state);
@@ -91,15 +155,31 @@ public:
     void unsubscribe(std::shared_ptr<IAgentSubscriber> subscriber);
     void clearSubscribers();
 
+    /**
+     * @brief Register a tool sent with every run, replacing one with the same name
+     *
+     * Registered tools are serialized here, once, and their bytes copied into each request
+     * ahead of RunAgentParams::tools. A per-run tool with the same name replaces the
+     * registered one for that run. Must not be called while a run is in progress.
+     */
+    void registerTool(const Tool& tool);
+    // Returns false if no tool with that name is registered
+    bool unregisterTool(const std::string& name);
+    // Current registered tools; the set is immutable and replaced on every change
+    std::shared_ptr<const ToolSchemaSet> registeredTools() const { return m_toolSchemas; }
+
+    static constexpr const char* kToolSchemaHashHeader = "X-AGUI-Tool-Schema-Hash";
+
     // Middleware management
     HttpAgent& use(std::shared_ptr<IMiddleware> middleware);
     MiddlewareChain& middlewareChain();
 
     /**
      * @brief Replace the HTTP service (dependency injection, useful for testing)
-     * @param service Custom IHttpService implementation
+     * @param service Custom IHttpService implementation; may be shared by several agents
+     *                if it supports concurrent requests (HttpService does)
      */
-    void setHttpService(std::unique_ptr<IHttpService> service);
+    void setHttpService(std::shared_ptr<IHttpService> service);
 
     /**
      * @brief Cancel the current agent run.
@@ -108,6 +188,30 @@ public:
      */
     void cancelRun();
 
+    /**
+     * @brief Collect RunMetrics for each run and pass them to sink when the run ends
+     *
+     * Without a sink (the default) no timestamps are taken. Takes effect from the next run.
+     */
+    void setMetricsSink(std::shared_ptr<IMetricsSink> sink) { m_metricsSink = std::move(sink); }
+    // Metrics of the last run that had a sink; read once runAgent() has returned
+    const RunMetrics& lastRunMetrics() const { return m_runMetrics; }
+
+    /**
+     * @brief Trace each run and pass its spans to sink as they end
+     *
+     * Each run is one trace rooted at an "agui.run" span, with child spans for request
+     * middleware and serialization, the HTTP request and its connection phases, each network
+     * read, and each event's parse, middleware, verify, handle and apply stages down to the
+     * individual subscriber callbacks. Without a sink (the default) no span is created.
+     * Takes effect from the next run.
+     */
+    void setTraceSink(std::shared_ptr<ITraceSink> sink) { m_traceSink = std::move(sink); }
+
+    VerificationLevel verificationLevel() const { return m_verificationLevel; }
+    // Cumulative since construction
+    const VerificationStats& verificationStats() const { return m_verificationStats; }
+
 public:
     // Public but effectively private: only Builder can construct ConstructorAccess.
     HttpAgent(Builder::ConstructorAccess,
@@ -116,11 +220,24 @@ public:
 
 private:
 
-    void handleStreamData(const HttpResponse& response);
+    void handleStreamData(std::string_view chunk);
     void handleStreamComplete(const HttpResponse& response, AgentSuccessCallback onSuccess, AgentErrorCallback onError);
-    void processAvailableEvents();
+    // Drains the SSE parser, then releases events middlewares held back for `flushReason`
+    void processAvailableEvents(FlushReason flushReason = FlushReason::EndOfRead);
     // Returns false when processing should stop (RunError detected).
     bool processNextEvent(MiddlewareContext& middlewareContext);
+    // Parses the next SSE payload and validates it if due; nullptr for events to skip. Throws on error.
+    std::unique_ptr<Event> decodeNextEvent();
+    // Runs the middleware chain and processSingleEvent(); returns false when processing should stop.
+    // Throws on error.
+    bool dispatchEvent(std::unique_ptr<Event> event, MiddlewareContext& middlewareContext);
+    // Releases held middleware events and closes the batch at the end of a read
+    void finishRead(MiddlewareContext& middlewareContext, bool keepGoing, FlushReason flushReason);
+    // Records a fatal streaming error unless an earlier one is already recorded
+    void recordRunError(const AgentError& error);
+    void recordRunError(const std::string& message);
+    // Same error handling and return value as processNextEvent()
+    bool flushMiddlewareEvents(MiddlewareContext& middlewareContext, FlushReason reason);
     RunAgentResult collectResults();
     void invokeErrorCallback(AgentErrorCallback onError, const std::string& errorMessage);
     // Called from all runAgent() exit paths to prevent per-run subscriber accumulation.
@@ -129,6 +246,27 @@ private:
     bool processSingleEvent(std::unique_ptr<Event> event, MiddlewareContext& middlewareContext);
     // Returns nullptr if JSON parsing fails.
     std::unique_ptr<Event> parseSseEventData(const std::string& eventData);
+    bool shouldValidateEvent();
+    // Run metrics (only called while m_collectMetrics is set)
+    void recordDecodedEvent(const Event& event);
+    // Called from all runAgent() exit paths: closes out the run's metrics and trace
+    void finishRun(Span& runSpan);
+    void publishRunMetrics();
+    // Child spans of the HTTP span for the connection phases, from libcurl's timings
+    void recordHttpPhases(const HttpTimings& timings);
+
+    // Pipelined mode (see Builder::withPipelinedProcessing)
+    // Decodes buffered SSE events and queues them, followed by a `boundary` marker. Throws on error.
+    void feedPipeline(FlushReason boundary);
+    // Worker-thread handler; returns false once the run has failed
+    bool processPipelineItem(EventPipeline::Item& item, MiddlewareContext& middlewareContext);
+    // Waits for queued events to be processed and joins the worker; no-op without a pipeline.
+    // Run error state may only be read from the network thread after this.
+    void closePipeline();
+    // Same, but discards queued events
+    void abortPipeline();
+    // Delivers the notifications of a batch left open by a read that did not finish
+    void endOpenBatch();
 
     std::string m_baseUrl;
     std::map<std::string, std::string> m_headers;
@@ -138,13 +276,22 @@ private:
     // Stored after middleware request processing so it can be passed as context.input
     // to MiddlewareContext during SSE streaming and response processing.
     RunAgentInput m_currentInput;
+    // Request body of the last run, kept for its capacity
+    std::string m_requestBody;
+    // Serialized history of previous requests; most messages are unchanged between turns
+    MessageJsonCache m_messageJsonCache;
+    // Registered tools, serialized once; shared with each run's RunAgentInput
+    std::shared_ptr<const ToolSchemaSet> m_toolSchemas = std::make_shared<ToolSchemaSet>();
+    bool m_sendToolSchemaHash = false;
 
     std::shared_ptr<EventHandler> m_eventHandler;
 
-    std::unique_ptr<IHttpService> m_httpService;
+    std::shared_ptr<IHttpService> m_httpService;
     std::unique_ptr<SseParser> m_sseParser;
 
     MiddlewareChain m_middlewareChain;
+    // Scratch output of m_middlewareChain.processEvent(), kept for its capacity
+    std::vector<std::unique_ptr<Event>> m_middlewareOutput;
 
     // Per-run subscribers added via RunAgentParams; removed after each runAgent() call
     std::vector<std::shared_ptr<IAgentSubscriber>> m_perRunSubscribers;
@@ -161,9 +308,37 @@ private:
     // from a non-AgentError source (network, STL, etc.).
     std::optional<AgentError> m_runError;
     EventVerifier m_eventVerifier;
+    VerificationLevel m_verificationLevel = VerificationLevel::Full;
+    uint32_t m_sampleInterval = 16;
+    uint64_t m_sampleCounter = 0;
+    VerificationStats m_verificationStats;
+    bool m_batchedProcessing = false;
+    size_t m_pipelineCapacity = 0;  // 0: pipelined mode disabled
+    PipelineBackpressure m_pipelineBackpressure = PipelineBackpressure::Block;
+
+    // Run metrics; m_collectMetrics is fixed for the duration of a run
+    std::shared_ptr<IMetricsSink> m_metricsSink;
+    bool m_collectMetrics = false;
+    RunMetrics m_runMetrics;
+    std::chrono::steady_clock::time_point m_runStartedAt;
+    std::chrono::steady_clock::time_point m_lastEventAt;
+    bool m_runSucceeded = false;
+
+    // Tracing; m_runTraceSink is the sink of the current run, null when it is not traced
+    std::shared_ptr<ITraceSink> m_traceSink;
+    std::shared_ptr<ITraceSink> m_runTraceSink;
+    SpanContext m_runSpanContext;
+    SpanContext m_httpSpanContext;
+    // The HTTP span, only while streamSseRequest() runs
+    Span* m_httpSpan = nullptr;
+    std::chrono::system_clock::time_point m_httpStartedAt;
 
     // Cancel key for the active request; used by cancelRun() to abort in-flight requests
     std::string m_currentRunKey;
+
+    // Active only while a pipelined run is streaming. Declared last so its worker
+    // thread is joined before any state it uses is destroyed.
+    std::unique_ptr<EventPipeline> m_pipeline;
 };
 
 }  // namespace agui
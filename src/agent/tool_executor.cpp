@@ -0,0 +1,413 @@
+#include "agent/tool_executor.h"
+
+#include <algorithm>
+#include <set>
+#include <thread>
+
+#include "apply/apply.h"
+#include "core/error.h"
+#include "core/logger.h"
+#include "core/uuid.h"
+#include "stream/incremental_json_parser.h"
+
+namespace agui {
+
+namespace {
+
+std::string errorContent(const std::string& message) {
+    return nlohmann::json{{"error", message}}.dump();
+}
+
+const ToolCall* findToolCall(const std::vector<Message>& messages, const ToolCallId& id) {
+    for (auto it = messages.rbegin(); it != messages.rend(); ++it) {
+        if (const ToolCall* call = ApplyModule::findToolCallById(*it, id)) {
+            return call;
+        }
+    }
+    return nullptr;
+}
+
+std::chrono::microseconds elapsedSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+}
+
+}  // namespace
+
+// ToolRegistry
+
+ToolRegistry& ToolRegistry::add(const Tool& definition, ToolHandler handler, std::chrono::milliseconds timeout) {
+    Options options;
+    options.timeout = timeout;
+    return add(definition, std::move(handler), std::move(options));
+}
+
+ToolRegistry& ToolRegistry::add(const Tool& definition, ToolHandler handler, Options options) {
+    if (definition.name.empty()) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Tool name must not be empty");
+    }
+    if (!handler) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument,
+                         "Tool handler must not be empty: " + definition.name);
+    }
+
+    std::vector<std::string> requiredFields = std::move(options.requiredFields);
+    if (requiredFields.empty() && definition.parameters.is_object()) {
+        auto it = definition.parameters.find("required");
+        if (it != definition.parameters.end() && it->is_array()) {
+            for (const auto& field : *it) {
+                if (field.is_string()) {
+                    requiredFields.push_back(field.get<std::string>());
+                }
+            }
+        }
+    }
+    m_entries[definition.name] =
+        Entry{definition, std::move(handler), options.timeout, options.speculative, std::move(requiredFields)};
+    return *this;
+}
+
+const ToolRegistry::Entry* ToolRegistry::find(const std::string& name) const {
+    auto it = m_entries.find(name);
+    return it == m_entries.end() ? nullptr : &it->second;
+}
+
+std::vector<Tool> ToolRegistry::definitions() const {
+    std::vector<Tool> tools;
+    tools.reserve(m_entries.size());
+    for (const auto& entry : m_entries) {
+        tools.push_back(entry.second.definition);
+    }
+    return tools;
+}
+
+Message ToolResult::toMessage() const {
+    return ApplyModule::createToolMessage(toolCallId, content);
+}
+
+// ToolExecutor
+
+std::shared_ptr<IExecutor> toolExecutor() {
+    static std::shared_ptr<IExecutor> executor = std::make_shared<WorkStealingExecutor>(
+        std::max<size_t>(kToolExecutorThreads, std::thread::hardware_concurrency()));
+    return executor;
+}
+
+ToolExecutor::ToolExecutor(std::shared_ptr<const ToolRegistry> registry, std::shared_ptr<IExecutor> executor)
+    : m_registry(std::move(registry)),
+      m_executor(executor ? std::move(executor) : toolExecutor()),
+      m_stats(std::make_shared<StatsState>()) {}
+
+AgentStateMutation ToolExecutor::onToolCallArgs(const ToolCallArgsEvent& event, const std::string& buffer,
+                                                const AgentSubscriberParams& params) {
+    speculate(event.toolCallId, params);
+    return AgentStateMutation();
+}
+
+AgentStateMutation ToolExecutor::onToolCallChunk(const ToolCallChunkEvent& event,
+                                                 const AgentSubscriberParams& params) {
+    // A chunk without an ID continues the previous chunked call, as in EventHandler
+    if (!event.toolCallId.empty()) {
+        m_lastChunkId = event.toolCallId;
+    }
+    if (!m_lastChunkId.empty()) {
+        speculate(m_lastChunkId, params);
+    }
+    return AgentStateMutation();
+}
+
+AgentStateMutation ToolExecutor::onToolCallEnd(const ToolCallEndEvent& event, const AgentSubscriberParams& params) {
+    const ToolCall* call = params.messages ? findToolCall(*params.messages, event.toolCallId) : nullptr;
+    if (!call) {
+        Logger::warningf("[ToolExecutor] tool call not found in messages: ", event.toolCallId);
+        return AgentStateMutation();
+    }
+    const ToolRegistry::Entry* entry = m_registry->find(call->function.name);
+    if (!entry) {
+        return AgentStateMutation();
+    }
+
+    Speculation speculation;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_candidates.erase(event.toolCallId);
+        auto it = m_speculations.find(event.toolCallId);
+        if (it != m_speculations.end()) {
+            speculation = std::move(it->second);
+            m_speculations.erase(it);
+        }
+    }
+
+    std::shared_ptr<Execution> execution;
+    if (speculation.execution) {
+        bool unchanged = false;
+        try {
+            const std::string& arguments = call->function.arguments;
+            unchanged = (arguments.empty() ? nlohmann::json::object() : nlohmann::json::parse(arguments)) ==
+                        speculation.arguments;
+        } catch (const nlohmann::json::parse_error&) {
+            // Not valid JSON after all; the rerun reports the parse error
+        }
+
+        if (unchanged) {
+            execution = std::move(speculation.execution);
+            std::chrono::microseconds saved = elapsedSince(execution->startedAt);
+            {
+                std::lock_guard<std::mutex> lock(execution->mutex);
+                if (execution->finished && execution->result.duration < saved) {
+                    saved = execution->result.duration;
+                }
+            }
+            std::lock_guard<std::mutex> lock(m_stats->mutex);
+            m_stats->stats.hits++;
+            m_stats->stats.savedTime += saved;
+        } else {
+            Logger::debugf("[ToolExecutor] arguments of ", event.toolCallId, " changed after speculative start");
+            discard(speculation.execution);
+        }
+    }
+
+    if (!execution) {
+        execution = start(*call, *entry);
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_executions.push_back(std::move(execution));
+    return AgentStateMutation();
+}
+
+void ToolExecutor::speculate(const ToolCallId& toolCallId, const AgentSubscriberParams& params) {
+    const IncrementalJsonParser* parser = params.toolCallArgs;
+    if (!parser || parser->hasError()) {
+        return;
+    }
+
+    const ToolRegistry::Entry* entry = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_candidates.find(toolCallId);
+        if (it == m_candidates.end()) {
+            // First delta of this call: the message already carries the tool name
+            const ToolCall* call = params.messages ? findToolCall(*params.messages, toolCallId) : nullptr;
+            const ToolRegistry::Entry* found = call ? m_registry->find(call->function.name) : nullptr;
+            it = m_candidates.emplace(toolCallId, found && found->speculative ? found : nullptr).first;
+        }
+        entry = it->second;
+    }
+    if (!entry) {
+        return;
+    }
+
+    nlohmann::json arguments;
+    if (entry->requiredFields.empty()) {
+        if (!parser->isComplete()) {
+            return;
+        }
+        arguments = parser->value();
+    } else {
+        for (const auto& field : entry->requiredFields) {
+            if (!parser->isFieldComplete(field)) {
+                return;
+            }
+        }
+        // Only complete fields: a value still streaming could change meaning
+        arguments = nlohmann::json::object();
+        for (const auto& field : parser->completedFields()) {
+            arguments[field] = parser->value()[field];
+        }
+    }
+
+    ToolCall call;
+    call.id = toolCallId;
+    call.function = FunctionCall(entry->definition.name, arguments.dump());
+    std::shared_ptr<Execution> execution = start(call, *entry);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_candidates[toolCallId] = nullptr;
+        m_speculations[toolCallId] = Speculation{std::move(execution), std::move(arguments)};
+    }
+    std::lock_guard<std::mutex> lock(m_stats->mutex);
+    m_stats->stats.started++;
+}
+
+void ToolExecutor::discard(const std::shared_ptr<Execution>& execution) {
+    std::lock_guard<std::mutex> lock(execution->mutex);
+    execution->discarded = true;
+    std::lock_guard<std::mutex> statsLock(m_stats->mutex);
+    m_stats->stats.misses++;
+    // Still running: the task adds its time when it finishes
+    if (execution->finished) {
+        m_stats->stats.wastedTime += execution->result.duration;
+    }
+}
+
+std::shared_ptr<ToolExecutor::Execution> ToolExecutor::start(const ToolCall& call, const ToolRegistry::Entry& entry) {
+    auto execution = std::make_shared<Execution>();
+    execution->call = call;
+    execution->timeout = entry.timeout;
+    execution->startedAt = std::chrono::steady_clock::now();
+    execution->deadline = execution->startedAt + entry.timeout;
+    execution->result.toolCallId = call.id;
+    execution->result.toolName = call.function.name;
+
+    // The registry entry is copied so the task does not depend on the registry's lifetime
+    m_executor->submit([execution, handler = entry.handler, stats = m_stats]() {
+        const auto startedAt = std::chrono::steady_clock::now();
+        ToolResult result = execution->result;
+        try {
+            const std::string& arguments = execution->call.function.arguments;
+            const nlohmann::json parsed =
+                arguments.empty() ? nlohmann::json::object() : nlohmann::json::parse(arguments);
+            result.content = handler(parsed);
+            result.succeeded = true;
+        } catch (const nlohmann::json::parse_error& e) {
+            result.content = errorContent(std::string("Invalid tool arguments: ") + e.what());
+        } catch (const std::exception& e) {
+            result.content = errorContent(e.what());
+        } catch (...) {
+            result.content = errorContent("Tool handler threw unknown exception");
+        }
+        result.duration = elapsedSince(startedAt);
+
+        std::lock_guard<std::mutex> lock(execution->mutex);
+        if (execution->discarded) {
+            std::lock_guard<std::mutex> statsLock(stats->mutex);
+            stats->stats.wastedTime += result.duration;
+        }
+        execution->result = std::move(result);
+        execution->finished = true;
+        execution->done.notify_all();
+    });
+    return execution;
+}
+
+std::vector<ToolResult> ToolExecutor::collectResults() {
+    std::vector<std::shared_ptr<Execution>> executions;
+    std::unordered_map<ToolCallId, Speculation> unconfirmed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        executions.swap(m_executions);
+        unconfirmed.swap(m_speculations);
+        m_candidates.clear();
+        m_lastChunkId.clear();
+    }
+    for (const auto& speculation : unconfirmed) {
+        discard(speculation.second.execution);
+    }
+
+    std::vector<ToolResult> results;
+    results.reserve(executions.size());
+    for (const auto& execution : executions) {
+        std::unique_lock<std::mutex> lock(execution->mutex);
+        if (execution->done.wait_until(lock, execution->deadline, [&]() { return execution->finished; })) {
+            results.push_back(execution->result);
+            continue;
+        }
+        ToolResult timedOut = execution->result;
+        timedOut.content = errorContent("Tool '" + timedOut.toolName + "' timed out after " +
+                                        std::to_string(execution->timeout.count()) + " ms");
+        timedOut.timedOut = true;
+        timedOut.duration = execution->timeout;
+        Logger::warningf("[ToolExecutor] ", timedOut.content);
+        results.push_back(std::move(timedOut));
+    }
+    return results;
+}
+
+size_t ToolExecutor::startedTools() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_executions.size();
+}
+
+SpeculationStats ToolExecutor::speculationStats() const {
+    std::lock_guard<std::mutex> lock(m_stats->mutex);
+    return m_stats->stats;
+}
+
+// ToolRunner
+
+ToolRunner::ToolRunner(HttpAgent& agent, std::shared_ptr<const ToolRegistry> registry,
+                       std::shared_ptr<IExecutor> executor)
+    : m_agent(agent),
+      m_registry(registry),
+      m_toolExecutor(std::make_shared<ToolExecutor>(std::move(registry), std::move(executor))) {}
+
+ToolRunner& ToolRunner::withMaxTurns(size_t maxTurns) {
+    m_maxTurns = maxTurns == 0 ? 1 : maxTurns;
+    return *this;
+}
+
+void ToolRunner::run(const RunAgentParams& params, AgentSuccessCallback onSuccess, AgentErrorCallback onError) {
+    m_results.clear();
+    m_turns = 0;
+
+    RunAgentParams turnParams = params;
+    for (const auto& message : turnParams.messages) {
+        m_agent.addMessage(message);
+    }
+    turnParams.messages.clear();
+    // Every turn is a new run in the same thread
+    turnParams.runId.clear();
+    if (turnParams.threadId.empty()) {
+        turnParams.threadId = UuidGenerator::generate();
+    }
+
+    std::set<std::string> advertised;
+    for (const auto& tool : turnParams.tools) {
+        advertised.insert(tool.name);
+    }
+    const auto agentTools = m_agent.registeredTools();
+    for (const auto& tool : m_registry->definitions()) {
+        if (!agentTools->contains(tool.name) && advertised.insert(tool.name).second) {
+            turnParams.tools.push_back(tool);
+        }
+    }
+    turnParams.subscribers.push_back(m_toolExecutor);
+
+    std::vector<Message> newMessages;
+    while (true) {
+        ++m_turns;
+        bool succeeded = false;
+        RunAgentResult turnResult;
+        std::string error;
+        m_agent.runAgent(
+            turnParams,
+            [&](const RunAgentResult& result) {
+                succeeded = true;
+                turnResult = result;
+            },
+            [&](const std::string& message) { error = message; });
+
+        // Collected even on failure so no handler outlives this run unobserved
+        std::vector<ToolResult> results = m_toolExecutor->collectResults();
+        if (!succeeded) {
+            if (onError) {
+                onError(error);
+            }
+            return;
+        }
+
+        newMessages.insert(newMessages.end(), turnResult.newMessages.begin(), turnResult.newMessages.end());
+        if (results.empty()) {
+            turnResult.newMessages = std::move(newMessages);
+            if (onSuccess) {
+                onSuccess(turnResult);
+            }
+            return;
+        }
+
+        for (const auto& result : results) {
+            Message message = result.toMessage();
+            m_agent.addMessage(message);
+            newMessages.push_back(std::move(message));
+            m_results.push_back(result);
+        }
+
+        if (m_turns >= m_maxTurns) {
+            if (onError) {
+                onError("Tool loop stopped after " + std::to_string(m_maxTurns) + " turns");
+            }
+            return;
+        }
+    }
+}
+
+}  // namespace agui
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "agent/http_agent.h"
+#include "core/executor.h"
+#include "core/session_types.h"
+#include "core/subscriber.h"
+
+namespace agui {
+
+// Executes one tool call. Receives the parsed arguments and returns the tool message
+// content; throwing reports the error to the agent instead.
+using ToolHandler = std::function<std::string(const nlohmann::json& arguments)>;
+
+/**
+ * @brief Client-side tools the agent may call, with their handlers
+ */
+class ToolRegistry {
+public:
+    static constexpr std::chrono::milliseconds kDefaultTimeout{30000};
+
+    struct Options {
+        std::chrono::milliseconds timeout = kDefaultTimeout;
+        // Read-only and idempotent: may start before TOOL_CALL_END (see ToolExecutor)
+        bool speculative = false;
+        // Top-level arguments that must be complete before a speculative start. Empty
+        // uses definition.parameters["required"]; with neither, the whole document.
+        std::vector<std::string> requiredFields;
+    };
+
+    struct Entry {
+        Tool definition;
+        ToolHandler handler;
+        std::chrono::milliseconds timeout;
+        bool speculative = false;
+        std::vector<std::string> requiredFields;
+    };
+
+    // Replaces any tool with the same name
+    ToolRegistry& add(const Tool& definition, ToolHandler handler,
+                      std::chrono::milliseconds timeout = kDefaultTimeout);
+    ToolRegistry& add(const Tool& definition, ToolHandler handler, Options options);
+    // nullptr if no tool has that name
+    const Entry* find(const std::string& name) const;
+    // Definitions to advertise in RunAgentParams::tools
+    std::vector<Tool> definitions() const;
+    size_t size() const { return m_entries.size(); }
+
+private:
+    std::map<std::string, Entry> m_entries;
+};
+
+struct ToolResult {
+    ToolCallId toolCallId;
+    std::string toolName;
+    // Handler output, or {"error": "..."} JSON when the call failed or timed out
+    std::string content;
+    bool succeeded = false;
+    bool timedOut = false;
+    std::chrono::microseconds duration{0};
+
+    // Tool message to send back to the agent
+    Message toMessage() const;
+};
+
+// Outcome of speculative starts, accumulated over the executor's lifetime
+struct SpeculationStats {
+    uint64_t started = 0;
+    // Final arguments matched: the result was reused
+    uint64_t hits = 0;
+    // Arguments changed or the call never ended: the result was discarded
+    uint64_t misses = 0;
+    // Sum over hits of the time between the speculative start and TOOL_CALL_END
+    std::chrono::microseconds savedTime{0};
+    // Sum over misses of the handler time spent on discarded results
+    std::chrono::microseconds wastedTime{0};
+};
+
+/**
+ * @brief Subscriber that starts registered tools as soon as their TOOL_CALL_END arrives
+ *
+ * Each call runs on the executor while the stream continues, so independent tools run
+ * concurrently and a turn with several tools takes about as long as the slowest one.
+ * Calls to tools that are not registered are left alone (they may be handled elsewhere).
+ *
+ * Tools registered as speculative start earlier, on the TOOL_CALL_ARGS delta that
+ * completes their required fields, with only the completed top-level fields as arguments.
+ * At TOOL_CALL_END the final arguments are compared with those: if equal the running call
+ * is kept, otherwise its result is discarded and the tool runs again with the final
+ * arguments. Only use this for tools that are safe to run twice or for nothing.
+ *
+ * The subscriber callbacks and collectResults() may be called from different threads.
+ */
+class ToolExecutor : public IAgentSubscriber {
+public:
+    /**
+     * @param executor Runs the handlers. nullptr uses toolExecutor(), which is separate from
+     *        defaultExecutor() so handlers cannot starve AsyncSubscriber callbacks. A handler
+     *        that outlives its timeout keeps its worker until it returns; pass an executor
+     *        sized for the handlers that may hang at the same time.
+     */
+    explicit ToolExecutor(std::shared_ptr<const ToolRegistry> registry, std::shared_ptr<IExecutor> executor = nullptr);
+
+    AgentStateMutation onToolCallArgs(const ToolCallArgsEvent& event, const std::string& buffer,
+                                      const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallChunk(const ToolCallChunkEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallEnd(const ToolCallEndEvent& event, const AgentSubscriberParams& params) override;
+
+    /**
+     * @brief Wait for every tool started so far and return their results
+     *
+     * Results are in the order the calls ended. A call still running at its deadline is
+     * reported as timed out; its handler keeps running but its result is discarded.
+     * Started calls are forgotten afterwards, so the next turn starts empty; speculative
+     * calls whose TOOL_CALL_END never arrived are discarded as misses.
+     */
+    std::vector<ToolResult> collectResults();
+    // Tools started and not yet collected, excluding unconfirmed speculative calls
+    size_t startedTools() const;
+    SpeculationStats speculationStats() const;
+
+private:
+    struct Execution {
+        ToolCall call;
+        std::chrono::steady_clock::time_point startedAt;
+        std::chrono::steady_clock::time_point deadline;
+        std::chrono::milliseconds timeout;
+        std::mutex mutex;
+        std::condition_variable done;
+        bool finished = false;
+        // Speculative result that will not be used; its duration counts as wasted
+        bool discarded = false;
+        ToolResult result;
+    };
+
+    struct Speculation {
+        std::shared_ptr<Execution> execution;
+        nlohmann::json arguments;
+    };
+
+    struct StatsState {
+        std::mutex mutex;
+        SpeculationStats stats;
+    };
+
+    std::shared_ptr<Execution> start(const ToolCall& call, const ToolRegistry::Entry& entry);
+    void speculate(const ToolCallId& toolCallId, const AgentSubscriberParams& params);
+    void discard(const std::shared_ptr<Execution>& execution);
+
+    std::shared_ptr<const ToolRegistry> m_registry;
+    std::shared_ptr<IExecutor> m_executor;
+
+    mutable std::mutex m_mutex;
+    std::vector<std::shared_ptr<Execution>> m_executions;
+    // Speculative calls started and not yet confirmed by TOOL_CALL_END, by tool call ID
+    std::unordered_map<ToolCallId, Speculation> m_speculations;
+    // Registry entry of each streaming call that may still start speculatively;
+    // nullptr once started, or when the tool is not speculative
+    std::unordered_map<ToolCallId, const ToolRegistry::Entry*> m_candidates;
+    ToolCallId m_lastChunkId;
+    // Shared with running tasks, which report the time of discarded results
+    std::shared_ptr<StatsState> m_stats;
+};
+
+// Process-wide executor for tool handlers, created on first use. Handlers usually wait on
+// I/O, so it has at least kToolExecutorThreads threads regardless of the core count.
+constexpr size_t kToolExecutorThreads = 8;
+std::shared_ptr<IExecutor> toolExecutor();
+
+/**
+ * @brief Runs an agent until it stops calling tools
+ *
+ * Each turn runs the agent with a ToolExecutor subscribed, appends a tool message per
+ * executed call (ApplyModule::createToolMessage) and runs the agent again, until a turn
+ * calls no registered tool. Messages in the initial RunAgentParams are added to the agent
+ * first so every turn sends the full history in order; registered tool definitions are
+ * added to params.tools unless a tool of that name is already listed or registered on
+ * the agent (HttpAgent::registerTool(), which serializes it once).
+ *
+ * onSuccess receives the last turn's result, with newMessages covering every turn
+ * (assistant messages and tool messages).
+ */
+class ToolRunner {
+public:
+    ToolRunner(HttpAgent& agent, std::shared_ptr<const ToolRegistry> registry,
+               std::shared_ptr<IExecutor> executor = nullptr);
+
+    // Turns allowed before the run fails (default 8)
+    ToolRunner& withMaxTurns(size_t maxTurns);
+
+    // Blocking, like HttpAgent::runAgent()
+    void run(const RunAgentParams& params, AgentSuccessCallback onSuccess, AgentErrorCallback onError);
+
+    // Every tool result of the last run(), in execution order
+    const std::vector<ToolResult>& results() const { return m_results; }
+    size_t turns() const { return m_turns; }
+
+private:
+    HttpAgent& m_agent;
+    std::shared_ptr<const ToolRegistry> m_registry;
+    std::shared_ptr<ToolExecutor> m_toolExecutor;
+    size_t m_maxTurns = 8;
+
+    std::vector<ToolResult> m_results;
+    size_t m_turns = 0;
+};
+
+}  // namespace agui
@@ -0,0 +1,229 @@
+#include "core/async_subscriber.h"
+
+#include "core/logger.h"
+
+namespace agui {
+
+namespace {
+
+template <typename EventT>
+std::shared_ptr<const EventT> copyEvent(const EventT& event) {
+    std::unique_ptr<Event> copy = event.clone();
+    return std::shared_ptr<const EventT>(static_cast<EventT*>(copy.release()));
+}
+
+}  // namespace
+
+AsyncSubscriber::AsyncSubscriber(std::shared_ptr<IAgentSubscriber> target, std::shared_ptr<IExecutor> executor,
+                                 AsyncSubscriberOptions options)
+    : m_target(std::move(target)),
+      m_options(options),
+      m_serial(executor ? std::move(executor) : defaultExecutor()),
+      m_failedCallbacks(std::make_shared<std::atomic<uint64_t>>(0)) {}
+
+void AsyncSubscriber::defer(const AgentSubscriberParams& params, Call call) {
+    std::shared_ptr<const std::vector<Message>> messages;
+    std::shared_ptr<const nlohmann::json> state;
+    if (m_options.copyConversation) {
+        if (params.messages) {
+            messages = std::make_shared<const std::vector<Message>>(*params.messages);
+        }
+        if (params.state) {
+            state = std::make_shared<const nlohmann::json>(*params.state);
+        }
+    }
+
+    m_serial.submit([target = m_target, failures = m_failedCallbacks, messages, state, call = std::move(call)]() {
+        AgentSubscriberParams deferredParams(messages.get(), state.get());
+        try {
+            call(*target, deferredParams);
+        } catch (const std::exception& e) {
+            failures->fetch_add(1, std::memory_order_relaxed);
+            Logger::errorf("[AsyncSubscriber] callback threw: ", e.what());
+        } catch (...) {
+            failures->fetch_add(1, std::memory_order_relaxed);
+            Logger::errorf("[AsyncSubscriber] callback threw unknown exception");
+        }
+    });
+}
+
+template <typename EventT>
+AgentStateMutation AsyncSubscriber::deferEvent(const EventT& event, const AgentSubscriberParams& params,
+                                               EventCallback<EventT> callback) {
+    defer(params, [copy = copyEvent(event), callback](IAgentSubscriber& target, const AgentSubscriberParams& p) {
+        (target.*callback)(*copy, p);
+    });
+    return AgentStateMutation();
+}
+
+template <typename EventT>
+AgentStateMutation AsyncSubscriber::deferWithBuffer(const EventT& event, const std::string& buffer,
+                                                    const AgentSubscriberParams& params,
+                                                    BufferCallback<EventT> callback) {
+    defer(params, [copy = copyEvent(event), buffer, callback](IAgentSubscriber& target,
+                                                              const AgentSubscriberParams& p) {
+        (target.*callback)(*copy, buffer, p);
+    });
+    return AgentStateMutation();
+}
+
+AgentStateMutation AsyncSubscriber::onEvent(const Event& event, const AgentSubscriberParams& params) {
+    std::shared_ptr<const Event> copy = event.clone();
+    defer(params, [copy](IAgentSubscriber& target, const AgentSubscriberParams& p) { target.onEvent(*copy, p); });
+    return AgentStateMutation();
+}
+
+AgentStateMutation AsyncSubscriber::onTextMessageStart(const TextMessageStartEvent& event,
+                                                       const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onTextMessageStart);
+}
+
+AgentStateMutation AsyncSubscriber::onTextMessageContent(const TextMessageContentEvent& event,
+                                                         const std::string& buffer,
+                                                         const AgentSubscriberParams& params) {
+    return deferWithBuffer(event, buffer, params, &IAgentSubscriber::onTextMessageContent);
+}
+
+AgentStateMutation AsyncSubscriber::onTextMessageEnd(const TextMessageEndEvent& event,
+                                                     const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onTextMessageEnd);
+}
+
+AgentStateMutation AsyncSubscriber::onTextMessageChunk(const TextMessageChunkEvent& event,
+                                                       const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onTextMessageChunk);
+}
+
+AgentStateMutation AsyncSubscriber::onThinkingTextMessageStart(const ThinkingTextMessageStartEvent& event,
+                                                               const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onThinkingTextMessageStart);
+}
+
+AgentStateMutation AsyncSubscriber::onThinkingTextMessageContent(const ThinkingTextMessageContentEvent& event,
+                                                                 const std::string& buffer,
+                                                                 const AgentSubscriberParams& params) {
+    return deferWithBuffer(event, buffer, params, &IAgentSubscriber::onThinkingTextMessageContent);
+}
+
+AgentStateMutation AsyncSubscriber::onThinkingTextMessageEnd(const ThinkingTextMessageEndEvent& event,
+                                                             const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onThinkingTextMessageEnd);
+}
+
+AgentStateMutation AsyncSubscriber::onToolCallStart(const ToolCallStartEvent& event,
+                                                    const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onToolCallStart);
+}
+
+AgentStateMutation AsyncSubscriber::onToolCallArgs(const ToolCallArgsEvent& event, const std::string& buffer,
+                                                   const AgentSubscriberParams& params) {
+    return deferWithBuffer(event, buffer, params, &IAgentSubscriber::onToolCallArgs);
+}
+
+AgentStateMutation AsyncSubscriber::onToolCallEnd(const ToolCallEndEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onToolCallEnd);
+}
+
+AgentStateMutation AsyncSubscriber::onToolCallChunk(const ToolCallChunkEvent& event,
+                                                    const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onToolCallChunk);
+}
+
+AgentStateMutation AsyncSubscriber::onToolCallResult(const ToolCallResultEvent& event,
+                                                     const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onToolCallResult);
+}
+
+AgentStateMutation AsyncSubscriber::onThinkingStart(const ThinkingStartEvent& event,
+                                                    const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onThinkingStart);
+}
+
+AgentStateMutation AsyncSubscriber::onThinkingEnd(const ThinkingEndEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onThinkingEnd);
+}
+
+AgentStateMutation AsyncSubscriber::onStateSnapshot(const StateSnapshotEvent& event,
+                                                    const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onStateSnapshot);
+}
+
+AgentStateMutation AsyncSubscriber::onStateDelta(const StateDeltaEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onStateDelta);
+}
+
+AgentStateMutation AsyncSubscriber::onMessagesSnapshot(const MessagesSnapshotEvent& event,
+                                                       const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onMessagesSnapshot);
+}
+
+AgentStateMutation AsyncSubscriber::onRunStarted(const RunStartedEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onRunStarted);
+}
+
+AgentStateMutation AsyncSubscriber::onRunFinished(const RunFinishedEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onRunFinished);
+}
+
+AgentStateMutation AsyncSubscriber::onRunError(const RunErrorEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onRunError);
+}
+
+AgentStateMutation AsyncSubscriber::onStepStarted(const StepStartedEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onStepStarted);
+}
+
+AgentStateMutation AsyncSubscriber::onStepFinished(const StepFinishedEvent& event,
+                                                   const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onStepFinished);
+}
+
+AgentStateMutation AsyncSubscriber::onActivitySnapshot(const ActivitySnapshotEvent& event,
+                                                       const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onActivitySnapshot);
+}
+
+AgentStateMutation AsyncSubscriber::onActivityDelta(const ActivityDeltaEvent& event,
+                                                    const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onActivityDelta);
+}
+
+AgentStateMutation AsyncSubscriber::onRawEvent(const RawEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onRawEvent);
+}
+
+AgentStateMutation AsyncSubscriber::onCustomEvent(const CustomEvent& event, const AgentSubscriberParams& params) {
+    return deferEvent(event, params, &IAgentSubscriber::onCustomEvent);
+}
+
+void AsyncSubscriber::onNewMessage(const Message& message, const AgentSubscriberParams& params) {
+    defer(params, [message](IAgentSubscriber& target, const AgentSubscriberParams& p) {
+        target.onNewMessage(message, p);
+    });
+}
+
+void AsyncSubscriber::onNewToolCall(const ToolCall& toolCall, const AgentSubscriberParams& params) {
+    defer(params, [toolCall](IAgentSubscriber& target, const AgentSubscriberParams& p) {
+        target.onNewToolCall(toolCall, p);
+    });
+}
+
+void AsyncSubscriber::onMessagesChanged(const AgentSubscriberParams& params) {
+    defer(params, [](IAgentSubscriber& target, const AgentSubscriberParams& p) { target.onMessagesChanged(p); });
+}
+
+void AsyncSubscriber::onStateChanged(const AgentSubscriberParams& params) {
+    defer(params, [](IAgentSubscriber& target, const AgentSubscriberParams& p) { target.onStateChanged(p); });
+}
+
+void AsyncSubscriber::onRunFailed(const AgentError& error, const AgentSubscriberParams& params) {
+    defer(params, [error](IAgentSubscriber& target, const AgentSubscriberParams& p) {
+        target.onRunFailed(error, p);
+    });
+}
+
+void AsyncSubscriber::onRunFinalized(const AgentSubscriberParams& params) {
+    defer(params, [](IAgentSubscriber& target, const AgentSubscriberParams& p) { target.onRunFinalized(p); });
+}
+
+}  // namespace agui
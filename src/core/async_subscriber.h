@@ -0,0 +1,120 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+
+#include "core/executor.h"
+#include "core/subscriber.h"
+
+namespace agui {
+
+struct AsyncSubscriberOptions {
+    // Copy messages and state into the params of every deferred callback. This costs a copy
+    // of the conversation per callback; without it params.messages and params.state are nullptr.
+    bool copyConversation = false;
+};
+
+/**
+ * @brief Runs another subscriber's callbacks off the stream thread
+ *
+ * Every callback copies its arguments (the event, the accumulated buffer) and queues the
+ * call on a SerialExecutor, then returns immediately, so an expensive subscriber no longer
+ * stalls the network read loop. Callbacks of one AsyncSubscriber run one at a time, in the
+ * order the events arrived; different AsyncSubscribers run in parallel.
+ *
+ * Because the call happens later:
+ * - mutations returned by the wrapped subscriber are discarded (stopPropagation included);
+ * - params.toolCallArgs is always nullptr, and params.messages / params.state are nullptr
+ *   unless AsyncSubscriberOptions::copyConversation is set. HttpAgent::snapshot() offers a
+ *   cheaper consistent view.
+ * Exceptions thrown by the wrapped subscriber are logged and counted, not propagated.
+ *
+ * @code
+ * agent->subscribe(std::make_shared<AsyncSubscriber>(std::make_shared<DatabaseWriter>()));
+ * @endcode
+ */
+class AsyncSubscriber : public IAgentSubscriber {
+public:
+    // executor nullptr uses defaultExecutor()
+    explicit AsyncSubscriber(std::shared_ptr<IAgentSubscriber> target, std::shared_ptr<IExecutor> executor = nullptr,
+                             AsyncSubscriberOptions options = AsyncSubscriberOptions());
+
+    AgentStateMutation onEvent(const Event& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onTextMessageStart(const TextMessageStartEvent& event,
+                                          const AgentSubscriberParams& params) override;
+    AgentStateMutation onTextMessageContent(const TextMessageContentEvent& event, const std::string& buffer,
+                                            const AgentSubscriberParams& params) override;
+    AgentStateMutation onTextMessageEnd(const TextMessageEndEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onTextMessageChunk(const TextMessageChunkEvent& event,
+                                          const AgentSubscriberParams& params) override;
+    AgentStateMutation onThinkingTextMessageStart(const ThinkingTextMessageStartEvent& event,
+                                                  const AgentSubscriberParams& params) override;
+    AgentStateMutation onThinkingTextMessageContent(const ThinkingTextMessageContentEvent& event,
+                                                    const std::string& buffer,
+                                                    const AgentSubscriberParams& params) override;
+    AgentStateMutation onThinkingTextMessageEnd(const ThinkingTextMessageEndEvent& event,
+                                                const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallStart(const ToolCallStartEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallArgs(const ToolCallArgsEvent& event, const std::string& buffer,
+                                      const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallEnd(const ToolCallEndEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallChunk(const ToolCallChunkEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onToolCallResult(const ToolCallResultEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onThinkingStart(const ThinkingStartEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onThinkingEnd(const ThinkingEndEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onStateSnapshot(const StateSnapshotEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onStateDelta(const StateDeltaEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onMessagesSnapshot(const MessagesSnapshotEvent& event,
+                                          const AgentSubscriberParams& params) override;
+    AgentStateMutation onRunStarted(const RunStartedEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onRunFinished(const RunFinishedEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onRunError(const RunErrorEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onStepStarted(const StepStartedEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onStepFinished(const StepFinishedEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onActivitySnapshot(const ActivitySnapshotEvent& event,
+                                          const AgentSubscriberParams& params) override;
+    AgentStateMutation onActivityDelta(const ActivityDeltaEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onRawEvent(const RawEvent& event, const AgentSubscriberParams& params) override;
+    AgentStateMutation onCustomEvent(const CustomEvent& event, const AgentSubscriberParams& params) override;
+
+    void onNewMessage(const Message& message, const AgentSubscriberParams& params) override;
+    void onNewToolCall(const ToolCall& toolCall, const AgentSubscriberParams& params) override;
+    void onMessagesChanged(const AgentSubscriberParams& params) override;
+    void onStateChanged(const AgentSubscriberParams& params) override;
+    void onRunFailed(const AgentError& error, const AgentSubscriberParams& params) override;
+    void onRunFinalized(const AgentSubscriberParams& params) override;
+
+    // Blocks until every callback queued so far has run. Must not be called from a callback.
+    void drain() { m_serial.drain(); }
+    const std::shared_ptr<IAgentSubscriber>& target() const { return m_target; }
+    // Deferred callbacks that threw; safe to read from any thread
+    uint64_t failedCallbacks() const { return m_failedCallbacks->load(std::memory_order_relaxed); }
+
+private:
+    using Call = std::function<void(IAgentSubscriber& target, const AgentSubscriberParams& params)>;
+    template <typename EventT>
+    using EventCallback = AgentStateMutation (IAgentSubscriber::*)(const EventT&, const AgentSubscriberParams&);
+    template <typename EventT>
+    using BufferCallback = AgentStateMutation (IAgentSubscriber::*)(const EventT&, const std::string&,
+                                                                    const AgentSubscriberParams&);
+
+    // Queues `call`, with params rebuilt from copies taken now
+    void defer(const AgentSubscriberParams& params, Call call);
+    template <typename EventT>
+    AgentStateMutation deferEvent(const EventT& event, const AgentSubscriberParams& params,
+                                  EventCallback<EventT> callback);
+    template <typename EventT>
+    AgentStateMutation deferWithBuffer(const EventT& event, const std::string& buffer,
+                                       const AgentSubscriberParams& params, BufferCallback<EventT> callback);
+
+    std::shared_ptr<IAgentSubscriber> m_target;
+    AsyncSubscriberOptions m_options;
+    SerialExecutor m_serial;
+    // Shared with queued calls, which may outlive this object
+    std::shared_ptr<std::atomic<uint64_t>> m_failedCallbacks;
+};
+
+}  // namespace agui
@@ -0,0 +1,556 @@
+#include "binary_log.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include "core/error.h"
+#include "core/spsc_ring_buffer.h"
+
+namespace agui {
+
+namespace {
+
+// File layout: kMagic, then site definitions and blocks of records in any order.
+// Site:  'S' u32 id, u8 level, i32 line, u32 size + file, u32 size + format
+// Block: 'B' u32 thread, u32 size + records, each kRecordHeaderBytes + arguments
+constexpr char kMagic[8] = {'A', 'G', 'U', 'I', 'B', 'L', 'G', '1'};
+constexpr char kSiteTag = 'S';
+constexpr char kBlockTag = 'B';
+
+struct Site {
+    LogLevel level;
+    std::string file;
+    int line;
+    std::string format;
+};
+
+// Byte ring of one logging thread: that thread writes, the background thread drains
+class ThreadRing {
+public:
+    ThreadRing(size_t capacity, uint32_t index) : m_buffer(capacity), m_index(index) {}
+
+    bool tryWrite(const char* data, size_t size) {
+        const uint64_t head = m_head.value.load(std::memory_order_relaxed);
+        const uint64_t tail = m_tail.value.load(std::memory_order_acquire);
+        if (size > m_buffer.size() - (head - tail)) {
+            return false;
+        }
+        const size_t offset = head % m_buffer.size();
+        const size_t first = std::min(size, m_buffer.size() - offset);
+        std::memcpy(m_buffer.data() + offset, data, first);
+        std::memcpy(m_buffer.data(), data + first, size - first);
+        m_head.value.store(head + size, std::memory_order_release);
+        return true;
+    }
+
+    // Appends every completely written record to out
+    void drain(std::string& out) {
+        const uint64_t tail = m_tail.value.load(std::memory_order_relaxed);
+        const uint64_t head = m_head.value.load(std::memory_order_acquire);
+        const size_t size = head - tail;
+        const size_t offset = tail % m_buffer.size();
+        const size_t first = std::min(size, m_buffer.size() - offset);
+        out.append(m_buffer.data() + offset, first);
+        out.append(m_buffer.data(), size - first);
+        m_tail.value.store(head, std::memory_order_release);
+    }
+
+    uint32_t index() const { return m_index; }
+
+    std::atomic<bool> abandoned{false};  // the owning thread has exited
+
+private:
+    struct alignas(SpscRingBuffer<char>::kCacheLineSize) Position {
+        std::atomic<uint64_t> value{0};
+    };
+
+    std::vector<char> m_buffer;
+    uint32_t m_index;
+    Position m_head;
+    Position m_tail;
+};
+
+// Call sites and thread rings; never destroyed, since threads may log during static destruction
+struct Registry {
+    std::mutex sitesMutex;
+    std::vector<Site> sites;
+    std::mutex ringsMutex;
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    uint32_t nextThreadIndex = 0;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+std::atomic<size_t> g_ringBytes{256 * 1024};
+std::atomic<uint64_t> g_dropped{0};
+
+// Marks the thread's ring abandoned when the thread exits; the writer frees it once drained
+struct RingHandle {
+    std::shared_ptr<ThreadRing> ring;
+    ~RingHandle() {
+        if (ring) {
+            ring->abandoned.store(true, std::memory_order_release);
+        }
+    }
+};
+
+ThreadRing* threadRing() {
+    thread_local RingHandle handle;
+    if (!handle.ring) {
+        Registry& shared = registry();
+        std::lock_guard<std::mutex> lock(shared.ringsMutex);
+        handle.ring = std::make_shared<ThreadRing>(g_ringBytes.load(), shared.nextThreadIndex++);
+        shared.rings.push_back(handle.ring);
+    }
+    return handle.ring.get();
+}
+
+template <typename T>
+bool take(const char*& data, const char* end, T& value) {
+    if (static_cast<size_t>(end - data) < sizeof(T)) {
+        return false;
+    }
+    std::memcpy(&value, data, sizeof(T));
+    data += sizeof(T);
+    return true;
+}
+
+template <typename T>
+void append(std::string& out, const T& value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    append(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+// Replaces each "{}" of format with the next argument; extra arguments are appended
+std::string formatRecord(const std::string& format, const char* args, const char* end) {
+    std::ostringstream out;
+    const auto nextArgument = [&]() {
+        uint8_t tag = 0;
+        if (!take(args, end, tag)) {
+            return false;
+        }
+        switch (static_cast<BinaryLog::ArgType>(tag)) {
+            case BinaryLog::ArgType::Int: {
+                int64_t value = 0;
+                take(args, end, value);
+                out << value;
+                break;
+            }
+            case BinaryLog::ArgType::UInt: {
+                uint64_t value = 0;
+                take(args, end, value);
+                out << value;
+                break;
+            }
+            case BinaryLog::ArgType::Double: {
+                double value = 0;
+                take(args, end, value);
+                out << value;
+                break;
+            }
+            case BinaryLog::ArgType::Bool:
+            case BinaryLog::ArgType::Char: {
+                char value = 0;
+                take(args, end, value);
+                if (static_cast<BinaryLog::ArgType>(tag) == BinaryLog::ArgType::Bool) {
+                    out << (value ? "true" : "false");
+                } else {
+                    out << value;
+                }
+                break;
+            }
+            case BinaryLog::ArgType::String: {
+                uint32_t size = 0;
+                take(args, end, size);
+                size = std::min<uint32_t>(size, static_cast<uint32_t>(end - args));
+                out.write(args, size);
+                args += size;
+                break;
+            }
+            default:
+                throw AGUI_ERROR(parse, ErrorCode::ParseEventError,
+                                 "Corrupt binary log: unknown argument type " + std::to_string(tag));
+        }
+        return true;
+    };
+
+    size_t position = 0;
+    for (size_t found; (found = format.find("{}", position)) != std::string::npos; position = found + 2) {
+        out.write(format.data() + position, static_cast<std::streamsize>(found - position));
+        if (!nextArgument()) {
+            out << "{}";
+        }
+    }
+    out.write(format.data() + position, static_cast<std::streamsize>(format.size() - position));
+    while (args < end) {
+        out << ' ';
+        nextArgument();
+    }
+    return out.str();
+}
+
+// Calls onRecord(site, timestamp, args, end) for every complete record in [data, end)
+template <typename OnRecord>
+void forEachRecord(const char* data, const char* end, OnRecord onRecord) {
+    while (static_cast<size_t>(end - data) >= BinaryLog::kRecordHeaderBytes) {
+        uint32_t size = 0;
+        uint32_t site = 0;
+        int64_t timestamp = 0;
+        const char* header = data;
+        take(header, end, size);
+        take(header, end, site);
+        take(header, end, timestamp);
+        if (size < BinaryLog::kRecordHeaderBytes || size > static_cast<size_t>(end - data)) {
+            throw AGUI_ERROR(parse, ErrorCode::ParseEventError, "Corrupt binary log: bad record size");
+        }
+        onRecord(site, timestamp, header, data + size);
+        data += size;
+    }
+}
+
+const char* levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug:
+            return "DEBUG";
+        case LogLevel::Info:
+            return "INFO";
+        case LogLevel::Warning:
+            return "WARN";
+        case LogLevel::Error:
+            return "ERROR";
+    }
+    return "?";
+}
+
+std::string utcTime(int64_t nanoseconds) {
+    const std::time_t seconds = static_cast<std::time_t>(nanoseconds / 1000000000);
+    std::tm utc{};
+#if defined(_WIN32)
+    gmtime_s(&utc, &seconds);
+#else
+    gmtime_r(&seconds, &utc);
+#endif
+    char date[32];
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", &utc);
+    char fraction[16];
+    std::snprintf(fraction, sizeof(fraction), ".%09lldZ", static_cast<long long>(nanoseconds % 1000000000));
+    return std::string(date) + fraction;
+}
+
+std::string baseName(const std::string& path) {
+    const size_t slash = path.find_last_of("/\\");
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Background thread of a recording session
+class Session {
+public:
+    explicit Session(const BinaryLog::Options& options) : m_options(options) {
+        if (!options.path.empty()) {
+            m_file.open(options.path, std::ios::binary | std::ios::app);
+            if (!m_file) {
+                throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument,
+                                 "Cannot open binary log file: " + options.path);
+            }
+            m_file.write(kMagic, sizeof(kMagic));
+        }
+        m_thread = std::thread([this] { run(); });
+    }
+
+    void flush() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        const uint64_t requested = ++m_requestedDrains;
+        m_wake.notify_one();
+        m_drained.wait(lock, [&] { return m_completedDrains >= requested; });
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_wake.notify_one();
+        }
+        m_thread.join();
+        if (m_file.is_open()) {
+            m_file.flush();
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        for (;;) {
+            m_wake.wait_for(lock, m_options.flushInterval,
+                            [this] { return m_stopping || m_requestedDrains > m_completedDrains; });
+            const uint64_t requested = m_requestedDrains;
+            const bool stopping = m_stopping;
+            lock.unlock();
+            drain();
+            lock.lock();
+            m_completedDrains = std::max(m_completedDrains, requested);
+            m_drained.notify_all();
+            if (stopping) {
+                return;
+            }
+        }
+    }
+
+    void drain() {
+        std::vector<std::pair<uint32_t, std::string>> blocks;
+        {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.ringsMutex);
+            for (auto it = shared.rings.begin(); it != shared.rings.end();) {
+                // Read before draining: an abandoned ring receives no more records
+                const bool abandoned = (*it)->abandoned.load(std::memory_order_acquire);
+                std::string bytes;
+                (*it)->drain(bytes);
+                if (!bytes.empty()) {
+                    blocks.emplace_back((*it)->index(), std::move(bytes));
+                }
+                it = abandoned ? shared.rings.erase(it) : std::next(it);
+            }
+        }
+        if (blocks.empty()) {
+            return;
+        }
+
+        // Every site used by the drained records was registered before they were written
+        {
+            Registry& shared = registry();
+            std::lock_guard<std::mutex> lock(shared.sitesMutex);
+            for (; m_sitesKnown < shared.sites.size(); ++m_sitesKnown) {
+                m_sites.push_back(shared.sites[m_sitesKnown]);
+            }
+        }
+        if (m_file.is_open()) {
+            writeSites();
+            for (const auto& block : blocks) {
+                std::string header(1, kBlockTag);
+                append(header, block.first);
+                append(header, static_cast<uint32_t>(block.second.size()));
+                m_file.write(header.data(), static_cast<std::streamsize>(header.size()));
+                m_file.write(block.second.data(), static_cast<std::streamsize>(block.second.size()));
+            }
+            m_file.flush();
+        }
+        if (m_options.forwardToLogger) {
+            for (const auto& block : blocks) {
+                const char* data = block.second.data();
+                forEachRecord(data, data + block.second.size(),
+                              [&](uint32_t site, int64_t, const char* args, const char* end) {
+                                  if (site < m_sites.size()) {
+                                      Logger::log(m_sites[site].level, formatRecord(m_sites[site].format, args, end));
+                                  }
+                              });
+            }
+        }
+    }
+
+    void writeSites() {
+        std::string out;
+        for (; m_sitesWritten < m_sites.size(); ++m_sitesWritten) {
+            const Site& site = m_sites[m_sitesWritten];
+            out += kSiteTag;
+            append(out, static_cast<uint32_t>(m_sitesWritten));
+            append(out, static_cast<uint8_t>(site.level));
+            append(out, static_cast<int32_t>(site.line));
+            appendString(out, site.file);
+            appendString(out, site.format);
+        }
+        m_file.write(out.data(), static_cast<std::streamsize>(out.size()));
+    }
+
+    BinaryLog::Options m_options;
+    std::ofstream m_file;
+    std::vector<Site> m_sites;  // copy of the registered sites, read without locking
+    size_t m_sitesKnown = 0;
+    size_t m_sitesWritten = 0;
+
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    uint64_t m_requestedDrains = 0;  // guarded by m_mutex
+    uint64_t m_completedDrains = 0;  // guarded by m_mutex
+    bool m_stopping = false;         // guarded by m_mutex
+    std::thread m_thread;
+};
+
+std::mutex g_sessionMutex;
+std::unique_ptr<Session> g_session;
+
+// Drops records that no session will write, and frees the rings of exited threads that
+// the session's drains did not get to. Requires g_sessionMutex and no running session.
+void discardRecordsAndReapRings() {
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.ringsMutex);
+    std::string discarded;
+    for (auto it = shared.rings.begin(); it != shared.rings.end();) {
+        const bool abandoned = (*it)->abandoned.load(std::memory_order_acquire);
+        (*it)->drain(discarded);
+        discarded.clear();
+        it = abandoned ? shared.rings.erase(it) : std::next(it);
+    }
+}
+
+// Writes what is still buffered at process exit
+struct SessionShutdown {
+    ~SessionShutdown() { BinaryLog::stop(); }
+} g_sessionShutdown;
+
+}  // namespace
+
+void BinaryLog::start(const Options& options) {
+    std::lock_guard<std::mutex> lock(g_sessionMutex);
+    if (g_session) {
+        s_threshold.store(kDisabled, std::memory_order_relaxed);
+        g_session->stop();
+        g_session.reset();
+    }
+    // Records written while no session was active are discarded
+    discardRecordsAndReapRings();
+    g_ringBytes.store(std::max<size_t>(options.threadBufferBytes, 4096));
+    g_session = std::make_unique<Session>(options);
+    s_threshold.store(static_cast<int>(options.minLevel), std::memory_order_relaxed);
+}
+
+void BinaryLog::stop() {
+    std::lock_guard<std::mutex> lock(g_sessionMutex);
+    if (g_session) {
+        s_threshold.store(kDisabled, std::memory_order_relaxed);
+        g_session->stop();
+        g_session.reset();
+    }
+    discardRecordsAndReapRings();
+}
+
+void BinaryLog::flush() {
+    std::lock_guard<std::mutex> lock(g_sessionMutex);
+    if (g_session) {
+        g_session->flush();
+    }
+}
+
+size_t BinaryLog::threadBuffers() {
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.ringsMutex);
+    return shared.rings.size();
+}
+
+uint64_t BinaryLog::droppedRecords() {
+    return g_dropped.load(std::memory_order_relaxed);
+}
+
+uint32_t BinaryLog::registerSite(LogLevel level, const char* file, int line, const char* format) {
+    Registry& shared = registry();
+    std::lock_guard<std::mutex> lock(shared.sitesMutex);
+    shared.sites.push_back({level, file, line, format});
+    return static_cast<uint32_t>(shared.sites.size() - 1);
+}
+
+std::string& BinaryLog::scratch() {
+    thread_local std::string record;
+    return record;
+}
+
+void BinaryLog::commit(uint32_t site, std::string& record) {
+    const uint32_t size = static_cast<uint32_t>(record.size());
+    const int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                  std::chrono::system_clock::now().time_since_epoch())
+                                  .count();
+    std::memcpy(&record[0], &size, sizeof(size));
+    std::memcpy(&record[4], &site, sizeof(site));
+    std::memcpy(&record[8], &timestamp, sizeof(timestamp));
+    if (!threadRing()->tryWrite(record.data(), record.size())) {
+        g_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+size_t BinaryLog::decode(std::istream& in, std::ostream& out) {
+    char magic[sizeof(kMagic)];
+    if (!in.read(magic, sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        throw AGUI_ERROR(parse, ErrorCode::ParseEventError, "Not a binary log file");
+    }
+
+    const auto readExactly = [&in](std::string& bytes, size_t size) {
+        bytes.resize(size);
+        return static_cast<bool>(in.read(&bytes[0], static_cast<std::streamsize>(size)));
+    };
+    const auto readValue = [&in](auto& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    };
+    const auto readString = [&](std::string& value) {
+        uint32_t size = 0;
+        return readValue(size) && readExactly(value, size);
+    };
+
+    std::vector<std::optional<Site>> sites;
+    size_t records = 0;
+    std::string block;
+    char tag = 0;
+    // A file appended to by several sessions repeats the magic and restarts site IDs
+    while (in.get(tag)) {
+        if (tag == kMagic[0]) {
+            if (!in.read(magic + 1, sizeof(kMagic) - 1) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+                throw AGUI_ERROR(parse, ErrorCode::ParseEventError, "Corrupt binary log: bad section tag");
+            }
+            sites.clear();
+        } else if (tag == kSiteTag) {
+            uint32_t id = 0;
+            uint8_t level = 0;
+            int32_t line = 0;
+            Site site;
+            if (!readValue(id) || !readValue(level) || !readValue(line) || !readString(site.file) ||
+                !readString(site.format)) {
+                break;
+            }
+            site.level = static_cast<LogLevel>(level);
+            site.line = line;
+            if (id >= sites.size()) {
+                sites.resize(id + 1);
+            }
+            sites[id] = std::move(site);
+        } else if (tag == kBlockTag) {
+            uint32_t thread = 0;
+            uint32_t size = 0;
+            if (!readValue(thread) || !readValue(size) || !readExactly(block, size)) {
+                break;
+            }
+            forEachRecord(block.data(), block.data() + block.size(),
+                          [&](uint32_t id, int64_t timestamp, const char* args, const char* end) {
+                              if (id >= sites.size() || !sites[id]) {
+                                  throw AGUI_ERROR(parse, ErrorCode::ParseEventError,
+                                                   "Corrupt binary log: unknown site " + std::to_string(id));
+                              }
+                              const Site& site = *sites[id];
+                              out << utcTime(timestamp) << ' ' << levelName(site.level) << ' ' << thread << ' '
+                                  << baseName(site.file) << ':' << site.line << ' '
+                                  << formatRecord(site.format, args, end) << '\n';
+                              ++records;
+                          });
+        } else {
+            throw AGUI_ERROR(parse, ErrorCode::ParseEventError, "Corrupt binary log: bad section tag");
+        }
+    }
+    return records;
+}
+
+}  // namespace agui
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <iosfwd>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "core/logger.h"
+
+namespace agui {
+
+/**
+ * @brief Structured binary logging with deferred formatting
+ *
+ * AGUI_BLOG_INFO("Run {} received {} events", runId, count) does not format anything on the
+ * calling thread. It appends the call site's ID, a timestamp and the raw argument values to
+ * a per-thread byte ring; a background thread drains the rings and either writes the records
+ * to a file (decoded offline by agui_logdecode) or formats them and passes the text to the
+ * Logger callback. Call sites register their level, location and format string once, on
+ * first use.
+ *
+ * Placeholders are "{}". Integers, floating point, bool, char and strings are stored as
+ * values; any other type with an operator<< is formatted into a string at the call site.
+ * When a thread's ring is full the record is dropped and counted, so logging never waits
+ * for the background thread.
+ */
+class BinaryLog {
+public:
+    struct Options {
+        // Binary log file to append to; empty for none
+        std::string path;
+        // Format records in the background thread and pass them to Logger's callback
+        bool forwardToLogger = false;
+        // Messages below this level are not recorded
+        LogLevel minLevel = LogLevel::Info;
+        // Ring size per logging thread
+        size_t threadBufferBytes = 256 * 1024;
+        // How often the background thread drains the rings
+        std::chrono::milliseconds flushInterval{20};
+    };
+
+    /**
+     * @brief Start recording; stops a previous session first
+     * @throws AgentError if the file cannot be opened
+     */
+    static void start(const Options& options);
+    // Writes everything recorded so far, then stops recording. Frees the rings of threads
+    // that have exited, even when no session is running.
+    static void stop();
+    // Blocks until everything recorded before the call has been written or forwarded
+    static void flush();
+
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= AGUI_LOG_MIN_LEVEL &&
+               static_cast<int>(level) >= s_threshold.load(std::memory_order_relaxed);
+    }
+
+    // Records dropped because a thread's ring was full, over the process lifetime
+    static uint64_t droppedRecords();
+    // Thread rings allocated. A ring lives until its thread has exited and a drain,
+    // start() or stop() has run since.
+    static size_t threadBuffers();
+
+    // Used by the AGUI_BLOG macros
+    static uint32_t registerSite(LogLevel level, const char* file, int line, const char* format);
+
+    template <typename... Args>
+    static void write(uint32_t site, const char* /*format*/, const Args&... args) {
+        std::string& record = scratch();
+        record.resize(kRecordHeaderBytes);
+        (encode(record, args), ...);
+        commit(site, record);
+    }
+
+    /**
+     * @brief Decodes a file written by BinaryLog into one text line per record
+     *
+     * Lines read "<UTC time> <level> <thread> <file>:<line> <message>", in the order the
+     * background thread wrote them (per thread, records are in call order).
+     * @return Number of records decoded
+     * @throws AgentError if the stream is not a binary log or is corrupt; a record cut off
+     *         at the end of the stream (e.g. by a crash) ends decoding without an error
+     */
+    static size_t decode(std::istream& in, std::ostream& out);
+
+    // Argument tags of the binary format
+    enum class ArgType : uint8_t { Int = 1, UInt = 2, Double = 3, Bool = 4, Char = 5, String = 6 };
+
+    // Record header: payload size (u32), site ID (u32), timestamp in ns since the epoch (i64)
+    static constexpr size_t kRecordHeaderBytes = 16;
+
+private:
+    static constexpr int kDisabled = 4;
+    static inline std::atomic<int> s_threshold{kDisabled};
+
+    static std::string& scratch();
+    static void commit(uint32_t site, std::string& record);
+
+    template <typename T>
+    static void put(std::string& out, const T& value) {
+        char bytes[sizeof(T)];
+        std::memcpy(bytes, &value, sizeof(T));
+        out.append(bytes, sizeof(T));
+    }
+
+    static void putString(std::string& out, std::string_view value) {
+        out.push_back(static_cast<char>(ArgType::String));
+        put(out, static_cast<uint32_t>(value.size()));
+        out.append(value.data(), value.size());
+    }
+
+    template <typename T>
+    static void encode(std::string& out, const T& value) {
+        using U = std::decay_t<T>;
+        if constexpr (std::is_same_v<U, bool>) {
+            out.push_back(static_cast<char>(ArgType::Bool));
+            out.push_back(value ? 1 : 0);
+        } else if constexpr (std::is_same_v<U, char>) {
+            out.push_back(static_cast<char>(ArgType::Char));
+            out.push_back(value);
+        } else if constexpr (std::is_integral_v<U> && std::is_signed_v<U>) {
+            out.push_back(static_cast<char>(ArgType::Int));
+            put(out, static_cast<int64_t>(value));
+        } else if constexpr (std::is_integral_v<U>) {
+            out.push_back(static_cast<char>(ArgType::UInt));
+            put(out, static_cast<uint64_t>(value));
+        } else if constexpr (std::is_floating_point_v<U>) {
+            out.push_back(static_cast<char>(ArgType::Double));
+            put(out, static_cast<double>(value));
+        } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+            putString(out, value ? std::string_view(value) : std::string_view("(null)"));
+        } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+            putString(out, std::string_view(value));
+        } else {
+            std::ostringstream text;
+            text << value;
+            putString(out, text.str());
+        }
+    }
+};
+
+namespace detail {
+// First macro argument, the format string
+template <typename... Args>
+constexpr const char* blogFormat(const char* format, const Args&...) {
+    return format;
+}
+}  // namespace detail
+
+}  // namespace agui
+
+/**
+ * Records a message through BinaryLog: AGUI_BLOG(LogLevel::Info, "format {}", args...).
+ * Levels below AGUI_LOG_MIN_LEVEL compile to nothing; arguments are only evaluated when
+ * the level is enabled.
+ */
+#define AGUI_BLOG(level, ...)                                                                    \
+    do {                                                                                         \
+        if (::agui::BinaryLog::isEnabled(level)) {                                               \
+            static const uint32_t aguiBlogSite = ::agui::BinaryLog::registerSite(                \
+                level, __FILE__, __LINE__, ::agui::detail::blogFormat(__VA_ARGS__));             \
+            ::agui::BinaryLog::write(aguiBlogSite, __VA_ARGS__);                                 \
+        }                                                                                        \
+    } while (false)
+
+#define AGUI_BLOG_DEBUG(...) AGUI_BLOG(::agui::LogLevel::Debug, __VA_ARGS__)
+#define AGUI_BLOG_INFO(...) AGUI_BLOG(::agui::LogLevel::Info, __VA_ARGS__)
+#define AGUI_BLOG_WARNING(...) AGUI_BLOG(::agui::LogLevel::Warning, __VA_ARGS__)
+#define AGUI_BLOG_ERROR(...) AGUI_BLOG(::agui::LogLevel::Error, __VA_ARGS__)
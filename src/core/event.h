@@ -77,8 +77,7 @@ public:
     Event() = default;
     virtual ~Event() = default;
 
-    // Non-copyable, movable
-    Event(const Event&) = delete;
+    // Not copyable through the base (no slicing); concrete events copy via clone()
     Event& operator=(const Event&) = delete;
     Event(Event&&) = default;
     Event& operator=(Event&&) = default;
@@ -86,11 +85,15 @@ public:
     virtual EventType type() const = 0;
     virtual nlohmann::json toJson() const = 0;
     virtual void validate() const {}
+    // Deep copy, e.g. for handing an event to another thread while the original is processed
+    virtual std::unique_ptr<Event> clone() const = 0;
 
     const BaseEventData& baseData() const { return m_baseData; }
     void setRawEvent(const nlohmann::json& raw);
 
 protected:
+    Event(const Event&) = default;
+
     // Returns a JSON object pre-populated with base fields (timestamp, rawEvent).
     // Derived toJson() implementations should start from this.
     nlohmann::json baseFieldsToJson() const;
@@ -101,6 +104,7 @@ struct TextMessageStartEvent : public Event {
     std::optional<MessageRole> role;
 
     EventType type() const override { return EventType::TextMessageStart; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<TextMessageStartEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static TextMessageStartEvent fromJson(const nlohmann::json& j);
@@ -111,6 +115,7 @@ struct TextMessageContentEvent : public Event {
     std::string delta;
 
     EventType type() const override { return EventType::TextMessageContent; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<TextMessageContentEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static TextMessageContentEvent fromJson(const nlohmann::json& j);
@@ -120,6 +125,7 @@ struct TextMessageEndEvent : public Event {
     MessageId messageId;
 
     EventType type() const override { return EventType::TextMessageEnd; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<TextMessageEndEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static TextMessageEndEvent fromJson(const nlohmann::json& j);
@@ -134,12 +140,14 @@ struct TextMessageChunkEvent : public Event {
     std::optional<std::string> name;
 
     EventType type() const override { return EventType::TextMessageChunk; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<TextMessageChunkEvent>(*this); }
     nlohmann::json toJson() const override;
     static TextMessageChunkEvent fromJson(const nlohmann::json& j);
 };
 
 struct ThinkingTextMessageStartEvent : public Event {
     EventType type() const override { return EventType::ThinkingTextMessageStart; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ThinkingTextMessageStartEvent>(*this); }
     nlohmann::json toJson() const override;
     static ThinkingTextMessageStartEvent fromJson(const nlohmann::json& j);
 };
@@ -148,12 +156,14 @@ struct ThinkingTextMessageContentEvent : public Event {
     std::string delta;
 
     EventType type() const override { return EventType::ThinkingTextMessageContent; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ThinkingTextMessageContentEvent>(*this); }
     nlohmann::json toJson() const override;
     static ThinkingTextMessageContentEvent fromJson(const nlohmann::json& j);
 };
 
 struct ThinkingTextMessageEndEvent : public Event {
     EventType type() const override { return EventType::ThinkingTextMessageEnd; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ThinkingTextMessageEndEvent>(*this); }
     nlohmann::json toJson() const override;
     static ThinkingTextMessageEndEvent fromJson(const nlohmann::json& j);
 };
@@ -164,6 +174,7 @@ struct ToolCallStartEvent : public Event {
     std::optional<MessageId> parentMessageId;
 
     EventType type() const override { return EventType::ToolCallStart; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ToolCallStartEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static ToolCallStartEvent fromJson(const nlohmann::json& j);
@@ -174,6 +185,7 @@ struct ToolCallArgsEvent : public Event {
     std::string delta;
 
     EventType type() const override { return EventType::ToolCallArgs; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ToolCallArgsEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static ToolCallArgsEvent fromJson(const nlohmann::json& j);
@@ -183,6 +195,7 @@ struct ToolCallEndEvent : public Event {
     ToolCallId toolCallId;
 
     EventType type() const override { return EventType::ToolCallEnd; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ToolCallEndEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static ToolCallEndEvent fromJson(const nlohmann::json& j);
@@ -196,6 +209,7 @@ struct ToolCallChunkEvent : public Event {
     std::optional<MessageId> parentMessageId;
 
     EventType type() const override { return EventType::ToolCallChunk; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ToolCallChunkEvent>(*this); }
     nlohmann::json toJson() const override;
     static ToolCallChunkEvent fromJson(const nlohmann::json& j);
 };
@@ -207,6 +221,7 @@ struct ToolCallResultEvent : public Event {
     std::optional<MessageRole> role;
 
     EventType type() const override { return EventType::ToolCallResult; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ToolCallResultEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static ToolCallResultEvent fromJson(const nlohmann::json& j);
@@ -214,12 +229,14 @@ struct ToolCallResultEvent : public Event {
 
 struct ThinkingStartEvent : public Event {
     EventType type() const override { return EventType::ThinkingStart; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ThinkingStartEvent>(*this); }
     nlohmann::json toJson() const override;
     static ThinkingStartEvent fromJson(const nlohmann::json& j);
 };
 
 struct ThinkingEndEvent : public Event {
     EventType type() const override { return EventType::ThinkingEnd; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ThinkingEndEvent>(*this); }
     nlohmann::json toJson() const override;
     static ThinkingEndEvent fromJson(const nlohmann::json& j);
 };
@@ -228,6 +245,7 @@ struct StateSnapshotEvent : public Event {
     nlohmann::json snapshot;
 
     EventType type() const override { return EventType::StateSnapshot; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<StateSnapshotEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static StateSnapshotEvent fromJson(const nlohmann::json& j);
@@ -237,6 +255,7 @@ struct StateDeltaEvent : public Event {
     nlohmann::json delta;  // JSON Patch array (RFC 6902)
 
     EventType type() const override { return EventType::StateDelta; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<StateDeltaEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static StateDeltaEvent fromJson(const nlohmann::json& j);
@@ -246,6 +265,7 @@ struct MessagesSnapshotEvent : public Event {
     std::vector<Message> messages;
 
     EventType type() const override { return EventType::MessagesSnapshot; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<MessagesSnapshotEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static MessagesSnapshotEvent fromJson(const nlohmann::json& j);
@@ -259,6 +279,7 @@ struct ActivitySnapshotEvent : public Event {
     bool replace = true;
 
     EventType type() const override { return EventType::ActivitySnapshot; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ActivitySnapshotEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static ActivitySnapshotEvent fromJson(const nlohmann::json& j);
@@ -271,6 +292,7 @@ struct ActivityDeltaEvent : public Event {
     std::vector<JsonPatchOp> patch;
 
     EventType type() const override { return EventType::ActivityDelta; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<ActivityDeltaEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static ActivityDeltaEvent fromJson(const nlohmann::json& j);
@@ -281,6 +303,7 @@ struct RunStartedEvent : public Event {
     RunId runId;
 
     EventType type() const override { return EventType::RunStarted; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<RunStartedEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static RunStartedEvent fromJson(const nlohmann::json& j);
@@ -292,6 +315,7 @@ struct RunFinishedEvent : public Event {
     nlohmann::json result;
 
     EventType type() const override { return EventType::RunFinished; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<RunFinishedEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static RunFinishedEvent fromJson(const nlohmann::json& j);
@@ -302,6 +326,7 @@ struct RunErrorEvent : public Event {
     std::optional<std::string> code;
 
     EventType type() const override { return EventType::RunError; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<RunErrorEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static RunErrorEvent fromJson(const nlohmann::json& j);
@@ -311,6 +336,7 @@ struct StepStartedEvent : public Event {
     std::string stepName;
 
     EventType type() const override { return EventType::StepStarted; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<StepStartedEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static StepStartedEvent fromJson(const nlohmann::json& j);
@@ -320,6 +346,7 @@ struct StepFinishedEvent : public Event {
     std::string stepName;
 
     EventType type() const override { return EventType::StepFinished; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<StepFinishedEvent>(*this); }
     nlohmann::json toJson() const override;
     void validate() const override;
     static StepFinishedEvent fromJson(const nlohmann::json& j);
@@ -330,6 +357,7 @@ struct RawEvent : public Event {
     std::optional<std::string> source;
 
     EventType type() const override { return EventType::Raw; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<RawEvent>(*this); }
     nlohmann::json toJson() const override;
     static RawEvent fromJson(const nlohmann::json& j);
 };
@@ -339,6 +367,7 @@ struct CustomEvent : public Event {
     nlohmann::json value;
 
     EventType type() const override { return EventType::Custom; }
+    std::unique_ptr<Event> clone() const override { return std::make_unique<CustomEvent>(*this); }
     nlohmann::json toJson() const override;
     static CustomEvent fromJson(const nlohmann::json& j);
 };
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "core/event.h"
+#include "core/mpsc_ring_buffer.h"
+#include "core/spsc_ring_buffer.h"
+#include "core/subscriber.h"
+
+namespace agui {
+
+// Lock-free queues for handing events to another thread (e.g. a UI thread)
+using SpscEventQueue = SpscRingBuffer<std::unique_ptr<Event>>;
+using MpscEventQueue = MpscRingBuffer<std::unique_ptr<Event>>;
+
+/**
+ * @brief Subscriber that copies every event into a lock-free queue
+ *
+ * Use SpscEventQueue when one agent feeds the consumer, MpscEventQueue when several
+ * agents (each streaming on its own thread) share one consumer. The subscriber never
+ * blocks the streaming thread: when the queue is full the event is dropped and counted.
+ *
+ * @code
+ * auto queue = std::make_shared<SpscEventQueue>(4096);
+ * agent->subscribe(std::make_shared<QueueingSubscriber<SpscEventQueue>>(queue));
+ * // consumer thread
+ * while (auto event = queue->tryPop()) { render(**event); }
+ * @endcode
+ */
+template <typename Queue>
+class QueueingSubscriber : public IAgentSubscriber {
+public:
+    explicit QueueingSubscriber(std::shared_ptr<Queue> queue) : m_queue(std::move(queue)) {}
+
+    AgentStateMutation onEvent(const Event& event, const AgentSubscriberParams& params) override {
+        if (!m_queue->tryPush(event.clone())) {
+            m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+        return AgentStateMutation();
+    }
+
+    const std::shared_ptr<Queue>& queue() const { return m_queue; }
+    // Events lost because the queue was full; safe to read from any thread
+    uint64_t droppedEvents() const { return m_droppedEvents.load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<Queue> m_queue;
+    std::atomic<uint64_t> m_droppedEvents{0};
+};
+
+}  // namespace agui
@@ -1,5 +1,7 @@
 #include "event_verifier.h"
 
+#include <functional>
+
 #include "core/error.h"
 
 namespace agui {
@@ -86,39 +88,40 @@ void EventVerifier::verifyTextMessage(EventType type, const std::string& message
                         "Message ID cannot be empty");
     }
 
-    EventState currentState = getMessageState(messageId);
+    EventState* tracked = m_messageStates.find(messageId);
 
     switch (type) {
         case EventType::TextMessageStart:
-            if (currentState != EventState::NotStarted && currentState != EventState::Ended) {
+            if (tracked) {
                 throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
                                "TEXT_MESSAGE_START received for message '" + messageId +
                                "' that is already in progress");
             }
-            updateMessageState(messageId, EventState::Started);
+            m_messageStates.set(messageId, EventState::Started);
             break;
 
         case EventType::TextMessageContent:
-            if (currentState != EventState::Started && currentState != EventState::InProgress) {
+            if (!tracked) {
                 throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
                                "TEXT_MESSAGE_CONTENT received for message '" + messageId +
                                "' that has not been started");
             }
-            updateMessageState(messageId, EventState::InProgress);
+            *tracked = EventState::InProgress;
             break;
 
         case EventType::TextMessageEnd:
-            if (currentState == EventState::NotStarted) {
+            if (!tracked) {
+                if (m_endedMessages.contains(messageId)) {
+                    throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
+                                   "TEXT_MESSAGE_END received for message '" + messageId +
+                                   "' that has already ended");
+                }
                 throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
                                "TEXT_MESSAGE_END received for message '" + messageId +
                                "' that was never started");
             }
-            if (currentState == EventState::Ended) {
-                throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
-                               "TEXT_MESSAGE_END received for message '" + messageId +
-                               "' that has already ended");
-            }
-            updateMessageState(messageId, EventState::Ended);
+            m_messageStates.erase(messageId);
+            m_endedMessages.add(messageId);
             break;
 
         default:
@@ -169,39 +172,40 @@ void EventVerifier::verifyToolCall(EventType type, const std::string& toolCallId
                         "Tool call ID cannot be empty");
     }
 
-    EventState currentState = getToolCallState(toolCallId);
+    EventState* tracked = m_toolCallStates.find(toolCallId);
 
     switch (type) {
         case EventType::ToolCallStart:
-            if (currentState != EventState::NotStarted && currentState != EventState::Ended) {
+            if (tracked) {
                 throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
                                "TOOL_CALL_START received for tool call '" + toolCallId +
                                "' that is already in progress");
             }
-            updateToolCallState(toolCallId, EventState::Started);
+            m_toolCallStates.set(toolCallId, EventState::Started);
             break;
 
         case EventType::ToolCallArgs:
-            if (currentState != EventState::Started && currentState != EventState::InProgress) {
+            if (!tracked) {
                 throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
                                "TOOL_CALL_ARGS received for tool call '" + toolCallId +
                                "' that has not been started");
             }
-            updateToolCallState(toolCallId, EventState::InProgress);
+            *tracked = EventState::InProgress;
             break;
 
         case EventType::ToolCallEnd:
-            if (currentState == EventState::NotStarted) {
+            if (!tracked) {
+                if (m_endedToolCalls.contains(toolCallId)) {
+                    throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
+                                   "TOOL_CALL_END received for tool call '" + toolCallId +
+                                   "' that has already ended");
+                }
                 throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
                                "TOOL_CALL_END received for tool call '" + toolCallId +
                                "' that was never started");
             }
-            if (currentState == EventState::Ended) {
-                throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidEvent,
-                               "TOOL_CALL_END received for tool call '" + toolCallId +
-                               "' that has already ended");
-            }
-            updateToolCallState(toolCallId, EventState::Ended);
+            m_toolCallStates.erase(toolCallId);
+            m_endedToolCalls.add(toolCallId);
             break;
 
         default:
@@ -236,34 +240,19 @@ void EventVerifier::verifyThinking(EventType type) {
     }
 }
 
-void EventVerifier::updateMessageState(const std::string& messageId, EventState newState) {
-    m_messageStates[messageId] = newState;
-}
-
-void EventVerifier::updateToolCallState(const std::string& toolCallId, EventState newState) {
-    m_toolCallStates[toolCallId] = newState;
-}
-
 void EventVerifier::reset() {
     m_messageStates.clear();
     m_toolCallStates.clear();
+    m_endedMessages.clear();
+    m_endedToolCalls.clear();
     m_thinkingState = EventState::NotStarted;
     m_thinkingTextMessageState = EventState::NotStarted;
 }
 
 bool EventVerifier::isComplete() const {
-    // Check for incomplete messages
-    for (const auto& pair : m_messageStates) {
-        if (pair.second != EventState::Ended && pair.second != EventState::NotStarted) {
-            return false;
-        }
-    }
-
-    // Check for incomplete tool calls
-    for (const auto& pair : m_toolCallStates) {
-        if (pair.second != EventState::Ended && pair.second != EventState::NotStarted) {
-            return false;
-        }
+    // Ended lifecycles are evicted, so every tracked entry is still open
+    if (m_messageStates.size() != 0 || m_toolCallStates.size() != 0) {
+        return false;
     }
 
     // Check thinking states
@@ -280,43 +269,160 @@ bool EventVerifier::isComplete() const {
 }
 
 std::set<std::string> EventVerifier::getIncompleteMessages() const {
-    std::set<std::string> incomplete;
-    for (const auto& pair : m_messageStates) {
-        if (pair.second != EventState::Ended && pair.second != EventState::NotStarted) {
-            incomplete.insert(pair.first);
-        }
-    }
-    return incomplete;
+    return m_messageStates.ids();
 }
 
 std::set<std::string> EventVerifier::getIncompleteToolCalls() const {
-    std::set<std::string> incomplete;
-    for (const auto& pair : m_toolCallStates) {
-        if (pair.second != EventState::Ended && pair.second != EventState::NotStarted) {
-            incomplete.insert(pair.first);
-        }
-    }
-    return incomplete;
+    return m_toolCallStates.ids();
 }
 
 EventVerifier::EventState EventVerifier::getMessageState(const std::string& messageId) const {
-    auto it = m_messageStates.find(messageId);
-    if (it != m_messageStates.end()) {
-        return it->second;
+    if (const EventState* state = m_messageStates.find(messageId)) {
+        return *state;
     }
-    return EventState::NotStarted;
+    return m_endedMessages.contains(messageId) ? EventState::Ended : EventState::NotStarted;
 }
 
 EventVerifier::EventState EventVerifier::getToolCallState(const std::string& toolCallId) const {
-    auto it = m_toolCallStates.find(toolCallId);
-    if (it != m_toolCallStates.end()) {
-        return it->second;
+    if (const EventState* state = m_toolCallStates.find(toolCallId)) {
+        return *state;
     }
-    return EventState::NotStarted;
+    return m_endedToolCalls.contains(toolCallId) ? EventState::Ended : EventState::NotStarted;
 }
 
 bool EventVerifier::isThinkingActive() const {
     return m_thinkingState == EventState::Started || m_thinkingState == EventState::InProgress;
 }
 
+// LifecycleTable
+
+EventVerifier::EventState* EventVerifier::LifecycleTable::find(const std::string& id) {
+    if (m_size == 0) {
+        return nullptr;
+    }
+    size_t index = findSlot(id, std::hash<std::string>{}(id));
+    return m_slots[index].used ? &m_slots[index].state : nullptr;
+}
+
+const EventVerifier::EventState* EventVerifier::LifecycleTable::find(const std::string& id) const {
+    return const_cast<LifecycleTable*>(this)->find(id);
+}
+
+void EventVerifier::LifecycleTable::set(const std::string& id, EventState state) {
+    // Keep the load factor at or below 3/4
+    if ((m_size + 1) * 4 > m_slots.size() * 3) {
+        grow();
+    }
+
+    const size_t hash = std::hash<std::string>{}(id);
+    Slot& slot = m_slots[findSlot(id, hash)];
+    if (!slot.used) {
+        slot.id = id;
+        slot.hash = hash;
+        slot.used = true;
+        ++m_size;
+    }
+    slot.state = state;
+}
+
+void EventVerifier::LifecycleTable::erase(const std::string& id) {
+    if (m_size == 0) {
+        return;
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    size_t hole = findSlot(id, std::hash<std::string>{}(id));
+    if (!m_slots[hole].used) {
+        return;
+    }
+
+    // Backward-shift deletion: pull later members of the probe run into the hole
+    // when their home slot is not cyclically between the hole and their position.
+    size_t next = (hole + 1) & mask;
+    while (m_slots[next].used) {
+        const size_t home = m_slots[next].hash & mask;
+        const bool homeInRange = hole <= next ? (hole < home && home <= next)
+                                              : (hole < home || home <= next);
+        if (!homeInRange) {
+            m_slots[hole] = std::move(m_slots[next]);
+            m_slots[next].used = false;
+            hole = next;
+        }
+        next = (next + 1) & mask;
+    }
+
+    m_slots[hole].used = false;
+    m_slots[hole].id.clear();
+    --m_size;
+}
+
+void EventVerifier::LifecycleTable::clear() {
+    for (Slot& slot : m_slots) {
+        slot.used = false;
+        slot.id.clear();
+    }
+    m_size = 0;
+}
+
+std::set<std::string> EventVerifier::LifecycleTable::ids() const {
+    std::set<std::string> result;
+    for (const Slot& slot : m_slots) {
+        if (slot.used) {
+            result.insert(slot.id);
+        }
+    }
+    return result;
+}
+
+size_t EventVerifier::LifecycleTable::findSlot(const std::string& id, size_t hash) const {
+    const size_t mask = m_slots.size() - 1;
+    size_t index = hash & mask;
+    while (m_slots[index].used && (m_slots[index].hash != hash || m_slots[index].id != id)) {
+        index = (index + 1) & mask;
+    }
+    return index;
+}
+
+void EventVerifier::LifecycleTable::grow() {
+    std::vector<Slot> old = std::move(m_slots);
+    m_slots = std::vector<Slot>(old.empty() ? 16 : old.size() * 2);
+    const size_t mask = m_slots.size() - 1;
+
+    for (Slot& slot : old) {
+        if (!slot.used) {
+            continue;
+        }
+        size_t index = slot.hash & mask;
+        while (m_slots[index].used) {
+            index = (index + 1) & mask;
+        }
+        m_slots[index] = std::move(slot);
+    }
+}
+
+// RecentlyEnded
+
+void EventVerifier::RecentlyEnded::add(const std::string& id) {
+    if (m_ids.size() < kRecentlyEndedCapacity) {
+        m_ids.push_back(id);
+        return;
+    }
+    m_ids[m_next] = id;
+    m_next = (m_next + 1) % kRecentlyEndedCapacity;
+}
+
+bool EventVerifier::RecentlyEnded::contains(const std::string& id) const {
+    for (const std::string& ended : m_ids) {
+        if (ended == id) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void EventVerifier::RecentlyEnded::clear() {
+    m_ids.clear();
+    m_next = 0;
+}
+
 }  // namespace agui
@@ -1,6 +1,7 @@
 #pragma once
 
-#include <map>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <set>
 #include <string>
@@ -10,6 +11,28 @@
 
 namespace agui {
 
+/**
+ * @brief How much per-event checking HttpAgent performs
+ *
+ * Lifecycle verification is stateful, so it is never sampled: skipping a START
+ * would make the matching END look invalid.
+ */
+enum class VerificationLevel {
+    Full,           ///< Event::validate() and EventVerifier::verify() on every event (default)
+    Sampled,        ///< verify() on every event, validate() on one event in every sample interval
+    LifecycleOnly,  ///< verify() only
+    Off             ///< No per-event checks and no lifecycle completeness check on RUN_FINISHED
+};
+
+/**
+ * @brief Counters of the checks performed under the configured VerificationLevel
+ */
+struct VerificationStats {
+    uint64_t eventsSeen = 0;       ///< Events parsed from the stream
+    uint64_t eventsValidated = 0;  ///< Events passed through Event::validate()
+    uint64_t eventsVerified = 0;   ///< Events passed through EventVerifier::verify()
+};
+
 /**
  * @brief Event sequence verifier for AG-UI protocol compliance
  * 
@@ -19,6 +42,12 @@ namespace agui {
  * - Thinking: START → CONTENT* → END
  * 
  * Supports concurrent messages and tool calls using unique IDs.
+ *
+ * Only open lifecycles are tracked: an ID is evicted as soon as its END arrives, so
+ * memory is bounded by the number of concurrently open messages/tool calls rather
+ * than by run length, and isComplete() is O(1). A small ring of recently ended IDs
+ * keeps duplicate-END diagnostics and getMessageState()/getToolCallState() reporting
+ * Ended for the last kRecentlyEndedCapacity IDs; older ones report NotStarted.
  */
 class EventVerifier {
 public:
@@ -43,6 +72,9 @@ public:
         Ended          ///< END event received, lifecycle complete (may restart)
     };
 
+    /// Number of recently ended IDs remembered per kind (messages, tool calls)
+    static constexpr size_t kRecentlyEndedCapacity = 64;
+
     EventVerifier();
     ~EventVerifier();
 
@@ -62,16 +94,61 @@ public:
     bool isThinkingActive() const;
 
 private:
+    /**
+     * @brief Open-addressing (linear probing) table of open lifecycles keyed by ID
+     *
+     * Each slot caches the ID's hash so probes compare hashes before strings.
+     * Erase uses backward-shift deletion, so there are no tombstones and lookups
+     * never degrade after many START/END cycles.
+     */
+    class LifecycleTable {
+    public:
+        // Returns nullptr when the ID is not tracked.
+        EventState* find(const std::string& id);
+        const EventState* find(const std::string& id) const;
+        void set(const std::string& id, EventState state);
+        void erase(const std::string& id);
+        void clear();
+        size_t size() const { return m_size; }
+        std::set<std::string> ids() const;
+
+    private:
+        struct Slot {
+            std::string id;
+            size_t hash = 0;
+            EventState state = EventState::NotStarted;
+            bool used = false;
+        };
+
+        size_t findSlot(const std::string& id, size_t hash) const;
+        void grow();
+
+        std::vector<Slot> m_slots;  // capacity is zero or a power of two
+        size_t m_size = 0;
+    };
+
+    // Fixed-size ring of recently ended IDs; consulted only on error paths and by getters.
+    class RecentlyEnded {
+    public:
+        void add(const std::string& id);
+        bool contains(const std::string& id) const;
+        void clear();
+
+    private:
+        std::vector<std::string> m_ids;
+        size_t m_next = 0;
+    };
+
     void verifyTextMessage(EventType type, const std::string& messageId);
     void verifyThinkingTextMessage(EventType type);
     void verifyToolCall(EventType type, const std::string& toolCallId);
     void verifyThinking(EventType type);
-    void updateMessageState(const std::string& messageId, EventState newState);
-    void updateToolCallState(const std::string& toolCallId, EventState newState);
 
-    // State tracking
-    std::map<std::string, EventState> m_messageStates;      // Message ID -> State
-    std::map<std::string, EventState> m_toolCallStates;     // Tool Call ID -> State
+    // State tracking (open lifecycles only)
+    LifecycleTable m_messageStates;                          // Message ID -> State
+    LifecycleTable m_toolCallStates;                         // Tool Call ID -> State
+    RecentlyEnded m_endedMessages;
+    RecentlyEnded m_endedToolCalls;
     EventState m_thinkingState;                              // Global thinking state
     EventState m_thinkingTextMessageState;                   // Thinking text message state
 };
@@ -0,0 +1,196 @@
+#include "core/executor.h"
+
+#include "core/error.h"
+#include "core/logger.h"
+
+namespace agui {
+
+namespace {
+
+// Identifies the executor and worker the current thread belongs to, if any
+thread_local const WorkStealingExecutor* t_executor = nullptr;
+thread_local size_t t_workerIndex = 0;
+
+// Tasks a SerialExecutor runs before yielding its worker
+constexpr int kSerialBatchSize = 32;
+
+}  // namespace
+
+WorkStealingExecutor::WorkStealingExecutor(size_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::thread::hardware_concurrency();
+    }
+    if (threadCount == 0) {
+        threadCount = 1;
+    }
+
+    m_workers.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_workers.push_back(std::make_unique<Worker>());
+    }
+    m_threads.reserve(threadCount);
+    for (size_t i = 0; i < threadCount; ++i) {
+        m_threads.emplace_back([this, i]() { run(i); });
+    }
+}
+
+WorkStealingExecutor::~WorkStealingExecutor() {
+    shutdown();
+}
+
+void WorkStealingExecutor::submit(Task task) {
+    size_t index;
+    if (t_executor == this) {
+        index = t_workerIndex;
+    } else {
+        index = m_nextWorker.fetch_add(1, std::memory_order_relaxed) % m_workers.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> wakeLock(m_wakeMutex);
+        if (m_stopping) {
+            throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed, "Executor is shutting down");
+        }
+        std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+        m_workers[index]->tasks.push_back(std::move(task));
+        m_queuedTasks.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_wakeCondition.notify_one();
+}
+
+void WorkStealingExecutor::shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_stopping = true;
+    }
+    m_wakeCondition.notify_all();
+    for (auto& thread : m_threads) {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
+}
+
+void WorkStealingExecutor::run(size_t index) {
+    t_executor = this;
+    t_workerIndex = index;
+
+    for (;;) {
+        Task task;
+        if (!popLocal(index, task) && !steal(index, task)) {
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeCondition.wait(lock, [this]() {
+                return m_queuedTasks.load(std::memory_order_relaxed) > 0 || m_stopping;
+            });
+            if (m_queuedTasks.load(std::memory_order_relaxed) == 0) {
+                break;  // stopping and drained
+            }
+            continue;
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            Logger::errorf("[WorkStealingExecutor] task threw: ", e.what());
+        } catch (...) {
+            Logger::errorf("[WorkStealingExecutor] task threw unknown exception");
+        }
+    }
+}
+
+bool WorkStealingExecutor::popLocal(size_t index, Task& task) {
+    Worker& worker = *m_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) {
+        return false;
+    }
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool WorkStealingExecutor::steal(size_t thief, Task& task) {
+    const size_t count = m_workers.size();
+    for (size_t offset = 1; offset < count; ++offset) {
+        Worker& victim = *m_workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (victim.tasks.empty()) {
+            continue;
+        }
+        task = std::move(victim.tasks.front());
+        victim.tasks.pop_front();
+        m_queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+        m_tasksStolen.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+    return false;
+}
+
+SerialExecutor::SerialExecutor(std::shared_ptr<IExecutor> executor)
+    : m_executor(std::move(executor)), m_state(std::make_shared<State>()) {
+    m_state->executor = m_executor.get();
+}
+
+void SerialExecutor::submit(Task task) {
+    {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        m_state->tasks.push_back(std::move(task));
+        if (m_state->scheduled) {
+            return;
+        }
+        m_state->scheduled = true;
+    }
+    std::shared_ptr<State> state = m_state;
+    try {
+        m_state->executor->submit([state]() { runTasks(state); });
+    } catch (const std::exception&) {
+        // The executor is shutting down; run the queue on the caller's thread instead
+        runTasks(state);
+    }
+}
+
+void SerialExecutor::drain() {
+    std::unique_lock<std::mutex> lock(m_state->mutex);
+    m_state->idle.wait(lock, [this]() { return m_state->tasks.empty() && !m_state->scheduled; });
+}
+
+void SerialExecutor::runTasks(const std::shared_ptr<State>& state) {
+    for (int ran = 0;; ++ran) {
+        if (ran == kSerialBatchSize) {
+            try {
+                state->executor->submit([state]() { runTasks(state); });
+                return;
+            } catch (const std::exception&) {
+                // The executor is shutting down; finish the queue on this thread
+            }
+        }
+
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            if (state->tasks.empty()) {
+                state->scheduled = false;
+                state->idle.notify_all();
+                return;
+            }
+            task = std::move(state->tasks.front());
+            state->tasks.pop_front();
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            Logger::errorf("[SerialExecutor] task threw: ", e.what());
+        } catch (...) {
+            Logger::errorf("[SerialExecutor] task threw unknown exception");
+        }
+    }
+}
+
+std::shared_ptr<IExecutor> defaultExecutor() {
+    static std::shared_ptr<IExecutor> executor = std::make_shared<WorkStealingExecutor>();
+    return executor;
+}
+
+}  // namespace agui
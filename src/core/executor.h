@@ -0,0 +1,116 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace agui {
+
+// Runs tasks asynchronously, on threads it chooses. Destroying an executor must run or
+// discard every task already submitted, and must not happen on one of its own tasks.
+class IExecutor {
+public:
+    using Task = std::function<void()>;
+
+    virtual ~IExecutor() = default;
+    virtual void submit(Task task) = 0;
+};
+
+/**
+ * @brief Fixed-size thread pool where idle workers steal queued tasks from busy ones
+ *
+ * Every worker owns a task deque. Tasks submitted from a worker thread go to the back of
+ * that worker's deque and are taken from the back (LIFO, cache-warm); tasks submitted from
+ * other threads are spread round-robin. A worker whose deque is empty steals from the
+ * front of the others' deques before going to sleep, so a long task never strands the
+ * work queued behind it.
+ *
+ * Tasks must not throw; exceptions are caught and logged.
+ */
+class WorkStealingExecutor : public IExecutor {
+public:
+    // threadCount 0 uses std::thread::hardware_concurrency() (at least 1)
+    explicit WorkStealingExecutor(size_t threadCount = 0);
+    // Runs every task already submitted, then joins the workers
+    ~WorkStealingExecutor();
+
+    WorkStealingExecutor(const WorkStealingExecutor&) = delete;
+    WorkStealingExecutor& operator=(const WorkStealingExecutor&) = delete;
+
+    // Any thread, including tasks. Throws after shutdown() has started.
+    void submit(Task task) override;
+    // Same as the destructor; idempotent. Must not be called from a task.
+    void shutdown();
+
+    size_t threadCount() const { return m_workers.size(); }
+    // Tasks run by a worker other than the one they were queued on
+    uint64_t tasksStolen() const { return m_tasksStolen.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    void run(size_t index);
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+
+    std::vector<std::unique_ptr<Worker>> m_workers;
+    std::atomic<size_t> m_nextWorker{0};
+    // Queued, not yet started; workers sleep while it is zero
+    std::atomic<size_t> m_queuedTasks{0};
+    std::atomic<uint64_t> m_tasksStolen{0};
+
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeCondition;
+    bool m_stopping = false;  // guarded by m_wakeMutex
+
+    std::vector<std::thread> m_threads;
+};
+
+/**
+ * @brief Runs tasks one at a time, in submission order, on another executor
+ *
+ * Tasks of one SerialExecutor never overlap, but may run on different threads of the
+ * underlying executor; separate SerialExecutors run in parallel. After a few tasks the
+ * remaining ones are resubmitted so a busy queue cannot monopolize a worker. Tasks must
+ * not throw; exceptions are caught and logged.
+ */
+class SerialExecutor : public IExecutor {
+public:
+    explicit SerialExecutor(std::shared_ptr<IExecutor> executor);
+
+    void submit(Task task) override;
+    // Blocks until every task submitted so far has run. Must not be called from a task.
+    void drain();
+
+private:
+    struct State {
+        // Raw: a queued task must never hold the last reference, or the executor could be
+        // destroyed on its own worker. m_executor keeps it alive; its destructor drains us.
+        IExecutor* executor = nullptr;
+        std::mutex mutex;
+        std::condition_variable idle;
+        std::deque<Task> tasks;
+        bool scheduled = false;  // a runTasks() call is queued or running
+    };
+
+    static void runTasks(const std::shared_ptr<State>& state);
+
+    std::shared_ptr<IExecutor> m_executor;
+    // Shared with queued runTasks() calls, which may outlive this object
+    std::shared_ptr<State> m_state;
+};
+
+// Process-wide WorkStealingExecutor with one thread per core, created on first use
+std::shared_ptr<IExecutor> defaultExecutor();
+
+}  // namespace agui
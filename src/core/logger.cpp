@@ -1,38 +1,206 @@
 #include "logger.h"
 
+#include <condition_variable>
+#include <thread>
+
+#include "core/mpsc_ring_buffer.h"
+
 namespace agui {
 
 std::mutex Logger::s_mutex;
-LogCallback Logger::s_callback = nullptr;
+std::shared_ptr<const LogCallback> Logger::s_callback;
 LogLevel Logger::s_minLevel = LogLevel::Info;
 
+namespace {
+
+struct LogRecord {
+    LogLevel level;
+    std::string message;
+};
+
+// Queue and delivery thread of Logger::enableAsync()
+class AsyncLogBackend {
+public:
+    explicit AsyncLogBackend(size_t capacity) : m_queue(capacity) {}
+
+    template <typename Deliver>
+    void start(Deliver deliver) {
+        m_thread = std::thread([this, deliver] { run(deliver); });
+    }
+
+    // Any thread; never waits for the delivery thread
+    bool push(LogLevel level, const std::string& message) {
+        // Counted before the push so that m_delivered never overtakes it
+        m_enqueued.fetch_add(1, std::memory_order_seq_cst);
+        if (!m_queue.tryPush(LogRecord{level, message})) {
+            m_enqueued.fetch_sub(1, std::memory_order_relaxed);
+            return false;
+        }
+        // The delivery thread sets m_sleeping before its last look at m_enqueued, so one
+        // of the two always sees the other; the mutex is only taken to wake it up
+        if (m_sleeping.load(std::memory_order_seq_cst)) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_wake.notify_one();
+        }
+        return true;
+    }
+
+    void flush() {
+        const uint64_t target = m_enqueued.load();
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_wake.notify_one();
+        m_drained.wait(lock, [&] { return m_delivered.load() >= target; });
+    }
+
+    // Delivers everything queued, then joins the thread
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+            m_wake.notify_one();
+        }
+        m_thread.join();
+    }
+
+private:
+    template <typename Deliver>
+    void run(Deliver deliver) {
+        for (;;) {
+            uint64_t count = 0;
+            while (auto record = m_queue.tryPop()) {
+                deliver(record->level, record->message);
+                ++count;
+            }
+            if (count > 0) {
+                m_delivered.fetch_add(count);
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_drained.notify_all();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_sleeping.store(true, std::memory_order_seq_cst);
+            if (m_enqueued.load(std::memory_order_seq_cst) == m_delivered.load()) {
+                if (m_stopping) {
+                    return;
+                }
+                m_wake.wait_for(lock, std::chrono::milliseconds(100));
+            }
+            m_sleeping.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRingBuffer<LogRecord> m_queue;
+    std::atomic<uint64_t> m_enqueued{0};
+    std::atomic<uint64_t> m_delivered{0};
+    std::atomic<bool> m_sleeping{false};
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_drained;
+    bool m_stopping = false;  // guarded by m_mutex
+    std::thread m_thread;
+};
+
+// The backend is only destroyed once no logging thread is inside push()
+std::atomic<AsyncLogBackend*> g_asyncBackend{nullptr};
+std::atomic<uint32_t> g_asyncProducers{0};
+std::atomic<uint64_t> g_droppedMessages{0};
+
+// Delivers queued messages at process exit
+struct AsyncBackendShutdown {
+    ~AsyncBackendShutdown() { Logger::disableAsync(); }
+} g_asyncBackendShutdown;
+
+}  // namespace
+
 void Logger::setCallback(LogCallback callback) {
     std::lock_guard<std::mutex> lock(s_mutex);
-    s_callback = callback;
+    std::atomic_store(&s_callback,
+                      callback ? std::make_shared<const LogCallback>(std::move(callback))
+                               : std::shared_ptr<const LogCallback>());
+    s_threshold.store(s_callback ? static_cast<int>(s_minLevel) : kDisabled, std::memory_order_relaxed);
 }
 
 void Logger::setMinLevel(LogLevel level) {
     std::lock_guard<std::mutex> lock(s_mutex);
     s_minLevel = level;
+    s_threshold.store(s_callback ? static_cast<int>(s_minLevel) : kDisabled, std::memory_order_relaxed);
 }
 
 void Logger::log(LogLevel level, const std::string& message) {
-    LogCallback cb;
-    LogLevel minLevel;
-    {
-      std::lock_guard<std::mutex> lock(s_mutex);
-      cb = s_callback;
-      minLevel = s_minLevel;
-    }
-    if (cb && level >= minLevel) {
+    if (!isEnabled(level)) {
+        return;
+    }
+    if (g_asyncBackend.load(std::memory_order_relaxed) != nullptr) {
+        g_asyncProducers.fetch_add(1, std::memory_order_seq_cst);
+        AsyncLogBackend* backend = g_asyncBackend.load(std::memory_order_seq_cst);
+        bool queued = false;
+        if (backend) {
+            queued = backend->push(level, message);
+            if (!queued) {
+                g_droppedMessages.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        g_asyncProducers.fetch_sub(1, std::memory_order_release);
+        if (backend) {
+            return;
+        }
+    }
+    deliver(level, message);
+}
+
+void Logger::deliver(LogLevel level, const std::string& message) {
+    const std::shared_ptr<const LogCallback> callback = std::atomic_load(&s_callback);
+    // The level may have been raised since the message was queued
+    if (callback && level >= static_cast<LogLevel>(s_threshold.load(std::memory_order_relaxed))) {
       try {
-        cb(level, message);
+        (*callback)(level, message);
       } catch (...) {
         // Never allow user callbacks to corrupt the error-handling path
       }
     }
 }
 
+void Logger::enableAsync(size_t capacity) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (g_asyncBackend.load() != nullptr) {
+        return;
+    }
+    auto* backend = new AsyncLogBackend(capacity == 0 ? 1 : capacity);
+    backend->start([](LogLevel level, const std::string& message) { deliver(level, message); });
+    g_asyncBackend.store(backend, std::memory_order_seq_cst);
+}
+
+void Logger::disableAsync() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    AsyncLogBackend* backend = g_asyncBackend.exchange(nullptr, std::memory_order_seq_cst);
+    if (!backend) {
+        return;
+    }
+    // Threads that loaded the old pointer are still pushing
+    while (g_asyncProducers.load(std::memory_order_acquire) != 0) {
+        std::this_thread::yield();
+    }
+    backend->stop();
+    delete backend;
+}
+
+bool Logger::isAsync() {
+    return g_asyncBackend.load() != nullptr;
+}
+
+void Logger::flush() {
+    // Holding s_mutex keeps disableAsync() from deleting the backend meanwhile
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (AsyncLogBackend* backend = g_asyncBackend.load()) {
+        backend->flush();
+    }
+}
+
+uint64_t Logger::droppedMessages() {
+    return g_droppedMessages.load(std::memory_order_relaxed);
+}
+
 void Logger::debug(const std::string& message) {
     log(LogLevel::Debug, message);
 }
@@ -1,10 +1,23 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <sstream>
 #include <string>
 
+/**
+ * Lowest level compiled in: 0 Debug, 1 Info, 2 Warning, 3 Error, 4 nothing.
+ * debugf()/infof()/warningf()/errorf() calls below it compile to nothing, and isEnabled()
+ * is constant false for them. Set through the AGUI_LOG_MIN_LEVEL CMake cache variable.
+ */
+#ifndef AGUI_LOG_MIN_LEVEL
+#define AGUI_LOG_MIN_LEVEL 0
+#endif
+
 namespace agui {
 
 /**
@@ -54,6 +67,10 @@ using LogCallback = std::function<void(LogLevel level, const std::string& messag
  * // Disable logging
  * agui::Logger::setCallback(nullptr);
  * @endcode
+ *
+ * Messages below the minimum level, or logged without a callback, are discarded after
+ * one relaxed atomic load, before any formatting. With enableAsync() the callback runs on
+ * a background thread, so logging threads only format and enqueue.
  */
 class Logger {
 public:
@@ -73,6 +90,35 @@ public:
      * Default is LogLevel::Info. Set to LogLevel::Debug to see all messages.
      */
     static void setMinLevel(LogLevel level);
+
+    /**
+     * @brief Whether a message at level would reach the callback
+     *
+     * Use it to skip building expensive log arguments.
+     */
+    static bool isEnabled(LogLevel level) {
+        return static_cast<int>(level) >= AGUI_LOG_MIN_LEVEL &&
+               static_cast<int>(level) >= s_threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Deliver messages to the callback from a background thread
+     *
+     * Logging threads then push each formatted message into a lock-free queue and never
+     * wait for the callback. When the queue is full the message is dropped and counted
+     * (see droppedMessages()). Messages from one thread keep their order. No-op if
+     * already enabled; disableAsync() or process exit delivers what is queued.
+     *
+     * @param capacity Messages that may be queued; rounded up to a power of two
+     */
+    static void enableAsync(size_t capacity = 8192);
+    // Delivers queued messages, stops the background thread and returns to synchronous delivery
+    static void disableAsync();
+    static bool isAsync();
+    // Blocks until every message queued before the call has been delivered; no-op when synchronous
+    static void flush();
+    // Messages dropped because the async queue was full, since process start
+    static uint64_t droppedMessages();
     
     /**
      * @brief Log a message with specified level
@@ -114,7 +160,9 @@ public:
      */
     template<typename... Args>
     static void debugf(Args&&... args) {
-        logf(LogLevel::Debug, std::forward<Args>(args)...);
+        if constexpr (static_cast<int>(LogLevel::Debug) >= AGUI_LOG_MIN_LEVEL) {
+            logf(LogLevel::Debug, std::forward<Args>(args)...);
+        }
     }
     
     /**
@@ -126,7 +174,9 @@ public:
      */
     template<typename... Args>
     static void infof(Args&&... args) {
-        logf(LogLevel::Info, std::forward<Args>(args)...);
+        if constexpr (static_cast<int>(LogLevel::Info) >= AGUI_LOG_MIN_LEVEL) {
+            logf(LogLevel::Info, std::forward<Args>(args)...);
+        }
     }
     
     /**
@@ -138,7 +188,9 @@ public:
      */
     template<typename... Args>
     static void warningf(Args&&... args) {
-        logf(LogLevel::Warning, std::forward<Args>(args)...);
+        if constexpr (static_cast<int>(LogLevel::Warning) >= AGUI_LOG_MIN_LEVEL) {
+            logf(LogLevel::Warning, std::forward<Args>(args)...);
+        }
     }
     
     /**
@@ -150,13 +202,22 @@ public:
      */
     template<typename... Args>
     static void errorf(Args&&... args) {
-        logf(LogLevel::Error, std::forward<Args>(args)...);
+        if constexpr (static_cast<int>(LogLevel::Error) >= AGUI_LOG_MIN_LEVEL) {
+            logf(LogLevel::Error, std::forward<Args>(args)...);
+        }
     }
     
 private:
+    // Level from which messages are delivered: the minimum level, or kDisabled without a callback
+    static constexpr int kDisabled = 4;
+    static inline std::atomic<int> s_threshold{kDisabled};
+
+    // Guards configuration changes; the logging path does not take it
     static std::mutex s_mutex;
-    static LogCallback s_callback;
+    static std::shared_ptr<const LogCallback> s_callback;  // accessed with std::atomic_load/store
     static LogLevel s_minLevel;
+
+    static void deliver(LogLevel level, const std::string& message);
     
     /**
      * @brief Format multiple arguments into a string and log
@@ -166,6 +227,9 @@ private:
      */
     template<typename... Args>
     static void logf(LogLevel level, Args&&... args) {
+        if (!isEnabled(level)) {
+            return;
+        }
         std::ostringstream oss;
         (oss << ... << args);
         log(level, oss.str());
@@ -0,0 +1,181 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace agui {
+
+// LatencyHistogram
+
+void LatencyHistogram::record(std::chrono::nanoseconds value) {
+    if (value.count() < 0) {
+        value = std::chrono::nanoseconds(0);
+    }
+    size_t index = 0;
+    while (index < kBounds && value > bucketBound(index)) {
+        ++index;
+    }
+    ++m_buckets[index];
+    ++m_count;
+    m_sum += value;
+    m_max = std::max(m_max, value);
+}
+
+void LatencyHistogram::merge(const LatencyHistogram& other) {
+    for (size_t i = 0; i < m_buckets.size(); ++i) {
+        m_buckets[i] += other.m_buckets[i];
+    }
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    m_max = std::max(m_max, other.m_max);
+}
+
+std::chrono::nanoseconds LatencyHistogram::quantile(double q) const {
+    if (m_count == 0) {
+        return std::chrono::nanoseconds(0);
+    }
+    const auto rank = static_cast<uint64_t>(std::ceil(std::clamp(q, 0.0, 1.0) * static_cast<double>(m_count)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBounds; ++i) {
+        seen += m_buckets[i];
+        if (seen >= std::max<uint64_t>(rank, 1)) {
+            return bucketBound(i);
+        }
+    }
+    return m_max;
+}
+
+// PrometheusMetricsSink
+
+namespace {
+
+void recordIfSet(LatencyHistogram& histogram, const std::optional<std::chrono::nanoseconds>& value) {
+    if (value) {
+        histogram.record(*value);
+    }
+}
+
+std::string seconds(std::chrono::nanoseconds value) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.9g", std::chrono::duration<double>(value).count());
+    return buffer;
+}
+
+// Label values escape backslash, double quote and newline
+std::string labelValue(const std::string& value) {
+    std::string escaped;
+    escaped.reserve(value.size());
+    for (const char c : value) {
+        if (c == '\\' || c == '"') {
+            escaped += '\\';
+            escaped += c;
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+}  // namespace
+
+void PrometheusMetricsSink::onRunCompleted(const RunMetrics& metrics) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    Series& series = m_series[metrics.agentId];
+    ++(metrics.succeeded ? series.runsSucceeded : series.runsFailed);
+    series.events += metrics.events;
+    series.bytes += metrics.bytes;
+    if (metrics.http) {
+        series.dnsTime.record(metrics.http->nameLookup);
+        series.connectTime.record(metrics.http->connect);
+        if (metrics.http->tlsHandshake.count() > 0) {
+            series.tlsTime.record(metrics.http->tlsHandshake);
+        }
+        series.firstByteTime.record(metrics.http->firstByte);
+    }
+    recordIfSet(series.runStartedTime, metrics.timeToRunStarted);
+    recordIfSet(series.firstContentTime, metrics.timeToFirstContent);
+    series.duration.record(metrics.duration);
+    series.requestBuild.record(metrics.requestBuild);
+    series.parseTime.record(metrics.parseTime);
+    series.dispatchTime.record(metrics.dispatchTime);
+    series.eventGaps.merge(metrics.eventGaps);
+}
+
+std::string PrometheusMetricsSink::render() const {
+    struct Counter {
+        const char* name;
+        const char* help;
+        uint64_t Series::*value;
+    };
+    static const Counter kCounters[] = {
+        {"run_events_total", "Events decoded from run streams", &Series::events},
+        {"run_bytes_total", "SSE bytes received by runs", &Series::bytes},
+    };
+    struct Histogram {
+        const char* name;
+        const char* help;
+        LatencyHistogram Series::*value;
+    };
+    static const Histogram kHistograms[] = {
+        {"http_dns_seconds", "Time until DNS resolution finished", &Series::dnsTime},
+        {"http_connect_seconds", "Time until the TCP connection was established", &Series::connectTime},
+        {"http_tls_seconds", "Time until the TLS handshake finished", &Series::tlsTime},
+        {"http_first_byte_seconds", "Time until the first response byte (TTFB)", &Series::firstByteTime},
+        {"run_started_seconds", "Time from runAgent() to RUN_STARTED", &Series::runStartedTime},
+        {"first_content_seconds", "Time from runAgent() to the first text content", &Series::firstContentTime},
+        {"run_duration_seconds", "Run duration", &Series::duration},
+        {"request_build_seconds", "Request middleware and serialization time per run", &Series::requestBuild},
+        {"parse_seconds", "SSE and event parsing time per run", &Series::parseTime},
+        {"dispatch_seconds", "Middleware and subscriber time per run", &Series::dispatchTime},
+        {"event_gap_seconds", "Time between consecutive events", &Series::eventGaps},
+    };
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::string out;
+    const auto header = [&](const std::string& name, const char* help, const char* type) {
+        out += "# HELP " + name + ' ' + help + "\n# TYPE " + name + ' ' + type + '\n';
+    };
+
+    const std::string runs = m_prefix + "_runs_total";
+    header(runs, "Completed runs", "counter");
+    for (const auto& entry : m_series) {
+        const std::string agent = labelValue(entry.first);
+        out += runs + "{agent=\"" + agent + "\",outcome=\"success\"} " + std::to_string(entry.second.runsSucceeded) +
+               '\n';
+        out += runs + "{agent=\"" + agent + "\",outcome=\"failure\"} " + std::to_string(entry.second.runsFailed) +
+               '\n';
+    }
+
+    for (const Counter& counter : kCounters) {
+        const std::string name = m_prefix + '_' + counter.name;
+        header(name, counter.help, "counter");
+        for (const auto& entry : m_series) {
+            out += name + "{agent=\"" + labelValue(entry.first) + "\"} " +
+                   std::to_string(entry.second.*counter.value) + '\n';
+        }
+    }
+
+    for (const Histogram& histogram : kHistograms) {
+        const std::string name = m_prefix + '_' + histogram.name;
+        header(name, histogram.help, "histogram");
+        for (const auto& entry : m_series) {
+            const std::string agent = "agent=\"" + labelValue(entry.first) + '"';
+            const LatencyHistogram& values = entry.second.*histogram.value;
+            uint64_t cumulative = 0;
+            for (size_t i = 0; i < LatencyHistogram::kBounds; ++i) {
+                cumulative += values.bucketCount(i);
+                out += name + "_bucket{" + agent + ",le=\"" + seconds(LatencyHistogram::bucketBound(i)) + "\"} " +
+                       std::to_string(cumulative) + '\n';
+            }
+            out += name + "_bucket{" + agent + ",le=\"+Inf\"} " + std::to_string(values.count()) + '\n';
+            out += name + "_sum{" + agent + "} " + seconds(values.sum()) + '\n';
+            out += name + "_count{" + agent + "} " + std::to_string(values.count()) + '\n';
+        }
+    }
+    return out;
+}
+
+}  // namespace agui
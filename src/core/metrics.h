@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+
+namespace agui {
+
+/**
+ * @brief Latency histogram with fixed, doubling bucket bounds
+ *
+ * Bucket i counts values <= bucketBound(i) (10 us << i, up to about 84 s) that did not
+ * fit a lower bucket; the last bucket counts everything larger. record() is a few
+ * instructions and never allocates. Not thread-safe.
+ */
+class LatencyHistogram {
+public:
+    static constexpr size_t kBounds = 24;
+
+    static std::chrono::nanoseconds bucketBound(size_t index) {
+        return std::chrono::microseconds(10) * (int64_t{1} << index);
+    }
+
+    void record(std::chrono::nanoseconds value);
+    void merge(const LatencyHistogram& other);
+
+    uint64_t count() const { return m_count; }
+    std::chrono::nanoseconds sum() const { return m_sum; }
+    std::chrono::nanoseconds max() const { return m_max; }
+    // Values in bucket index alone (not cumulative); index kBounds is the overflow bucket
+    uint64_t bucketCount(size_t index) const { return m_buckets[index]; }
+    /**
+     * @brief Upper bound of the bucket holding quantile q (0..1); max() for the overflow bucket
+     * @return zero if nothing was recorded
+     */
+    std::chrono::nanoseconds quantile(double q) const;
+
+private:
+    std::array<uint64_t, kBounds + 1> m_buckets{};
+    uint64_t m_count = 0;
+    std::chrono::nanoseconds m_sum{0};
+    std::chrono::nanoseconds m_max{0};
+};
+
+/**
+ * @brief Connection phases of one HTTP request, as reported by libcurl
+ *
+ * Each value is measured from the start of the request, so they are cumulative:
+ * connect includes nameLookup, firstByte includes the TLS handshake and so on.
+ */
+struct HttpTimings {
+    std::chrono::microseconds nameLookup{0};    ///< DNS resolution done
+    std::chrono::microseconds connect{0};       ///< TCP connection established
+    std::chrono::microseconds tlsHandshake{0};  ///< TLS handshake done; 0 for plain HTTP
+    std::chrono::microseconds firstByte{0};     ///< First response byte received (TTFB)
+    std::chrono::microseconds total{0};         ///< Transfer finished
+};
+
+/**
+ * @brief Where the time of one HttpAgent run went
+ *
+ * Durations named timeTo* are measured from the start of runAgent(), on the thread that
+ * reads the network, when the event is decoded. Parse time covers SSE framing, JSON
+ * decoding and validation; dispatch time covers middleware, lifecycle verification,
+ * state updates and subscriber callbacks. Both are wall-clock time spent in those stages.
+ */
+struct RunMetrics {
+    std::string agentId;
+    std::string threadId;
+    std::string runId;
+    bool succeeded = false;
+
+    std::optional<HttpTimings> http;  ///< Absent if the HTTP service does not report timings
+    std::chrono::nanoseconds requestBuild{0};  ///< Request middleware and serialization
+    std::optional<std::chrono::nanoseconds> timeToFirstChunk;
+    std::optional<std::chrono::nanoseconds> timeToRunStarted;
+    std::optional<std::chrono::nanoseconds> timeToFirstContent;  ///< First TEXT_MESSAGE_CONTENT/CHUNK
+    std::chrono::nanoseconds duration{0};  ///< Start of runAgent() until the run ended
+
+    uint64_t events = 0;  ///< Events decoded from the stream
+    uint64_t bytes = 0;   ///< SSE bytes received (after Content-Encoding decoding)
+    uint64_t chunks = 0;  ///< Network reads delivered to the agent
+    std::chrono::nanoseconds parseTime{0};
+    std::chrono::nanoseconds dispatchTime{0};
+    LatencyHistogram eventGaps;  ///< Time between consecutive decoded events
+};
+
+/**
+ * @brief Receives the metrics of every HttpAgent run
+ *
+ * Called on the runAgent() thread after onSuccess/onError. A sink may be shared by
+ * several agents running on different threads, so implementations must be thread-safe.
+ */
+class IMetricsSink {
+public:
+    virtual ~IMetricsSink() = default;
+    virtual void onRunCompleted(const RunMetrics& metrics) = 0;
+};
+
+/**
+ * @brief Aggregates run metrics per agent ID and renders them in the Prometheus text format
+ *
+ * Counters: <prefix>_runs_total{agent,outcome}, <prefix>_run_events_total,
+ * <prefix>_run_bytes_total. Histograms (seconds): HTTP phases, time to RUN_STARTED and to
+ * the first content, run duration, request build, parse and dispatch time per run, and
+ * the gaps between events. Serve render() from the application's /metrics endpoint.
+ */
+class PrometheusMetricsSink : public IMetricsSink {
+public:
+    explicit PrometheusMetricsSink(std::string prefix = "agui") : m_prefix(std::move(prefix)) {}
+
+    void onRunCompleted(const RunMetrics& metrics) override;
+
+    // Text exposition format 0.0.4
+    std::string render() const;
+
+private:
+    struct Series {
+        uint64_t runsSucceeded = 0;
+        uint64_t runsFailed = 0;
+        uint64_t events = 0;
+        uint64_t bytes = 0;
+        LatencyHistogram dnsTime;
+        LatencyHistogram connectTime;
+        LatencyHistogram tlsTime;
+        LatencyHistogram firstByteTime;
+        LatencyHistogram runStartedTime;
+        LatencyHistogram firstContentTime;
+        LatencyHistogram duration;
+        LatencyHistogram requestBuild;
+        LatencyHistogram parseTime;
+        LatencyHistogram dispatchTime;
+        LatencyHistogram eventGaps;
+    };
+
+    std::string m_prefix;
+    mutable std::mutex m_mutex;
+    std::map<std::string, Series> m_series;  // by agent ID
+};
+
+}  // namespace agui
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <optional>
+#include <utility>
+
+#include "core/spsc_ring_buffer.h"
+
+namespace agui {
+
+/**
+ * @brief Bounded lock-free multi-producer/single-consumer queue
+ *
+ * Dmitry Vyukov's bounded queue: every slot carries a sequence number telling producers
+ * and the consumer whose turn it is, so producers only contend on one CAS of the enqueue
+ * position and never wait for each other. tryPush() may be called from any number of
+ * threads, tryPop() from one. Items from one producer are popped in the order it pushed
+ * them. Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class MpscRingBuffer {
+public:
+    static constexpr size_t kCacheLineSize = SpscRingBuffer<T>::kCacheLineSize;
+
+    explicit MpscRingBuffer(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        m_mask = rounded - 1;
+        m_cells = std::make_unique<Cell[]>(rounded);
+        for (size_t i = 0; i < rounded; ++i) {
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    ~MpscRingBuffer() {
+        while (tryPop()) {
+        }
+    }
+
+    MpscRingBuffer(const MpscRingBuffer&) = delete;
+    MpscRingBuffer& operator=(const MpscRingBuffer&) = delete;
+
+    size_t capacity() const { return m_mask + 1; }
+
+    // Any thread. Returns false (leaving `value` untouched) when full.
+    bool tryPush(T&& value) {
+        size_t pos = m_enqueuePos.value.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_enqueuePos.value.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // the slot still holds an item from the previous lap
+            } else {
+                pos = m_enqueuePos.value.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->storage) T(std::move(value));
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only. Returns std::nullopt when empty.
+    std::optional<T> tryPop() {
+        const size_t pos = m_dequeuePos.value;
+        Cell& cell = m_cells[pos & m_mask];
+        if (cell.sequence.load(std::memory_order_acquire) != pos + 1) {
+            return std::nullopt;
+        }
+        T* slot = std::launder(reinterpret_cast<T*>(cell.storage));
+        std::optional<T> value(std::move(*slot));
+        slot->~T();
+        cell.sequence.store(pos + m_mask + 1, std::memory_order_release);
+        m_dequeuePos.value = pos + 1;
+        return value;
+    }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence{0};
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    struct alignas(kCacheLineSize) EnqueuePosition {
+        std::atomic<size_t> value{0};
+    };
+    struct alignas(kCacheLineSize) DequeuePosition {
+        size_t value = 0;
+    };
+
+    EnqueuePosition m_enqueuePos;
+    DequeuePosition m_dequeuePos;
+    size_t m_mask = 0;
+    std::unique_ptr<Cell[]> m_cells;
+};
+
+}  // namespace agui
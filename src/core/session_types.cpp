@@ -1,11 +1,106 @@
 #include "session_types.h"
 
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+
 #include "error.h"
 #include "uuid.h"
 #include "logger.h"
 
 namespace agui {
 
+namespace {
+
+// Length of the well-formed UTF-8 sequence at the start of s (non-empty, first byte
+// >= 0x80), or 0. Same rules as nlohmann's decoder: no overlongs, surrogates or
+// code points above U+10FFFF.
+size_t utf8SequenceLength(std::string_view s) {
+    const auto byte = [&](size_t i) { return static_cast<unsigned char>(s[i]); };
+    const unsigned char lead = byte(0);
+    size_t length;
+    unsigned char secondMin = 0x80;
+    unsigned char secondMax = 0xBF;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) {
+            secondMin = 0xA0;
+        } else if (lead == 0xED) {
+            secondMax = 0x9F;
+        }
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) {
+            secondMin = 0x90;
+        } else if (lead == 0xF4) {
+            secondMax = 0x8F;
+        }
+    } else {
+        return 0;
+    }
+    if (s.size() < length || byte(1) < secondMin || byte(1) > secondMax) {
+        return 0;
+    }
+    for (size_t i = 2; i < length; ++i) {
+        if (byte(i) < 0x80 || byte(i) > 0xBF) {
+            return 0;
+        }
+    }
+    return length;
+}
+
+void appendKey(std::string& out, const char* key) {
+    out += '"';
+    out += key;
+    out += "\":";
+}
+
+}  // namespace
+
+void appendJsonString(std::string& out, std::string_view value) {
+    static constexpr char kHex[] = "0123456789abcdef";
+    out += '"';
+    size_t runStart = 0;
+    size_t i = 0;
+    while (i < value.size()) {
+        const auto c = static_cast<unsigned char>(value[i]);
+        if (c >= 0x80) {
+            const size_t length = utf8SequenceLength(value.substr(i));
+            if (length == 0) {
+                throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidInput,
+                                 "Invalid UTF-8 byte at index " + std::to_string(i) + " of JSON string");
+            }
+            i += length;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            ++i;
+            continue;
+        }
+
+        out.append(value.data() + runStart, i - runStart);
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                out += "\\u00";
+                out += kHex[c >> 4];
+                out += kHex[c & 0xF];
+                break;
+        }
+        runStart = ++i;
+    }
+    out.append(value.data() + runStart, value.size() - runStart);
+    out += '"';
+}
+
 // ToolCall implementation
 
 nlohmann::json ToolCall::toJson() const {
@@ -16,6 +111,19 @@ nlohmann::json ToolCall::toJson() const {
     return j;
 }
 
+// Keys in std::map order, as dump() writes them
+void ToolCall::appendJson(std::string& out) const {
+    out += "{\"function\":{\"arguments\":";
+    appendJsonString(out, function.arguments);
+    out += ",\"name\":";
+    appendJsonString(out, function.name);
+    out += "},\"id\":";
+    appendJsonString(out, id);
+    out += ",\"type\":";
+    appendJsonString(out, callType);
+    out += '}';
+}
+
 ToolCall ToolCall::fromJson(const nlohmann::json& j) {
     ToolCall tc;
     tc.id = j.value("id", "");
@@ -34,7 +142,13 @@ ToolCall ToolCall::fromJson(const nlohmann::json& j) {
 Message::Message(const MessageId &mid, const MessageRole &role, const std::string &content) :
     m_id(mid),
     m_role(role),
-    m_content(content) {}
+    m_content(content),
+    m_revision(nextRevision()) {}
+
+uint64_t Message::nextRevision() {
+    static std::atomic<uint64_t> counter{0};
+    return counter.fetch_add(1, std::memory_order_relaxed) + 1;
+}
 
 std::string Message::roleToString(MessageRole role) {
     switch (role) {
@@ -95,8 +209,8 @@ nlohmann::json Message::toJson() const {
 
     j["role"] = roleToString(m_role);
 
-    if (!m_content.empty()) {
-        j["content"] = m_content;
+    if (!content().empty()) {
+        j["content"] = content();
     }
 
     if (!m_name.empty()) {
@@ -122,6 +236,50 @@ nlohmann::json Message::toJson() const {
     return j;
 }
 
+void Message::appendJson(std::string& out) const {
+    // Keys in std::map order, as dump() writes them
+    out += '{';
+    if (m_role == MessageRole::Activity && !m_activityType.empty()) {
+        appendKey(out, "activityType");
+        appendJsonString(out, m_activityType);
+        out += ',';
+    }
+    const std::string& text = content();
+    if (!text.empty()) {
+        appendKey(out, "content");
+        appendJsonString(out, text);
+        out += ',';
+    }
+    appendKey(out, "id");
+    appendJsonString(out, m_id);
+    if (!m_name.empty()) {
+        out += ',';
+        appendKey(out, "name");
+        appendJsonString(out, m_name);
+    }
+    out += ',';
+    appendKey(out, "role");
+    appendJsonString(out, roleToString(m_role));
+    if (m_role == MessageRole::Tool && !m_toolCallId.empty()) {
+        out += ',';
+        appendKey(out, "toolCallId");
+        appendJsonString(out, m_toolCallId);
+    }
+    if (!m_toolCalls.empty()) {
+        out += ',';
+        appendKey(out, "toolCalls");
+        out += '[';
+        for (size_t i = 0; i < m_toolCalls.size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            m_toolCalls[i].appendJson(out);
+        }
+        out += ']';
+    }
+    out += '}';
+}
+
 Message Message::fromJson(const nlohmann::json& j) {
     Message msg;
 
@@ -157,11 +315,32 @@ Message Message::fromJson(const nlohmann::json& j) {
     return msg;
 }
 
+void Message::setStructuredContent(nlohmann::json content) {
+    m_structuredContent = std::move(content);
+    m_contentStale = true;
+    m_revision = nextRevision();
+}
+
+nlohmann::json& Message::editStructuredContent() {
+    if (!m_structuredContent.has_value()) {
+        m_structuredContent = m_content.empty() ? nlohmann::json::object() : nlohmann::json::parse(m_content);
+    }
+    m_contentStale = true;
+    m_revision = nextRevision();
+    return *m_structuredContent;
+}
+
+void Message::materializeContent() const {
+    m_content = m_structuredContent->dump();
+    m_contentStale = false;
+}
+
 void Message::assignEventDelta(const ToolCallId& toolCallId, const std::string &value) {
     bool found = false;
     for (auto &toolCall : m_toolCalls) {
         if (toolCall.id == toolCallId) {
             toolCall.function.arguments = value;
+            m_revision = nextRevision();
             found = true;
             break;
         }
@@ -177,6 +356,7 @@ void Message::appendEventDelta(const ToolCallId& toolCallId, const std::string &
     for (auto &toolCall : m_toolCalls) {
         if (toolCall.id == toolCallId) {
             toolCall.function.arguments += delta;
+            m_revision = nextRevision();
             found = true;
             break;
         }
@@ -187,6 +367,37 @@ void Message::appendEventDelta(const ToolCallId& toolCallId, const std::string &
     }
 }
 
+// MessageJsonCache implementation
+
+void MessageJsonCache::appendArray(std::string& out, const std::vector<Message>& messages) {
+    ++m_pass;
+    out += '[';
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (i > 0) {
+            out += ',';
+        }
+        const Message& message = messages[i];
+        Entry& entry = m_entries[message.id()];
+        if (entry.pass == 0 || entry.revision != message.revision()) {
+            entry.json.clear();
+            message.appendJson(entry.json);
+            entry.revision = message.revision();
+            ++m_misses;
+        } else {
+            ++m_hits;
+        }
+        entry.pass = m_pass;
+        out += entry.json;
+    }
+    out += ']';
+
+    if (m_entries.size() > messages.size()) {
+        for (auto it = m_entries.begin(); it != m_entries.end();) {
+            it = it->second.pass == m_pass ? std::next(it) : m_entries.erase(it);
+        }
+    }
+}
+
 // Tool implementation
 
 nlohmann::json Tool::toJson() const {
@@ -197,6 +408,16 @@ nlohmann::json Tool::toJson() const {
     return j;
 }
 
+void Tool::appendJson(std::string& out) const {
+    out += "{\"description\":";
+    appendJsonString(out, description);
+    out += ",\"name\":";
+    appendJsonString(out, name);
+    out += ",\"parameters\":";
+    out += parameters.dump();
+    out += '}';
+}
+
 Tool Tool::fromJson(const nlohmann::json& j) {
     Tool tool;
     tool.name = j.value("name", "");
@@ -205,6 +426,94 @@ Tool Tool::fromJson(const nlohmann::json& j) {
     return tool;
 }
 
+// ToolSchemaSet implementation
+
+ToolSchemaSet::ToolSchemaSet(const std::vector<Tool>& tools) {
+    for (const auto& tool : tools) {
+        std::string json;
+        tool.appendJson(json);
+        add(tool, std::move(json));
+    }
+    rebuild();
+}
+
+void ToolSchemaSet::add(const Tool& tool, std::string json) {
+    auto it = m_index.find(tool.name);
+    if (it != m_index.end()) {
+        m_tools[it->second] = tool;
+        m_elements[it->second] = std::move(json);
+        return;
+    }
+    m_index.emplace(tool.name, m_tools.size());
+    m_tools.push_back(tool);
+    m_elements.push_back(std::move(json));
+}
+
+void ToolSchemaSet::rebuild() {
+    m_joined.clear();
+    for (size_t i = 0; i < m_elements.size(); ++i) {
+        if (i > 0) {
+            m_joined += ',';
+        }
+        m_joined += m_elements[i];
+    }
+    // FNV-1a, 64-bit
+    m_hash = 14695981039346656037ull;
+    for (const char c : m_joined) {
+        m_hash ^= static_cast<unsigned char>(c);
+        m_hash *= 1099511628211ull;
+    }
+}
+
+std::shared_ptr<const ToolSchemaSet> ToolSchemaSet::with(const Tool& tool) const {
+    auto set = std::make_shared<ToolSchemaSet>(*this);
+    std::string json;
+    tool.appendJson(json);
+    set->add(tool, std::move(json));
+    set->rebuild();
+    return set;
+}
+
+std::shared_ptr<const ToolSchemaSet> ToolSchemaSet::without(const std::string& name) const {
+    auto set = std::make_shared<ToolSchemaSet>();
+    for (size_t i = 0; i < m_tools.size(); ++i) {
+        if (m_tools[i].name != name) {
+            set->add(m_tools[i], m_elements[i]);
+        }
+    }
+    set->rebuild();
+    return set;
+}
+
+std::string ToolSchemaSet::hashHex() const {
+    static const char kDigits[] = "0123456789abcdef";
+    std::string hex(16, '0');
+    for (int i = 15, shift = 0; i >= 0; --i, shift += 4) {
+        hex[i] = kDigits[(m_hash >> shift) & 0xf];
+    }
+    return hex;
+}
+
+size_t ToolSchemaSet::appendElements(std::string& out, const std::vector<Tool>& overrides) const {
+    const auto isOverridden = [&overrides](const std::string& name) {
+        return std::any_of(overrides.begin(), overrides.end(), [&name](const Tool& tool) { return tool.name == name; });
+    };
+    if (std::none_of(overrides.begin(), overrides.end(), [this](const Tool& tool) { return contains(tool.name); })) {
+        out += m_joined;
+        return m_elements.size();
+    }
+    size_t appended = 0;
+    for (size_t i = 0; i < m_tools.size(); ++i) {
+        if (!isOverridden(m_tools[i].name)) {
+            if (appended++ > 0) {
+                out += ',';
+            }
+            out += m_elements[i];
+        }
+    }
+    return appended;
+}
+
 // Context implementation
 
 nlohmann::json Context::toJson() const {
@@ -214,6 +523,14 @@ nlohmann::json Context::toJson() const {
     return j;
 }
 
+void Context::appendJson(std::string& out) const {
+    out += "{\"description\":";
+    appendJsonString(out, description);
+    out += ",\"value\":";
+    appendJsonString(out, value);
+    out += '}';
+}
+
 Context Context::fromJson(const nlohmann::json& j) {
     Context ctx;
     ctx.description = j.value("description", "");
@@ -242,6 +559,15 @@ nlohmann::json RunAgentInput::toJson() const {
 
     // Tools array
     nlohmann::json toolsJson = nlohmann::json::array();
+    if (toolSchemas) {
+        for (const auto& tool : toolSchemas->tools()) {
+            const bool overridden = std::any_of(tools.begin(), tools.end(),
+                                                [&tool](const Tool& other) { return other.name == tool.name; });
+            if (!overridden) {
+                toolsJson.push_back(tool.toJson());
+            }
+        }
+    }
     for (const auto& tool : tools) {
         toolsJson.push_back(tool.toJson());
     }
@@ -257,6 +583,56 @@ nlohmann::json RunAgentInput::toJson() const {
     return j;
 }
 
+void RunAgentInput::appendJson(std::string& out, MessageJsonCache* messageCache) const {
+    const auto appendArray = [&out](const auto& items) {
+        out += '[';
+        for (size_t i = 0; i < items.size(); ++i) {
+            if (i > 0) {
+                out += ',';
+            }
+            items[i].appendJson(out);
+        }
+        out += ']';
+    };
+
+    // Keys in std::map order, as dump() writes them
+    out += "{\"context\":";
+    appendArray(context);
+    out += ",\"forwardedProps\":";
+    out += forwardedProps.dump();
+    out += ",\"messages\":";
+    if (messageCache) {
+        messageCache->appendArray(out, messages);
+    } else {
+        appendArray(messages);
+    }
+    if (parentRunId.has_value()) {
+        out += ",\"parentRunId\":";
+        appendJsonString(out, *parentRunId);
+    }
+    out += ",\"runId\":";
+    appendJsonString(out, runId);
+    out += ",\"state\":";
+    out += state.dump();
+    out += ",\"threadId\":";
+    appendJsonString(out, threadId);
+    out += ",\"tools\":";
+    if (toolSchemas && !toolSchemas->empty()) {
+        out += '[';
+        const size_t registered = toolSchemas->appendElements(out, tools);
+        for (size_t i = 0; i < tools.size(); ++i) {
+            if (registered > 0 || i > 0) {
+                out += ',';
+            }
+            tools[i].appendJson(out);
+        }
+        out += ']';
+    } else {
+        appendArray(tools);
+    }
+    out += '}';
+}
+
 RunAgentInput RunAgentInput::fromJson(const nlohmann::json& j) {
     RunAgentInput input;
 
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <cstdint>
 #include <map>
+#include <memory>
 #include <nlohmann/json.hpp>
 #include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 #include <vector>
 
 namespace agui {
@@ -17,12 +21,19 @@ using ToolCallId = std::string;
 
 // Forward declarations
 class Message;
+class ToolSchemaSet;
 struct Tool;
 struct Context;
 struct ToolCall;
 
 enum class MessageRole { User, Assistant, System, Tool, Developer, Activity, Reasoning };
 
+/**
+ * @brief Appends value as a JSON string literal, escaped exactly like nlohmann::json::dump()
+ * @throws AgentError if value is not valid UTF-8 (dump() throws type_error 316)
+ */
+void appendJsonString(std::string& out, std::string_view value);
+
 struct FunctionCall {
     std::string name;
     std::string arguments;
@@ -40,12 +51,14 @@ public:
     ToolCall() : callType("function") {}
 
     nlohmann::json toJson() const;
+    // Appends toJson().dump() without building the JSON tree
+    void appendJson(std::string& out) const;
     static ToolCall fromJson(const nlohmann::json& j);
 };
 
 class Message {
 public:
-    Message() {}
+    Message() : m_revision(nextRevision()) {}
     Message(const MessageId &mid, const MessageRole &role, const std::string &content);
     ~Message() = default;
 
@@ -66,32 +79,132 @@ public:
 
     const MessageId& id() const { return m_id; }
     MessageRole role() const { return m_role; }
-    const std::string& content() const { return m_content; }
+    const std::string& content() const {
+        if (m_contentStale) {
+            materializeContent();
+        }
+        return m_content;
+    }
     const std::string& name() const { return m_name; }
     const std::vector<ToolCall>& toolCalls() const { return m_toolCalls; }
     const std::string& toolCallId() const { return m_toolCallId; }
     const std::string& activityType() const { return m_activityType; }
+    /**
+     * @brief Process-wide unique stamp of this message's current contents
+     *
+     * Every mutator assigns a fresh value and copies keep their source's, so equal
+     * revisions mean equal contents. Lets readers detect unchanged messages in O(1).
+     */
+    uint64_t revision() const { return m_revision; }
+
+    void setRole(const MessageRole &role) {
+        m_role = role;
+        m_revision = nextRevision();
+    }
+    void setContent(const std::string& content) {
+        dropStructuredContent();
+        m_content = content;
+    }
+    void setName(const std::string& name) {
+        m_name = name;
+        m_revision = nextRevision();
+    }
+    void appendContent(const std::string& delta) {
+        dropStructuredContent();
+        m_content += delta;
+    }
+    void addToolCall(const ToolCall& toolCall) {
+        m_toolCalls.push_back(toolCall);
+        m_revision = nextRevision();
+    }
+    void setActivityType(const std::string& type) {
+        m_activityType = type;
+        m_revision = nextRevision();
+    }
+    /**
+     * @brief Structured (JSON) content, used by activity messages
+     *
+     * The tree is the source of truth while present; content() serializes it lazily
+     * on first access after a change. setContent()/appendContent() discard the tree.
+     */
+    bool hasStructuredContent() const { return m_structuredContent.has_value(); }
+    void setStructuredContent(nlohmann::json content);
+    /**
+     * @brief Mutable access to the structured content for in-place edits
+     *
+     * Parses the string content once if no tree exists yet (empty content becomes {}).
+     * Invalidates the serialized form.
+     * @throws nlohmann::json::parse_error if the string content is not valid JSON
+     */
+    nlohmann::json& editStructuredContent();
 
-    void setRole(const MessageRole &role) {m_role = role;}
-    void setContent(const std::string& content) { m_content = content; }
-    void setName(const std::string& name) { m_name = name; }
-    void appendContent(const std::string& delta) { m_content += delta; }
-    void addToolCall(const ToolCall& toolCall) { m_toolCalls.push_back(toolCall); }
-    void setActivityType(const std::string& type) { m_activityType = type; }
     void assignEventDelta(const ToolCallId& toolCallId, const std::string &value);
     void appendEventDelta(const ToolCallId& toolCallId, const std::string &delta);
 
     nlohmann::json toJson() const;
+    // Appends toJson().dump() without building the JSON tree
+    void appendJson(std::string& out) const;
     static Message fromJson(const nlohmann::json& j);
 
 private:
+    static uint64_t nextRevision();
+    void materializeContent() const;
+    // Called by every content mutator
+    void dropStructuredContent() {
+        m_structuredContent.reset();
+        m_contentStale = false;
+        m_revision = nextRevision();
+    }
+
     MessageId m_id;
     MessageRole m_role = MessageRole::User;
-    std::string m_content;
+    // Serialized content; stale while m_structuredContent holds unserialized edits.
+    // Lazily refreshed from const accessors, so concurrent readers need external locking.
+    mutable std::string m_content;
+    mutable bool m_contentStale = false;
+    std::optional<nlohmann::json> m_structuredContent;
     std::string m_name;
     std::vector<ToolCall> m_toolCalls;
     std::string m_toolCallId;
     std::string m_activityType;  // non-empty for MessageRole::Activity messages
+    uint64_t m_revision;
+};
+
+/**
+ * @brief Serialized messages kept across requests, reused while a message is unchanged
+ *
+ * A message is serialized again only when its revision() changed (or its ID is new), so
+ * a request for a long conversation mostly concatenates cached text. Edits made through
+ * Message::editStructuredContent() must be finished before the next request is built.
+ * Not thread-safe; one cache per conversation.
+ */
+class MessageJsonCache {
+public:
+    /**
+     * @brief Appends messages as a JSON array, same text as Message::toJson() per element
+     *
+     * Entries of messages absent from this call are dropped, so the cache never holds
+     * more than the latest history.
+     */
+    void appendArray(std::string& out, const std::vector<Message>& messages);
+    void clear() { m_entries.clear(); }
+
+    size_t size() const { return m_entries.size(); }
+    // Messages taken from / written into the cache, over its lifetime
+    uint64_t hits() const { return m_hits; }
+    uint64_t misses() const { return m_misses; }
+
+private:
+    struct Entry {
+        uint64_t revision = 0;
+        uint64_t pass = 0;  // last appendArray() call that used it
+        std::string json;
+    };
+
+    std::unordered_map<MessageId, Entry> m_entries;
+    uint64_t m_pass = 0;
+    uint64_t m_hits = 0;
+    uint64_t m_misses = 0;
 };
 
 struct Tool {
@@ -100,14 +213,68 @@ struct Tool {
     nlohmann::json parameters;
 
     nlohmann::json toJson() const;
+    void appendJson(std::string& out) const;
     static Tool fromJson(const nlohmann::json& j);
 };
 
+/**
+ * @brief Immutable set of tool definitions, serialized once when the set is built
+ *
+ * Requests that carry a ToolSchemaSet copy its bytes instead of serializing each tool's
+ * JSON schema again. Tool names are unique within a set; adding a tool with an existing
+ * name replaces it in place. Sets are shared between requests through shared_ptr and
+ * never modified, so they may be read from any thread.
+ */
+class ToolSchemaSet {
+public:
+    ToolSchemaSet() = default;
+    explicit ToolSchemaSet(const std::vector<Tool>& tools);
+
+    // New set with tool added or replaced; only that tool is serialized
+    std::shared_ptr<const ToolSchemaSet> with(const Tool& tool) const;
+    // New set without the named tool (a copy of this one if there is none)
+    std::shared_ptr<const ToolSchemaSet> without(const std::string& name) const;
+
+    const std::vector<Tool>& tools() const { return m_tools; }
+    size_t size() const { return m_tools.size(); }
+    bool empty() const { return m_tools.empty(); }
+    bool contains(const std::string& name) const { return m_index.count(name) > 0; }
+
+    /**
+     * @brief 64-bit FNV-1a hash of the serialized definitions, in order
+     *
+     * Equal for sets that serialize identically, so a backend can use it to skip parsing
+     * schemas it has already seen.
+     */
+    uint64_t hash() const { return m_hash; }
+    // hash() as 16 lowercase hex digits
+    std::string hashHex() const;
+
+    /**
+     * @brief Appends the serialized tools as comma-separated array elements
+     *
+     * Tools whose name also appears in overrides are skipped.
+     * @return Number of tools appended
+     */
+    size_t appendElements(std::string& out, const std::vector<Tool>& overrides = {}) const;
+
+private:
+    void add(const Tool& tool, std::string json);
+    void rebuild();
+
+    std::vector<Tool> m_tools;
+    std::vector<std::string> m_elements;  // Tool::appendJson() output, parallel to m_tools
+    std::string m_joined;                 // m_elements joined with ','
+    std::unordered_map<std::string, size_t> m_index;
+    uint64_t m_hash = 0;
+};
+
 struct Context {
     std::string description;
     std::string value;
 
     nlohmann::json toJson() const;
+    void appendJson(std::string& out) const;
     static Context fromJson(const nlohmann::json& j);
 };
 
@@ -118,10 +285,22 @@ struct RunAgentInput {
     nlohmann::json state = nlohmann::json::object();
     std::vector<Message> messages;
     std::vector<Tool> tools;
+    // Pre-serialized tools, sent ahead of `tools`; an entry of `tools` with the same
+    // name replaces the registered one. Not restored by fromJson().
+    std::shared_ptr<const ToolSchemaSet> toolSchemas;
     std::vector<Context> context;
     nlohmann::json forwardedProps;
 
     nlohmann::json toJson() const;
+    /**
+     * @brief Appends toJson().dump() to out without building the JSON tree
+     *
+     * Writes messages, tools and context directly, so the request body is the only full
+     * copy of the history. state, forwardedProps and tool parameters are already JSON
+     * and are dumped as they are. Reuse out across calls to keep its capacity.
+     * With messageCache, unchanged messages are copied from the previous request's text.
+     */
+    void appendJson(std::string& out, MessageJsonCache* messageCache = nullptr) const;
     static RunAgentInput fromJson(const nlohmann::json& j);
 };
 
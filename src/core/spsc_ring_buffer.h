@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace agui {
+
+/**
+ * @brief Bounded lock-free single-producer/single-consumer queue
+ *
+ * tryPush() may only be called from one thread and tryPop() from one (other) thread.
+ * The head and tail indices live on separate cache lines, and each side caches the
+ * other's index so the shared line is only re-read when the queue looks full/empty.
+ * Capacity is rounded up to a power of two.
+ */
+template <typename T>
+class SpscRingBuffer {
+public:
+    // std::hardware_destructive_interference_size is not ABI-stable across compilers
+    static constexpr size_t kCacheLineSize = 64;
+
+    explicit SpscRingBuffer(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        m_mask = rounded - 1;
+        m_slots = std::make_unique<Slot[]>(rounded);
+    }
+
+    ~SpscRingBuffer() {
+        // Destroy anything the consumer did not drain
+        while (tryPop()) {
+        }
+    }
+
+    SpscRingBuffer(const SpscRingBuffer&) = delete;
+    SpscRingBuffer& operator=(const SpscRingBuffer&) = delete;
+
+    size_t capacity() const { return m_mask + 1; }
+
+    // Producer side. Returns false (leaving `value` untouched) when full.
+    bool tryPush(T&& value) {
+        const size_t tail = m_producer.index.load(std::memory_order_relaxed);
+        if (tail - m_producer.cachedOther > m_mask) {
+            m_producer.cachedOther = m_consumer.index.load(std::memory_order_acquire);
+            if (tail - m_producer.cachedOther > m_mask) {
+                return false;
+            }
+        }
+        new (m_slots[tail & m_mask].storage) T(std::move(value));
+        m_producer.index.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns std::nullopt when empty.
+    std::optional<T> tryPop() {
+        const size_t head = m_consumer.index.load(std::memory_order_relaxed);
+        if (head == m_consumer.cachedOther) {
+            m_consumer.cachedOther = m_producer.index.load(std::memory_order_acquire);
+            if (head == m_consumer.cachedOther) {
+                return std::nullopt;
+            }
+        }
+        T* slot = std::launder(reinterpret_cast<T*>(m_slots[head & m_mask].storage));
+        std::optional<T> value(std::move(*slot));
+        slot->~T();
+        m_consumer.index.store(head + 1, std::memory_order_release);
+        return value;
+    }
+
+    // Approximate when called concurrently with the other side
+    bool empty() const {
+        return m_consumer.index.load(std::memory_order_acquire) == m_producer.index.load(std::memory_order_acquire);
+    }
+
+private:
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    // One side's index plus its cached copy of the other side's index
+    struct alignas(kCacheLineSize) Side {
+        std::atomic<size_t> index{0};
+        size_t cachedOther = 0;
+    };
+
+    Side m_producer;
+    Side m_consumer;
+    size_t m_mask = 0;
+    std::unique_ptr<Slot[]> m_slots;
+};
+
+}  // namespace agui
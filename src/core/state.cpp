@@ -1,6 +1,7 @@
 #include "core/state.h"
 
 #include <algorithm>
+#include <optional>
 #include <sstream>
 #include "core/logger.h"
 
@@ -144,6 +145,9 @@ StateManager::StateManager()
 StateManager::StateManager(const nlohmann::json& initialState)
     : m_currentState(initialState), m_historyEnabled(false), m_maxHistorySize(10) {}
 
+StateManager::StateManager(nlohmann::json&& initialState)
+    : m_currentState(std::move(initialState)), m_historyEnabled(false), m_maxHistorySize(10) {}
+
 void StateManager::setState(const nlohmann::json& state) {
     if (m_historyEnabled) {
         addToHistory(m_currentState);
@@ -185,6 +189,38 @@ void StateManager::applyPatch(const nlohmann::json& patch) {
     }
 }
 
+void StateManager::applyPatchOps(const std::vector<JsonPatchOp>& ops) {
+    const bool needsBackup = m_historyEnabled || ops.size() > 1 ||
+                             (ops.size() == 1 && ops.front().op == PatchOperation::Move);
+    std::optional<nlohmann::json> backup;
+    if (needsBackup) {
+        backup = m_currentState;
+    }
+
+    try {
+        for (const auto& op : ops) {
+            applyPatchOp(op);
+        }
+    } catch (const AgentError& e) {
+        Logger::errorf("StateManager::applyPatchOps failed: ", e.what());
+        if (backup) {
+            m_currentState = std::move(*backup);
+        }
+        throw;
+    } catch (const std::exception& e) {
+        Logger::errorf("StateManager::applyPatchOps error: ", e.what());
+        if (backup) {
+            m_currentState = std::move(*backup);
+        }
+        throw AgentError(ErrorType::State, ErrorCode::StatePatchFailed,
+                         "Patch operation failed: " + std::string(e.what()));
+    }
+
+    if (m_historyEnabled) {
+        addToHistory(*backup);
+    }
+}
+
 void StateManager::applyPatchOp(const JsonPatchOp& op) {
     try {
         switch (op.op) {
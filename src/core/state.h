@@ -35,10 +35,21 @@ class StateManager {
 public:
     StateManager();
     explicit StateManager(const nlohmann::json& initialState);
+    explicit StateManager(nlohmann::json&& initialState);
 
     const nlohmann::json& currentState() const { return m_currentState; }
+    // Moves the current state out, leaving the manager holding null
+    nlohmann::json releaseState() { return std::move(m_currentState); }
     void setState(const nlohmann::json& state);
     void applyPatch(const nlohmann::json& patch);
+    /**
+     * @brief Apply already-decoded patch operations atomically
+     *
+     * Same semantics as applyPatch() without the JSON round-trip. The rollback copy is
+     * only taken when needed: every operation except move fails before mutating, so a
+     * single non-move operation (with history disabled) is applied in O(patch).
+     */
+    void applyPatchOps(const std::vector<JsonPatchOp>& ops);
     void applyPatchOp(const JsonPatchOp& op);
     bool validateState() const;
     nlohmann::json createSnapshot() const;
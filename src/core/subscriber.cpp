@@ -1,5 +1,6 @@
 #include "core/subscriber.h"
 #include "logger.h"
+#include "tracing.h"
 #include <algorithm>
 
 namespace agui {
@@ -21,6 +22,14 @@ namespace {
                      std::string(eventType) + " is missing required context: " + reason);
 }
 
+// Names the subscriber and callback on a span opened around one notification
+void describeSubscriberSpan(Span& span, const IAgentSubscriber& subscriber, const char* callback) {
+    if (span) {
+        span.setAttribute("agui.subscriber", typeName(typeid(subscriber)));
+        span.setAttribute("agui.callback", callback);
+    }
+}
+
 AgentStateMutation mergeMutations(const AgentStateMutation& first, const AgentStateMutation& second) {
     AgentStateMutation merged;
     if (first.messages.has_value()) {
@@ -58,6 +67,7 @@ AgentStateMutation EventHandler::handleEvent(std::unique_ptr<Event> event) {
     }
 
     EventType type = event->type();
+    m_activeToolCallArgs = nullptr;
 
     // Step 1: Invoke generic onEvent callback first
     AgentStateMutation genericMutation = notifySubscribers(
@@ -144,8 +154,11 @@ AgentStateMutation EventHandler::handleEvent(std::unique_ptr<Event> event) {
     }
 #undef AGUI_HANDLE_EVENT
 
+    publishSnapshot();
+
     // Step 4: Invoke type-specific subscriber callbacks
     AgentStateMutation specificMutation;
+    m_activeToolCallArgs = toolCallArgsFor(*event);
 
 #define AGUI_NOTIFY_EVENT(EventClass, callback) \
     { auto* e = dynamic_cast<EventClass*>(event.get()); \
@@ -292,6 +305,7 @@ AgentStateMutation EventHandler::handleEvent(std::unique_ptr<Event> event) {
             break;
     }
 #undef AGUI_NOTIFY_EVENT
+    m_activeToolCallArgs = nullptr;
 
     // Generic onEvent() and type-specific callbacks are both allowed to
     // request state/message overrides. Specific callbacks run later and take
@@ -308,8 +322,11 @@ void EventHandler::applyMutation(const AgentStateMutation& mutation) {
 
     if (mutation.state.has_value()) {
         m_state = mutation.state.value();
+        m_stateDirty = true;
         notifyStateChanged();
     }
+
+    publishSnapshot();
 }
 
 void EventHandler::addSubscriber(std::shared_ptr<IAgentSubscriber> subscriber) {
@@ -329,6 +346,7 @@ void EventHandler::clearSubscribers() {
 void EventHandler::clearBuffers() {
     m_textBuffers.clear();
     m_toolCallArgsBuffers.clear();
+    m_toolCallArgsParsers.clear();
     m_thinkingBuffer.clear();
     m_lastTextChunkMessageId.clear();
     m_lastToolCallChunkId.clear();
@@ -437,11 +455,13 @@ void EventHandler::handleToolCallStart(const ToolCallStartEvent& event) {
     msg->addToolCall(toolCall);
     m_toolCallToMessageIndex[event.toolCallId] = m_messageIndex.at(msg->id());
     m_toolCallArgsBuffers[event.toolCallId] = "";
+    m_toolCallArgsParsers[event.toolCallId].reset();
     notifyNewToolCall(toolCall);
 }
 
 void EventHandler::handleToolCallArgs(const ToolCallArgsEvent& event) {
     m_toolCallArgsBuffers[event.toolCallId] += event.delta;
+    feedToolCallArgs(event.toolCallId, event.delta);
     appendEventDelta(event.toolCallId, event.delta);
 }
 
@@ -489,11 +509,13 @@ void EventHandler::handleToolCallChunk(const ToolCallChunkEvent& event) {
     }
 
     m_toolCallArgsBuffers[targetToolCallId] += event.delta;
+    feedToolCallArgs(targetToolCallId, event.delta);
     appendEventDelta(targetToolCallId, event.delta);
 }
 
 void EventHandler::handleStateSnapshot(const StateSnapshotEvent& event) {
     m_state = event.snapshot;
+    m_stateDirty = true;
     notifyStateChanged();
 }
 
@@ -503,6 +525,7 @@ void EventHandler::handleStateDelta(const StateDeltaEvent& event) {
     StateManager stateManager(m_state);
     stateManager.applyPatch(event.delta);
     m_state = stateManager.currentState();
+    m_stateDirty = true;
     notifyStateChanged();
 }
 
@@ -536,6 +559,8 @@ AgentStateMutation EventHandler::notifySubscribers(
     AgentSubscriberParams params = createParams();
 
     for (auto& subscriber : m_subscribers) {
+        Span span("agui.subscriber");
+        describeSubscriberSpan(span, *subscriber, "event notification");
         try {
             AgentStateMutation mutation = notifyFunc(subscriber.get(), params);
             
@@ -565,6 +590,8 @@ AgentStateMutation EventHandler::notifySubscribers(
 void EventHandler::notifyNewMessage(const Message& message) {
     AgentSubscriberParams params = createParams();
     for (auto& subscriber : m_subscribers) {
+        Span span("agui.subscriber");
+        describeSubscriberSpan(span, *subscriber, "onNewMessage");
         try {
             subscriber->onNewMessage(message, params);
         } catch (const std::exception& e) {
@@ -580,6 +607,8 @@ void EventHandler::notifyNewMessage(const Message& message) {
 void EventHandler::notifyNewToolCall(const ToolCall& toolCall) {
     AgentSubscriberParams params = createParams();
     for (auto& subscriber : m_subscribers) {
+        Span span("agui.subscriber");
+        describeSubscriberSpan(span, *subscriber, "onNewToolCall");
         try {
             subscriber->onNewToolCall(toolCall, params);
         } catch (const std::exception& e) {
@@ -592,9 +621,97 @@ void EventHandler::notifyNewToolCall(const ToolCall& toolCall) {
     }
 }
 
+void EventHandler::beginBatch() {
+    ++m_batchDepth;
+}
+
+void EventHandler::endBatch() {
+    if (m_batchDepth == 0 || --m_batchDepth > 0) {
+        return;
+    }
+
+    // Clear the flags first so a throwing subscriber cannot cause a repeat delivery
+    const bool messagesChanged = m_pendingMessagesChanged;
+    const bool stateChanged = m_pendingStateChanged;
+    m_pendingMessagesChanged = false;
+    m_pendingStateChanged = false;
+
+    // Published before notifying so onMessagesChanged/onStateChanged can hand it out
+    publishSnapshot();
+
+    if (messagesChanged) {
+        notifyMessagesChanged();
+    }
+    if (stateChanged) {
+        notifyStateChanged();
+    }
+}
+
+void EventHandler::enableSnapshots(bool enable) {
+    m_snapshotsEnabled = enable;
+    if (!enable) {
+        std::atomic_store(&m_snapshot, std::shared_ptr<const EventHandlerSnapshot>());
+        return;
+    }
+    m_stateDirty = true;
+    publishSnapshot();
+}
+
+std::shared_ptr<const EventHandlerSnapshot> EventHandler::snapshot() const {
+    return std::atomic_load(&m_snapshot);
+}
+
+void EventHandler::publishSnapshot() {
+    if (!m_snapshotsEnabled || m_batchDepth > 0) {
+        return;
+    }
+
+    // Only the writer thread stores, so a plain load of our own last publication is enough
+    std::shared_ptr<const EventHandlerSnapshot> previous = std::atomic_load(&m_snapshot);
+    const std::vector<std::shared_ptr<const Message>> noMessages;
+    const auto& previousMessages = previous ? previous->messages : noMessages;
+
+    auto next = std::make_shared<EventHandlerSnapshot>();
+    next->messages.reserve(m_messages.size());
+    bool changed = !previous || previousMessages.size() != m_messages.size();
+    for (size_t i = 0; i < m_messages.size(); ++i) {
+        const Message& message = m_messages[i];
+        if (i < previousMessages.size() && previousMessages[i]->revision() == message.revision()) {
+            next->messages.push_back(previousMessages[i]);
+            continue;
+        }
+        auto copy = std::make_shared<Message>(message);
+        // Serialize lazily-held content now: readers must not trigger the mutable refresh
+        (void)copy->content();
+        next->messages.push_back(std::move(copy));
+        changed = true;
+    }
+
+    if (m_stateDirty || !previous) {
+        next->state = std::make_shared<const nlohmann::json>(m_state);
+        m_stateDirty = false;
+        changed = true;
+    } else {
+        next->state = previous->state;
+    }
+
+    if (!changed) {
+        return;
+    }
+    next->version = previous ? previous->version + 1 : 1;
+    std::atomic_store(&m_snapshot, std::shared_ptr<const EventHandlerSnapshot>(std::move(next)));
+}
+
 void EventHandler::notifyMessagesChanged() {
+    if (m_batchDepth > 0) {
+        m_pendingMessagesChanged = true;
+        return;
+    }
+
     AgentSubscriberParams params = createParams();
     for (auto& subscriber : m_subscribers) {
+        Span span("agui.subscriber");
+        describeSubscriberSpan(span, *subscriber, "onMessagesChanged");
         try {
             subscriber->onMessagesChanged(params);
         } catch (const std::exception& e) {
@@ -608,8 +725,15 @@ void EventHandler::notifyMessagesChanged() {
 }
 
 void EventHandler::notifyStateChanged() {
+    if (m_batchDepth > 0) {
+        m_pendingStateChanged = true;
+        return;
+    }
+
     AgentSubscriberParams params = createParams();
     for (auto& subscriber : m_subscribers) {
+        Span span("agui.subscriber");
+        describeSubscriberSpan(span, *subscriber, "onStateChanged");
         try {
             subscriber->onStateChanged(params);
         } catch (const std::exception& e) {
@@ -696,7 +820,51 @@ void EventHandler::appendEventDelta(const ToolCallId& toolCallId, const std::str
 }
 
 AgentSubscriberParams EventHandler::createParams() const {
-    return AgentSubscriberParams(&m_messages, &m_state);
+    AgentSubscriberParams params(&m_messages, &m_state);
+    params.toolCallArgs = m_activeToolCallArgs;
+    return params;
+}
+
+const IncrementalJsonParser* EventHandler::toolCallArguments(const ToolCallId& toolCallId) const {
+    auto it = m_toolCallArgsParsers.find(toolCallId);
+    return it != m_toolCallArgsParsers.end() ? &it->second : nullptr;
+}
+
+void EventHandler::feedToolCallArgs(const ToolCallId& toolCallId, const std::string& delta) {
+    IncrementalJsonParser& parser = m_toolCallArgsParsers[toolCallId];
+    if (parser.hasError()) {
+        return;
+    }
+    // Arguments are not required to be valid JSON until the tool runs, so a parse
+    // failure only disables incremental access for this call; the raw buffer is kept.
+    try {
+        parser.feed(delta);
+    } catch (const AgentError& e) {
+        Logger::warningf("Tool call '", toolCallId, "' arguments are not incrementally parseable: ", e.what());
+    }
+}
+
+const IncrementalJsonParser* EventHandler::toolCallArgsFor(const Event& event) const {
+    switch (event.type()) {
+        case EventType::ToolCallArgs:
+            if (auto* e = dynamic_cast<const ToolCallArgsEvent*>(&event)) {
+                return toolCallArguments(e->toolCallId);
+            }
+            break;
+        case EventType::ToolCallEnd:
+            if (auto* e = dynamic_cast<const ToolCallEndEvent*>(&event)) {
+                return toolCallArguments(e->toolCallId);
+            }
+            break;
+        case EventType::ToolCallChunk:
+            if (auto* e = dynamic_cast<const ToolCallChunkEvent*>(&event)) {
+                return toolCallArguments(e->toolCallId.empty() ? m_lastToolCallChunkId : e->toolCallId);
+            }
+            break;
+        default:
+            break;
+    }
+    return nullptr;
 }
 
 void EventHandler::handleToolCallResult(const ToolCallResultEvent& event) {
@@ -713,14 +881,14 @@ void EventHandler::handleActivitySnapshot(const ActivitySnapshotEvent& event) {
     Message* existing = findMessage(event.messageId);
 
     if (!existing) {
-        Message activityMsg = Message::createWithId(event.messageId, MessageRole::Activity,
-                                                    event.content.dump());
+        Message activityMsg = Message::createWithId(event.messageId, MessageRole::Activity);
+        activityMsg.setStructuredContent(event.content);
         activityMsg.setActivityType(event.activityType);
-        m_messages.push_back(activityMsg);
+        m_messages.push_back(std::move(activityMsg));
         m_messageIndex[event.messageId] = m_messages.size() - 1;
         notifyNewMessage(m_messages.back());
     } else if (event.replace) {
-        existing->setContent(event.content.dump());
+        existing->setStructuredContent(event.content);
         existing->setActivityType(event.activityType);
     }
 
@@ -740,19 +908,18 @@ void EventHandler::handleActivityDelta(const ActivityDeltaEvent& event) {
     }
 
     try {
-        // Default to empty object if content is absent, consistent with TypeScript (content ?? {})
-        nlohmann::json currentContent = existing->content().empty()
-            ? nlohmann::json::object()
-            : nlohmann::json::parse(existing->content());
-
-        nlohmann::json patchJson = nlohmann::json::array();
-        for (const auto& op : event.patch) {
-            patchJson.push_back(op.toJson());
+        // Patch the live content tree in place; it is only re-serialized when content() is read.
+        // Empty content defaults to an empty object, consistent with TypeScript (content ?? {})
+        nlohmann::json& content = existing->editStructuredContent();
+        StateManager stateManager(std::move(content));
+        try {
+            stateManager.applyPatchOps(event.patch);
+        } catch (...) {
+            // applyPatchOps has already rolled back; hand the unmodified tree back
+            content = stateManager.releaseState();
+            throw;
         }
-
-        StateManager stateManager(currentContent);
-        stateManager.applyPatch(patchJson);
-        existing->setContent(stateManager.currentState().dump());
+        content = stateManager.releaseState();
         existing->setActivityType(event.activityType);  // sync activityType from delta event
     } catch (const AgentError& e) {
         throw AGUI_ERROR(state, ErrorCode::StatePatchFailed,
@@ -13,6 +13,7 @@
 #include "core/event.h"
 #include "core/session_types.h"
 #include "core/state.h"
+#include "stream/incremental_json_parser.h"
 
 namespace agui {
 
@@ -44,6 +45,9 @@ struct AgentStateMutation {
 struct AgentSubscriberParams {
     const std::vector<Message>* messages = nullptr;
     const nlohmann::json* state = nullptr;
+    // Incrementally parsed arguments of the tool call being delivered; set only for
+    // onToolCallArgs / onToolCallChunk / onToolCallEnd, nullptr otherwise.
+    const IncrementalJsonParser* toolCallArgs = nullptr;
 
     AgentSubscriberParams() {}
 
@@ -187,6 +191,19 @@ public:
     virtual void onRunFinalized(const AgentSubscriberParams& params) {}
 };
 
+/**
+ * @brief Immutable view of an EventHandler's messages and state at one point in time
+ *
+ * Messages whose revision did not change are shared with the previous snapshot, and
+ * the state is shared until it changes, so publishing a new version costs O(messages)
+ * pointer copies plus copies of what actually changed.
+ */
+struct EventHandlerSnapshot {
+    uint64_t version = 0;  ///< Increases with every published change
+    std::vector<std::shared_ptr<const Message>> messages;
+    std::shared_ptr<const nlohmann::json> state;
+};
+
 /**
  * @class EventHandler
  * @brief Handles AG-UI protocol events and manages agent state
@@ -194,7 +211,8 @@ public:
  * @warning Thread Safety: NOT thread-safe
  * All methods must be called from the same thread. For multi-threaded use,
  * provide external synchronization (e.g., std::mutex) or use a message queue
- * to serialize events to a single processing thread.
+ * to serialize events to a single processing thread. The exception is snapshot(),
+ * which other threads may call while events are being handled.
  */
 class EventHandler {
 public:
@@ -216,10 +234,44 @@ public:
     void notifyRunFailed(const AgentError& error);
     void notifyRunFinalized();
 
+    /**
+     * @brief Coalesce change notifications across a group of events
+     *
+     * Between beginBatch() and the matching endBatch(), onMessagesChanged/onStateChanged
+     * are recorded instead of delivered; endBatch() then delivers each at most once.
+     * Event callbacks are unaffected. Batches nest; only the outermost endBatch() flushes.
+     * @throws AgentError from endBatch() if a subscriber fails, as for unbatched delivery
+     */
+    void beginBatch();
+    void endBatch();
+    bool inBatch() const { return m_batchDepth > 0; }
+
     const std::vector<Message>& messages() const { return m_messages; }
     const nlohmann::json& state() const { return m_state; }
     const std::string& result() const { return m_result; }
 
+    /**
+     * @brief Publish copy-on-write snapshots for readers on other threads (default: off)
+     *
+     * While enabled, a new snapshot is published after each handled event or applied
+     * mutation that changed something, or once per batch at the outermost endBatch().
+     * Enabling publishes the current contents immediately; disabling drops the snapshot.
+     */
+    void enableSnapshots(bool enable = true);
+    /**
+     * @brief Latest published snapshot; safe to call from any thread
+     * @return nullptr unless snapshots are enabled. Readers never block the writer and
+     *         may keep the snapshot as long as they like.
+     */
+    std::shared_ptr<const EventHandlerSnapshot> snapshot() const;
+
+    /**
+     * @brief Incrementally parsed arguments of a tool call in the current run
+     * @return nullptr if the tool call is unknown. The parser stays available after
+     *         TOOL_CALL_END until clearBuffers().
+     */
+    const IncrementalJsonParser* toolCallArguments(const ToolCallId& toolCallId) const;
+
     void setResult(const nlohmann::json& result) { m_result = result.dump(); }
     void clearResult() { m_result.clear(); }
 
@@ -231,6 +283,17 @@ private:
 
     std::map<MessageId, std::string> m_textBuffers;
     std::map<ToolCallId, std::string> m_toolCallArgsBuffers;
+    std::map<ToolCallId, IncrementalJsonParser> m_toolCallArgsParsers;
+    const IncrementalJsonParser* m_activeToolCallArgs = nullptr;  ///< exposed via createParams()
+
+    int m_batchDepth = 0;
+    bool m_pendingMessagesChanged = false;
+    bool m_pendingStateChanged = false;
+
+    bool m_snapshotsEnabled = false;
+    bool m_stateDirty = false;  ///< m_state changed since the last published snapshot
+    // Only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const EventHandlerSnapshot> m_snapshot;
     std::string m_thinkingBuffer;
     MessageId m_lastTextChunkMessageId;
     ToolCallId m_lastToolCallChunkId;
@@ -267,6 +330,9 @@ private:
     AgentStateMutation notifySubscribers(
         std::function<AgentStateMutation(IAgentSubscriber*, const AgentSubscriberParams&)> notifyFunc);
 
+    // Publishes a snapshot if enabled, outside a batch, and something changed
+    void publishSnapshot();
+
     void notifyNewMessage(const Message& message);
     void notifyNewToolCall(const ToolCall& toolCall);
     void notifyMessagesChanged();
@@ -275,6 +341,8 @@ private:
     Message* findMessage(const MessageId& id);
     Message* findMessageContainingToolCall(const ToolCallId& toolCallId);
     void appendEventDelta(const ToolCallId& toolCallId, const std::string &delta);
+    void feedToolCallArgs(const ToolCallId& toolCallId, const std::string& delta);
+    const IncrementalJsonParser* toolCallArgsFor(const Event& event) const;
     AgentSubscriberParams createParams() const;
     void rebuildMessageIndex();
 };
@@ -0,0 +1,239 @@
+#include "tracing.h"
+
+#include <cstdio>
+#include <random>
+
+#include <nlohmann/json.hpp>
+
+#include "core/error.h"
+#include "core/logger.h"
+
+#if defined(__GNUG__)
+#include <cxxabi.h>
+#include <cstdlib>
+#endif
+
+namespace agui {
+
+namespace {
+
+// Non-zero random ID; one generator per thread so span creation never locks
+uint64_t randomId() {
+    thread_local std::mt19937_64 generator{std::random_device{}()};
+    uint64_t id = 0;
+    while (id == 0) {
+        id = generator();
+    }
+    return id;
+}
+
+std::string hex(uint64_t value) {
+    char buffer[17];
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(value));
+    return buffer;
+}
+
+// OTLP/JSON carries 64-bit integers as decimal strings
+std::string unixNanos(std::chrono::system_clock::time_point time) {
+    return std::to_string(std::chrono::duration_cast<std::chrono::nanoseconds>(time.time_since_epoch()).count());
+}
+
+nlohmann::json stringAttribute(const std::string& key, const std::string& value) {
+    return {{"key", key}, {"value", {{"stringValue", value}}}};
+}
+
+nlohmann::json spanToJson(const SpanRecord& span) {
+    nlohmann::json attributes = nlohmann::json::array();
+    for (const auto& attribute : span.attributes) {
+        if (attribute.isInt) {
+            attributes.push_back(
+                {{"key", attribute.key}, {"value", {{"intValue", std::to_string(attribute.intValue)}}}});
+        } else {
+            attributes.push_back(stringAttribute(attribute.key, attribute.stringValue));
+        }
+    }
+
+    nlohmann::json json = {
+        {"traceId", hex(span.context.traceIdHigh) + hex(span.context.traceIdLow)},
+        {"spanId", hex(span.context.spanId)},
+        {"name", span.name},
+        {"kind", 1},  // SPAN_KIND_INTERNAL
+        {"startTimeUnixNano", unixNanos(span.start)},
+        {"endTimeUnixNano", unixNanos(span.end)},
+        {"attributes", std::move(attributes)},
+    };
+    if (span.parentSpanId != 0) {
+        json["parentSpanId"] = hex(span.parentSpanId);
+    }
+    if (span.error) {
+        json["status"] = {{"code", 2}, {"message", span.statusMessage}};  // STATUS_CODE_ERROR
+    }
+    return json;
+}
+
+}  // namespace
+
+// Span
+
+Span::Span(ITraceSink* sink, const char* name, const SpanContext& parent) {
+    if (sink) {
+        start(sink, name, parent);
+    }
+}
+
+void Span::start(ITraceSink* sink, const char* name, const SpanContext& parent) {
+    m_state = std::make_unique<State>();
+    m_state->sink = sink;
+    SpanRecord& record = m_state->record;
+    record.name = name;
+    if (parent.valid()) {
+        record.context.traceIdHigh = parent.traceIdHigh;
+        record.context.traceIdLow = parent.traceIdLow;
+        record.parentSpanId = parent.spanId;
+    } else {
+        record.context.traceIdHigh = randomId();
+        record.context.traceIdLow = randomId();
+    }
+    record.context.spanId = randomId();
+    record.start = std::chrono::system_clock::now();
+    m_state->previous = s_current;
+    s_current = this;
+}
+
+void Span::finish() {
+    m_state->record.end = std::chrono::system_clock::now();
+    s_current = m_state->previous;
+    try {
+        m_state->sink->onSpanEnd(m_state->record);
+    } catch (const std::exception& e) {
+        Logger::errorf("Trace sink threw: ", e.what());
+    } catch (...) {
+        Logger::errorf("Trace sink threw unknown exception");
+    }
+    m_state.reset();
+}
+
+SpanContext Span::context() const {
+    return m_state ? m_state->record.context : SpanContext();
+}
+
+void Span::setAttribute(const char* key, std::string value) {
+    if (m_state) {
+        SpanAttribute attribute;
+        attribute.key = key;
+        attribute.stringValue = std::move(value);
+        m_state->record.attributes.push_back(std::move(attribute));
+    }
+}
+
+void Span::setAttribute(const char* key, int64_t value) {
+    if (m_state) {
+        SpanAttribute attribute;
+        attribute.key = key;
+        attribute.intValue = value;
+        attribute.isInt = true;
+        m_state->record.attributes.push_back(std::move(attribute));
+    }
+}
+
+void Span::setError(std::string message) {
+    if (m_state) {
+        m_state->record.error = true;
+        m_state->record.statusMessage = std::move(message);
+    }
+}
+
+void Span::record(ITraceSink* sink, const char* name, const SpanContext& parent,
+                  std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end,
+                  std::vector<SpanAttribute> attributes) {
+    if (!sink || !parent.valid()) {
+        return;
+    }
+    SpanRecord record;
+    record.name = name;
+    record.context.traceIdHigh = parent.traceIdHigh;
+    record.context.traceIdLow = parent.traceIdLow;
+    record.context.spanId = randomId();
+    record.parentSpanId = parent.spanId;
+    record.start = start;
+    record.end = end;
+    record.attributes = std::move(attributes);
+    try {
+        sink->onSpanEnd(record);
+    } catch (const std::exception& e) {
+        Logger::errorf("Trace sink threw: ", e.what());
+    }
+}
+
+std::string typeName(const std::type_info& type) {
+#if defined(__GNUG__)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        std::string name(demangled);
+        std::free(demangled);
+        return name;
+    }
+    std::free(demangled);
+#endif
+    return type.name();
+}
+
+// OtlpJsonFileExporter
+
+OtlpJsonFileExporter::OtlpJsonFileExporter(const std::string& path, std::string serviceName, size_t batchSize)
+    : m_serviceName(std::move(serviceName)), m_batchSize(batchSize == 0 ? 1 : batchSize),
+      m_file(path, std::ios::out | std::ios::app) {
+    if (!m_file) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Cannot open trace file: " + path);
+    }
+    m_batch.reserve(m_batchSize);
+}
+
+OtlpJsonFileExporter::~OtlpJsonFileExporter() {
+    try {
+        flush();
+    } catch (const std::exception& e) {
+        Logger::errorf("Failed to flush trace file: ", e.what());
+    }
+}
+
+void OtlpJsonFileExporter::onSpanEnd(const SpanRecord& span) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_batch.push_back(span);
+    if (m_batch.size() >= m_batchSize) {
+        writeBatch();
+    }
+}
+
+void OtlpJsonFileExporter::flush() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    writeBatch();
+    m_file.flush();
+}
+
+uint64_t OtlpJsonFileExporter::spansExported() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_exported;
+}
+
+void OtlpJsonFileExporter::writeBatch() {
+    if (m_batch.empty()) {
+        return;
+    }
+    nlohmann::json spans = nlohmann::json::array();
+    for (const auto& span : m_batch) {
+        spans.push_back(spanToJson(span));
+    }
+    const nlohmann::json request = {
+        {"resourceSpans",
+         {{{"resource", {{"attributes", {stringAttribute("service.name", m_serviceName)}}}},
+           {"scopeSpans", {{{"scope", {{"name", "ag-ui-cpp"}}}, {"spans", std::move(spans)}}}}}}},
+    };
+    // Span names and attributes are caller-provided: replace invalid UTF-8 rather than throw
+    m_file << request.dump(-1, ' ', false, nlohmann::json::error_handler_t::replace) << '\n';
+    m_exported += m_batch.size();
+    m_batch.clear();
+}
+
+}  // namespace agui
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <typeinfo>
+#include <vector>
+
+namespace agui {
+
+// Identifies a span within a trace; spanId 0 means "no span"
+struct SpanContext {
+    uint64_t traceIdHigh = 0;
+    uint64_t traceIdLow = 0;
+    uint64_t spanId = 0;
+
+    bool valid() const { return spanId != 0; }
+};
+
+struct SpanAttribute {
+    std::string key;
+    std::string stringValue;
+    int64_t intValue = 0;
+    bool isInt = false;
+};
+
+// A finished span, as handed to ITraceSink
+struct SpanRecord {
+    std::string name;
+    SpanContext context;
+    uint64_t parentSpanId = 0;  ///< 0 for the root span of a trace
+    std::chrono::system_clock::time_point start;
+    std::chrono::system_clock::time_point end;
+    std::vector<SpanAttribute> attributes;
+    bool error = false;
+    std::string statusMessage;  ///< Set with error
+};
+
+/**
+ * @brief Receives every span when it ends
+ *
+ * Called on the thread that ended the span, which for pipelined runs includes the
+ * event worker thread. A sink may be shared by several agents, so implementations
+ * must be thread-safe.
+ */
+class ITraceSink {
+public:
+    virtual ~ITraceSink() = default;
+    virtual void onSpanEnd(const SpanRecord& span) = 0;
+};
+
+/**
+ * @brief Scoped span: starts when constructed, ends and is reported when destroyed
+ *
+ * A span either starts a trace (or continues an explicit parent) through a sink, or is a
+ * child of the innermost active span on the calling thread. The latter is how library code
+ * below HttpAgent (middleware chain, subscriber notification) opens spans without knowing
+ * about sinks: with tracing disabled there is no active span, so constructing one costs a
+ * thread-local read and a branch, and nothing is allocated. Spans on one thread must end in
+ * reverse order of construction, which scoping guarantees.
+ */
+class Span {
+public:
+    // Child of parent, or the root of a new trace if parent is invalid; inactive if sink is null
+    Span(ITraceSink* sink, const char* name, const SpanContext& parent = SpanContext());
+    // Child of the innermost active span on this thread; inactive if there is none
+    explicit Span(const char* name) {
+        if (s_current) {
+            start(s_current->m_state->sink, name, s_current->m_state->record.context);
+        }
+    }
+    ~Span() {
+        if (m_state) {
+            finish();
+        }
+    }
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    // True if the span is recorded; attribute setters are no-ops otherwise
+    explicit operator bool() const { return m_state != nullptr; }
+    // Invalid for an inactive span
+    SpanContext context() const;
+
+    void setAttribute(const char* key, std::string value);
+    void setAttribute(const char* key, int64_t value);
+    void setError(std::string message);
+
+    // True while a span is active on the calling thread
+    static bool tracing() { return s_current != nullptr; }
+
+    // Reports a span with explicit times, e.g. reconstructed from transport timings
+    static void record(ITraceSink* sink, const char* name, const SpanContext& parent,
+                       std::chrono::system_clock::time_point start, std::chrono::system_clock::time_point end,
+                       std::vector<SpanAttribute> attributes = {});
+
+private:
+    struct State {
+        ITraceSink* sink = nullptr;
+        SpanRecord record;
+        Span* previous = nullptr;
+    };
+
+    void start(ITraceSink* sink, const char* name, const SpanContext& parent);
+    void finish();
+
+    std::unique_ptr<State> m_state;
+
+    static inline thread_local Span* s_current = nullptr;
+};
+
+// Readable (demangled where supported) name of a type, for span attributes
+std::string typeName(const std::type_info& type);
+
+/**
+ * @brief Writes spans to a file in the OTLP/JSON encoding, for offline analysis
+ *
+ * Spans are buffered and written in batches; each batch is one ExportTraceServiceRequest
+ * on its own line (JSON Lines), the format of the OpenTelemetry Collector's file exporter,
+ * which its otlpjsonfile receiver and most trace viewers can import. flush() writes the
+ * current batch; the destructor flushes. Thread-safe.
+ */
+class OtlpJsonFileExporter : public ITraceSink {
+public:
+    /**
+     * @param path File to append to
+     * @param serviceName Value of the service.name resource attribute
+     * @param batchSize Spans buffered before a batch is written
+     * @throws AgentError if the file cannot be opened
+     */
+    explicit OtlpJsonFileExporter(const std::string& path, std::string serviceName = "ag-ui-cpp",
+                                  size_t batchSize = 512);
+    ~OtlpJsonFileExporter() override;
+
+    void onSpanEnd(const SpanRecord& span) override;
+    void flush();
+
+    uint64_t spansExported() const;
+
+private:
+    void writeBatch();  // m_mutex must be held
+
+    std::string m_serviceName;
+    size_t m_batchSize;
+    mutable std::mutex m_mutex;
+    std::ofstream m_file;
+    std::vector<SpanRecord> m_batch;
+    uint64_t m_exported = 0;
+};
+
+}  // namespace agui
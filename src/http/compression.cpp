@@ -0,0 +1,236 @@
+#include "http/compression.h"
+
+#include <climits>
+
+#ifdef AGUI_HAS_ZLIB
+#include <zlib.h>
+#endif
+#ifdef AGUI_HAS_ZSTD
+#include <zstd.h>
+#endif
+
+#include "core/error.h"
+#include "http/http_service.h"
+
+namespace agui {
+
+namespace {
+
+[[noreturn]] void throwUnavailable(ContentEncoding encoding) {
+    throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument,
+                     std::string("Content encoding not built in: ") + contentEncodingName(encoding));
+}
+
+[[noreturn]] void throwTooLarge(size_t maxOutputBytes) {
+    throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidInput,
+                     "Decompressed body exceeds " + std::to_string(maxOutputBytes) + " bytes");
+}
+
+#ifdef AGUI_HAS_ZLIB
+// deflate/inflate with a gzip header and trailer
+constexpr int kGzipWindowBits = 15 + 16;
+
+void gzipCompress(std::string_view input, int level, std::string& output) {
+    if (input.size() > UINT_MAX) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument, "Body too large for gzip");
+    }
+    z_stream stream{};
+    if (deflateInit2(&stream, level < 0 ? Z_DEFAULT_COMPRESSION : level, Z_DEFLATED, kGzipWindowBits, 8,
+                     Z_DEFAULT_STRATEGY) != Z_OK) {
+        throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed, "deflateInit2 failed");
+    }
+    const size_t offset = output.size();
+    output.resize(offset + deflateBound(&stream, static_cast<uLong>(input.size())));
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    stream.next_out = reinterpret_cast<Bytef*>(&output[offset]);
+    stream.avail_out = static_cast<uInt>(output.size() - offset);
+    const int result = deflate(&stream, Z_FINISH);
+    const size_t written = stream.total_out;
+    deflateEnd(&stream);
+    if (result != Z_STREAM_END) {
+        output.resize(offset);
+        throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed, "gzip compression failed");
+    }
+    output.resize(offset + written);
+}
+
+std::string gzipDecompress(std::string_view input, size_t maxOutputBytes) {
+    z_stream stream{};
+    if (inflateInit2(&stream, kGzipWindowBits) != Z_OK) {
+        throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed, "inflateInit2 failed");
+    }
+    std::string output;
+    char buffer[16 * 1024];
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    stream.avail_in = static_cast<uInt>(input.size());
+    int result = Z_OK;
+    bool tooLarge = false;
+    while (result == Z_OK) {
+        stream.next_out = reinterpret_cast<Bytef*>(buffer);
+        stream.avail_out = sizeof(buffer);
+        result = inflate(&stream, Z_NO_FLUSH);
+        output.append(buffer, sizeof(buffer) - stream.avail_out);
+        if (output.size() > maxOutputBytes) {
+            tooLarge = true;
+            break;
+        }
+        if (result == Z_BUF_ERROR && stream.avail_in == 0) {
+            break;  // truncated input
+        }
+    }
+    inflateEnd(&stream);
+    if (tooLarge) {
+        throwTooLarge(maxOutputBytes);
+    }
+    if (result != Z_STREAM_END) {
+        throw AGUI_ERROR(parse, ErrorCode::ParseJsonError, "Invalid gzip data");
+    }
+    return output;
+}
+#endif
+
+#ifdef AGUI_HAS_ZSTD
+void zstdCompress(std::string_view input, int level, std::string& output) {
+    const size_t offset = output.size();
+    output.resize(offset + ZSTD_compressBound(input.size()));
+    const size_t written = ZSTD_compress(&output[offset], output.size() - offset, input.data(), input.size(),
+                                         level < 0 ? ZSTD_CLEVEL_DEFAULT : level);
+    if (ZSTD_isError(written)) {
+        output.resize(offset);
+        throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed,
+                         std::string("zstd compression failed: ") + ZSTD_getErrorName(written));
+    }
+    output.resize(offset + written);
+}
+
+// Streams into a growing buffer, like gzipDecompress(), rather than trusting the
+// content size declared in the frame header
+std::string zstdDecompress(std::string_view input, size_t maxOutputBytes) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    if (!context) {
+        throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed, "ZSTD_createDCtx failed");
+    }
+    std::string output;
+    char buffer[16 * 1024];
+    ZSTD_inBuffer in{input.data(), input.size(), 0};
+    size_t result = 0;
+    bool complete = false;
+    bool tooLarge = false;
+    while (true) {
+        ZSTD_outBuffer out{buffer, sizeof(buffer), 0};
+        result = ZSTD_decompressStream(context, &out, &in);
+        if (ZSTD_isError(result)) {
+            break;
+        }
+        output.append(buffer, out.pos);
+        if (output.size() > maxOutputBytes) {
+            tooLarge = true;
+            break;
+        }
+        // 0: the frame is decoded and flushed. Otherwise, with all input consumed, only a
+        // full output buffer means there is more to flush; anything else is truncation.
+        if (in.pos == in.size && (result == 0 || out.pos < out.size)) {
+            complete = result == 0;
+            break;
+        }
+    }
+    ZSTD_freeDCtx(context);
+    if (tooLarge) {
+        throwTooLarge(maxOutputBytes);
+    }
+    if (!complete) {
+        throw AGUI_ERROR(parse, ErrorCode::ParseJsonError, "Invalid zstd data");
+    }
+    return output;
+}
+#endif
+
+}  // namespace
+
+const char* contentEncodingName(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Identity: return "identity";
+        case ContentEncoding::Gzip:     return "gzip";
+        case ContentEncoding::Zstd:     return "zstd";
+    }
+    return "identity";
+}
+
+bool isContentEncodingAvailable(ContentEncoding encoding) {
+    switch (encoding) {
+        case ContentEncoding::Identity:
+            return true;
+        case ContentEncoding::Gzip:
+#ifdef AGUI_HAS_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case ContentEncoding::Zstd:
+#ifdef AGUI_HAS_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+void compressBody(ContentEncoding encoding, std::string_view input, int level, std::string& output) {
+    switch (encoding) {
+        case ContentEncoding::Identity:
+            output.append(input.data(), input.size());
+            return;
+        case ContentEncoding::Gzip:
+#ifdef AGUI_HAS_ZLIB
+            gzipCompress(input, level, output);
+            return;
+#else
+            break;
+#endif
+        case ContentEncoding::Zstd:
+#ifdef AGUI_HAS_ZSTD
+            zstdCompress(input, level, output);
+            return;
+#else
+            break;
+#endif
+    }
+    throwUnavailable(encoding);
+}
+
+std::string decompressBody(ContentEncoding encoding, std::string_view input, size_t maxOutputBytes) {
+    switch (encoding) {
+        case ContentEncoding::Identity:
+            if (input.size() > maxOutputBytes) {
+                throwTooLarge(maxOutputBytes);
+            }
+            return std::string(input);
+        case ContentEncoding::Gzip:
+#ifdef AGUI_HAS_ZLIB
+            return gzipDecompress(input, maxOutputBytes);
+#else
+            break;
+#endif
+        case ContentEncoding::Zstd:
+#ifdef AGUI_HAS_ZSTD
+            return zstdDecompress(input, maxOutputBytes);
+#else
+            break;
+#endif
+    }
+    throwUnavailable(encoding);
+}
+
+bool encodeRequestBody(const HttpCompressionOptions& options, const HttpRequest& request, std::string& encoded) {
+    if (options.requestEncoding == ContentEncoding::Identity || request.body.size() < options.minBodySize ||
+        request.headers.count("Content-Encoding") > 0) {
+        return false;
+    }
+    encoded.clear();
+    compressBody(options.requestEncoding, request.body, options.level, encoded);
+    return encoded.size() < request.body.size();
+}
+
+}  // namespace agui
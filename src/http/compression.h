@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace agui {
+
+struct HttpRequest;
+
+// Content-Encoding of a request body
+enum class ContentEncoding { Identity, Gzip, Zstd };
+
+/**
+ * @brief When and how HttpService compresses request bodies
+ *
+ * Codecs are optional at build time (zlib for gzip, libzstd for zstd); an encoding that
+ * was not built in is rejected by the HttpService constructor.
+ */
+struct HttpCompressionOptions {
+    ContentEncoding requestEncoding = ContentEncoding::Gzip;
+    // Codec level; -1 uses the codec's default (gzip 6, zstd 3)
+    int level = -1;
+    // Smaller bodies are sent as they are; compressing them costs more than it saves
+    size_t minBodySize = 16 * 1024;
+    // Send Accept-Encoding with every encoding libcurl can decode; responses, including
+    // SSE streams, are decoded before they reach callbacks
+    bool acceptEncoding = true;
+
+    // No request compression and no Accept-Encoding (HttpService's default)
+    static HttpCompressionOptions disabled() {
+        HttpCompressionOptions options;
+        options.requestEncoding = ContentEncoding::Identity;
+        options.acceptEncoding = false;
+        return options;
+    }
+};
+
+// Content-Encoding header value: "identity", "gzip" or "zstd"
+const char* contentEncodingName(ContentEncoding encoding);
+// Whether this build can compress and decompress with encoding (Identity always can)
+bool isContentEncodingAvailable(ContentEncoding encoding);
+
+/**
+ * @brief Appends input compressed with encoding to output
+ * @throws AgentError if the codec is not built in or fails
+ */
+void compressBody(ContentEncoding encoding, std::string_view input, int level, std::string& output);
+// Default bound on decompressBody() output
+constexpr size_t kDefaultMaxDecompressedBytes = 64 * 1024 * 1024;
+
+/**
+ * @brief Inverse of compressBody()
+ *
+ * Output grows as it is decoded, so a small, highly compressible input cannot allocate
+ * more than maxOutputBytes.
+ * @throws AgentError on corrupt input or once the output exceeds maxOutputBytes
+ */
+std::string decompressBody(ContentEncoding encoding, std::string_view input,
+                           size_t maxOutputBytes = kDefaultMaxDecompressedBytes);
+
+/**
+ * @brief Compresses request.body into encoded if options call for it
+ *
+ * Bodies below options.minBodySize, requests that already carry a Content-Encoding header
+ * and bodies that would not shrink are left alone.
+ * @return true if encoded holds the body to send, with Content-Encoding options.requestEncoding
+ */
+bool encodeRequestBody(const HttpCompressionOptions& options, const HttpRequest& request, std::string& encoded);
+
+}  // namespace agui
@@ -51,9 +51,32 @@ struct curl_slist* appendCurlHeader(struct curl_slist* list, const char* header)
     return newList;
 }
 
+HttpTimings readTimings(CURL* curl) {
+    const auto phase = [curl](CURLINFO info) {
+        curl_off_t micros = 0;
+        if (curl_easy_getinfo(curl, info, &micros) != CURLE_OK) {
+            micros = 0;
+        }
+        return std::chrono::microseconds(micros);
+    };
+    HttpTimings timings;
+    timings.nameLookup = phase(CURLINFO_NAMELOOKUP_TIME_T);
+    timings.connect = phase(CURLINFO_CONNECT_TIME_T);
+    timings.tlsHandshake = phase(CURLINFO_APPCONNECT_TIME_T);
+    timings.firstByte = phase(CURLINFO_STARTTRANSFER_TIME_T);
+    timings.total = phase(CURLINFO_TOTAL_TIME_T);
+    return timings;
+}
+
 }  // namespace
 
-HttpService::HttpService() {
+HttpService::HttpService(HttpCompressionOptions compression) : m_compression(std::move(compression)) {
+    if (!isContentEncodingAvailable(m_compression.requestEncoding)) {
+        throw AGUI_ERROR(validation, ErrorCode::ValidationInvalidArgument,
+                         std::string("Request compression not available in this build: ") +
+                             contentEncodingName(m_compression.requestEncoding));
+    }
+
     // curl_global_init must not be retried on failure; record the error once and throw on every
     // subsequent construction attempt instead.
     std::call_once(s_curlInitFlag, []() {
@@ -71,6 +94,33 @@ HttpService::~HttpService() {
     // Note: Do not call curl_global_cleanup() here as there may be multiple instances
 }
 
+HttpTransferStats HttpService::transferStats() const {
+    HttpTransferStats stats;
+    stats.requests = m_requests.load(std::memory_order_relaxed);
+    stats.requestsCompressed = m_requestsCompressed.load(std::memory_order_relaxed);
+    stats.requestBodyBytes = m_requestBodyBytes.load(std::memory_order_relaxed);
+    stats.requestBytesSent = m_requestBytesSent.load(std::memory_order_relaxed);
+    stats.responseBytesReceived = m_responseBytesReceived.load(std::memory_order_relaxed);
+    stats.responseBytesDecoded = m_responseBytesDecoded.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void HttpService::recordTransfer(CURL* curl, const HttpRequest& request, bool compressed, size_t sentBytes,
+                                 size_t decodedBytes) {
+    curl_off_t received = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received) != CURLE_OK) {
+        received = static_cast<curl_off_t>(decodedBytes);
+    }
+    m_requests.fetch_add(1, std::memory_order_relaxed);
+    if (compressed) {
+        m_requestsCompressed.fetch_add(1, std::memory_order_relaxed);
+    }
+    m_requestBodyBytes.fetch_add(request.body.size(), std::memory_order_relaxed);
+    m_requestBytesSent.fetch_add(sentBytes, std::memory_order_relaxed);
+    m_responseBytesReceived.fetch_add(static_cast<uint64_t>(received), std::memory_order_relaxed);
+    m_responseBytesDecoded.fetch_add(decodedBytes, std::memory_order_relaxed);
+}
+
 void HttpService::sendRequest(const HttpRequest& request, HttpResponseCallback responseCallbackFunc,
                                   HttpErrorCallback errorCallbackFunc) {
     // Blocking call: returns only after the full response is received.
@@ -82,10 +132,11 @@ void HttpService::sendRequest(const HttpRequest& request, HttpResponseCallback r
 
     HttpResponse response;
     struct curl_slist* headers = nullptr;
+    std::string encodedBody;
 
     try {
         // Set common options
-        setupCurlOptions(curl, request, &headers);
+        const bool compressed = setupCurlOptions(curl, request, &headers, encodedBody);
 
         std::string responseBody;
         CURLcode wfRes = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
@@ -116,7 +167,10 @@ void HttpService::sendRequest(const HttpRequest& request, HttpResponseCallback r
         }
 
         response.statusCode = static_cast<int>(statusCode);
-        response.content = responseBody;
+        recordTransfer(curl, request, compressed, compressed ? encodedBody.size() : request.body.size(),
+                       responseBody.size());
+        response.content = std::move(responseBody);
+        response.timings = readTimings(curl);
 
         // Get actual Content-Type from server response
         char* contentType = nullptr;
@@ -159,6 +213,31 @@ void HttpService::sendRequest(const HttpRequest& request, HttpResponseCallback r
 
 void HttpService::sendSseRequest(const HttpRequest& request, SseDataCallback sseDataCallbackFunc,
                                     SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) {
+    SseStatusChunkCallback onData;
+    if (sseDataCallbackFunc) {
+        onData = [sseDataCallbackFunc](int statusCode, std::string_view chunk) {
+            HttpResponse httpResponse;
+            httpResponse.statusCode = statusCode > 0 ? statusCode : 0;
+            httpResponse.content.assign(chunk.data(), chunk.size());
+            sseDataCallbackFunc(httpResponse);
+        };
+    }
+    performSseRequest(request, std::move(onData), std::move(completeCallbackFunc), std::move(errorCallbackFunc));
+}
+
+void HttpService::streamSseRequest(const HttpRequest& request, SseChunkCallback chunkCallbackFunc,
+                                   SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) {
+    SseStatusChunkCallback onData;
+    if (chunkCallbackFunc) {
+        onData = [chunkCallbackFunc = std::move(chunkCallbackFunc)](int, std::string_view chunk) {
+            chunkCallbackFunc(chunk);
+        };
+    }
+    performSseRequest(request, std::move(onData), std::move(completeCallbackFunc), std::move(errorCallbackFunc));
+}
+
+void HttpService::performSseRequest(const HttpRequest& request, SseStatusChunkCallback onData,
+                                    SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) {
     // Blocking call: streams SSE data synchronously until the connection closes.
     // The caller is responsible for running this on a worker thread if needed.
     CURL* curl = curl_easy_init();
@@ -171,10 +250,11 @@ void HttpService::sendSseRequest(const HttpRequest& request, SseDataCallback sse
     }
 
     struct curl_slist* headers = nullptr;
+    std::string encodedBody;
 
     try {
         // Set common options (excluding total timeout)
-        setupCurlOptions(curl, request, &headers);
+        const bool compressed = setupCurlOptions(curl, request, &headers, encodedBody);
 
         // SSE-specific configuration
         // 1. Remove total timeout limit for long-lived SSE connections
@@ -210,7 +290,7 @@ void HttpService::sendSseRequest(const HttpRequest& request, SseDataCallback sse
             }
         }
 
-        SseCallbackContext context(sseDataCallbackFunc, cancelFlag.get());
+        SseCallbackContext context(std::move(onData), cancelFlag.get());
         CURLcode sseWfRes = curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, sseWriteCallback);
         if (sseWfRes != CURLE_OK) {
             throw std::runtime_error(std::string("curl_easy_setopt(WRITEFUNCTION) failed: ") +
@@ -244,6 +324,8 @@ void HttpService::sendSseRequest(const HttpRequest& request, SseDataCallback sse
             Logger::errorf("[HttpService] curl_easy_getinfo(RESPONSE_CODE) failed: ",
                            curl_easy_strerror(rcRes));
         }
+        recordTransfer(curl, request, compressed, compressed ? encodedBody.size() : request.body.size(),
+                       context.bytesDelivered);
 
         // Cleanup cancel flag
         {
@@ -259,6 +341,7 @@ void HttpService::sendSseRequest(const HttpRequest& request, SseDataCallback sse
                 if (completeCallbackFunc) {
                     HttpResponse httpResponse;
                     httpResponse.statusCode = static_cast<int>(responseCode);
+                    httpResponse.timings = readTimings(curl);
                     // content is empty: SSE data was already delivered incrementally via onData.
                     Logger::debugf("[HttpService] Calling onComplete callback, status: ", responseCode);
                     completeCallbackFunc(httpResponse);
@@ -301,6 +384,7 @@ void HttpService::sendSseRequest(const HttpRequest& request, SseDataCallback sse
                 if (completeCallbackFunc) {
                     HttpResponse cancelledResponse;
                     cancelledResponse.cancelled = true;
+                    cancelledResponse.timings = readTimings(curl);
                     completeCallbackFunc(cancelledResponse);
                 }
             } else {
@@ -356,9 +440,15 @@ void HttpService::cancelRequest(const std::string& requestKey) {
     }
 }
 
-void HttpService::setupCurlOptions(CURL* curl, const HttpRequest& request, struct curl_slist** headers) {
+bool HttpService::setupCurlOptions(CURL* curl, const HttpRequest& request, struct curl_slist** headers,
+                                   std::string& encodedBody) {
     CURL_CHECK_SETOPT(curl, CURLOPT_URL, request.url.c_str());
 
+    const bool hasBody = request.method == HttpMethod::POST || request.method == HttpMethod::PUT ||
+                         request.method == HttpMethod::PATCH;
+    const bool compressed = hasBody && encodeRequestBody(m_compression, request, encodedBody);
+    const std::string& body = compressed ? encodedBody : request.body;
+
     // Set HTTP method
     switch (request.method) {
         case HttpMethod::GET:
@@ -366,21 +456,22 @@ void HttpService::setupCurlOptions(CURL* curl, const HttpRequest& request, struc
             break;
         case HttpMethod::POST:
             CURL_CHECK_SETOPT(curl, CURLOPT_POST, 1L);
-            CURL_CHECK_SETOPT(curl, CURLOPT_POSTFIELDS, request.body.c_str());
-            CURL_CHECK_SETOPT(curl, CURLOPT_POSTFIELDSIZE, static_cast<long>(request.body.length()));
             break;
         case HttpMethod::PUT:
             CURL_CHECK_SETOPT(curl, CURLOPT_CUSTOMREQUEST, "PUT");
-            CURL_CHECK_SETOPT(curl, CURLOPT_POSTFIELDS, request.body.c_str());
             break;
         case HttpMethod::DELETE:
             CURL_CHECK_SETOPT(curl, CURLOPT_CUSTOMREQUEST, "DELETE");
             break;
         case HttpMethod::PATCH:
             CURL_CHECK_SETOPT(curl, CURLOPT_CUSTOMREQUEST, "PATCH");
-            CURL_CHECK_SETOPT(curl, CURLOPT_POSTFIELDS, request.body.c_str());
             break;
     }
+    if (hasBody) {
+        // Explicit size: a compressed body may contain NUL bytes
+        CURL_CHECK_SETOPT(curl, CURLOPT_POSTFIELDS, body.c_str());
+        CURL_CHECK_SETOPT(curl, CURLOPT_POSTFIELDSIZE_LARGE, static_cast<curl_off_t>(body.size()));
+    }
 
     for (const auto& [key, value] : request.headers) {
         std::string header = key + ": " + value;
@@ -390,6 +481,15 @@ void HttpService::setupCurlOptions(CURL* curl, const HttpRequest& request, struc
     if (request.headers.find("Content-Type") == request.headers.end() && !request.body.empty()) {
         *headers = appendCurlHeader(*headers, "Content-Type: application/json");
     }
+    if (compressed) {
+        const std::string header =
+            std::string("Content-Encoding: ") + contentEncodingName(m_compression.requestEncoding);
+        *headers = appendCurlHeader(*headers, header.c_str());
+    }
+    if (m_compression.acceptEncoding) {
+        // Empty string: advertise and transparently decode every encoding libcurl supports
+        CURL_CHECK_SETOPT(curl, CURLOPT_ACCEPT_ENCODING, "");
+    }
 
     CURL_CHECK_SETOPT(curl, CURLOPT_HTTPHEADER, *headers);
 
@@ -402,6 +502,7 @@ void HttpService::setupCurlOptions(CURL* curl, const HttpRequest& request, struc
     CURL_CHECK_SETOPT(curl, CURLOPT_USERAGENT, "AG-UI-CPP-SDK/1.0");
     CURL_CHECK_SETOPT(curl, CURLOPT_FOLLOWLOCATION, 1L);
     CURL_CHECK_SETOPT(curl, CURLOPT_MAXREDIRS, 5L);
+    return compressed;
 }
 
 // Static Callback Functions
@@ -437,13 +538,10 @@ size_t HttpService::sseWriteCallback(void* contents, size_t size, size_t nmemb,
         return 0;  // Abort transfer for non-2xx responses
     }
 
+    context->bytesDelivered += realsize;
     if (context->onData) {
-        std::string chunk(static_cast<char*>(contents), realsize);
-        HttpResponse httpResponse;
-        httpResponse.statusCode = statusCode > 0 ? statusCode : 0;
-        httpResponse.content = chunk;
         try {
-            context->onData(httpResponse);
+            context->onData(statusCode, std::string_view(static_cast<const char*>(contents), realsize));
         } catch (const AgentError& error) {
             context->abortedDueToCallbackException = true;
             context->callbackExceptionMessage = error.message();
@@ -472,12 +570,13 @@ size_t HttpService::sseHeaderCallback(char* buffer, size_t size, size_t nitems,
     // Parse HTTP status line: "HTTP/x.x NNN reason\r\n"
     // With CURLOPT_FOLLOWLOCATION enabled, this may be called multiple times for redirects.
     // Each new "HTTP/" status line overwrites the previous one, so the final value is correct.
-    std::string headerLine(buffer, realsize);
+    // Called for every header line: only the status line is copied
+    const std::string_view headerLine(buffer, realsize);
     if (headerLine.compare(0, 5, "HTTP/") == 0) {
         size_t spacePos = headerLine.find(' ');
         if (spacePos != std::string::npos && spacePos + 3 <= headerLine.size()) {
             try {
-                context->httpStatusCode = std::stoi(headerLine.substr(spacePos + 1, 3));
+                context->httpStatusCode = std::stoi(std::string(headerLine.substr(spacePos + 1, 3)));
                 Logger::debugf("[HttpService] SSE HTTP status code: ", context->httpStatusCode);
             } catch (const std::invalid_argument&) {
                 Logger::errorf("[HttpService] Failed to parse HTTP status code from header: ", headerLine);
@@ -1,13 +1,18 @@
 #pragma once
 
 #include <atomic>
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
+#include <string_view>
 
 #include "core/error.h"
+#include "core/metrics.h"
+#include "http/compression.h"
 
 // Forward declaration
 typedef void CURL;
@@ -20,6 +25,7 @@ struct HttpResponse {
     std::string content;
     std::map<std::string, std::string> headers;
     bool cancelled = false;  ///< true when the request was cancelled via cancelRequest()
+    std::optional<HttpTimings> timings;  ///< Set by HttpService on completed requests
 
     bool isSuccess() const { return statusCode >= 200 && statusCode < 300; }
 };
@@ -42,6 +48,10 @@ using HttpResponseCallback = std::function<void(const HttpResponse& response)>;
 using HttpErrorCallback = std::function<void(const AgentError& error)>;
 using SseDataCallback = std::function<void(const HttpResponse& data)>;
 using SseCompleteCallback = std::function<void(const HttpResponse& data)>;
+// Receives the transport's buffer for one read; the view is only valid during the call.
+using SseChunkCallback = std::function<void(std::string_view chunk)>;
+// HttpService internal: a chunk with the status code from the response's status line
+using SseStatusChunkCallback = std::function<void(int statusCode, std::string_view chunk)>;
 
 class IHttpService {
 public:
@@ -53,28 +63,83 @@ public:
     virtual void sendSseRequest(const HttpRequest& request, SseDataCallback sseDataCallbackFunc,
                                 SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) = 0;
 
+    /**
+     * @brief Same as sendSseRequest(), delivering body bytes without copying them
+     *
+     * HttpAgent streams through this. The default adapts sendSseRequest(), so services
+     * that only implement that keep working; override it to avoid the HttpResponse copy.
+     * Only 2xx response bodies reach chunkCallbackFunc.
+     */
+    virtual void streamSseRequest(const HttpRequest& request, SseChunkCallback chunkCallbackFunc,
+                                  SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) {
+        sendSseRequest(
+            request,
+            [chunkCallbackFunc](const HttpResponse& data) {
+                if (chunkCallbackFunc) {
+                    chunkCallbackFunc(data.content);
+                }
+            },
+            std::move(completeCallbackFunc), std::move(errorCallbackFunc));
+    }
+
     virtual void cancelRequest(const std::string& requestKey) {}
 };
 
+// Byte counts of an HttpService's transfers, over its lifetime
+struct HttpTransferStats {
+    uint64_t requests = 0;
+    uint64_t requestsCompressed = 0;
+    // Request bodies before / after compression
+    uint64_t requestBodyBytes = 0;
+    uint64_t requestBytesSent = 0;
+    // Response bodies as received (possibly compressed) / as delivered to callbacks
+    uint64_t responseBytesReceived = 0;
+    uint64_t responseBytesDecoded = 0;
+
+    uint64_t requestBytesSaved() const { return requestBodyBytes - requestBytesSent; }
+    uint64_t responseBytesSaved() const {
+        return responseBytesDecoded > responseBytesReceived ? responseBytesDecoded - responseBytesReceived : 0;
+    }
+};
+
 class HttpServiceFactory {
 public:
     static std::unique_ptr<IHttpService> createCurlService();
 };
 class HttpService : public IHttpService {
 public:
-    HttpService();
+    /**
+     * @param compression Request compression and Accept-Encoding; off by default
+     * @throws AgentError if compression.requestEncoding is not built in
+     */
+    explicit HttpService(HttpCompressionOptions compression = HttpCompressionOptions::disabled());
     ~HttpService() override;
 
+    const HttpCompressionOptions& compression() const { return m_compression; }
+    HttpTransferStats transferStats() const;
+
     void sendRequest(const HttpRequest& request, HttpResponseCallback onResponse,
                      HttpErrorCallback onError) override;
 
     void sendSseRequest(const HttpRequest& request, SseDataCallback sseDataCallbackFunc,
                         SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) override;
 
+    // Passes curl's receive buffer straight to chunkCallbackFunc
+    void streamSseRequest(const HttpRequest& request, SseChunkCallback chunkCallbackFunc,
+                          SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc) override;
+
     void cancelRequest(const std::string& requestKey) override;
 
 private:
-    void setupCurlOptions(CURL* curl, const HttpRequest& request, struct curl_slist** headers);
+    // Shared by both SSE entry points; onData also receives the response status code
+    void performSseRequest(const HttpRequest& request, SseStatusChunkCallback onData,
+                           SseCompleteCallback completeCallbackFunc, HttpErrorCallback errorCallbackFunc);
+    // encodedBody receives the compressed body, if any; it must outlive the transfer.
+    // Returns whether the body was compressed.
+    bool setupCurlOptions(CURL* curl, const HttpRequest& request, struct curl_slist** headers,
+                          std::string& encodedBody);
+    void recordTransfer(CURL* curl, const HttpRequest& request, bool compressed, size_t sentBytes,
+                        size_t decodedBytes);
     static size_t writeCallback(void* contents, size_t size, size_t nmemb, void* userp);
     static size_t sseWriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
     // Extracts HTTP status code from the response status line.
@@ -88,6 +153,14 @@ private:
     // target the same URL.
     std::multimap<std::string, std::shared_ptr<std::atomic<bool>>> m_cancelFlags;
     std::mutex m_cancelMutex;
+
+    const HttpCompressionOptions m_compression;
+    std::atomic<uint64_t> m_requests{0};
+    std::atomic<uint64_t> m_requestsCompressed{0};
+    std::atomic<uint64_t> m_requestBodyBytes{0};
+    std::atomic<uint64_t> m_requestBytesSent{0};
+    std::atomic<uint64_t> m_responseBytesReceived{0};
+    std::atomic<uint64_t> m_responseBytesDecoded{0};
 };
 
 /**
@@ -106,15 +179,16 @@ private:
  *   should adapt the threading model accordingly before use.
  */
 struct SseCallbackContext {
-    SseDataCallback onData;
+    SseStatusChunkCallback onData;
     std::atomic<bool>* cancelFlag;  ///< Shared with cancelRequest(); must be atomic (cross-thread write).
     int httpStatusCode;             ///< Written by sseHeaderCallback, read by sseWriteCallback (same thread).
     bool abortedDueToHttpError;     ///< Written by sseWriteCallback, read after curl_easy_perform() (same thread).
     bool abortedDueToCallbackException;  ///< Written by sseWriteCallback, read after curl_easy_perform().
     std::string errorBody;          ///< Server error response body collected on non-2xx (max 8 KiB).
     std::string callbackExceptionMessage;  ///< Captures the callback failure that aborted the stream.
+    size_t bytesDelivered = 0;      ///< Decoded body bytes passed to onData.
 
-    SseCallbackContext(SseDataCallback callback, std::atomic<bool>* flag)
+    SseCallbackContext(SseStatusChunkCallback callback, std::atomic<bool>* flag)
         : onData(std::move(callback)), cancelFlag(flag),
           httpStatusCode(0), abortedDueToHttpError(false), abortedDueToCallbackException(false) {}
 };
@@ -0,0 +1,114 @@
+#include "middleware/delta_coalescing_middleware.h"
+
+namespace agui {
+
+namespace {
+
+// Returns the delta of a mergeable event, or nullptr for every other event type
+std::string* mutableDelta(Event& event) {
+    switch (event.type()) {
+        case EventType::TextMessageContent:
+            return &static_cast<TextMessageContentEvent&>(event).delta;
+        case EventType::ToolCallArgs:
+            return &static_cast<ToolCallArgsEvent&>(event).delta;
+        default:
+            return nullptr;
+    }
+}
+
+// The two accessors below require a mergeable event
+const std::string& deltaOf(const Event& event) {
+    if (event.type() == EventType::TextMessageContent) {
+        return static_cast<const TextMessageContentEvent&>(event).delta;
+    }
+    return static_cast<const ToolCallArgsEvent&>(event).delta;
+}
+
+const std::string& deltaOwnerId(const Event& event) {
+    if (event.type() == EventType::TextMessageContent) {
+        return static_cast<const TextMessageContentEvent&>(event).messageId;
+    }
+    return static_cast<const ToolCallArgsEvent&>(event).toolCallId;
+}
+
+}  // namespace
+
+RunAgentInput DeltaCoalescingMiddleware::onRequest(const RunAgentInput& input, MiddlewareContext& context) {
+    // Anything left from an aborted run belongs to that run
+    m_pending.reset();
+    m_pendingBytes = 0;
+    return input;
+}
+
+std::unique_ptr<Event> DeltaCoalescingMiddleware::onEvent(std::unique_ptr<Event> event,
+                                                          MiddlewareContext& context) {
+    std::string* delta = mutableDelta(*event);
+    if (!delta) {
+        return event;
+    }
+
+    if (m_pending) {
+        // flushEvents(BeforeEvent) already released the pending event unless this one merges
+        *mutableDelta(*m_pending) += *delta;
+        m_pendingBytes += delta->size();
+        ++m_eventsMerged;
+        return nullptr;
+    }
+
+    if (delta->size() >= m_options.maxBytes) {
+        return event;
+    }
+
+    m_pendingBytes = delta->size();
+    m_pendingSince = std::chrono::steady_clock::now();
+    m_pending = std::move(event);
+    return nullptr;
+}
+
+std::vector<std::unique_ptr<Event>> DeltaCoalescingMiddleware::flushEvents(const Event* next, FlushReason reason,
+                                                                           MiddlewareContext& context) {
+    if (!m_pending) {
+        return {};
+    }
+
+    switch (reason) {
+        case FlushReason::BeforeEvent:
+            if (next && canMerge(*next)) {
+                return {};
+            }
+            break;
+        case FlushReason::EndOfRead:
+            if (m_options.maxDelay.count() > 0 &&
+                std::chrono::steady_clock::now() - m_pendingSince < m_options.maxDelay) {
+                return {};
+            }
+            break;
+        case FlushReason::EndOfStream:
+            break;
+    }
+
+    return release();
+}
+
+bool DeltaCoalescingMiddleware::canMerge(const Event& next) const {
+    if (next.type() != m_pending->type() || deltaOwnerId(next) != deltaOwnerId(*m_pending)) {
+        return false;
+    }
+
+    if (m_pendingBytes + deltaOf(next).size() > m_options.maxBytes) {
+        return false;
+    }
+
+    return m_options.maxDelay.count() == 0 ||
+           std::chrono::steady_clock::now() - m_pendingSince < m_options.maxDelay;
+}
+
+std::vector<std::unique_ptr<Event>> DeltaCoalescingMiddleware::release() {
+    std::vector<std::unique_ptr<Event>> released;
+    released.push_back(std::move(m_pending));
+    m_pendingBytes = 0;
+    ++m_eventsEmitted;
+    return released;
+}
+
+}  // namespace agui
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "middleware/middleware.h"
+
+namespace agui {
+
+/**
+ * @brief Merges consecutive TEXT_MESSAGE_CONTENT / TOOL_CALL_ARGS deltas
+ *
+ * Agents often stream one token per event. This middleware holds back a content or
+ * args delta and appends the deltas that directly follow it for the same message or
+ * tool call, so subscribers and the event handler see one event per group.
+ *
+ * A held delta is released as soon as any other event arrives (so an END is never
+ * merged across and ordering is preserved), when it reaches Options::maxBytes, and at
+ * the end of each network read (maxDelay == 0) or at the first read boundary or event
+ * after maxDelay has elapsed. There is no timer: the window is only checked when data
+ * arrives, so if the stream goes quiet (a model pause, a server-side tool call) held
+ * deltas stay hidden until the next read or the end of the stream. Keep maxDelay at 0
+ * where display latency during pauses matters.
+ */
+class DeltaCoalescingMiddleware : public IMiddleware {
+public:
+    struct Options {
+        // Stop merging once the combined delta reaches this size
+        size_t maxBytes = 4096;
+        // 0: release at the end of every network read. Otherwise deltas may be held
+        // across reads; they are released by the first read or event that arrives once
+        // this much time has passed since the first one, not by a timer.
+        std::chrono::milliseconds maxDelay{0};
+    };
+
+    DeltaCoalescingMiddleware() = default;
+    explicit DeltaCoalescingMiddleware(Options options) : m_options(options) {}
+
+    RunAgentInput onRequest(const RunAgentInput& input, MiddlewareContext& context) override;
+
+    std::unique_ptr<Event> onEvent(std::unique_ptr<Event> event, MiddlewareContext& context) override;
+
+    std::vector<std::unique_ptr<Event>> flushEvents(const Event* next, FlushReason reason,
+                                                    MiddlewareContext& context) override;
+
+    uint32_t eventHooks() const override { return HookOnEvent | HookFlushEvents; }
+
+    // Deltas folded into an earlier event (each one is an event subscribers did not receive)
+    uint64_t eventsMerged() const { return m_eventsMerged; }
+    // Coalesced events released downstream
+    uint64_t eventsEmitted() const { return m_eventsEmitted; }
+
+private:
+    bool canMerge(const Event& next) const;
+    std::vector<std::unique_ptr<Event>> release();
+
+    Options m_options;
+    std::unique_ptr<Event> m_pending;
+    size_t m_pendingBytes = 0;
+    std::chrono::steady_clock::time_point m_pendingSince;
+    uint64_t m_eventsMerged = 0;
+    uint64_t m_eventsEmitted = 0;
+};
+
+}  // namespace agui
@@ -0,0 +1,178 @@
+#include "middleware/history_compaction_middleware.h"
+
+#include <algorithm>
+
+namespace agui {
+
+namespace {
+
+bool isSystemRole(MessageRole role) {
+    return role == MessageRole::System || role == MessageRole::Developer;
+}
+
+// Largest prefix length <= limit that does not split a UTF-8 sequence
+size_t utf8Prefix(const std::string& text, size_t limit) {
+    if (limit >= text.size()) {
+        return text.size();
+    }
+    while (limit > 0 && (static_cast<unsigned char>(text[limit]) & 0xC0) == 0x80) {
+        --limit;
+    }
+    return limit;
+}
+
+}  // namespace
+
+size_t HistoryCompactionMiddleware::estimatedSize(const Message& message) {
+    size_t size = message.content().size();
+    for (const auto& toolCall : message.toolCalls()) {
+        size += toolCall.function.name.size() + toolCall.function.arguments.size();
+    }
+    return size;
+}
+
+size_t HistoryCompactionMiddleware::budget() const {
+    size_t limit = m_options.maxBytes;
+    if (m_options.maxTokens > 0) {
+        const size_t tokenBytes = m_options.maxTokens * std::max<size_t>(m_options.bytesPerToken, 1);
+        limit = limit == 0 ? tokenBytes : std::min(limit, tokenBytes);
+    }
+    return limit;
+}
+
+size_t HistoryCompactionMiddleware::recentTurnsStart(const std::vector<Message>& messages) const {
+    if (m_options.keepLastTurns == 0) {
+        return messages.size();
+    }
+    size_t turns = 0;
+    for (size_t i = messages.size(); i > 0; --i) {
+        if (messages[i - 1].role() == MessageRole::User && ++turns == m_options.keepLastTurns) {
+            return i - 1;
+        }
+    }
+    return 0;
+}
+
+const Message& HistoryCompactionMiddleware::collapseToolResult(const Message& message) {
+    auto it = m_collapsed.find(message.id());
+    if (it != m_collapsed.end() && it->second.sourceRevision == message.revision()) {
+        it->second.pass = m_pass;
+        return it->second.message;
+    }
+
+    const std::string& content = message.content();
+    std::string text;
+    switch (m_options.oldToolResults) {
+        case ToolResultPolicy::Truncate: {
+            const size_t keep = utf8Prefix(content, m_options.toolResultPreviewBytes);
+            text = content.substr(0, keep) + "\n[" + std::to_string(content.size() - keep) +
+                   " bytes of tool output omitted]";
+            break;
+        }
+        case ToolResultPolicy::Summarize:
+            if (m_options.summarizer) {
+                text = m_options.summarizer(message);
+                break;
+            }
+            // fall through
+        case ToolResultPolicy::Stub:
+        case ToolResultPolicy::Keep:
+            text = "[tool output omitted: " + std::to_string(content.size()) + " bytes]";
+            break;
+    }
+
+    Collapsed& entry = m_collapsed[message.id()];
+    entry.sourceRevision = message.revision();
+    entry.pass = m_pass;
+    entry.message = message;
+    entry.message.setContent(text);
+    return entry.message;
+}
+
+RunAgentInput HistoryCompactionMiddleware::onRequest(const RunAgentInput& input, MiddlewareContext& context) {
+    ++m_pass;
+    ++m_stats.requests;
+    const std::vector<Message>& messages = input.messages;
+    const size_t recentStart = recentTurnsStart(messages);
+
+    // Pick the version of each message to send; nullptr drops it
+    std::vector<const Message*> chosen(messages.size(), nullptr);
+    std::vector<size_t> sizes(messages.size(), 0);
+    size_t bytesIn = 0;
+    size_t bytesOut = 0;
+    uint64_t dropped = 0;
+    uint64_t collapsed = 0;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        const Message& message = messages[i];
+        const size_t size = estimatedSize(message);
+        bytesIn += size;
+        if ((message.role() == MessageRole::Activity && m_options.dropActivityMessages) ||
+            (message.role() == MessageRole::Reasoning && m_options.dropReasoningMessages)) {
+            ++dropped;
+            continue;
+        }
+        chosen[i] = &message;
+        sizes[i] = size;
+        if (i < recentStart && message.role() == MessageRole::Tool &&
+            m_options.oldToolResults != ToolResultPolicy::Keep) {
+            const Message& replacement = collapseToolResult(message);
+            const size_t replacementSize = estimatedSize(replacement);
+            if (replacementSize < size) {
+                chosen[i] = &replacement;
+                sizes[i] = replacementSize;
+                ++collapsed;
+            }
+        }
+        bytesOut += sizes[i];
+    }
+
+    // Drop the oldest turns whole until the history fits
+    const size_t limit = budget();
+    for (size_t turnStart = 0; limit > 0 && bytesOut > limit && turnStart < recentStart;) {
+        size_t turnEnd = turnStart + 1;
+        while (turnEnd < recentStart && messages[turnEnd].role() != MessageRole::User) {
+            ++turnEnd;
+        }
+        for (size_t i = turnStart; i < turnEnd; ++i) {
+            if (chosen[i] != nullptr && !(m_options.keepSystemMessages && isSystemRole(messages[i].role()))) {
+                bytesOut -= sizes[i];
+                chosen[i] = nullptr;
+                ++dropped;
+            }
+        }
+        turnStart = turnEnd;
+    }
+
+    for (auto it = m_collapsed.begin(); it != m_collapsed.end();) {
+        it = it->second.pass == m_pass ? std::next(it) : m_collapsed.erase(it);
+    }
+
+    m_stats.bytesIn += bytesIn;
+    m_stats.bytesOut += bytesOut;
+    m_lastBytesSaved = bytesIn - bytesOut;
+    if (dropped == 0 && collapsed == 0) {
+        return input;
+    }
+    ++m_stats.requestsCompacted;
+    m_stats.messagesDropped += dropped;
+    m_stats.toolResultsCollapsed += collapsed;
+
+    RunAgentInput output;
+    output.threadId = input.threadId;
+    output.runId = input.runId;
+    output.parentRunId = input.parentRunId;
+    output.state = input.state;
+    output.tools = input.tools;
+    output.toolSchemas = input.toolSchemas;
+    output.context = input.context;
+    output.forwardedProps = input.forwardedProps;
+    output.messages.reserve(messages.size() - dropped);
+    for (const Message* message : chosen) {
+        if (message != nullptr) {
+            output.messages.push_back(*message);
+        }
+    }
+    return output;
+}
+
+}  // namespace agui
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "middleware/middleware.h"
+
+namespace agui {
+
+/**
+ * @brief Keeps the history sent with each run within a size budget
+ *
+ * Applied in onRequest() to RunAgentInput::messages, in this order:
+ *  - Activity and Reasoning messages are removed (they are client-side UI state).
+ *  - Tool results older than the last Options::keepLastTurns turns are collapsed
+ *    according to Options::oldToolResults. The message itself stays, so every tool
+ *    call still has its result.
+ *  - While the estimated size exceeds the budget, the oldest turns are dropped whole.
+ *    System/developer messages and the recent turns are never dropped.
+ *
+ * A turn starts at a user message. Sizes are estimates: content plus tool call names and
+ * arguments. Collapsed messages are reused across requests while the original is
+ * unchanged, so HttpAgent's message cache keeps hitting on them. Not thread-safe; one
+ * instance per agent.
+ */
+class HistoryCompactionMiddleware : public IMiddleware {
+public:
+    // What becomes of tool results outside the recent turns
+    enum class ToolResultPolicy {
+        Keep,      ///< Sent unchanged
+        Truncate,  ///< First toolResultPreviewBytes bytes and an omission note
+        Stub,      ///< Replaced by a short note with the original size
+        Summarize  ///< Replaced by Options::summarizer(message); Stub if none is set
+    };
+
+    struct Options {
+        // Budget for the estimated history size; 0 disables the limit
+        size_t maxBytes = 0;
+        // Alternative budget in tokens, estimated as bytes / bytesPerToken; 0 disables it.
+        // With both set, the smaller one applies.
+        size_t maxTokens = 0;
+        size_t bytesPerToken = 4;
+        // Turns at the end of the history that are sent unchanged (apart from role filtering)
+        size_t keepLastTurns = 4;
+        // Never drop System and Developer messages
+        bool keepSystemMessages = true;
+        ToolResultPolicy oldToolResults = ToolResultPolicy::Truncate;
+        size_t toolResultPreviewBytes = 256;
+        std::function<std::string(const Message&)> summarizer;
+        bool dropActivityMessages = true;
+        bool dropReasoningMessages = true;
+    };
+
+    struct Stats {
+        uint64_t requests = 0;
+        // Requests whose history was changed
+        uint64_t requestsCompacted = 0;
+        // Messages removed, by role filtering or the budget
+        uint64_t messagesDropped = 0;
+        uint64_t toolResultsCollapsed = 0;
+        // Estimated history size received and sent, summed over requests
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+
+        uint64_t bytesSaved() const { return bytesIn - bytesOut; }
+    };
+
+    HistoryCompactionMiddleware() = default;
+    explicit HistoryCompactionMiddleware(Options options) : m_options(std::move(options)) {}
+
+    RunAgentInput onRequest(const RunAgentInput& input, MiddlewareContext& context) override;
+
+    uint32_t eventHooks() const override { return 0; }
+
+    const Stats& stats() const { return m_stats; }
+    // Estimated history bytes removed from the last request
+    uint64_t lastBytesSaved() const { return m_lastBytesSaved; }
+
+    // Size estimate used for the budget
+    static size_t estimatedSize(const Message& message);
+
+private:
+    struct Collapsed {
+        uint64_t sourceRevision = 0;
+        uint64_t pass = 0;
+        Message message;
+    };
+
+    size_t budget() const;
+    size_t recentTurnsStart(const std::vector<Message>& messages) const;
+    const Message& collapseToolResult(const Message& message);
+
+    Options m_options;
+    Stats m_stats;
+    uint64_t m_lastBytesSaved = 0;
+    uint64_t m_pass = 0;
+    std::unordered_map<MessageId, Collapsed> m_collapsed;
+};
+
+}  // namespace agui
@@ -1,28 +1,49 @@
 #include "middleware/middleware.h"
 
-#include <algorithm>
 #include "core/logger.h"
+#include "core/tracing.h"
 
 namespace agui {
 
 void MiddlewareChain::addMiddleware(std::shared_ptr<IMiddleware> middleware) {
     if (middleware) {
+        const uint32_t hooks = middleware->eventHooks();
         m_middlewares.push_back(middleware);
+        m_eventHooks.push_back(hooks);
+        m_chainHooks |= hooks;
     }
 }
 
 void MiddlewareChain::removeMiddleware(std::shared_ptr<IMiddleware> middleware) {
-    m_middlewares.erase(std::remove(m_middlewares.begin(), m_middlewares.end(), middleware), m_middlewares.end());
+    m_chainHooks = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < m_middlewares.size(); ++i) {
+        if (m_middlewares[i] == middleware) {
+            continue;
+        }
+        m_middlewares[kept] = std::move(m_middlewares[i]);
+        m_eventHooks[kept] = m_eventHooks[i];
+        m_chainHooks |= m_eventHooks[kept];
+        ++kept;
+    }
+    m_middlewares.resize(kept);
+    m_eventHooks.resize(kept);
 }
 
 void MiddlewareChain::clear() {
     m_middlewares.clear();
+    m_eventHooks.clear();
+    m_chainHooks = 0;
 }
 
 RunAgentInput MiddlewareChain::processRequest(const RunAgentInput& input, MiddlewareContext& context) {
     RunAgentInput processedInput = input;
 
     for (auto& middleware : m_middlewares) {
+        Span span("agui.middleware.request");
+        if (span) {
+            span.setAttribute("agui.middleware", typeName(typeid(*middleware)));
+        }
         try {
             if (!middleware->shouldContinue(processedInput, context)) {
                 context.shouldContinue = false;
@@ -31,6 +52,7 @@ RunAgentInput MiddlewareChain::processRequest(const RunAgentInput& input, Middle
             processedInput = middleware->onRequest(processedInput, context);
         } catch (const std::exception& e) {
             Logger::errorf("[MiddlewareChain] processRequest: middleware threw: ", e.what());
+            span.setError(e.what());
             throw;
         } catch (...) {
             Logger::errorf("[MiddlewareChain] processRequest: middleware threw unknown exception");
@@ -49,10 +71,15 @@ RunAgentResult MiddlewareChain::processResponse(const RunAgentResult& result, Mi
     RunAgentResult processedResult = result;
 
     for (auto it = m_middlewares.rbegin(); it != m_middlewares.rend(); ++it) {
+        Span span("agui.middleware.response");
+        if (span) {
+            span.setAttribute("agui.middleware", typeName(typeid(**it)));
+        }
         try {
             processedResult = (*it)->onResponse(processedResult, context);
         } catch (const std::exception& e) {
             Logger::errorf("[MiddlewareChain] processResponse: middleware threw: ", e.what());
+            span.setError(e.what());
             throw;  // re-throw: returning a partial result would silently corrupt the response
         } catch (...) {
             Logger::errorf("[MiddlewareChain] processResponse: middleware threw unknown exception");
@@ -67,41 +94,123 @@ RunAgentResult MiddlewareChain::processResponse(const RunAgentResult& result, Mi
 std::vector<std::unique_ptr<Event>> MiddlewareChain::processEvent(std::unique_ptr<Event> event,
                                                                    MiddlewareContext& context) {
     std::vector<std::unique_ptr<Event>> result;
-    // Collect per-middleware afterEvent vectors so they can be appended in reverse
-    // order (onion model): M2_after then M1_after, matching the processResponse order.
-    std::vector<std::vector<std::unique_ptr<Event>>> perMiddlewareAfterEvents;
+    processEvent(std::move(event), context, result);
+    return result;
+}
+
+void MiddlewareChain::processEvent(std::unique_ptr<Event> event, MiddlewareContext& context,
+                                   std::vector<std::unique_ptr<Event>>& out) {
+    if (event) {
+        processEventFrom(0, std::move(event), context, out);
+    }
+}
 
-    if (!event) {
+std::vector<std::unique_ptr<Event>> MiddlewareChain::flushEvents(FlushReason reason, MiddlewareContext& context) {
+    std::vector<std::unique_ptr<Event>> result;
+    if (!(m_chainHooks & IMiddleware::HookFlushEvents)) {
         return result;
     }
 
+    for (size_t i = 0; i < m_middlewares.size(); ++i) {
+        if (!(m_eventHooks[i] & IMiddleware::HookFlushEvents)) {
+            continue;
+        }
+
+        std::vector<std::unique_ptr<Event>> released;
+        try {
+            released = m_middlewares[i]->flushEvents(nullptr, reason, context);
+        } catch (const std::exception& e) {
+            Logger::errorf("[MiddlewareChain] flushEvents: middleware threw: ", e.what());
+            throw;
+        } catch (...) {
+            Logger::errorf("[MiddlewareChain] flushEvents: middleware threw unknown exception");
+            throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed,
+                             "Middleware threw unknown exception during event flush");
+        }
+
+        // Later middlewares are flushed afterwards, so anything they hold back here is released too
+        for (auto& e : released) {
+            if (e) {
+                processEventFrom(i + 1, std::move(e), context, result);
+            }
+        }
+    }
+
+    return result;
+}
+
+void MiddlewareChain::processEventFrom(size_t start, std::unique_ptr<Event> event, MiddlewareContext& context,
+                                       std::vector<std::unique_ptr<Event>>& out) {
+    // Hooks are only invoked when the middleware declares them, and the vectors below are
+    // only populated when something is injected: pass-through chains never allocate here.
+    //
+    // Before events are kept locally so that a filtered event drops them as well
+    std::vector<std::unique_ptr<Event>> beforeEvents;
+    // Non-empty afterEvent vectors per middleware, appended in reverse order (onion
+    // model): M2_after then M1_after, matching the processResponse order.
+    std::vector<std::vector<std::unique_ptr<Event>>> perMiddlewareAfterEvents;
+
     std::unique_ptr<Event> processedEvent = std::move(event);
 
-    for (auto& middleware : m_middlewares) {
+    for (size_t i = start; i < m_middlewares.size(); ++i) {
         if (!processedEvent) {
             break;
         }
+        auto& middleware = m_middlewares[i];
+        const uint32_t hooks = m_eventHooks[i];
+        if (hooks == 0) {
+            continue;
+        }
+        Span span("agui.middleware.event");
+        if (span) {
+            span.setAttribute("agui.middleware", typeName(typeid(*middleware)));
+        }
+
+        if (hooks & IMiddleware::HookFlushEvents) {
+            std::vector<std::unique_ptr<Event>> released;
+            try {
+                released = middleware->flushEvents(processedEvent.get(), FlushReason::BeforeEvent, context);
+            } catch (const std::exception& e) {
+                Logger::errorf("[MiddlewareChain] processEvent: middleware threw: ", e.what());
+                throw;
+            } catch (...) {
+                Logger::errorf("[MiddlewareChain] processEvent: middleware threw unknown exception");
+                throw AGUI_ERROR(execution, ErrorCode::ExecutionAgentFailed,
+                                 "Middleware threw unknown exception during event processing");
+            }
+            for (auto& e : released) {
+                if (e) {
+                    processEventFrom(i + 1, std::move(e), context, out);
+                }
+            }
+        }
 
         try {
-            if (!middleware->shouldProcessEvent(*processedEvent, context)) {
-                return {};
+            if ((hooks & IMiddleware::HookShouldProcessEvent) &&
+                !middleware->shouldProcessEvent(*processedEvent, context)) {
+                return;
             }
 
-            auto beforeEvents = middleware->beforeEvent(*processedEvent, context);
-            for (auto& e : beforeEvents) {
-                result.push_back(std::move(e));
+            if (hooks & IMiddleware::HookBeforeEvent) {
+                auto injected = middleware->beforeEvent(*processedEvent, context);
+                for (auto& e : injected) {
+                    beforeEvents.push_back(std::move(e));
+                }
             }
 
-            processedEvent = middleware->onEvent(std::move(processedEvent), context);
+            if (hooks & IMiddleware::HookOnEvent) {
+                processedEvent = middleware->onEvent(std::move(processedEvent), context);
+            }
 
-            // Collect after events per middleware (appended in reverse order below)
-            if (processedEvent) {
-                perMiddlewareAfterEvents.push_back(middleware->afterEvent(*processedEvent, context));
-            } else {
-                perMiddlewareAfterEvents.push_back({});
+            if (processedEvent && (hooks & IMiddleware::HookAfterEvent)) {
+                auto injected = middleware->afterEvent(*processedEvent, context);
+                if (!injected.empty()) {
+                    perMiddlewareAfterEvents.push_back(std::move(injected));
+                }
             }
         } catch (const std::exception& e) {
             Logger::errorf("[MiddlewareChain] processEvent: middleware threw: ", e.what());
+            span.setError(e.what());
             throw;
         } catch (...) {
             Logger::errorf("[MiddlewareChain] processEvent: middleware threw unknown exception");
@@ -110,18 +219,20 @@ std::vector<std::unique_ptr<Event>> MiddlewareChain::processEvent(std::unique_pt
         }
     }
 
+    for (auto& e : beforeEvents) {
+        out.push_back(std::move(e));
+    }
+
     if (processedEvent) {
-        result.push_back(std::move(processedEvent));
+        out.push_back(std::move(processedEvent));
     }
 
-    // 6. Append after events in reverse middleware order (onion model)
+    // Append after events in reverse middleware order (onion model)
     for (auto it = perMiddlewareAfterEvents.rbegin(); it != perMiddlewareAfterEvents.rend(); ++it) {
         for (auto& e : *it) {
-            result.push_back(std::move(e));
+            out.push_back(std::move(e));
         }
     }
-
-    return result;
 }
 
 void MiddlewareChain::notifyError(const AgentError& error, MiddlewareContext& context) {
@@ -145,7 +256,17 @@ RunAgentInput LoggingMiddleware::onRequest(const RunAgentInput& input, Middlewar
     Logger::debugf("  Thread ID: ", input.threadId);
     Logger::debugf("  Run ID: ", input.runId);
     Logger::debugf("  Messages: ", input.messages.size());
-    Logger::debugf("  Tools: ", input.tools.size());
+    // Registered tools are sent too, unless a per-run tool replaces them
+    size_t registered = 0;
+    if (input.toolSchemas) {
+        registered = input.toolSchemas->size();
+        for (const auto& tool : input.tools) {
+            if (registered > 0 && input.toolSchemas->contains(tool.name)) {
+                registered--;
+            }
+        }
+    }
+    Logger::debugf("  Tools: ", registered + input.tools.size(), " (", registered, " registered)");
 
     return input;
 }
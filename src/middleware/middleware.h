@@ -1,5 +1,6 @@
 #pragma once
 
+#include <cstdint>
 #include <functional>
 #include <map>
 #include <memory>
@@ -17,6 +18,13 @@ namespace agui {
 class IMiddleware;
 class MiddlewareChain;
 
+// Why MiddlewareChain is asking middlewares to release events they are holding back
+enum class FlushReason {
+    BeforeEvent,  ///< Another event is about to reach the middleware
+    EndOfRead,    ///< All events decoded from the current network read have been processed
+    EndOfStream   ///< The stream has ended; nothing may be held back any longer
+};
+
 struct MiddlewareContext {
     const RunAgentInput* input = nullptr;
     RunAgentResult* result = nullptr;
@@ -33,8 +41,36 @@ struct MiddlewareContext {
 
 class IMiddleware {
 public:
+    // Bit flags for eventHooks()
+    enum EventHook : uint32_t {
+        HookShouldProcessEvent = 1u << 0,
+        HookBeforeEvent = 1u << 1,
+        HookOnEvent = 1u << 2,
+        HookAfterEvent = 1u << 3,
+        HookFlushEvents = 1u << 4,
+        AllEventHooks = HookShouldProcessEvent | HookBeforeEvent | HookOnEvent | HookAfterEvent | HookFlushEvents
+    };
+
     virtual ~IMiddleware() = default;
 
+    /**
+     * @brief Event hooks this middleware overrides
+     *
+     * MiddlewareChain skips hooks whose flag is not set, so a middleware that only
+     * overrides onEvent() costs one virtual call per event. Read once when the middleware
+     * is added to a chain; the default conservatively reports every hook.
+     */
+    virtual uint32_t eventHooks() const { return AllEventHooks; }
+
+    /**
+     * @brief Inspect or rewrite the request before it is sent
+     *
+     * The tools sent are input.toolSchemas (registered on the agent with registerTool(),
+     * serialized once) followed by input.tools; a tool in input.tools replaces the
+     * registered one of the same name. Middleware that inspects or filters tools must
+     * handle both: to drop a registered tool, replace toolSchemas with
+     * toolSchemas->without(name), since it is shared and immutable.
+     */
     virtual RunAgentInput onRequest(const RunAgentInput& input, MiddlewareContext& context) {
         return input;
     }
@@ -70,6 +106,19 @@ public:
     virtual std::vector<std::unique_ptr<Event>> afterEvent(const Event& event, MiddlewareContext& context) {
         return {};
     }
+
+    /**
+     * @brief Release events previously withheld by onEvent() (by returning nullptr)
+     *
+     * Unlike beforeEvent() injections, released events continue through the remaining
+     * middlewares. For FlushReason::BeforeEvent, `next` is the event about to be passed
+     * to this middleware and released events are emitted ahead of it; otherwise it is nullptr.
+     * On EndOfStream every withheld event must be released.
+     */
+    virtual std::vector<std::unique_ptr<Event>> flushEvents(const Event* next, FlushReason reason,
+                                                            MiddlewareContext& context) {
+        return {};
+    }
 };
 
 class MiddlewareChain {
@@ -88,12 +137,28 @@ public:
     // Runs shouldProcessEvent → beforeEvent → onEvent → afterEvent for each middleware.
     // Returns the resulting event list (may be empty if filtered, or contain injected events).
     std::vector<std::unique_ptr<Event>> processEvent(std::unique_ptr<Event> event, MiddlewareContext& context);
+    // Same as above but appends to `out`, so callers can reuse its capacity across events.
+    // Allocation-free when no middleware injects, withholds or releases events.
+    void processEvent(std::unique_ptr<Event> event, MiddlewareContext& context,
+                      std::vector<std::unique_ptr<Event>>& out);
+
+    // Collects events released by IMiddleware::flushEvents(), each passed through the
+    // middlewares registered after the one that released it.
+    std::vector<std::unique_ptr<Event>> flushEvents(FlushReason reason, MiddlewareContext& context);
 
     // Delivers the error to each middleware's onError in reverse registration order.
     void notifyError(const AgentError& error, MiddlewareContext& context);
 
 private:
+    // Runs the event through middlewares [start, size()) and appends the output to `out`.
+    void processEventFrom(size_t start, std::unique_ptr<Event> event, MiddlewareContext& context,
+                          std::vector<std::unique_ptr<Event>>& out);
+
     std::vector<std::shared_ptr<IMiddleware>> m_middlewares;
+    // eventHooks() of each middleware, parallel to m_middlewares
+    std::vector<uint32_t> m_eventHooks;
+    // Union of m_eventHooks
+    uint32_t m_chainHooks = 0;
 };
 
 class LoggingMiddleware : public IMiddleware {
@@ -106,6 +171,8 @@ public:
 
     std::unique_ptr<Event> onEvent(std::unique_ptr<Event> event, MiddlewareContext& context) override;
 
+    uint32_t eventHooks() const override { return HookOnEvent; }
+
     std::unique_ptr<AgentError> onError(std::unique_ptr<AgentError> error, MiddlewareContext& context) override;
 };
 
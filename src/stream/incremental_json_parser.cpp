@@ -0,0 +1,406 @@
+#include "incremental_json_parser.h"
+
+#include <algorithm>
+
+namespace agui {
+
+namespace {
+
+bool isJsonWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool isNumberChar(char c) {
+    return (c >= '0' && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+}
+
+int hexDigitValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+const char* literalFor(char first) {
+    switch (first) {
+        case 't': return "true";
+        case 'f': return "false";
+        default: return "null";
+    }
+}
+
+}  // namespace
+
+IncrementalJsonParser::IncrementalJsonParser() = default;
+
+void IncrementalJsonParser::feed(const std::string& delta) {
+    if (m_failed || delta.empty()) {
+        return;
+    }
+    consume(delta.data(), delta.size());
+    m_bytesConsumed += delta.size();
+}
+
+void IncrementalJsonParser::reset() {
+    m_root = nullptr;
+    m_stack.clear();
+    m_completedFields.clear();
+    m_token = TokenState::None;
+    m_tokenIsKey = false;
+    m_scalar.clear();
+    m_activeString = nullptr;
+    m_unicodeValue = 0;
+    m_unicodeDigits = 0;
+    m_highSurrogate = 0;
+    m_started = false;
+    m_complete = false;
+    m_failed = false;
+    m_errorMessage.clear();
+    m_bytesConsumed = 0;
+}
+
+bool IncrementalJsonParser::isFieldComplete(const std::string& key) const {
+    return std::find(m_completedFields.begin(), m_completedFields.end(), key) != m_completedFields.end();
+}
+
+void IncrementalJsonParser::consume(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        const char c = data[i];
+
+        switch (m_token) {
+            case TokenState::String:
+            case TokenState::StringEscape:
+            case TokenState::StringUnicode:
+                i += consumeString(data + i, size - i);
+                continue;
+
+            case TokenState::Number:
+                if (isNumberChar(c)) {
+                    m_scalar += c;
+                    ++i;
+                    continue;
+                }
+                // The delimiter still needs structural handling below
+                completeNumber();
+                break;
+
+            case TokenState::Literal: {
+                const std::string expected = literalFor(m_scalar[0]);
+                m_scalar += c;
+                ++i;
+                if (expected.compare(0, m_scalar.size(), m_scalar) != 0) {
+                    fail("invalid literal '" + m_scalar + "'");
+                }
+                if (m_scalar.size() == expected.size()) {
+                    if (expected == "null") {
+                        insertValue(nullptr);
+                    } else {
+                        insertValue(expected == "true");
+                    }
+                    m_token = TokenState::None;
+                    m_scalar.clear();
+                    completeValue();
+                }
+                continue;
+            }
+
+            case TokenState::None:
+                break;
+        }
+
+        ++i;
+        if (isJsonWhitespace(c)) {
+            continue;
+        }
+        if (m_complete) {
+            fail("unexpected data after complete document");
+        }
+        if (m_stack.empty()) {
+            beginValue(c);
+            continue;
+        }
+
+        Frame& top = m_stack.back();
+        switch (top.state) {
+            case FrameState::ObjectKeyOrEnd:
+                if (c == '}') {
+                    closeContainer();
+                    break;
+                }
+                [[fallthrough]];
+            case FrameState::ObjectKey:
+                if (c != '"') {
+                    fail(std::string("expected object key, got '") + c + "'");
+                }
+                top.key.clear();
+                m_token = TokenState::String;
+                m_tokenIsKey = true;
+                break;
+
+            case FrameState::ObjectColon:
+                if (c != ':') {
+                    fail(std::string("expected ':', got '") + c + "'");
+                }
+                top.state = FrameState::ObjectValue;
+                break;
+
+            case FrameState::ObjectValue:
+            case FrameState::ArrayValue:
+                beginValue(c);
+                break;
+
+            case FrameState::ArrayValueOrEnd:
+                if (c == ']') {
+                    closeContainer();
+                } else {
+                    beginValue(c);
+                }
+                break;
+
+            case FrameState::ObjectCommaOrEnd:
+                if (c == ',') {
+                    top.state = FrameState::ObjectKey;
+                } else if (c == '}') {
+                    closeContainer();
+                } else {
+                    fail(std::string("expected ',' or '}', got '") + c + "'");
+                }
+                break;
+
+            case FrameState::ArrayCommaOrEnd:
+                if (c == ',') {
+                    top.state = FrameState::ArrayValue;
+                } else if (c == ']') {
+                    closeContainer();
+                } else {
+                    fail(std::string("expected ',' or ']', got '") + c + "'");
+                }
+                break;
+        }
+    }
+}
+
+size_t IncrementalJsonParser::consumeString(const char* data, size_t size) {
+    size_t i = 0;
+    while (i < size) {
+        if (m_token == TokenState::StringEscape) {
+            const char c = data[i++];
+            if (m_highSurrogate != 0 && c != 'u') {
+                fail("unpaired UTF-16 high surrogate");
+            }
+            switch (c) {
+                case '"': appendToString("\"", 1); break;
+                case '\\': appendToString("\\", 1); break;
+                case '/': appendToString("/", 1); break;
+                case 'b': appendToString("\b", 1); break;
+                case 'f': appendToString("\f", 1); break;
+                case 'n': appendToString("\n", 1); break;
+                case 'r': appendToString("\r", 1); break;
+                case 't': appendToString("\t", 1); break;
+                case 'u':
+                    m_token = TokenState::StringUnicode;
+                    m_unicodeValue = 0;
+                    m_unicodeDigits = 0;
+                    continue;
+                default:
+                    fail(std::string("invalid escape '\\") + c + "'");
+            }
+            m_token = TokenState::String;
+            continue;
+        }
+
+        if (m_token == TokenState::StringUnicode) {
+            const int digit = hexDigitValue(data[i++]);
+            if (digit < 0) {
+                fail("invalid \\u escape");
+            }
+            m_unicodeValue = (m_unicodeValue << 4) | static_cast<uint32_t>(digit);
+            if (++m_unicodeDigits < 4) {
+                continue;
+            }
+
+            const uint32_t unit = m_unicodeValue;
+            if (m_highSurrogate != 0) {
+                if (unit < 0xDC00 || unit > 0xDFFF) {
+                    fail("unpaired UTF-16 high surrogate");
+                }
+                appendCodePoint(0x10000 + ((m_highSurrogate - 0xD800) << 10) + (unit - 0xDC00));
+                m_highSurrogate = 0;
+            } else if (unit >= 0xD800 && unit <= 0xDBFF) {
+                m_highSurrogate = unit;
+            } else if (unit >= 0xDC00 && unit <= 0xDFFF) {
+                fail("unpaired UTF-16 low surrogate");
+            } else {
+                appendCodePoint(unit);
+            }
+            m_token = TokenState::String;
+            continue;
+        }
+
+        if (m_highSurrogate != 0 && data[i] != '\\') {
+            fail("unpaired UTF-16 high surrogate");
+        }
+
+        // Copy the run of plain characters in one go
+        const size_t start = i;
+        while (i < size) {
+            const unsigned char c = static_cast<unsigned char>(data[i]);
+            if (c == '"' || c == '\\' || c < 0x20) {
+                break;
+            }
+            ++i;
+        }
+        if (i > start) {
+            appendToString(data + start, i - start);
+        }
+        if (i == size) {
+            break;
+        }
+
+        const char c = data[i++];
+        if (c == '"') {
+            m_token = TokenState::None;
+            if (m_tokenIsKey) {
+                m_tokenIsKey = false;
+                m_stack.back().state = FrameState::ObjectColon;
+            } else {
+                m_activeString = nullptr;
+                completeValue();
+            }
+            return i;
+        }
+        if (c == '\\') {
+            m_token = TokenState::StringEscape;
+            continue;
+        }
+        fail("unescaped control character in string");
+    }
+    return i;
+}
+
+void IncrementalJsonParser::beginValue(char c) {
+    m_started = true;
+    switch (c) {
+        case '{':
+            pushContainer(nlohmann::json::object(), FrameState::ObjectKeyOrEnd);
+            return;
+        case '[':
+            pushContainer(nlohmann::json::array(), FrameState::ArrayValueOrEnd);
+            return;
+        case '"':
+            m_activeString = &insertValue(std::string());
+            m_token = TokenState::String;
+            m_tokenIsKey = false;
+            return;
+        case 't':
+        case 'f':
+        case 'n':
+            m_token = TokenState::Literal;
+            m_scalar.assign(1, c);
+            return;
+        default:
+            if (c == '-' || (c >= '0' && c <= '9')) {
+                m_token = TokenState::Number;
+                m_scalar.assign(1, c);
+                return;
+            }
+            fail(std::string("unexpected character '") + c + "'");
+    }
+}
+
+nlohmann::json& IncrementalJsonParser::insertValue(nlohmann::json value) {
+    if (m_stack.empty()) {
+        m_root = std::move(value);
+        return m_root;
+    }
+
+    Frame& top = m_stack.back();
+    if (top.container->is_object()) {
+        nlohmann::json& slot = (*top.container)[top.key];
+        slot = std::move(value);
+        return slot;
+    }
+    top.container->push_back(std::move(value));
+    return top.container->back();
+}
+
+void IncrementalJsonParser::pushContainer(nlohmann::json container, FrameState state) {
+    if (m_stack.size() >= kMaxDepth) {
+        fail("maximum nesting depth of " + std::to_string(kMaxDepth) + " exceeded");
+    }
+    // Object members live in a node-based map and array elements are only appended
+    // while the array is on top of the stack, so this pointer stays valid until popped.
+    nlohmann::json& slot = insertValue(std::move(container));
+    m_stack.push_back(Frame{&slot, state, std::string()});
+}
+
+void IncrementalJsonParser::closeContainer() {
+    m_stack.pop_back();
+    completeValue();
+}
+
+void IncrementalJsonParser::completeValue() {
+    if (m_stack.empty()) {
+        m_complete = true;
+        return;
+    }
+
+    Frame& top = m_stack.back();
+    if (top.container->is_object()) {
+        if (m_stack.size() == 1) {
+            m_completedFields.push_back(top.key);
+        }
+        top.state = FrameState::ObjectCommaOrEnd;
+    } else {
+        top.state = FrameState::ArrayCommaOrEnd;
+    }
+}
+
+void IncrementalJsonParser::completeNumber() {
+    nlohmann::json number = nlohmann::json::parse(m_scalar, nullptr, false);
+    if (!number.is_number()) {
+        fail("invalid number '" + m_scalar + "'");
+    }
+    insertValue(std::move(number));
+    m_token = TokenState::None;
+    m_scalar.clear();
+    completeValue();
+}
+
+void IncrementalJsonParser::appendCodePoint(uint32_t codePoint) {
+    char buf[4];
+    size_t len = 0;
+    if (codePoint < 0x80) {
+        buf[len++] = static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        buf[len++] = static_cast<char>(0xC0 | (codePoint >> 6));
+        buf[len++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        buf[len++] = static_cast<char>(0xE0 | (codePoint >> 12));
+        buf[len++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        buf[len++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        buf[len++] = static_cast<char>(0xF0 | (codePoint >> 18));
+        buf[len++] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        buf[len++] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        buf[len++] = static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+    appendToString(buf, len);
+}
+
+void IncrementalJsonParser::appendToString(const char* data, size_t size) {
+    if (m_tokenIsKey) {
+        m_stack.back().key.append(data, size);
+    } else {
+        m_activeString->get_ref<std::string&>().append(data, size);
+    }
+}
+
+void IncrementalJsonParser::fail(const std::string& reason) {
+    m_failed = true;
+    m_errorMessage = reason + " (in fragment starting at byte " + std::to_string(m_bytesConsumed) + ")";
+    throw AGUI_ERROR(parse, ErrorCode::ParseJsonError, "Incremental JSON parse failed: " + m_errorMessage);
+}
+
+}  // namespace agui
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <nlohmann/json.hpp>
+#include <string>
+#include <vector>
+
+#include "core/error.h"
+
+namespace agui {
+
+/**
+ * @brief Resumable JSON parser for streamed tool-call arguments
+ *
+ * Consumes TOOL_CALL_ARGS / TOOL_CALL_CHUNK deltas as they arrive and keeps a
+ * partially-built document up to date, so callers can inspect arguments before
+ * TOOL_CALL_END without re-parsing the accumulated buffer. Each feed() call costs
+ * O(delta) regardless of how much has already been received.
+ *
+ * Partial document semantics:
+ * - Objects and arrays appear as soon as their opening bracket is seen.
+ * - String values grow in place as characters arrive.
+ * - Numbers and literals (true/false/null) appear only once complete.
+ *
+ * A number at the top level has no terminator and therefore never completes;
+ * tool arguments are always objects, so this does not arise in practice.
+ */
+class IncrementalJsonParser {
+public:
+    /// Maximum nesting depth accepted before the input is rejected
+    static constexpr size_t kMaxDepth = 256;
+
+    IncrementalJsonParser();
+
+    // The partial document holds internal pointers into itself
+    IncrementalJsonParser(const IncrementalJsonParser&) = delete;
+    IncrementalJsonParser& operator=(const IncrementalJsonParser&) = delete;
+
+    /**
+     * @brief Consume the next fragment of the document
+     * @throws AgentError (ParseJsonError) on malformed input. The parser then stays
+     *         in the failed state and ignores any further input until reset().
+     */
+    void feed(const std::string& delta);
+
+    void reset();
+
+    // True once a complete top-level value has been parsed.
+    bool isComplete() const { return m_complete; }
+    bool hasError() const { return m_failed; }
+    const std::string& errorMessage() const { return m_errorMessage; }
+    size_t bytesConsumed() const { return m_bytesConsumed; }
+
+    // Partially-complete document; null until the first value starts.
+    const nlohmann::json& value() const { return m_root; }
+
+    // Top-level object keys whose values are fully parsed, in arrival order.
+    const std::vector<std::string>& completedFields() const { return m_completedFields; }
+    bool isFieldComplete(const std::string& key) const;
+
+private:
+    enum class FrameState {
+        ObjectKeyOrEnd,   ///< after '{'
+        ObjectKey,        ///< after ','
+        ObjectColon,      ///< after a key
+        ObjectValue,      ///< after ':'
+        ObjectCommaOrEnd,
+        ArrayValueOrEnd,  ///< after '['
+        ArrayValue,       ///< after ','
+        ArrayCommaOrEnd
+    };
+
+    enum class TokenState { None, String, StringEscape, StringUnicode, Number, Literal };
+
+    struct Frame {
+        nlohmann::json* container;
+        FrameState state;
+        std::string key;  ///< object frames: key being read, or the key awaiting its value
+    };
+
+    void consume(const char* data, size_t size);
+    size_t consumeString(const char* data, size_t size);
+    void beginValue(char c);
+    nlohmann::json& insertValue(nlohmann::json value);
+    void pushContainer(nlohmann::json container, FrameState state);
+    void closeContainer();
+    void completeValue();
+    void completeNumber();
+    void appendCodePoint(uint32_t codePoint);
+    void appendToString(const char* data, size_t size);
+    [[noreturn]] void fail(const std::string& reason);
+
+    nlohmann::json m_root;
+    std::vector<Frame> m_stack;
+    std::vector<std::string> m_completedFields;
+
+    TokenState m_token = TokenState::None;
+    bool m_tokenIsKey = false;
+    std::string m_scalar;           ///< pending number or literal text
+    nlohmann::json* m_activeString = nullptr;
+    uint32_t m_unicodeValue = 0;
+    int m_unicodeDigits = 0;
+    uint32_t m_highSurrogate = 0;
+
+    bool m_started = false;
+    bool m_complete = false;
+    bool m_failed = false;
+    std::string m_errorMessage;
+    size_t m_bytesConsumed = 0;
+};
+
+}  // namespace agui
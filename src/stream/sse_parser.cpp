@@ -3,14 +3,14 @@
 
 namespace agui {
 
-void SseParser::feed(const std::string& chunk) {
+void SseParser::feed(std::string_view chunk) {
     // Check buffer size limit to prevent memory exhaustion
     if (m_buffer.size() + chunk.size() > kMaxBufferSize) {
         throw SseBufferExceededError(
             "SSE buffer size exceeded maximum limit of " + 
             std::to_string(kMaxBufferSize / (1024 * 1024)) + " MB");
     }
-    m_buffer += chunk;
+    m_buffer.append(chunk.data(), chunk.size());
     processBuffer();
 }
 
@@ -2,6 +2,7 @@
 
 #include <nlohmann/json.hpp>
 #include <string>
+#include <string_view>
 #include <queue>
 
 #include "core/error.h"
@@ -35,7 +36,8 @@ public:
     SseParser() = default;
     ~SseParser() = default;
 
-    void feed(const std::string& chunk);
+    // Appends chunk to the internal buffer (its only copy) and splits complete events
+    void feed(std::string_view chunk);
     bool hasEvent() const;
     // Check hasEvent() before calling.
     std::string nextEvent();
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "core/error.h"
+#include "http/http_service.h"
+
+namespace agui {
+
+/**
+ * @brief IHttpService test double that streams scripted SSE chunks, without a network
+ *
+ * Each SSE request replays the next script in `turns`, and the last one repeats. Chunks go
+ * through streamSseRequest() by default. With `legacy` set, only sendSseRequest() delivers
+ * them, so callers go through IHttpService's default streamSseRequest() adapter.
+ */
+class ScriptedHttpService : public IHttpService {
+public:
+    explicit ScriptedHttpService(std::vector<std::string> chunks = {}) : turns{std::move(chunks)} {}
+
+    // Fixed connection phases, for tests that check how timings are reported
+    static HttpTimings sampleTimings() {
+        using namespace std::chrono_literals;
+        HttpTimings timings;
+        timings.nameLookup = 100us;
+        timings.connect = 300us;
+        timings.tlsHandshake = 900us;
+        timings.firstByte = 2ms;
+        timings.total = 20ms;
+        return timings;
+    }
+
+    void sendRequest(const HttpRequest&, HttpResponseCallback, HttpErrorCallback) override {}
+
+    void sendSseRequest(const HttpRequest& request, SseDataCallback onData, SseCompleteCallback onComplete,
+                        HttpErrorCallback onError) override {
+        respond(
+            request,
+            [&onData](std::string_view chunk) {
+                if (!onData) {
+                    return;
+                }
+                HttpResponse response;
+                response.statusCode = 200;
+                response.content.assign(chunk.data(), chunk.size());
+                onData(response);
+            },
+            onComplete, onError);
+    }
+
+    void streamSseRequest(const HttpRequest& request, SseChunkCallback onChunk, SseCompleteCallback onComplete,
+                          HttpErrorCallback onError) override {
+        if (legacy) {
+            IHttpService::streamSseRequest(request, std::move(onChunk), std::move(onComplete), std::move(onError));
+            return;
+        }
+        streamCalls++;
+        respond(request, onChunk, onComplete, onError);
+    }
+
+    const HttpRequest& lastRequest() const { return requests.back(); }
+
+    // One script per request
+    std::vector<std::vector<std::string>> turns;
+    // Slept before each read
+    std::chrono::milliseconds pause{0};
+    // Splits each script's bytes into reads of this size; 0 delivers the scripted chunks
+    size_t readSize = 0;
+    // Reported with the completion
+    std::optional<HttpTimings> timings;
+    // Fails every request with a connection error instead of responding
+    bool fail = false;
+    // Only sendSseRequest() delivers data
+    bool legacy = false;
+    // Called with the read's index before each read is delivered
+    std::function<void(size_t)> beforeChunk;
+    // Called after the last read, before completion
+    std::function<void()> afterData;
+
+    // Every SSE request, in order
+    std::vector<HttpRequest> requests;
+    // Calls that streamed without the sendSseRequest() adapter
+    int streamCalls = 0;
+    int readsDelivered = 0;
+
+private:
+    void respond(const HttpRequest& request, const std::function<void(std::string_view)>& deliver,
+                 const SseCompleteCallback& onComplete, const HttpErrorCallback& onError) {
+        requests.push_back(request);
+        if (fail) {
+            if (onError) {
+                onError(AgentError(ErrorType::Network, ErrorCode::NetworkError, "connection refused"));
+            }
+            return;
+        }
+
+        std::vector<std::string> reads;
+        if (!turns.empty()) {
+            const std::vector<std::string>& script = turns[std::min(requests.size(), turns.size()) - 1];
+            if (readSize == 0) {
+                reads = script;
+            } else {
+                std::string body;
+                for (const auto& chunk : script) {
+                    body += chunk;
+                }
+                for (size_t offset = 0; offset < body.size(); offset += readSize) {
+                    reads.push_back(body.substr(offset, readSize));
+                }
+            }
+        }
+        for (size_t i = 0; i < reads.size(); ++i) {
+            if (beforeChunk) {
+                beforeChunk(i);
+            }
+            if (pause.count() > 0) {
+                std::this_thread::sleep_for(pause);
+            }
+            if (deliver) {
+                deliver(reads[i]);
+            }
+            readsDelivered++;
+        }
+        if (afterData) {
+            afterData();
+        }
+
+        HttpResponse response;
+        response.statusCode = 200;
+        response.timings = timings;
+        if (onComplete) {
+            onComplete(response);
+        }
+    }
+};
+
+}  // namespace agui
@@ -0,0 +1,361 @@
+/**
+ * @file test_agent_pool.cpp
+ * @brief WorkStealingExecutor and AgentPool tests (scripted HTTP service, no network)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "agent/agent_pool.h"
+#include "core/executor.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+
+namespace {
+
+// Waits up to five seconds for `ready`
+template <typename Predicate>
+bool eventually(Predicate ready) {
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!ready()) {
+        if (std::chrono::steady_clock::now() > deadline) {
+            return false;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+
+std::string sse(const std::string& json) {
+    return "data: " + json + "\n\n";
+}
+
+// Shared by every session: streams a short run and tracks concurrency per URL and host.
+// While `holdUntil` is set, requests wait until that many are in flight at once.
+class TrackingHttpService : public IHttpService {
+public:
+    void sendRequest(const HttpRequest&, HttpResponseCallback, HttpErrorCallback) override {}
+
+    void sendSseRequest(const HttpRequest& request, SseDataCallback onData, SseCompleteCallback onComplete,
+                        HttpErrorCallback) override {
+        const std::string backend = AgentPool::backendKey(request.url);
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            track(m_inFlightByUrl[request.url], m_maxByUrl[request.url]);
+            track(m_inFlightByBackend[backend], m_maxByBackend[backend]);
+            m_changed.notify_all();
+            m_changed.wait_for(lock, std::chrono::seconds(5),
+                               [&]() { return holdUntil == 0 || m_inFlightByBackend[backend] >= holdUntil; });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+
+        HttpResponse response;
+        response.statusCode = 200;
+        const bool fail = request.url.find("/fail") != std::string::npos;
+        response.content = sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})") +
+                           (fail ? sse(R"({"type":"RUN_ERROR","message":"boom"})")
+                                 : sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"));
+        onData(response);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_inFlightByUrl[request.url]--;
+            m_inFlightByBackend[backend]--;
+        }
+        response.content.clear();
+        onComplete(response);
+    }
+
+    int maxByUrl(const std::string& url) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_maxByUrl[url];
+    }
+
+    int maxByBackend(const std::string& backend) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_maxByBackend[backend];
+    }
+
+    int holdUntil = 0;
+
+private:
+    static void track(int& inFlight, int& max) {
+        inFlight++;
+        if (inFlight > max) {
+            max = inFlight;
+        }
+    }
+
+    std::mutex m_mutex;
+    std::condition_variable m_changed;
+    std::map<std::string, int> m_inFlightByUrl;
+    std::map<std::string, int> m_maxByUrl;
+    std::map<std::string, int> m_inFlightByBackend;
+    std::map<std::string, int> m_maxByBackend;
+};
+
+std::unique_ptr<HttpAgent> makeAgent(const std::string& url) {
+    return HttpAgent::builder().withUrl(url).build();
+}
+
+struct Outcomes {
+    std::atomic<int> succeeded{0};
+    std::atomic<int> failed{0};
+
+    AgentSuccessCallback onSuccess() {
+        return [this](const RunAgentResult&) { succeeded++; };
+    }
+    AgentErrorCallback onError() {
+        return [this](const std::string&) { failed++; };
+    }
+};
+
+}  // namespace
+
+// WorkStealingExecutor
+
+TEST_CASE(ExecutorRunsEveryTask) {
+    std::atomic<int> count{0};
+    {
+        WorkStealingExecutor executor(3);
+        EXPECT_EQ(executor.threadCount(), 3u);
+        for (int i = 0; i < 200; ++i) {
+            executor.submit([&]() {
+                count++;
+                // Tasks may submit follow-up work
+                executor.submit([&]() { count++; });
+            });
+        }
+        ASSERT_TRUE(eventually([&]() { return count.load() == 400; }));
+    }
+    EXPECT_EQ(count.load(), 400);
+}
+
+TEST_CASE(ExecutorStealsFromBusyWorker) {
+    WorkStealingExecutor executor(2);
+    std::atomic<int> done{0};
+    std::atomic<bool> finished{false};
+    executor.submit([&]() {
+        // Queued on this worker, which then blocks until they ran: only stealing can run them
+        for (int i = 0; i < 10; ++i) {
+            executor.submit([&]() { done++; });
+        }
+        finished = eventually([&]() { return done.load() == 10; });
+    });
+    ASSERT_TRUE(eventually([&]() { return finished.load(); }));
+    ASSERT_TRUE(executor.tasksStolen() >= 10);
+}
+
+TEST_CASE(ExecutorSurvivesThrowingTask) {
+    std::atomic<int> count{0};
+    WorkStealingExecutor executor(1);
+    executor.submit([]() { throw std::runtime_error("task failure"); });
+    executor.submit([&]() { count++; });
+    ASSERT_TRUE(eventually([&]() { return count.load() == 1; }));
+}
+
+// AgentPool
+
+TEST_CASE(BackendKey) {
+    EXPECT_EQ(AgentPool::backendKey("https://api.example.com:8443/v1/agent?x=1"), "https://api.example.com:8443");
+    EXPECT_EQ(AgentPool::backendKey("http://localhost:8080"), "http://localhost:8080");
+    EXPECT_EQ(AgentPool::backendKey("localhost/agent"), "localhost");
+}
+
+TEST_CASE(SessionsRunInParallel) {
+    auto service = std::make_shared<TrackingHttpService>();
+    service->holdUntil = 4;
+    AgentPoolOptions options;
+    options.workerThreads = 4;
+    options.httpService = service;
+    AgentPool pool(options);
+
+    Outcomes outcomes;
+    for (int i = 0; i < 4; ++i) {
+        const std::string id = "s" + std::to_string(i);
+        pool.addSession(id, makeAgent("http://backend/" + id));
+        pool.submitRun(id, RunAgentParams(), outcomes.onSuccess(), outcomes.onError());
+    }
+    pool.waitIdle();
+
+    EXPECT_EQ(outcomes.succeeded.load(), 4);
+    EXPECT_EQ(service->maxByBackend("http://backend"), 4);
+    EXPECT_EQ(pool.sessionCount(), 4u);
+}
+
+TEST_CASE(PerBackendCap) {
+    auto service = std::make_shared<TrackingHttpService>();
+    AgentPoolOptions options;
+    options.workerThreads = 4;
+    options.maxConcurrentRunsPerBackend = 2;
+    options.httpService = service;
+    AgentPool pool(options);
+
+    Outcomes outcomes;
+    for (int i = 0; i < 6; ++i) {
+        const std::string id = "a" + std::to_string(i);
+        pool.addSession(id, makeAgent("http://busy:1/" + id));
+        pool.submitRun(id, RunAgentParams(), outcomes.onSuccess(), outcomes.onError());
+    }
+    pool.addSession("b0", makeAgent("http://other:2/b0"));
+    pool.submitRun("b0", RunAgentParams(), outcomes.onSuccess(), outcomes.onError());
+    ASSERT_TRUE(pool.activeRuns("http://busy:1/anything") <= 2);
+    pool.waitIdle();
+
+    EXPECT_EQ(outcomes.succeeded.load(), 7);
+    ASSERT_TRUE(service->maxByBackend("http://busy:1") <= 2);
+    EXPECT_EQ(pool.activeRuns("http://busy:1"), 0u);
+}
+
+TEST_CASE(WorkerCountCapsConcurrentStreams) {
+    auto service = std::make_shared<TrackingHttpService>();
+    service->holdUntil = 2;
+    AgentPoolOptions options;
+    options.workerThreads = 2;
+    options.httpService = service;
+    AgentPool pool(options);
+    EXPECT_EQ(pool.maxConcurrentRuns(), 2u);
+
+    // No per-backend cap: only the workers limit how many runs stream at once
+    Outcomes outcomes;
+    for (int i = 0; i < 4; ++i) {
+        const std::string id = "w" + std::to_string(i);
+        pool.addSession(id, makeAgent("http://wide/" + id));
+        pool.submitRun(id, RunAgentParams(), outcomes.onSuccess(), outcomes.onError());
+    }
+    pool.waitIdle();
+
+    EXPECT_EQ(outcomes.succeeded.load(), 4);
+    EXPECT_EQ(service->maxByBackend("http://wide"), 2);
+}
+
+TEST_CASE(SessionRunsAreSerializedAndCounted) {
+    auto service = std::make_shared<TrackingHttpService>();
+    AgentPoolOptions options;
+    options.workerThreads = 4;
+    options.httpService = service;
+    AgentPool pool(options);
+
+    pool.addSession("chat", makeAgent("http://backend/chat"));
+    pool.addSession("broken", makeAgent("http://backend/fail"));
+    Outcomes outcomes;
+    for (int i = 0; i < 5; ++i) {
+        pool.submitRun("chat", RunAgentParams(), outcomes.onSuccess(), outcomes.onError());
+    }
+    pool.submitRun("broken", RunAgentParams(), outcomes.onSuccess(), outcomes.onError());
+    pool.waitIdle();
+
+    EXPECT_EQ(service->maxByUrl("http://backend/chat"), 1);
+    EXPECT_EQ(outcomes.succeeded.load(), 5);
+    EXPECT_EQ(outcomes.failed.load(), 1);
+
+    SessionMetrics chat = pool.sessionMetrics("chat");
+    EXPECT_EQ(chat.runsSubmitted, 5u);
+    EXPECT_EQ(chat.runsSucceeded, 5u);
+    EXPECT_EQ(chat.runsFailed, 0u);
+    EXPECT_EQ(chat.runsQueued, 0u);
+    ASSERT_FALSE(chat.running);
+    ASSERT_TRUE(chat.totalRunTime >= chat.lastRunTime);
+    ASSERT_TRUE(chat.lastRunTime.count() > 0);
+
+    SessionMetrics broken = pool.sessionMetrics("broken");
+    EXPECT_EQ(broken.runsFailed, 1u);
+}
+
+TEST_CASE(SessionManagement) {
+    AgentPoolOptions options;
+    options.workerThreads = 1;
+    options.httpService = std::make_shared<TrackingHttpService>();
+    AgentPool pool(options);
+
+    pool.addSession("s1", makeAgent("http://backend/s1"));
+    ASSERT_TRUE(pool.session("s1") != nullptr);
+    ASSERT_TRUE(pool.session("missing") == nullptr);
+
+    bool threw = false;
+    try {
+        pool.addSession("s1", makeAgent("http://backend/s1"));
+    } catch (const AgentError&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    threw = false;
+    try {
+        pool.submitRun("missing", RunAgentParams(), nullptr, nullptr);
+    } catch (const AgentError&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    ASSERT_TRUE(pool.removeSession("s1"));
+    ASSERT_FALSE(pool.removeSession("s1"));
+    EXPECT_EQ(pool.sessionCount(), 0u);
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi AgentPool Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
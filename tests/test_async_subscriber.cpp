@@ -0,0 +1,279 @@
+/**
+ * @file test_async_subscriber.cpp
+ * @brief SerialExecutor and AsyncSubscriber tests
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/async_subscriber.h"
+#include "core/executor.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+
+namespace {
+
+std::unique_ptr<Event> textStart(const MessageId& id) {
+    auto event = std::make_unique<TextMessageStartEvent>();
+    event->messageId = id;
+    return event;
+}
+
+std::unique_ptr<Event> textContent(const MessageId& id, const std::string& delta) {
+    auto event = std::make_unique<TextMessageContentEvent>();
+    event->messageId = id;
+    event->delta = delta;
+    return event;
+}
+
+std::unique_ptr<Event> textEnd(const MessageId& id) {
+    auto event = std::make_unique<TextMessageEndEvent>();
+    event->messageId = id;
+    return event;
+}
+
+// Records callbacks with the thread they ran on; optionally slow or failing
+class Recorder : public IAgentSubscriber {
+public:
+    AgentStateMutation onEvent(const Event& event, const AgentSubscriberParams&) override {
+        record("event");
+        return AgentStateMutation();
+    }
+
+    AgentStateMutation onTextMessageContent(const TextMessageContentEvent& event, const std::string& buffer,
+                                            const AgentSubscriberParams& params) override {
+        record("content:" + buffer);
+        if (params.messages) {
+            messagesSeen = params.messages->size();
+        }
+        if (throwOnContent) {
+            throw std::runtime_error("subscriber failure");
+        }
+        // Discarded: asynchronous callbacks cannot mutate the run
+        return AgentStateMutation().withState(nlohmann::json({{"mutated", true}}));
+    }
+
+    AgentStateMutation onTextMessageEnd(const TextMessageEndEvent& event, const AgentSubscriberParams&) override {
+        record("end:" + event.messageId);
+        return AgentStateMutation();
+    }
+
+    void onNewMessage(const Message& message, const AgentSubscriberParams&) override {
+        record("new:" + message.id());
+    }
+
+    std::vector<std::string> calls() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_calls;
+    }
+
+    std::vector<std::thread::id> threads() {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_threads;
+    }
+
+    std::chrono::milliseconds delay{0};
+    bool throwOnContent = false;
+    size_t messagesSeen = 0;
+
+private:
+    void record(const std::string& call) {
+        std::this_thread::sleep_for(delay);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_calls.push_back(call);
+        m_threads.push_back(std::this_thread::get_id());
+    }
+
+    std::mutex m_mutex;
+    std::vector<std::string> m_calls;
+    std::vector<std::thread::id> m_threads;
+};
+
+void streamHello(EventHandler& handler) {
+    handler.handleEvent(textStart("m1"));
+    handler.handleEvent(textContent("m1", "Hel"));
+    handler.handleEvent(textContent("m1", "lo"));
+    handler.handleEvent(textEnd("m1"));
+}
+
+}  // namespace
+
+// SerialExecutor
+
+TEST_CASE(SerialExecutorKeepsOrderWithoutOverlap) {
+    auto pool = std::make_shared<WorkStealingExecutor>(4);
+    const int tasks = 500;
+    std::vector<std::unique_ptr<SerialExecutor>> serials;
+    std::vector<std::vector<int>> seen(3);
+    std::vector<std::unique_ptr<std::atomic<bool>>> busy;
+    std::atomic<bool> overlapped{false};
+    for (int s = 0; s < 3; ++s) {
+        serials.push_back(std::make_unique<SerialExecutor>(pool));
+        busy.push_back(std::make_unique<std::atomic<bool>>(false));
+    }
+
+    for (int i = 0; i < tasks; ++i) {
+        for (int s = 0; s < 3; ++s) {
+            serials[s]->submit([&, s, i]() {
+                if (busy[s]->exchange(true)) {
+                    overlapped = true;
+                }
+                seen[s].push_back(i);
+                busy[s]->store(false);
+            });
+        }
+    }
+    for (auto& serial : serials) {
+        serial->drain();
+    }
+
+    ASSERT_FALSE(overlapped.load());
+    for (const auto& values : seen) {
+        EXPECT_EQ(values.size(), static_cast<size_t>(tasks));
+        for (int i = 0; i < tasks; ++i) {
+            EXPECT_EQ(values[i], i);
+        }
+    }
+}
+
+// AsyncSubscriber
+
+TEST_CASE(CallbacksRunInOrderOffStreamThread) {
+    auto recorder = std::make_shared<Recorder>();
+    auto async = std::make_shared<AsyncSubscriber>(recorder, std::make_shared<WorkStealingExecutor>(2));
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(async);
+
+    streamHello(handler);
+    async->drain();
+
+    const std::vector<std::string> expected = {"event", "new:m1", "event", "content:Hel", "event",
+                                               "content:Hello", "event", "end:m1"};
+    const std::vector<std::string> calls = recorder->calls();
+    EXPECT_EQ(calls.size(), expected.size());
+    for (size_t i = 0; i < expected.size() && i < calls.size(); ++i) {
+        EXPECT_EQ(calls[i], expected[i]);
+    }
+    for (const auto& id : recorder->threads()) {
+        ASSERT_TRUE(id != std::this_thread::get_id());
+    }
+    // The returned mutation was discarded
+    ASSERT_TRUE(handler.state().find("mutated") == handler.state().end());
+}
+
+TEST_CASE(SlowSubscriberDoesNotBlockStream) {
+    auto recorder = std::make_shared<Recorder>();
+    recorder->delay = std::chrono::milliseconds(20);
+    auto async = std::make_shared<AsyncSubscriber>(recorder, std::make_shared<WorkStealingExecutor>(1));
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(async);
+
+    const auto start = std::chrono::steady_clock::now();
+    streamHello(handler);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    // Eight callbacks at 20 ms each would take 160 ms if run inline
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(100));
+
+    async->drain();
+    EXPECT_EQ(recorder->calls().size(), 8u);
+}
+
+TEST_CASE(FailuresAreCountedNotPropagated) {
+    auto recorder = std::make_shared<Recorder>();
+    recorder->throwOnContent = true;
+    auto async = std::make_shared<AsyncSubscriber>(recorder, std::make_shared<WorkStealingExecutor>(1));
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(async);
+
+    streamHello(handler);
+    async->drain();
+
+    EXPECT_EQ(async->failedCallbacks(), 2u);
+    EXPECT_EQ(recorder->calls().back(), "end:m1");
+}
+
+TEST_CASE(CopyConversationOption) {
+    auto withoutCopy = std::make_shared<Recorder>();
+    auto withCopy = std::make_shared<Recorder>();
+    auto executor = std::make_shared<WorkStealingExecutor>(2);
+    AsyncSubscriberOptions options;
+    options.copyConversation = true;
+    auto plain = std::make_shared<AsyncSubscriber>(withoutCopy, executor);
+    auto copying = std::make_shared<AsyncSubscriber>(withCopy, executor, options);
+
+    Message question = Message::createWithId("q", MessageRole::User, "hi");
+    EventHandler handler({question}, nlohmann::json::object());
+    handler.addSubscriber(plain);
+    handler.addSubscriber(copying);
+    streamHello(handler);
+    plain->drain();
+    copying->drain();
+
+    EXPECT_EQ(withoutCopy->messagesSeen, 0u);
+    EXPECT_EQ(withCopy->messagesSeen, 2u);
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi AsyncSubscriber Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,326 @@
+/**
+ * @file test_binary_log.cpp
+ * @brief BinaryLog recording, decoding and forwarding to Logger
+ */
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/binary_log.h"
+#include "core/error.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+// Counts how often it is formatted
+struct Probe {
+    int* formatted;
+};
+
+std::ostream& operator<<(std::ostream& out, const Probe& probe) {
+    ++*probe.formatted;
+    return out << "probe";
+}
+
+class Recorder {
+public:
+    LogCallback callback() {
+        return [this](LogLevel level, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back({level, message});
+            threads.push_back(std::this_thread::get_id());
+        };
+    }
+
+    std::mutex mutex;
+    std::vector<std::pair<LogLevel, std::string>> messages;
+    std::vector<std::thread::id> threads;
+};
+
+std::vector<std::string> decodeFile(const std::string& path, size_t& records) {
+    std::ifstream in(path, std::ios::binary);
+    std::ostringstream out;
+    records = BinaryLog::decode(in, out);
+    std::vector<std::string> lines;
+    std::istringstream text(out.str());
+    for (std::string line; std::getline(text, line);) {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+bool endsWith(const std::string& text, const std::string& suffix) {
+    return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+}  // namespace
+
+TEST_CASE(FileRoundTrip) {
+    const std::string path = "test_binary_log.blog";
+    std::remove(path.c_str());
+    BinaryLog::Options options;
+    options.path = path;
+    options.minLevel = LogLevel::Debug;
+    BinaryLog::start(options);
+
+    int formatted = 0;
+    const std::string name = "run-1";
+    const char* nothing = nullptr;
+    AGUI_BLOG_INFO("Run {} received {} events", name, 42);
+    AGUI_BLOG_DEBUG("signed {} unsigned {} double {}", -7, 18446744073709551615ull, 2.5);
+    AGUI_BLOG_WARNING("bool {} char {} literal {} null {}", true, 'x', "text", nothing);
+    AGUI_BLOG_ERROR("formatted at the call site: {}", Probe{&formatted});
+    AGUI_BLOG_INFO("missing {} {}", 1);
+    AGUI_BLOG_INFO("extra {}", 1, 2);
+    AGUI_BLOG_INFO("no placeholders");
+    EXPECT_EQ(formatted, 1);
+    BinaryLog::stop();
+
+    size_t records = 0;
+    const std::vector<std::string> lines = decodeFile(path, records);
+    EXPECT_EQ(records, 7u);
+    EXPECT_EQ(lines.size(), 7u);
+    ASSERT_TRUE(lines[0].find(" INFO ") != std::string::npos);
+    ASSERT_TRUE(lines[0].find("test_binary_log.cpp:") != std::string::npos);
+    ASSERT_TRUE(endsWith(lines[0], "Run run-1 received 42 events"));
+    ASSERT_TRUE(lines[1].find(" DEBUG ") != std::string::npos);
+    ASSERT_TRUE(endsWith(lines[1], "signed -7 unsigned 18446744073709551615 double 2.5"));
+    ASSERT_TRUE(lines[2].find(" WARN ") != std::string::npos);
+    ASSERT_TRUE(endsWith(lines[2], "bool true char x literal text null (null)"));
+    ASSERT_TRUE(lines[3].find(" ERROR ") != std::string::npos);
+    ASSERT_TRUE(endsWith(lines[3], "formatted at the call site: probe"));
+    ASSERT_TRUE(endsWith(lines[4], "missing 1 {}"));
+    ASSERT_TRUE(endsWith(lines[5], "extra 1 2"));
+    ASSERT_TRUE(endsWith(lines[6], "no placeholders"));
+    // "<date>T<time>.<ns>Z"
+    EXPECT_EQ(lines[0][10], 'T');
+    EXPECT_EQ(lines[0][29], 'Z');
+    std::remove(path.c_str());
+}
+
+TEST_CASE(DisabledLevelsAreNotRecorded) {
+    int formatted = 0;
+    ASSERT_FALSE(BinaryLog::isEnabled(LogLevel::Error));
+    AGUI_BLOG_ERROR("not started {}", Probe{&formatted});
+    EXPECT_EQ(formatted, 0);
+
+    Recorder recorder;
+    Logger::setCallback(recorder.callback());
+    BinaryLog::Options options;
+    options.forwardToLogger = true;
+    options.minLevel = LogLevel::Warning;
+    BinaryLog::start(options);
+    ASSERT_FALSE(BinaryLog::isEnabled(LogLevel::Info));
+    AGUI_BLOG_INFO("below the level {}", Probe{&formatted});
+    EXPECT_EQ(formatted, 0);
+    AGUI_BLOG_WARNING("value {}", 42);
+    BinaryLog::stop();
+    ASSERT_FALSE(BinaryLog::isEnabled(LogLevel::Error));
+
+    EXPECT_EQ(recorder.messages.size(), 1u);
+    EXPECT_EQ(recorder.messages[0].second, "value 42");
+    ASSERT_TRUE(recorder.messages[0].first == LogLevel::Warning);
+    Logger::setCallback(nullptr);
+}
+
+TEST_CASE(ForwardingKeepsPerThreadOrder) {
+    Recorder recorder;
+    Logger::setCallback(recorder.callback());
+    BinaryLog::Options options;
+    options.forwardToLogger = true;
+    BinaryLog::start(options);
+
+    constexpr int kThreads = 4;
+    constexpr int kMessages = 2000;
+    const uint64_t droppedBefore = BinaryLog::droppedRecords();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < kMessages; ++i) {
+                AGUI_BLOG_INFO("{}:{}", t, i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    BinaryLog::flush();
+    EXPECT_EQ(BinaryLog::droppedRecords(), droppedBefore);
+    EXPECT_EQ(recorder.messages.size(), static_cast<size_t>(kThreads * kMessages));
+
+    std::vector<int> next(kThreads, 0);
+    for (size_t i = 0; i < recorder.messages.size(); ++i) {
+        const std::string& message = recorder.messages[i].second;
+        const size_t colon = message.find(':');
+        const int thread = std::stoi(message.substr(0, colon));
+        EXPECT_EQ(std::stoi(message.substr(colon + 1)), next[thread]);
+        ++next[thread];
+        ASSERT_TRUE(recorder.threads[i] != std::this_thread::get_id());
+    }
+    BinaryLog::stop();
+    Logger::setCallback(nullptr);
+}
+
+TEST_CASE(FullRingDropsWithoutBlocking) {
+    const std::string path = "test_binary_log_drops.blog";
+    std::remove(path.c_str());
+    BinaryLog::Options options;
+    options.path = path;
+    options.threadBufferBytes = 4096;
+    options.flushInterval = std::chrono::hours(1);
+    BinaryLog::start(options);
+
+    // Runs on a new thread so that its ring is created with the small size
+    constexpr int kRecords = 1000;
+    const uint64_t droppedBefore = BinaryLog::droppedRecords();
+    std::thread([] {
+        for (int i = 0; i < kRecords; ++i) {
+            AGUI_BLOG_INFO("record {}", i);
+        }
+    }).join();
+    const uint64_t dropped = BinaryLog::droppedRecords() - droppedBefore;
+    ASSERT_TRUE(dropped > 0);
+    BinaryLog::stop();
+
+    size_t records = 0;
+    const std::vector<std::string> lines = decodeFile(path, records);
+    EXPECT_EQ(records + dropped, static_cast<uint64_t>(kRecords));
+    ASSERT_TRUE(endsWith(lines.front(), "record 0"));
+    std::remove(path.c_str());
+}
+
+TEST_CASE(RingsOfExitedThreadsAreFreed) {
+    BinaryLog::Options options;
+    options.flushInterval = std::chrono::hours(1);
+    BinaryLog::stop();
+    const size_t baseline = BinaryLog::threadBuffers();
+
+    // Logs during a session and exits only after stop(), so no session drain reaps its ring
+    const auto logUntilStopped = [&options, baseline]() {
+        BinaryLog::start(options);
+        std::atomic<bool> stopped{false};
+        std::thread thread([&stopped] {
+            AGUI_BLOG_INFO("short-lived thread");
+            while (!stopped.load()) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        });
+        while (BinaryLog::threadBuffers() == baseline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        BinaryLog::stop();
+        stopped.store(true);
+        thread.join();
+    };
+
+    logUntilStopped();
+    EXPECT_EQ(BinaryLog::threadBuffers(), baseline + 1);
+    BinaryLog::stop();
+    EXPECT_EQ(BinaryLog::threadBuffers(), baseline);
+
+    logUntilStopped();
+    EXPECT_EQ(BinaryLog::threadBuffers(), baseline + 1);
+    BinaryLog::start(options);
+    EXPECT_EQ(BinaryLog::threadBuffers(), baseline);
+    BinaryLog::stop();
+}
+
+TEST_CASE(DecodeRejectsOtherFiles) {
+    std::istringstream in("{\"not\": \"a binary log\"}");
+    std::ostringstream out;
+    bool threw = false;
+    try {
+        BinaryLog::decode(in, out);
+    } catch (const AgentError&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+
+    // A record cut off at the end, as after a crash, is skipped
+    const std::string path = "test_binary_log_cut.blog";
+    std::remove(path.c_str());
+    BinaryLog::Options options;
+    options.path = path;
+    BinaryLog::start(options);
+    AGUI_BLOG_INFO("complete");
+    BinaryLog::flush();
+    AGUI_BLOG_INFO("cut off");
+    BinaryLog::stop();
+
+    std::ifstream file(path, std::ios::binary);
+    std::string bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::istringstream truncated(bytes.substr(0, bytes.size() - 3));
+    std::ostringstream decoded;
+    EXPECT_EQ(BinaryLog::decode(truncated, decoded), 1u);
+    ASSERT_TRUE(decoded.str().find("complete") != std::string::npos);
+    std::remove(path.c_str());
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Binary Log Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
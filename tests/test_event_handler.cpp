@@ -0,0 +1,384 @@
+#include "core/event_verifier.h"
+#include "core/subscriber.h"
+#include "core/state.h"
+#include <atomic>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <type_traits>
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+std::unique_ptr<Event> makeActivitySnapshot(const MessageId& id, const nlohmann::json& content) {
+    auto event = std::make_unique<ActivitySnapshotEvent>();
+    event->messageId = id;
+    event->activityType = "PLAN";
+    event->content = content;
+    return event;
+}
+
+std::unique_ptr<Event> makeActivityDelta(const MessageId& id, const nlohmann::json& patch) {
+    auto event = std::make_unique<ActivityDeltaEvent>();
+    event->messageId = id;
+    event->activityType = "PLAN";
+    for (const auto& op : patch) {
+        event->patch.push_back(JsonPatchOp::fromJson(op));
+    }
+    return event;
+}
+
+std::unique_ptr<Event> makeTextStart(const MessageId& id) {
+    auto event = std::make_unique<TextMessageStartEvent>();
+    event->messageId = id;
+    return event;
+}
+
+std::unique_ptr<Event> makeTextContent(const MessageId& id, const std::string& delta) {
+    auto event = std::make_unique<TextMessageContentEvent>();
+    event->messageId = id;
+    event->delta = delta;
+    return event;
+}
+
+}  // namespace
+
+// Activity content
+
+TEST_CASE(ActivityDeltaPatchesLiveContent) {
+    EventHandler handler({}, nlohmann::json::object());
+    handler.handleEvent(makeActivitySnapshot("act-1", {{"steps", nlohmann::json::array()}}));
+
+    for (int i = 0; i < 3; ++i) {
+        handler.handleEvent(makeActivityDelta(
+            "act-1", nlohmann::json::parse(R"([{"op":"add","path":"/steps/-","value":{"done":false}}])")));
+    }
+    handler.handleEvent(makeActivityDelta(
+        "act-1", nlohmann::json::parse(R"([{"op":"replace","path":"/steps/1/done","value":true}])")));
+
+    const Message& msg = handler.messages().back();
+    ASSERT_TRUE(msg.hasStructuredContent());
+    const nlohmann::json content = nlohmann::json::parse(msg.content());
+    EXPECT_EQ(content["steps"].size(), 3u);
+    EXPECT_EQ(content["steps"][1]["done"], true);
+    EXPECT_EQ(msg.toJson()["content"], msg.content());
+}
+
+TEST_CASE(ActivityDeltaFailureKeepsContent) {
+    EventHandler handler({}, nlohmann::json::object());
+    handler.handleEvent(makeActivitySnapshot("act-2", {{"a", 1}}));
+
+    bool threw = false;
+    try {
+        // Second op fails; the first must be rolled back
+        handler.handleEvent(makeActivityDelta(
+            "act-2", nlohmann::json::parse(R"([{"op":"add","path":"/b","value":2},
+                                              {"op":"remove","path":"/missing"}])")));
+    } catch (const AgentError& e) {
+        threw = e.code() == ErrorCode::StatePatchFailed;
+    }
+    ASSERT_TRUE(threw);
+    EXPECT_EQ(nlohmann::json::parse(handler.messages().back().content()), nlohmann::json({{"a", 1}}));
+
+    threw = false;
+    try {
+        handler.handleEvent(makeActivityDelta(
+            "act-2", nlohmann::json::parse(R"([{"op":"replace","path":"/missing","value":0}])")));
+    } catch (const AgentError&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+    EXPECT_EQ(nlohmann::json::parse(handler.messages().back().content()), nlohmann::json({{"a", 1}}));
+}
+
+TEST_CASE(ActivityDeltaOnStringContent) {
+    // Activity messages restored from history carry serialized content only
+    Message restored = Message::createWithId("act-3", MessageRole::Activity, R"({"n":1})");
+    EventHandler handler({restored}, nlohmann::json::object());
+
+    handler.handleEvent(makeActivityDelta(
+        "act-3", nlohmann::json::parse(R"([{"op":"replace","path":"/n","value":2}])")));
+    EXPECT_EQ(handler.messages().back().content(), R"({"n":2})");
+
+    Message copy = handler.messages().back();
+    copy.appendContent(" ");
+    ASSERT_FALSE(copy.hasStructuredContent());
+    EXPECT_EQ(copy.content(), R"({"n":2} )");
+}
+
+TEST_CASE(ApplyPatchOpsMatchesApplyPatch) {
+    const nlohmann::json initial = {{"list", {1, 2, 3}}, {"obj", {{"k", "v"}}}};
+    const nlohmann::json patch = nlohmann::json::parse(R"([
+        {"op":"move","from":"/list/0","path":"/obj/first"},
+        {"op":"copy","from":"/obj/k","path":"/list/-"},
+        {"op":"test","path":"/obj/first","value":1}
+    ])");
+
+    StateManager viaJson(initial);
+    viaJson.applyPatch(patch);
+
+    std::vector<JsonPatchOp> ops;
+    for (const auto& op : patch) {
+        ops.push_back(JsonPatchOp::fromJson(op));
+    }
+    StateManager viaOps{nlohmann::json(initial)};
+    viaOps.applyPatchOps(ops);
+
+    EXPECT_EQ(viaOps.currentState(), viaJson.currentState());
+    EXPECT_EQ(viaOps.releaseState(), viaJson.currentState());
+}
+
+// EventVerifier
+
+namespace {
+
+template <typename EventT>
+EventT makeIdEvent(const std::string& id) {
+    EventT event;
+    if constexpr (std::is_same_v<EventT, ToolCallStartEvent> || std::is_same_v<EventT, ToolCallArgsEvent> ||
+                  std::is_same_v<EventT, ToolCallEndEvent>) {
+        event.toolCallId = id;
+    } else {
+        event.messageId = id;
+    }
+    return event;
+}
+
+bool verifyThrows(EventVerifier& verifier, const Event& event, const std::string& expectedFragment) {
+    try {
+        verifier.verify(event);
+    } catch (const AgentError& e) {
+        return std::string(e.what()).find(expectedFragment) != std::string::npos;
+    }
+    return false;
+}
+
+}  // namespace
+
+TEST_CASE(VerifierTracksOnlyOpenLifecycles) {
+    EventVerifier verifier;
+    for (int i = 0; i < 1000; ++i) {
+        const std::string id = "msg-" + std::to_string(i);
+        verifier.verify(makeIdEvent<TextMessageStartEvent>(id));
+        verifier.verify(makeIdEvent<TextMessageContentEvent>(id));
+        ASSERT_FALSE(verifier.isComplete());
+        verifier.verify(makeIdEvent<TextMessageEndEvent>(id));
+    }
+    ASSERT_TRUE(verifier.isComplete());
+    ASSERT_TRUE(verifier.getIncompleteMessages().empty());
+    ASSERT_TRUE(verifier.getMessageState("msg-999") == EventVerifier::EventState::Ended);
+    ASSERT_TRUE(verifier.getMessageState("msg-0") == EventVerifier::EventState::NotStarted);
+}
+
+TEST_CASE(VerifierConcurrentLifecycles) {
+    EventVerifier verifier;
+    // Enough concurrent IDs to force several table resizes and probe collisions
+    for (int i = 0; i < 200; ++i) {
+        verifier.verify(makeIdEvent<ToolCallStartEvent>("tc-" + std::to_string(i)));
+    }
+    for (int i = 0; i < 200; i += 2) {
+        verifier.verify(makeIdEvent<ToolCallArgsEvent>("tc-" + std::to_string(i)));
+        verifier.verify(makeIdEvent<ToolCallEndEvent>("tc-" + std::to_string(i)));
+    }
+
+    EXPECT_EQ(verifier.getIncompleteToolCalls().size(), 100u);
+    for (int i = 1; i < 200; i += 2) {
+        const std::string id = "tc-" + std::to_string(i);
+        ASSERT_TRUE(verifier.getToolCallState(id) == EventVerifier::EventState::Started);
+        verifier.verify(makeIdEvent<ToolCallArgsEvent>(id));
+        ASSERT_TRUE(verifier.getToolCallState(id) == EventVerifier::EventState::InProgress);
+        verifier.verify(makeIdEvent<ToolCallEndEvent>(id));
+    }
+    ASSERT_TRUE(verifier.isComplete());
+}
+
+TEST_CASE(VerifierSequenceErrors) {
+    EventVerifier verifier;
+    ASSERT_TRUE(verifyThrows(verifier, makeIdEvent<TextMessageEndEvent>("m"), "never started"));
+    ASSERT_TRUE(verifyThrows(verifier, makeIdEvent<TextMessageContentEvent>("m"), "has not been started"));
+
+    verifier.verify(makeIdEvent<TextMessageStartEvent>("m"));
+    ASSERT_TRUE(verifyThrows(verifier, makeIdEvent<TextMessageStartEvent>("m"), "already in progress"));
+    verifier.verify(makeIdEvent<TextMessageEndEvent>("m"));
+    ASSERT_TRUE(verifyThrows(verifier, makeIdEvent<TextMessageEndEvent>("m"), "already ended"));
+
+    // Reusing an ended ID is allowed
+    verifier.verify(makeIdEvent<TextMessageStartEvent>("m"));
+    ASSERT_FALSE(verifier.isComplete());
+
+    verifier.reset();
+    ASSERT_TRUE(verifier.isComplete());
+    ASSERT_TRUE(verifyThrows(verifier, makeIdEvent<TextMessageEndEvent>("m"), "never started"));
+}
+
+// Reader snapshots
+
+TEST_CASE(MessageRevisionTracksChanges) {
+    Message a = Message::createWithId("m1", MessageRole::Assistant, "hi");
+    const uint64_t created = a.revision();
+    Message copy = a;
+    EXPECT_EQ(copy.revision(), created);
+
+    a.appendContent("!");
+    ASSERT_TRUE(a.revision() != created);
+    EXPECT_EQ(copy.revision(), created);
+
+    const uint64_t appended = a.revision();
+    a.setName("bot");
+    ASSERT_TRUE(a.revision() != appended);
+}
+
+TEST_CASE(SnapshotsDisabledByDefault) {
+    EventHandler handler({}, nlohmann::json::object());
+    handler.handleEvent(makeTextStart("m1"));
+    ASSERT_TRUE(handler.snapshot() == nullptr);
+
+    handler.enableSnapshots();
+    auto snapshot = handler.snapshot();
+    ASSERT_TRUE(snapshot != nullptr);
+    EXPECT_EQ(snapshot->messages.size(), 1u);
+
+    handler.enableSnapshots(false);
+    ASSERT_TRUE(handler.snapshot() == nullptr);
+}
+
+TEST_CASE(SnapshotSharesUnchangedMessages) {
+    Message first = Message::createWithId("m0", MessageRole::User, "question");
+    EventHandler handler({first}, nlohmann::json({{"count", 0}}));
+    handler.enableSnapshots();
+
+    handler.handleEvent(makeTextStart("m1"));
+    handler.handleEvent(makeTextContent("m1", "Hel"));
+    auto before = handler.snapshot();
+
+    handler.handleEvent(makeTextContent("m1", "lo"));
+    auto after = handler.snapshot();
+
+    ASSERT_TRUE(after->version > before->version);
+    EXPECT_EQ(after->messages.size(), 2u);
+    // The untouched message and the state are shared, the streamed one is a new copy
+    ASSERT_TRUE(after->messages[0] == before->messages[0]);
+    ASSERT_TRUE(after->state == before->state);
+    ASSERT_TRUE(after->messages[1] != before->messages[1]);
+
+    // Published snapshots never change
+    EXPECT_EQ(before->messages[1]->content(), "Hel");
+    EXPECT_EQ(after->messages[1]->content(), "Hello");
+}
+
+TEST_CASE(SnapshotPublishedOncePerBatch) {
+    EventHandler handler({}, nlohmann::json::object());
+    handler.enableSnapshots();
+    const uint64_t initial = handler.snapshot()->version;
+
+    handler.beginBatch();
+    handler.handleEvent(makeTextStart("m1"));
+    handler.handleEvent(makeTextContent("m1", "a"));
+    AgentStateMutation mutation;
+    mutation.withState(nlohmann::json({{"k", "v"}}));
+    handler.applyMutation(mutation);
+    EXPECT_EQ(handler.snapshot()->version, initial);
+    handler.endBatch();
+
+    auto snapshot = handler.snapshot();
+    EXPECT_EQ(snapshot->version, initial + 1);
+    EXPECT_EQ(snapshot->messages.size(), 1u);
+    EXPECT_EQ((*snapshot->state)["k"], "v");
+
+    // Nothing changed: no new version
+    handler.beginBatch();
+    handler.endBatch();
+    EXPECT_EQ(handler.snapshot()->version, initial + 1);
+}
+
+TEST_CASE(SnapshotReaderThread) {
+    EventHandler handler({}, nlohmann::json::object());
+    handler.enableSnapshots();
+    handler.handleEvent(makeTextStart("m1"));
+
+    const int deltas = 2000;
+    std::atomic<bool> done{false};
+    bool consistent = true;
+    std::thread reader([&]() {
+        size_t lastLength = 0;
+        while (!done.load()) {
+            auto snapshot = handler.snapshot();
+            const size_t length = snapshot->messages.back()->content().size();
+            // Version 1 is the empty handler, 2 the started message, then one character per version
+            if (length < lastLength || length + 2 != snapshot->version) {
+                consistent = false;
+            }
+            lastLength = length;
+        }
+    });
+    for (int i = 0; i < deltas; ++i) {
+        handler.handleEvent(makeTextContent("m1", "x"));
+    }
+    done.store(true);
+    reader.join();
+
+    ASSERT_TRUE(consistent);
+    EXPECT_EQ(handler.snapshot()->messages.back()->content().size(), static_cast<size_t>(deltas));
+}
+
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi EventHandler Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,219 @@
+/**
+ * @file test_event_queue.cpp
+ * @brief Lock-free event queue and QueueingSubscriber tests
+ */
+
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/event_queue.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+std::unique_ptr<Event> makeContent(const std::string& delta) {
+    auto event = std::make_unique<TextMessageContentEvent>();
+    event->messageId = "m1";
+    event->delta = delta;
+    return event;
+}
+
+std::string deltaOf(const Event& event) {
+    return static_cast<const TextMessageContentEvent&>(event).delta;
+}
+
+}  // namespace
+
+// Event::clone
+
+TEST_CASE(CloneCopiesDerivedAndBaseFields) {
+    auto original = std::make_unique<ToolCallStartEvent>();
+    original->toolCallId = "tc1";
+    original->toolCallName = "search";
+    original->setRawEvent({{"source", "test"}});
+
+    std::unique_ptr<Event> copy = original->clone();
+    ASSERT_TRUE(copy->type() == EventType::ToolCallStart);
+    EXPECT_EQ(copy->toJson(), original->toJson());
+    original->toolCallName = "changed";
+    EXPECT_EQ(static_cast<const ToolCallStartEvent&>(*copy).toolCallName, "search");
+}
+
+// SpscRingBuffer
+
+TEST_CASE(SpscFifoAndCapacity) {
+    SpscEventQueue queue(3);
+    EXPECT_EQ(queue.capacity(), 4u);
+    ASSERT_TRUE(queue.empty());
+
+    for (int lap = 0; lap < 3; ++lap) {
+        for (int i = 0; i < 4; ++i) {
+            ASSERT_TRUE(queue.tryPush(makeContent(std::to_string(i))));
+        }
+        auto rejected = makeContent("overflow");
+        ASSERT_FALSE(queue.tryPush(std::move(rejected)));
+        ASSERT_TRUE(rejected != nullptr);  // untouched on failure
+
+        for (int i = 0; i < 4; ++i) {
+            auto event = queue.tryPop();
+            ASSERT_TRUE(event.has_value());
+            EXPECT_EQ(deltaOf(**event), std::to_string(i));
+        }
+        ASSERT_FALSE(queue.tryPop().has_value());
+    }
+}
+
+TEST_CASE(SpscAcrossThreads) {
+    constexpr int kCount = 100000;
+    SpscRingBuffer<int> queue(64);
+
+    std::thread producer([&]() {
+        for (int i = 0; i < kCount; ++i) {
+            int value = i;
+            while (!queue.tryPush(std::move(value))) {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    while (expected < kCount) {
+        if (auto value = queue.tryPop()) {
+            EXPECT_EQ(*value, expected);
+            ++expected;
+        }
+    }
+    producer.join();
+    ASSERT_TRUE(queue.empty());
+}
+
+// MpscRingBuffer
+
+TEST_CASE(MpscPreservesPerProducerOrder) {
+    constexpr int kProducers = 4;
+    constexpr int kPerProducer = 25000;
+    MpscRingBuffer<std::pair<int, int>> queue(128);
+
+    std::vector<std::thread> producers;
+    for (int p = 0; p < kProducers; ++p) {
+        producers.emplace_back([&queue, p]() {
+            for (int i = 0; i < kPerProducer; ++i) {
+                std::pair<int, int> item(p, i);
+                while (!queue.tryPush(std::move(item))) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    std::vector<int> next(kProducers, 0);
+    int received = 0;
+    while (received < kProducers * kPerProducer) {
+        if (auto item = queue.tryPop()) {
+            EXPECT_EQ(item->second, next[item->first]);
+            next[item->first]++;
+            ++received;
+        }
+    }
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    ASSERT_FALSE(queue.tryPop().has_value());
+}
+
+TEST_CASE(MpscRejectsWhenFull) {
+    MpscEventQueue queue(2);
+    ASSERT_TRUE(queue.tryPush(makeContent("a")));
+    ASSERT_TRUE(queue.tryPush(makeContent("b")));
+    ASSERT_FALSE(queue.tryPush(makeContent("c")));
+    EXPECT_EQ(deltaOf(**queue.tryPop()), "a");
+    ASSERT_TRUE(queue.tryPush(makeContent("c")));
+    EXPECT_EQ(deltaOf(**queue.tryPop()), "b");
+    EXPECT_EQ(deltaOf(**queue.tryPop()), "c");
+}
+
+// QueueingSubscriber
+
+TEST_CASE(QueueingSubscriberCopiesEvents) {
+    auto queue = std::make_shared<SpscEventQueue>(2);
+    auto subscriber = std::make_shared<QueueingSubscriber<SpscEventQueue>>(queue);
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(subscriber);
+
+    auto start = std::make_unique<TextMessageStartEvent>();
+    start->messageId = "m1";
+    handler.handleEvent(std::move(start));
+    handler.handleEvent(makeContent("hi"));
+    handler.handleEvent(makeContent("dropped"));
+
+    EXPECT_EQ(subscriber->droppedEvents(), 1u);
+    auto first = queue->tryPop();
+    ASSERT_TRUE(first.has_value() && (*first)->type() == EventType::TextMessageStart);
+    EXPECT_EQ(deltaOf(**queue->tryPop()), "hi");
+    ASSERT_FALSE(queue->tryPop().has_value());
+    EXPECT_EQ(handler.messages().back().content(), "hidropped");
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Event Queue Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,815 @@
+/**
+ * @file test_http_agent_streaming.cpp
+ * @brief HttpAgent streaming-path tests driven by a scripted HTTP service
+ *
+ * Replays canned SSE chunks through HttpAgent::runAgent without a network connection.
+ */
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "agent/http_agent.h"
+#include "core/error.h"
+#include "core/event.h"
+#include "core/subscriber.h"
+#include "middleware/delta_coalescing_middleware.h"
+#include "scripted_http_service.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+std::string sse(const std::string& json) {
+    return "data: " + json + "\n\n";
+}
+
+struct RunOutcome {
+    bool succeeded = false;
+    std::string error;
+};
+
+RunOutcome run(HttpAgent& agent, std::vector<std::string> chunks, std::function<void()> afterData = nullptr) {
+    auto service = std::make_unique<ScriptedHttpService>(std::move(chunks));
+    service->afterData = std::move(afterData);
+    agent.setHttpService(std::move(service));
+    RunOutcome outcome;
+    RunAgentParams params;
+    agent.runAgent(
+        params, [&](const RunAgentResult&) { outcome.succeeded = true; },
+        [&](const std::string& error) { outcome.error = error; });
+    return outcome;
+}
+
+std::vector<std::string> textRun(int contentEvents) {
+    std::vector<std::string> chunks;
+    chunks.push_back(sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"));
+    chunks.push_back(sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})"));
+    for (int i = 0; i < contentEvents; ++i) {
+        chunks.push_back(sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":"m1","delta":"x"})"));
+    }
+    chunks.push_back(sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})"));
+    chunks.push_back(sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"));
+    return chunks;
+}
+
+}  // namespace
+
+// Verification levels
+
+TEST_CASE(FullVerificationChecksEveryEvent) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    RunOutcome outcome = run(*agent, textRun(10));
+
+    ASSERT_TRUE(outcome.succeeded);
+    EXPECT_EQ(agent->verificationStats().eventsSeen, 14u);
+    EXPECT_EQ(agent->verificationStats().eventsValidated, 14u);
+    EXPECT_EQ(agent->verificationStats().eventsVerified, 14u);
+    EXPECT_EQ(agent->messages().back().content(), std::string(10, 'x'));
+}
+
+TEST_CASE(SampledVerificationValidatesSubset) {
+    auto agent = HttpAgent::builder()
+        .withUrl("http://localhost")
+        .withVerificationLevel(VerificationLevel::Sampled, 4)
+        .build();
+    RunOutcome outcome = run(*agent, textRun(10));
+
+    ASSERT_TRUE(outcome.succeeded);
+    EXPECT_EQ(agent->verificationStats().eventsSeen, 14u);
+    EXPECT_EQ(agent->verificationStats().eventsValidated, 4u);
+    EXPECT_EQ(agent->verificationStats().eventsVerified, 14u);
+}
+
+TEST_CASE(LifecycleOnlyStillRejectsBadSequences) {
+    auto agent = HttpAgent::builder()
+        .withUrl("http://localhost")
+        .withVerificationLevel(VerificationLevel::LifecycleOnly)
+        .build();
+    RunOutcome outcome = run(*agent, {
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+        sse(R"({"type":"TEXT_MESSAGE_END","messageId":"never"})"),
+    });
+
+    ASSERT_FALSE(outcome.succeeded);
+    ASSERT_TRUE(outcome.error.find("never started") != std::string::npos);
+    EXPECT_EQ(agent->verificationStats().eventsValidated, 0u);
+}
+
+TEST_CASE(OffSkipsAllChecks) {
+    auto agent = HttpAgent::builder()
+        .withUrl("http://localhost")
+        .withVerificationLevel(VerificationLevel::Off)
+        .build();
+    // Unterminated message before RUN_FINISHED would fail the completeness check
+    RunOutcome outcome = run(*agent, {
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})"),
+        sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"),
+    });
+
+    ASSERT_TRUE(outcome.succeeded);
+    EXPECT_EQ(agent->verificationStats().eventsSeen, 3u);
+    EXPECT_EQ(agent->verificationStats().eventsValidated, 0u);
+    EXPECT_EQ(agent->verificationStats().eventsVerified, 0u);
+}
+
+TEST_CASE(FullVerificationRejectsIncompleteRun) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    RunOutcome outcome = run(*agent, {
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})"),
+        sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"),
+    });
+
+    ASSERT_FALSE(outcome.succeeded);
+    ASSERT_TRUE(outcome.error.find("incomplete messages: m1") != std::string::npos);
+}
+
+// Batched processing
+
+namespace {
+
+class ChangeCounter : public IAgentSubscriber {
+public:
+    int messagesChanged = 0;
+    int stateChanged = 0;
+    int contentEvents = 0;
+
+    AgentStateMutation onTextMessageContent(const TextMessageContentEvent&, const std::string&,
+                                            const AgentSubscriberParams&) override {
+        contentEvents++;
+        return AgentStateMutation();
+    }
+    void onMessagesChanged(const AgentSubscriberParams&) override { messagesChanged++; }
+    void onStateChanged(const AgentSubscriberParams&) override { stateChanged++; }
+};
+
+// The whole run in one network read
+std::vector<std::string> singleChunkRun() {
+    std::string chunk;
+    chunk += sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})");
+    for (const char* id : {"m1", "m2"}) {
+        chunk += sse(std::string(R"({"type":"TEXT_MESSAGE_START","role":"assistant","messageId":")") + id + "\"}");
+        chunk += sse(std::string(R"({"type":"TEXT_MESSAGE_CONTENT","delta":"hi","messageId":")") + id + "\"}");
+        chunk += sse(std::string(R"({"type":"TEXT_MESSAGE_END","messageId":")") + id + "\"}");
+    }
+    chunk += sse(R"({"type":"STATE_SNAPSHOT","snapshot":{"a":1}})");
+    chunk += sse(R"({"type":"STATE_DELTA","delta":[{"op":"add","path":"/b","value":2}]})");
+    chunk += sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})");
+    return {chunk};
+}
+
+}  // namespace
+
+TEST_CASE(UnbatchedNotifiesPerEvent) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    auto counter = std::make_shared<ChangeCounter>();
+    agent->subscribe(counter);
+
+    ASSERT_TRUE(run(*agent, singleChunkRun()).succeeded);
+    EXPECT_EQ(counter->messagesChanged, 4);
+    EXPECT_EQ(counter->stateChanged, 2);
+}
+
+TEST_CASE(BatchedCoalescesNotificationsPerRead) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withBatchedEventProcessing().build();
+    auto counter = std::make_shared<ChangeCounter>();
+    agent->subscribe(counter);
+
+    ASSERT_TRUE(run(*agent, singleChunkRun()).succeeded);
+    EXPECT_EQ(counter->messagesChanged, 1);
+    EXPECT_EQ(counter->stateChanged, 1);
+    EXPECT_EQ(counter->contentEvents, 2);
+    EXPECT_EQ(agent->messages().size(), 2u);
+    EXPECT_EQ(agent->state(), nlohmann::json({{"a", 1}, {"b", 2}}));
+}
+
+TEST_CASE(BatchedNotifiesOncePerChunk) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withBatchedEventProcessing().build();
+    auto counter = std::make_shared<ChangeCounter>();
+    agent->subscribe(counter);
+
+    // Every event in its own read: no coalescing possible beyond one per chunk
+    ASSERT_TRUE(run(*agent, textRun(3)).succeeded);
+    EXPECT_EQ(counter->messagesChanged, 2);  // TEXT_MESSAGE_START and TEXT_MESSAGE_END reads
+}
+
+// Delta coalescing
+
+namespace {
+
+class DeltaRecorder : public IAgentSubscriber {
+public:
+    std::vector<std::string> textDeltas;
+    std::vector<std::chrono::steady_clock::time_point> textTimes;
+    std::vector<std::string> argsDeltas;
+
+    AgentStateMutation onTextMessageContent(const TextMessageContentEvent& event, const std::string&,
+                                            const AgentSubscriberParams&) override {
+        textDeltas.push_back(event.delta);
+        textTimes.push_back(std::chrono::steady_clock::now());
+        return AgentStateMutation();
+    }
+    AgentStateMutation onToolCallArgs(const ToolCallArgsEvent& event, const std::string&,
+                                      const AgentSubscriberParams&) override {
+        argsDeltas.push_back(event.delta);
+        return AgentStateMutation();
+    }
+};
+
+std::string textContent(const std::string& id, const std::string& delta) {
+    return sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":")" + id + R"(","delta":")" + delta + R"("})");
+}
+
+}  // namespace
+
+TEST_CASE(CoalescesDeltasWithinRead) {
+    auto coalescer = std::make_shared<DeltaCoalescingMiddleware>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->use(coalescer);
+    auto recorder = std::make_shared<DeltaRecorder>();
+    agent->subscribe(recorder);
+
+    std::string chunk = sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})") +
+                        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})");
+    for (const char* word : {"Hel", "lo", " wor", "ld"}) {
+        chunk += textContent("m1", word);
+    }
+    chunk += sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})") +
+             sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})");
+
+    ASSERT_TRUE(run(*agent, {chunk}).succeeded);
+    EXPECT_EQ(recorder->textDeltas.size(), 1u);
+    EXPECT_EQ(recorder->textDeltas[0], "Hello world");
+    EXPECT_EQ(agent->messages().back().content(), "Hello world");
+    EXPECT_EQ(coalescer->eventsMerged(), 3u);
+    EXPECT_EQ(coalescer->eventsEmitted(), 1u);
+}
+
+TEST_CASE(CoalescingRespectsIdsAndEnds) {
+    auto coalescer = std::make_shared<DeltaCoalescingMiddleware>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->use(coalescer);
+    auto recorder = std::make_shared<DeltaRecorder>();
+    agent->subscribe(recorder);
+
+    std::string chunk = sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})") +
+                        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})") +
+                        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m2","role":"assistant"})") +
+                        textContent("m1", "a") + textContent("m1", "b") +
+                        textContent("m2", "c") +
+                        textContent("m1", "d") +
+                        sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})") +
+                        sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m2"})") +
+                        sse(R"({"type":"TOOL_CALL_START","toolCallId":"tc1","toolCallName":"f"})") +
+                        sse(R"({"type":"TOOL_CALL_ARGS","toolCallId":"tc1","delta":"{\"x\":"})") +
+                        sse(R"({"type":"TOOL_CALL_ARGS","toolCallId":"tc1","delta":"1}"})") +
+                        sse(R"({"type":"TOOL_CALL_END","toolCallId":"tc1"})") +
+                        sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})");
+
+    ASSERT_TRUE(run(*agent, {chunk}).succeeded);
+    EXPECT_EQ(recorder->textDeltas, (std::vector<std::string>{"ab", "c", "d"}));
+    EXPECT_EQ(recorder->argsDeltas, (std::vector<std::string>{"{\"x\":1}"}));
+    EXPECT_EQ(coalescer->eventsMerged(), 2u);
+    EXPECT_EQ(coalescer->eventsEmitted(), 4u);
+}
+
+TEST_CASE(CoalescingHonoursByteLimit) {
+    DeltaCoalescingMiddleware::Options options;
+    options.maxBytes = 4;
+    auto coalescer = std::make_shared<DeltaCoalescingMiddleware>(options);
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->use(coalescer);
+    auto recorder = std::make_shared<DeltaRecorder>();
+    agent->subscribe(recorder);
+
+    std::string chunk = sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})") +
+                        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})") +
+                        textContent("m1", "ab") + textContent("m1", "cd") + textContent("m1", "e") +
+                        textContent("m1", "toolong") + textContent("m1", "f") +
+                        sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})") +
+                        sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})");
+
+    ASSERT_TRUE(run(*agent, {chunk}).succeeded);
+    EXPECT_EQ(recorder->textDeltas, (std::vector<std::string>{"abcd", "e", "toolong", "f"}));
+    EXPECT_EQ(agent->messages().back().content(), "abcdetoolongf");
+}
+
+TEST_CASE(CoalescingReleasesAtEndOfRead) {
+    auto coalescer = std::make_shared<DeltaCoalescingMiddleware>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->use(coalescer);
+    auto recorder = std::make_shared<DeltaRecorder>();
+    agent->subscribe(recorder);
+
+    // One delta per read: nothing is held across reads with the default maxDelay of 0
+    ASSERT_TRUE(run(*agent, textRun(3)).succeeded);
+    EXPECT_EQ(recorder->textDeltas.size(), 3u);
+    EXPECT_EQ(coalescer->eventsMerged(), 0u);
+
+    // With a delay window, deltas merge across reads and the END still releases them
+    DeltaCoalescingMiddleware::Options options;
+    options.maxDelay = std::chrono::milliseconds(60000);
+    auto delayed = std::make_shared<DeltaCoalescingMiddleware>(options);
+    auto agent2 = HttpAgent::builder().withUrl("http://localhost").build();
+    agent2->use(delayed);
+    auto recorder2 = std::make_shared<DeltaRecorder>();
+    agent2->subscribe(recorder2);
+
+    ASSERT_TRUE(run(*agent2, textRun(3)).succeeded);
+    EXPECT_EQ(recorder2->textDeltas, (std::vector<std::string>{"xxx"}));
+    EXPECT_EQ(delayed->eventsMerged(), 2u);
+}
+
+TEST_CASE(CoalescingWindowIsCheckedWhenDataArrives) {
+    DeltaCoalescingMiddleware::Options options;
+    options.maxDelay = std::chrono::milliseconds(20);
+    auto coalescer = std::make_shared<DeltaCoalescingMiddleware>(options);
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->use(coalescer);
+    auto recorder = std::make_shared<DeltaRecorder>();
+    agent->subscribe(recorder);
+
+    auto service = std::make_unique<ScriptedHttpService>(std::vector<std::string>{
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})") +
+            sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})") + textContent("m1", "Hel"),
+        textContent("m1", "lo"),
+        textContent("m1", " world") + sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})") +
+            sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"),
+    });
+    // The stream goes quiet for longer than maxDelay before the last read
+    std::chrono::steady_clock::time_point idleEnd;
+    service->beforeChunk = [&idleEnd](size_t index) {
+        if (index == 2) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(80));
+            idleEnd = std::chrono::steady_clock::now();
+        }
+    };
+    agent->setHttpService(std::move(service));
+    bool succeeded = false;
+    agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    // Nothing runs while no data arrives, so the held "Hello" is only released by the next
+    // read, which no longer merges into it because the window has passed
+    EXPECT_EQ(recorder->textDeltas, (std::vector<std::string>{"Hello", " world"}));
+    ASSERT_TRUE(recorder->textTimes[0] >= idleEnd);
+}
+
+// Pipelined processing
+
+namespace {
+
+class ThreadRecorder : public IAgentSubscriber {
+public:
+    std::vector<std::string> deltas;
+    std::thread::id callbackThread;
+    // When set, the first content callback waits for it (bounded, so a regression fails instead of hanging)
+    std::shared_future<void> gate;
+    bool gateOpenedFirst = false;
+    std::chrono::milliseconds delay{0};
+
+    AgentStateMutation onTextMessageContent(const TextMessageContentEvent& event, const std::string&,
+                                            const AgentSubscriberParams&) override {
+        callbackThread = std::this_thread::get_id();
+        if (gate.valid() && deltas.empty()) {
+            gateOpenedFirst = gate.wait_for(std::chrono::seconds(5)) == std::future_status::ready;
+        }
+        if (delay.count() > 0) {
+            std::this_thread::sleep_for(delay);
+        }
+        deltas.push_back(event.delta);
+        return AgentStateMutation();
+    }
+};
+
+std::vector<std::string> numberedRun(int contentEvents) {
+    std::vector<std::string> chunks;
+    chunks.push_back(sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"));
+    chunks.push_back(sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})"));
+    for (int i = 0; i < contentEvents; ++i) {
+        chunks.push_back(textContent("m1", std::to_string(i)));
+    }
+    chunks.push_back(sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})"));
+    chunks.push_back(sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"));
+    return chunks;
+}
+
+}  // namespace
+
+TEST_CASE(PipelinedPreservesOrderOffNetworkThread) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withPipelinedProcessing(4).build();
+    auto recorder = std::make_shared<ThreadRecorder>();
+    agent->subscribe(recorder);
+
+    RunOutcome outcome = run(*agent, numberedRun(50));
+
+    ASSERT_TRUE(outcome.succeeded);
+    ASSERT_TRUE(recorder->callbackThread != std::this_thread::get_id());
+    EXPECT_EQ(recorder->deltas.size(), 50u);
+    for (size_t i = 0; i < recorder->deltas.size(); ++i) {
+        EXPECT_EQ(recorder->deltas[i], std::to_string(i));
+    }
+    EXPECT_EQ(agent->verificationStats().eventsVerified, 54u);
+    EXPECT_EQ(agent->messages().back().content().size(), 90u);  // "0".."49"
+}
+
+TEST_CASE(PipelinedSlowSubscriberDoesNotBlockReads) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withPipelinedProcessing().build();
+    auto recorder = std::make_shared<ThreadRecorder>();
+    std::promise<void> allDataDelivered;
+    recorder->gate = allDataDelivered.get_future().share();
+    agent->subscribe(recorder);
+
+    // The subscriber only proceeds once every chunk has been handed over
+    RunOutcome outcome = run(*agent, numberedRun(10), [&]() { allDataDelivered.set_value(); });
+
+    ASSERT_TRUE(outcome.succeeded);
+    ASSERT_TRUE(recorder->gateOpenedFirst);
+    EXPECT_EQ(recorder->deltas.size(), 10u);
+}
+
+TEST_CASE(PipelinedFailBackpressure) {
+    auto agent = HttpAgent::builder()
+        .withUrl("http://localhost")
+        .withPipelinedProcessing(2, PipelineBackpressure::Fail)
+        .build();
+    auto recorder = std::make_shared<ThreadRecorder>();
+    recorder->delay = std::chrono::milliseconds(50);
+    agent->subscribe(recorder);
+
+    std::string chunk;
+    for (const auto& event : numberedRun(20)) {
+        chunk += event;
+    }
+    RunOutcome outcome = run(*agent, {chunk});
+
+    ASSERT_FALSE(outcome.succeeded);
+    ASSERT_TRUE(outcome.error.find("queue full") != std::string::npos);
+}
+
+TEST_CASE(PipelinedWorkerErrorFailsRun) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withPipelinedProcessing().build();
+    RunOutcome outcome = run(*agent, {
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+        sse(R"({"type":"TEXT_MESSAGE_END","messageId":"never"})"),
+        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})"),
+    });
+
+    ASSERT_FALSE(outcome.succeeded);
+    ASSERT_TRUE(outcome.error.find("never started") != std::string::npos);
+
+    // The agent is reusable after a failed pipelined run
+    ASSERT_TRUE(run(*agent, textRun(2)).succeeded);
+}
+
+TEST_CASE(PipelinedBatchesPerRead) {
+    auto agent = HttpAgent::builder()
+        .withUrl("http://localhost")
+        .withBatchedEventProcessing()
+        .withPipelinedProcessing()
+        .build();
+    auto counter = std::make_shared<ChangeCounter>();
+    agent->subscribe(counter);
+
+    ASSERT_TRUE(run(*agent, singleChunkRun()).succeeded);
+    EXPECT_EQ(counter->messagesChanged, 1);
+    EXPECT_EQ(counter->stateChanged, 1);
+    EXPECT_EQ(agent->state(), nlohmann::json({{"a", 1}, {"b", 2}}));
+}
+
+TEST_CASE(PipelinedBatchClosesOnDecodeError) {
+    auto agent = HttpAgent::builder()
+        .withUrl("http://localhost")
+        .withBatchedEventProcessing()
+        .withPipelinedProcessing()
+        .withReaderSnapshots()
+        .build();
+    auto counter = std::make_shared<ChangeCounter>();
+    agent->subscribe(counter);
+
+    // The malformed payload fails the read after its first events opened a batch
+    RunOutcome outcome = run(*agent, {sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})") +
+                                      sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})") +
+                                      "data: {not json}\n\n"});
+
+    ASSERT_FALSE(outcome.succeeded);
+    EXPECT_EQ(agent->messages().size(), 1u);
+    EXPECT_EQ(counter->messagesChanged, 1);
+    EXPECT_EQ(agent->snapshot()->messages.size(), 1u);
+}
+
+// Chunk delivery
+
+TEST_CASE(StreamsThroughChunkCallback) {
+    std::string body;
+    for (const auto& chunk : textRun(5)) {
+        body += chunk;
+    }
+    // Reads split events, lines and JSON at arbitrary points
+    auto service = std::make_shared<ScriptedHttpService>(std::vector<std::string>{body});
+    service->readSize = 7;
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->setHttpService(service);
+
+    bool succeeded = false;
+    agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(service->streamCalls, 1);
+    ASSERT_TRUE(service->readsDelivered > 1);
+    EXPECT_EQ(agent->messages().back().content(), std::string(5, 'x'));
+}
+
+TEST_CASE(LegacyServicesStillStream) {
+    // Data only reaches sendSseRequest(); the default adapter bridges it
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    auto service = std::make_shared<ScriptedHttpService>(textRun(3));
+    service->legacy = true;
+    agent->setHttpService(service);
+    bool succeeded = false;
+    agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(service->streamCalls, 0);
+    EXPECT_EQ(service->readsDelivered, 7);
+    EXPECT_EQ(agent->messages().back().content(), std::string(3, 'x'));
+}
+
+// Request serialization
+
+RunAgentInput serializationInput() {
+    RunAgentInput input;
+    input.threadId = "thread \"1\"";
+    input.runId = "run\\1";
+    input.parentRunId = "parent";
+    input.state = {{"count", 3}, {"nested", {{"list", {1, 2.5, "x"}}, {"flag", true}}}};
+    input.forwardedProps = nlohmann::json();
+
+    std::string every;
+    for (int c = 1; c < 0x80; ++c) {
+        every += static_cast<char>(c);
+    }
+    input.messages.push_back(Message::createWithId("u1", MessageRole::User, every, "alice"));
+    input.messages.push_back(
+        Message::createWithId("u2", MessageRole::User, "caf\xc3\xa9 \xf0\x9f\x98\x80 \xe2\x82\xac"));
+
+    Message assistant = Message::createWithId("a1", MessageRole::Assistant, "");
+    ToolCall call;
+    call.id = "c1";
+    call.function = FunctionCall("lookup", R"({"q":"a\nb"})");
+    assistant.addToolCall(call);
+    assistant.addToolCall(call);
+    input.messages.push_back(assistant);
+    input.messages.push_back(Message::createWithId("t1", MessageRole::Tool, "found\t1", "", "c1"));
+
+    Message activity = Message::createWithId("act", MessageRole::Activity, "");
+    activity.setActivityType("progress");
+    activity.setStructuredContent({{"done", 1}, {"of", 2}});
+    input.messages.push_back(activity);
+
+    Tool tool;
+    tool.name = "lookup";
+    tool.description = "Looks \"things\" up";
+    tool.parameters = {{"type", "object"}, {"required", {"q"}}};
+    input.tools.push_back(tool);
+    input.context.push_back(Context{"locale", "fr\x01"});
+    return input;
+}
+
+TEST_CASE(RequestSerializerMatchesDump) {
+    RunAgentInput input = serializationInput();
+    std::string body = "stale";
+    body.clear();
+    input.appendJson(body);
+    EXPECT_EQ(body, input.toJson().dump());
+
+    input.parentRunId.reset();
+    input.messages.clear();
+    input.tools.clear();
+    input.context.clear();
+    input.state = nlohmann::json::object();
+    body.clear();
+    input.appendJson(body);
+    EXPECT_EQ(body, input.toJson().dump());
+}
+
+TEST_CASE(MessageCacheReusesUnchangedMessages) {
+    RunAgentInput input = serializationInput();
+    MessageJsonCache cache;
+    std::string body;
+    input.appendJson(body, &cache);
+    EXPECT_EQ(body, input.toJson().dump());
+    EXPECT_EQ(cache.misses(), input.messages.size());
+    EXPECT_EQ(cache.hits(), 0u);
+
+    // Next turn: one streamed edit, one tool-call delta, one new message
+    input.messages[1].appendContent(" more");
+    input.messages[2].appendEventDelta("c1", " ");
+    input.messages.push_back(Message::createWithId("u3", MessageRole::User, "next"));
+    body.clear();
+    input.appendJson(body, &cache);
+    EXPECT_EQ(body, input.toJson().dump());
+    EXPECT_EQ(cache.misses(), input.messages.size() - 1 + 3);
+    EXPECT_EQ(cache.hits(), input.messages.size() - 3);
+
+    // Messages no longer sent are dropped
+    input.messages.erase(input.messages.begin(), input.messages.begin() + 2);
+    input.messages[0].setContent("replaced");
+    body.clear();
+    input.appendJson(body, &cache);
+    EXPECT_EQ(body, input.toJson().dump());
+    EXPECT_EQ(cache.size(), input.messages.size());
+}
+
+TEST_CASE(AgentRequestBodiesReuseHistory) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    agent->addMessage(Message::createWithId("u1", MessageRole::User, "hello"));
+
+    for (const std::string id : {"m1", "m2"}) {
+        auto service = std::make_shared<ScriptedHttpService>(std::vector<std::string>{
+            sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+            sse(R"({"type":"TEXT_MESSAGE_START","messageId":")" + id + R"(","role":"assistant"})"),
+            sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":")" + id + R"(","delta":"hi"})"),
+            sse(R"({"type":"TEXT_MESSAGE_END","messageId":")" + id + R"("})"),
+            sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})")});
+        agent->setHttpService(service);
+        const size_t historySize = agent->messages().size();
+        bool succeeded = false;
+        agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+        ASSERT_TRUE(succeeded);
+        RunAgentInput sent = RunAgentInput::fromJson(nlohmann::json::parse(service->lastRequest().body));
+        EXPECT_EQ(service->lastRequest().body, sent.toJson().dump());
+        // The second request carries the first turn's reply, partly from the cache
+        EXPECT_EQ(sent.messages.size(), historySize);
+    }
+}
+
+Tool schemaTool(const std::string& name, const std::string& description) {
+    Tool tool;
+    tool.name = name;
+    tool.description = description;
+    tool.parameters = {{"type", "object"}, {"properties", {{"q", {{"type", "string"}}}}}};
+    return tool;
+}
+
+std::vector<std::string> toolNames(const RunAgentInput& input) {
+    std::vector<std::string> names;
+    for (const auto& tool : input.tools) {
+        names.push_back(tool.name);
+    }
+    return names;
+}
+
+TEST_CASE(ToolSchemaSetSerializesOnce) {
+    auto set = std::make_shared<const ToolSchemaSet>(
+        std::vector<Tool>{schemaTool("a", "first"), schemaTool("b", "second"), schemaTool("a", "replaced")});
+    EXPECT_EQ(set->size(), 2u);
+    EXPECT_EQ(set->tools()[0].description, "replaced");
+
+    RunAgentInput input = serializationInput();  // per-run tool "lookup"
+    input.toolSchemas = set;
+    std::string body;
+    input.appendJson(body);
+    EXPECT_EQ(body, input.toJson().dump());
+    EXPECT_EQ(toolNames(RunAgentInput::fromJson(nlohmann::json::parse(body))),
+              (std::vector<std::string>{"a", "b", "lookup"}));
+
+    // A per-run tool replaces the registered one of the same name
+    input.tools.push_back(schemaTool("b", "per run"));
+    body.clear();
+    input.appendJson(body);
+    EXPECT_EQ(body, input.toJson().dump());
+    EXPECT_EQ(toolNames(RunAgentInput::fromJson(nlohmann::json::parse(body))),
+              (std::vector<std::string>{"a", "lookup", "b"}));
+    input.tools.clear();
+    body.clear();
+    input.toolSchemas = set->without("a")->without("b");
+    input.appendJson(body);
+    EXPECT_EQ(body, input.toJson().dump());
+
+    // The hash follows the serialized content
+    EXPECT_EQ(set->hashHex().size(), 16u);
+    EXPECT_EQ(ToolSchemaSet(set->tools()).hash(), set->hash());
+    auto changed = set->with(schemaTool("b", "changed"));
+    EXPECT_EQ(changed->size(), 2u);
+    ASSERT_TRUE(changed->hash() != set->hash());
+    EXPECT_EQ(changed->with(schemaTool("b", "second"))->hash(), set->hash());
+    EXPECT_EQ(set->without("missing")->hash(), set->hash());
+}
+
+TEST_CASE(AgentSendsRegisteredTools) {
+    auto agent = HttpAgent::builder()
+                     .withUrl("http://localhost")
+                     .withTools({schemaTool("search", "Searches")})
+                     .withToolSchemaHash()
+                     .build();
+    agent->registerTool(schemaTool("fetch", "Fetches"));
+    ASSERT_TRUE(agent->unregisterTool("fetch"));
+    ASSERT_FALSE(agent->unregisterTool("fetch"));
+    agent->registerTool(schemaTool("open", "Opens"));
+
+    auto service = std::make_shared<ScriptedHttpService>(std::vector<std::string>{
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+        sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})")});
+    agent->setHttpService(service);
+    RunAgentParams params;
+    params.tools.push_back(schemaTool("per-run", "Only this run"));
+    bool succeeded = false;
+    agent->runAgent(params, [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+    ASSERT_TRUE(succeeded);
+
+    RunAgentInput sent = RunAgentInput::fromJson(nlohmann::json::parse(service->lastRequest().body));
+    EXPECT_EQ(toolNames(sent), (std::vector<std::string>{"search", "open", "per-run"}));
+    EXPECT_EQ(service->lastRequest().headers.at(HttpAgent::kToolSchemaHashHeader),
+              agent->registeredTools()->hashHex());
+}
+
+TEST_CASE(RequestSerializerRejectsInvalidUtf8) {
+    for (const char* invalid : {"\xff", "\xc3", "\xc0\xaf", "\xed\xa0\x80", "\xf4\x90\x80\x80"}) {
+        std::string out;
+        bool threw = false;
+        try {
+            appendJsonString(out, invalid);
+        } catch (const AgentError&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+
+        // Same strings dump() refuses
+        threw = false;
+        try {
+            nlohmann::json(std::string(invalid)).dump();
+        } catch (const nlohmann::json::type_error&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+    }
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi HttpAgent Streaming Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
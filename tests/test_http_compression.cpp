@@ -0,0 +1,436 @@
+/**
+ * @file test_http_compression.cpp
+ * @brief Request body compression, Accept-Encoding and transfer counters
+ *
+ * The HttpService tests talk to a one-shot HTTP server on a loopback socket.
+ */
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "http/compression.h"
+#include "http/http_service.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+// Compressible stand-in for a RunAgentInput body
+std::string largeBody(size_t size) {
+    std::string body = "{\"messages\":[";
+    for (int i = 0; body.size() < size; ++i) {
+        body += "{\"id\":\"msg-" + std::to_string(i) + "\",\"role\":\"user\",\"content\":\"hello there\"},";
+    }
+    body.back() = ']';
+    return body + "}";
+}
+
+std::string lowercase(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+// Accepts one connection, records the request and answers with a fixed SSE response
+class LoopbackServer {
+public:
+    LoopbackServer(std::string responseBody, std::string contentEncoding, std::string status = "200 OK")
+        : m_responseBody(std::move(responseBody)),
+          m_contentEncoding(std::move(contentEncoding)),
+          m_status(std::move(status)) {
+        m_listener = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = 0;
+        socklen_t length = sizeof(address);
+        if (m_listener < 0 || bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(m_listener, 1) != 0 ||
+            getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &length) != 0) {
+            throw std::runtime_error("Cannot open loopback socket");
+        }
+        m_port = ntohs(address.sin_port);
+        m_thread = std::thread([this]() { serve(); });
+    }
+
+    ~LoopbackServer() {
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+        close(m_listener);
+    }
+
+    std::string url() const { return "http://127.0.0.1:" + std::to_string(m_port) + "/agent"; }
+
+    // Valid once the client call has returned
+    std::string requestHead;  // lowercased
+    std::string requestBody;
+
+private:
+    void serve() {
+        const int connection = accept(m_listener, nullptr, nullptr);
+        if (connection < 0) {
+            return;
+        }
+        std::string data;
+        char buffer[16 * 1024];
+        size_t headEnd;
+        while ((headEnd = data.find("\r\n\r\n")) == std::string::npos) {
+            const ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                close(connection);
+                return;
+            }
+            data.append(buffer, static_cast<size_t>(n));
+        }
+        requestHead = lowercase(data.substr(0, headEnd));
+        requestBody = data.substr(headEnd + 4);
+
+        if (requestHead.find("expect: 100-continue") != std::string::npos) {
+            const std::string proceed = "HTTP/1.1 100 Continue\r\n\r\n";
+            send(connection, proceed.data(), proceed.size(), 0);
+        }
+        size_t contentLength = 0;
+        const size_t field = requestHead.find("content-length:");
+        if (field != std::string::npos) {
+            contentLength = std::stoul(requestHead.substr(field + 15));
+        }
+        while (requestBody.size() < contentLength) {
+            const ssize_t n = recv(connection, buffer, sizeof(buffer), 0);
+            if (n <= 0) {
+                break;
+            }
+            requestBody.append(buffer, static_cast<size_t>(n));
+        }
+
+        std::string response =
+            "HTTP/1.1 " + m_status + "\r\nContent-Type: text/event-stream\r\nConnection: close\r\n";
+        if (!m_contentEncoding.empty()) {
+            response += "Content-Encoding: " + m_contentEncoding + "\r\n";
+        }
+        response += "Content-Length: " + std::to_string(m_responseBody.size()) + "\r\n\r\n" + m_responseBody;
+        send(connection, response.data(), response.size(), 0);
+        close(connection);
+    }
+
+    std::string m_responseBody;
+    std::string m_contentEncoding;
+    std::string m_status;
+    int m_listener = -1;
+    uint16_t m_port = 0;
+    std::thread m_thread;
+};
+
+struct StreamResult {
+    std::string data;
+    bool completed = false;
+    std::string error;
+    std::optional<HttpTimings> timings;
+};
+
+StreamResult stream(HttpService& service, const std::string& url, const std::string& body) {
+    HttpRequest request;
+    request.method = HttpMethod::POST;
+    request.url = url;
+    request.body = body;
+    request.timeoutMs = 5000;
+    StreamResult result;
+    service.streamSseRequest(
+        request, [&](std::string_view chunk) { result.data.append(chunk.data(), chunk.size()); },
+        [&](const HttpResponse& response) {
+            result.completed = true;
+            result.timings = response.timings;
+        },
+        [&](const AgentError& error) { result.error = error.message(); });
+    return result;
+}
+
+std::string sseEvents(int count) {
+    std::string events;
+    for (int i = 0; i < count; ++i) {
+        events += "data: {\"type\":\"TEXT_MESSAGE_CONTENT\",\"messageId\":\"m1\",\"delta\":\"token\"}\n\n";
+    }
+    return events;
+}
+
+}  // namespace
+
+// Codecs
+
+TEST_CASE(GzipRoundTrip) {
+    if (!isContentEncodingAvailable(ContentEncoding::Gzip)) {
+        std::string out;
+        bool threw = false;
+        try {
+            compressBody(ContentEncoding::Gzip, "x", -1, out);
+        } catch (const AgentError&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+        return;
+    }
+    const std::string body = largeBody(64 * 1024);
+    for (int level : {-1, 1, 9}) {
+        std::string compressed = "prefix";
+        compressBody(ContentEncoding::Gzip, body, level, compressed);
+        EXPECT_EQ(compressed.substr(0, 6), "prefix");
+        ASSERT_TRUE(compressed.size() < body.size() / 4);
+        EXPECT_EQ(decompressBody(ContentEncoding::Gzip, std::string_view(compressed).substr(6)), body);
+    }
+
+    bool threw = false;
+    try {
+        decompressBody(ContentEncoding::Gzip, "not gzip");
+    } catch (const AgentError&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+TEST_CASE(ZstdRoundTrip) {
+    if (!isContentEncodingAvailable(ContentEncoding::Zstd)) {
+        return;
+    }
+    const std::string body = largeBody(64 * 1024);
+    std::string compressed;
+    compressBody(ContentEncoding::Zstd, body, -1, compressed);
+    ASSERT_TRUE(compressed.size() < body.size() / 4);
+    EXPECT_EQ(decompressBody(ContentEncoding::Zstd, compressed), body);
+
+    // Truncated frames and garbage are rejected, not returned short
+    for (const std::string& input : {compressed.substr(0, compressed.size() / 2), std::string("not zstd")}) {
+        bool threw = false;
+        try {
+            decompressBody(ContentEncoding::Zstd, input);
+        } catch (const AgentError&) {
+            threw = true;
+        }
+        ASSERT_TRUE(threw);
+    }
+}
+
+TEST_CASE(DecompressionStopsAtOutputLimit) {
+    // 16 MiB of zeros compresses to a few KiB
+    const std::string zeros(16 * 1024 * 1024, '\0');
+    for (ContentEncoding encoding : {ContentEncoding::Identity, ContentEncoding::Gzip, ContentEncoding::Zstd}) {
+        if (!isContentEncodingAvailable(encoding)) {
+            continue;
+        }
+        std::string compressed;
+        compressBody(encoding, zeros, -1, compressed);
+        EXPECT_EQ(decompressBody(encoding, compressed).size(), zeros.size());
+
+        bool threw = false;
+        try {
+            decompressBody(encoding, compressed, 1024 * 1024);
+        } catch (const AgentError& error) {
+            threw = error.message().find("exceeds") != std::string::npos;
+        }
+        ASSERT_TRUE(threw);
+    }
+}
+
+TEST_CASE(EncodeRequestBodyAppliesThreshold) {
+    HttpCompressionOptions options;
+    options.minBodySize = 1024;
+    HttpRequest request;
+    std::string encoded;
+
+    request.body = largeBody(512);
+    ASSERT_FALSE(encodeRequestBody(options, request, encoded));
+
+    request.body = largeBody(4096);
+    EXPECT_EQ(encodeRequestBody(options, request, encoded), isContentEncodingAvailable(ContentEncoding::Gzip));
+
+    // Already encoded by the caller
+    request.headers["Content-Encoding"] = "br";
+    ASSERT_FALSE(encodeRequestBody(options, request, encoded));
+
+    ASSERT_FALSE(encodeRequestBody(HttpCompressionOptions::disabled(), HttpRequest(), encoded));
+}
+
+TEST_CASE(UnavailableEncodingIsRejected) {
+    for (ContentEncoding encoding : {ContentEncoding::Gzip, ContentEncoding::Zstd}) {
+        HttpCompressionOptions options;
+        options.requestEncoding = encoding;
+        bool threw = false;
+        try {
+            HttpService service(options);
+        } catch (const AgentError&) {
+            threw = true;
+        }
+        EXPECT_EQ(threw, !isContentEncodingAvailable(encoding));
+    }
+}
+
+// HttpService over loopback
+
+TEST_CASE(CompressedRequestAndResponse) {
+    if (!isContentEncodingAvailable(ContentEncoding::Gzip)) {
+        return;
+    }
+    const std::string events = sseEvents(200);
+    std::string gzippedEvents;
+    compressBody(ContentEncoding::Gzip, events, -1, gzippedEvents);
+    LoopbackServer server(gzippedEvents, "gzip");
+
+    HttpCompressionOptions options;
+    options.minBodySize = 1024;
+    HttpService service(options);
+    const std::string body = largeBody(128 * 1024);
+    StreamResult result = stream(service, server.url(), body);
+
+    ASSERT_TRUE(result.completed);
+    EXPECT_EQ(result.data, events);
+    ASSERT_TRUE(server.requestHead.find("content-encoding: gzip") != std::string::npos);
+    ASSERT_TRUE(server.requestHead.find("accept-encoding:") != std::string::npos);
+    EXPECT_EQ(decompressBody(ContentEncoding::Gzip, server.requestBody), body);
+
+    HttpTransferStats stats = service.transferStats();
+    EXPECT_EQ(stats.requests, 1u);
+    EXPECT_EQ(stats.requestsCompressed, 1u);
+    EXPECT_EQ(stats.requestBodyBytes, body.size());
+    EXPECT_EQ(stats.requestBytesSent, server.requestBody.size());
+    ASSERT_TRUE(stats.requestBytesSaved() > body.size() / 2);
+    EXPECT_EQ(stats.responseBytesReceived, gzippedEvents.size());
+    EXPECT_EQ(stats.responseBytesDecoded, events.size());
+    ASSERT_TRUE(stats.responseBytesSaved() > 0);
+}
+
+TEST_CASE(SmallOrDisabledRequestsAreSentAsIs) {
+    const std::string events = sseEvents(3);
+    {
+        LoopbackServer server(events, "");
+        HttpCompressionOptions options;
+        HttpService service(options);
+        const std::string body = largeBody(256);
+        StreamResult result = stream(service, server.url(), body);
+        ASSERT_TRUE(result.completed);
+        EXPECT_EQ(server.requestBody, body);
+        ASSERT_TRUE(server.requestHead.find("content-encoding") == std::string::npos);
+        EXPECT_EQ(service.transferStats().requestBytesSaved(), 0u);
+    }
+    {
+        LoopbackServer server(events, "");
+        HttpService service;
+        const std::string body = largeBody(64 * 1024);
+        StreamResult result = stream(service, server.url(), body);
+        ASSERT_TRUE(result.completed);
+        EXPECT_EQ(result.data, events);
+        EXPECT_EQ(server.requestBody, body);
+        ASSERT_TRUE(server.requestHead.find("accept-encoding") == std::string::npos);
+    }
+}
+
+TEST_CASE(SseDataCarriesResponseStatus) {
+    const std::string events = sseEvents(3);
+    LoopbackServer server(events, "", "201 Created");
+    HttpService service;
+    HttpRequest request;
+    request.method = HttpMethod::POST;
+    request.url = server.url();
+    request.body = "{}";
+    request.timeoutMs = 5000;
+
+    std::string data;
+    std::vector<int> statusCodes;
+    int completedStatus = 0;
+    service.sendSseRequest(
+        request,
+        [&](const HttpResponse& response) {
+            statusCodes.push_back(response.statusCode);
+            data += response.content;
+        },
+        [&](const HttpResponse& response) { completedStatus = response.statusCode; }, nullptr);
+
+    EXPECT_EQ(data, events);
+    ASSERT_FALSE(statusCodes.empty());
+    for (int statusCode : statusCodes) {
+        EXPECT_EQ(statusCode, 201);
+    }
+    EXPECT_EQ(completedStatus, 201);
+}
+
+TEST_CASE(SseCompletionReportsConnectionTimings) {
+    LoopbackServer server(sseEvents(3), "");
+    HttpService service;
+    StreamResult result = stream(service, server.url(), largeBody(256));
+    ASSERT_TRUE(result.completed);
+
+    // Connection phases are reported with the completion, in order
+    ASSERT_TRUE(result.timings.has_value());
+    ASSERT_TRUE(result.timings->connect >= result.timings->nameLookup);
+    ASSERT_TRUE(result.timings->firstByte >= result.timings->connect);
+    ASSERT_TRUE(result.timings->total >= result.timings->firstByte);
+    ASSERT_TRUE(result.timings->total.count() > 0);
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi HTTP Compression Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
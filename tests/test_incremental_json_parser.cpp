@@ -0,0 +1,290 @@
+#include "stream/incremental_json_parser.h"
+#include "core/subscriber.h"
+#include <iostream>
+#include <string>
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+// Feeds the document one byte at a time, the worst case for fragment boundaries
+void feedBytewise(IncrementalJsonParser& parser, const std::string& text) {
+    for (char c : text) {
+        parser.feed(std::string(1, c));
+    }
+}
+
+bool throwsParseError(const std::string& text) {
+    IncrementalJsonParser parser;
+    try {
+        parser.feed(text);
+    } catch (const AgentError& e) {
+        return e.code() == ErrorCode::ParseJsonError && parser.hasError();
+    }
+    return false;
+}
+
+}  // namespace
+
+// Complete documents
+
+TEST_CASE(WholeDocument) {
+    IncrementalJsonParser parser;
+    parser.feed(R"({"city":"Paris","days":3,"metric":true,"tags":["a","b"],"extra":null})");
+
+    ASSERT_TRUE(parser.isComplete());
+    ASSERT_FALSE(parser.hasError());
+    EXPECT_EQ(parser.value()["city"], "Paris");
+    EXPECT_EQ(parser.value()["days"], 3);
+    EXPECT_EQ(parser.value()["metric"], true);
+    EXPECT_EQ(parser.value()["tags"].size(), 2u);
+    ASSERT_TRUE(parser.value()["extra"].is_null());
+}
+
+TEST_CASE(BytewiseMatchesFullParse) {
+    const std::string text =
+        R"({"q":"café 😀","n":[-1.5e3,0,12],"nested":{"deep":[{"x":"\"\\\/\n"}]},"ok":false})";
+
+    IncrementalJsonParser parser;
+    feedBytewise(parser, text);
+
+    ASSERT_TRUE(parser.isComplete());
+    EXPECT_EQ(parser.value(), nlohmann::json::parse(text));
+    EXPECT_EQ(parser.bytesConsumed(), text.size());
+}
+
+// Partial document semantics
+
+TEST_CASE(PartialStringGrowsInPlace) {
+    IncrementalJsonParser parser;
+    parser.feed(R"({"path":"/tmp/fo)");
+
+    ASSERT_FALSE(parser.isComplete());
+    EXPECT_EQ(parser.value()["path"], "/tmp/fo");
+    ASSERT_FALSE(parser.isFieldComplete("path"));
+
+    parser.feed(R"(o.txt","mode")");
+    EXPECT_EQ(parser.value()["path"], "/tmp/foo.txt");
+    ASSERT_TRUE(parser.isFieldComplete("path"));
+    ASSERT_FALSE(parser.value().contains("mode"));
+}
+
+TEST_CASE(NumbersAppearOnlyWhenComplete) {
+    IncrementalJsonParser parser;
+    parser.feed(R"({"limit":12)");
+    ASSERT_FALSE(parser.value().contains("limit"));
+
+    parser.feed("5}");
+    ASSERT_TRUE(parser.isComplete());
+    EXPECT_EQ(parser.value()["limit"], 125);
+}
+
+TEST_CASE(CompletedFieldsInArrivalOrder) {
+    IncrementalJsonParser parser;
+    parser.feed(R"({"b":{"inner":1},"a":[1,2)");
+
+    EXPECT_EQ(parser.completedFields().size(), 1u);
+    EXPECT_EQ(parser.completedFields()[0], "b");
+    ASSERT_FALSE(parser.isFieldComplete("inner"));
+
+    parser.feed("]}");
+    EXPECT_EQ(parser.completedFields().size(), 2u);
+    EXPECT_EQ(parser.completedFields()[1], "a");
+}
+
+TEST_CASE(EscapeSplitAcrossFragments) {
+    IncrementalJsonParser parser;
+    parser.feed(R"({"s":"x\)");
+    parser.feed(R"(u00)");
+    parser.feed(R"(41\ud83d)");
+    parser.feed(R"(\ude00"})");
+
+    ASSERT_TRUE(parser.isComplete());
+    EXPECT_EQ(parser.value()["s"], "xA\xF0\x9F\x98\x80");
+}
+
+TEST_CASE(ResetStartsNewDocument) {
+    IncrementalJsonParser parser;
+    parser.feed(R"({"a":1})");
+    parser.reset();
+
+    ASSERT_FALSE(parser.isComplete());
+    ASSERT_TRUE(parser.value().is_null());
+    EXPECT_EQ(parser.bytesConsumed(), 0u);
+
+    parser.feed("[true]");
+    ASSERT_TRUE(parser.isComplete());
+    EXPECT_EQ(parser.value(), nlohmann::json::parse("[true]"));
+}
+
+// Malformed input
+
+TEST_CASE(RejectsMalformedInput) {
+    ASSERT_TRUE(throwsParseError(R"({"a" 1})"));
+    ASSERT_TRUE(throwsParseError(R"({"a":tru3})"));
+    ASSERT_TRUE(throwsParseError(R"({"a":1,})"));
+    ASSERT_TRUE(throwsParseError(R"({"a":"\q"})"));
+    ASSERT_TRUE(throwsParseError("{\"a\":\"line\nbreak\"}"));
+    ASSERT_TRUE(throwsParseError(R"({"a":"\udc00"})"));
+    ASSERT_TRUE(throwsParseError(R"({"a":1-2})"));
+    ASSERT_TRUE(throwsParseError(R"({} {})"));
+}
+
+TEST_CASE(RejectsExcessiveNesting) {
+    ASSERT_TRUE(throwsParseError(std::string(IncrementalJsonParser::kMaxDepth + 1, '[')));
+
+    IncrementalJsonParser parser;
+    parser.feed(std::string(IncrementalJsonParser::kMaxDepth, '['));
+    ASSERT_FALSE(parser.hasError());
+}
+
+TEST_CASE(FailedParserIgnoresFurtherInput) {
+    IncrementalJsonParser parser;
+    try {
+        parser.feed("{]");
+    } catch (const AgentError&) {
+    }
+    ASSERT_TRUE(parser.hasError());
+    ASSERT_FALSE(parser.errorMessage().empty());
+
+    parser.feed(R"("a":1})");
+    ASSERT_TRUE(parser.hasError());
+    ASSERT_FALSE(parser.isComplete());
+}
+
+// EventHandler integration
+
+namespace {
+
+class ArgsProbe : public IAgentSubscriber {
+public:
+    std::vector<bool> cityCompleteOnArgs;
+    bool sawParserOnEnd = false;
+
+    AgentStateMutation onToolCallArgs(const ToolCallArgsEvent&, const std::string&,
+                                      const AgentSubscriberParams& params) override {
+        cityCompleteOnArgs.push_back(params.toolCallArgs && params.toolCallArgs->isFieldComplete("city"));
+        return AgentStateMutation();
+    }
+
+    AgentStateMutation onToolCallEnd(const ToolCallEndEvent&, const AgentSubscriberParams& params) override {
+        sawParserOnEnd = params.toolCallArgs && params.toolCallArgs->isComplete();
+        return AgentStateMutation();
+    }
+};
+
+std::unique_ptr<Event> makeArgs(const std::string& id, const std::string& delta) {
+    auto event = std::make_unique<ToolCallArgsEvent>();
+    event->toolCallId = id;
+    event->delta = delta;
+    return event;
+}
+
+}  // namespace
+
+TEST_CASE(EventHandlerExposesParsedArguments) {
+    auto probe = std::make_shared<ArgsProbe>();
+    EventHandler handler({}, nlohmann::json::object(), {probe});
+
+    auto start = std::make_unique<ToolCallStartEvent>();
+    start->toolCallId = "call-1";
+    start->toolCallName = "weather";
+    handler.handleEvent(std::move(start));
+
+    handler.handleEvent(makeArgs("call-1", R"({"city":"Os)"));
+    handler.handleEvent(makeArgs("call-1", R"(lo","days":)"));
+    handler.handleEvent(makeArgs("call-1", "2}"));
+
+    auto end = std::make_unique<ToolCallEndEvent>();
+    end->toolCallId = "call-1";
+    handler.handleEvent(std::move(end));
+
+    EXPECT_EQ(probe->cityCompleteOnArgs.size(), 3u);
+    ASSERT_FALSE(probe->cityCompleteOnArgs[0]);
+    ASSERT_TRUE(probe->cityCompleteOnArgs[1]);
+    ASSERT_TRUE(probe->sawParserOnEnd);
+
+    const IncrementalJsonParser* args = handler.toolCallArguments("call-1");
+    ASSERT_TRUE(args != nullptr);
+    EXPECT_EQ(args->value()["days"], 2);
+
+    handler.clearBuffers();
+    ASSERT_TRUE(handler.toolCallArguments("call-1") == nullptr);
+}
+
+TEST_CASE(EventHandlerToleratesInvalidArguments) {
+    EventHandler handler({}, nlohmann::json::object());
+
+    auto start = std::make_unique<ToolCallStartEvent>();
+    start->toolCallId = "call-2";
+    start->toolCallName = "echo";
+    handler.handleEvent(std::move(start));
+
+    handler.handleEvent(makeArgs("call-2", "not json"));
+    handler.handleEvent(makeArgs("call-2", " at all"));
+
+    const IncrementalJsonParser* args = handler.toolCallArguments("call-2");
+    ASSERT_TRUE(args != nullptr);
+    ASSERT_TRUE(args->hasError());
+    EXPECT_EQ(handler.messages().back().toolCalls().back().function.arguments, "not json at all");
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Incremental JSON Parser Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
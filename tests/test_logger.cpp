@@ -0,0 +1,232 @@
+/**
+ * @file test_logger.cpp
+ * @brief Logger level filtering and asynchronous delivery
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "core/logger.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+// Counts how often it is formatted
+struct Probe {
+    int* formatted;
+};
+
+std::ostream& operator<<(std::ostream& out, const Probe& probe) {
+    ++*probe.formatted;
+    return out << "probe";
+}
+
+struct Delivered {
+    LogLevel level;
+    std::string message;
+    std::thread::id thread;
+};
+
+class Recorder {
+public:
+    LogCallback callback() {
+        return [this](LogLevel level, const std::string& message) {
+            std::lock_guard<std::mutex> lock(mutex);
+            messages.push_back({level, message, std::this_thread::get_id()});
+        };
+    }
+
+    size_t size() {
+        std::lock_guard<std::mutex> lock(mutex);
+        return messages.size();
+    }
+
+    std::mutex mutex;
+    std::vector<Delivered> messages;
+};
+
+}  // namespace
+
+TEST_CASE(DisabledLevelsAreNotFormatted) {
+    int formatted = 0;
+    Logger::setCallback(nullptr);
+    Logger::setMinLevel(LogLevel::Debug);
+    ASSERT_FALSE(Logger::isEnabled(LogLevel::Error));
+    Logger::errorf("no callback: ", Probe{&formatted});
+    EXPECT_EQ(formatted, 0);
+
+    Recorder recorder;
+    Logger::setCallback(recorder.callback());
+    Logger::setMinLevel(LogLevel::Warning);
+    ASSERT_FALSE(Logger::isEnabled(LogLevel::Info));
+    ASSERT_TRUE(Logger::isEnabled(LogLevel::Warning));
+    Logger::infof("below the level: ", Probe{&formatted});
+    Logger::debug("below the level");
+    EXPECT_EQ(formatted, 0);
+    Logger::warningf("value ", 42, ' ', Probe{&formatted});
+    EXPECT_EQ(formatted, 1);
+
+    EXPECT_EQ(recorder.size(), 1u);
+    EXPECT_EQ(recorder.messages[0].message, "value 42 probe");
+    ASSERT_TRUE(recorder.messages[0].level == LogLevel::Warning);
+    EXPECT_EQ(recorder.messages[0].thread, std::this_thread::get_id());
+    Logger::setCallback(nullptr);
+    Logger::setMinLevel(LogLevel::Info);
+}
+
+TEST_CASE(AsyncDeliveryKeepsPerThreadOrder) {
+    Recorder recorder;
+    Logger::setCallback(recorder.callback());
+    Logger::enableAsync(1 << 16);
+    ASSERT_TRUE(Logger::isAsync());
+
+    constexpr int kThreads = 4;
+    constexpr int kMessages = 2000;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < kThreads; ++t) {
+        threads.emplace_back([t] {
+            for (int i = 0; i < kMessages; ++i) {
+                Logger::infof(t, ':', i);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    Logger::flush();
+    EXPECT_EQ(recorder.size(), static_cast<size_t>(kThreads * kMessages));
+
+    std::vector<int> next(kThreads, 0);
+    for (const auto& delivered : recorder.messages) {
+        const size_t colon = delivered.message.find(':');
+        const int thread = std::stoi(delivered.message.substr(0, colon));
+        EXPECT_EQ(std::stoi(delivered.message.substr(colon + 1)), next[thread]);
+        ++next[thread];
+        ASSERT_TRUE(delivered.thread != std::this_thread::get_id());
+    }
+
+    Logger::disableAsync();
+    ASSERT_FALSE(Logger::isAsync());
+    Logger::info("synchronous again");
+    EXPECT_EQ(recorder.messages.back().thread, std::this_thread::get_id());
+    Logger::setCallback(nullptr);
+}
+
+TEST_CASE(FullQueueDropsWithoutBlocking) {
+    std::mutex mutex;
+    std::condition_variable released;
+    bool release = false;
+    std::atomic<int> delivered{0};
+    Logger::setCallback([&](LogLevel, const std::string&) {
+        std::unique_lock<std::mutex> lock(mutex);
+        released.wait(lock, [&] { return release; });
+        ++delivered;
+    });
+    Logger::enableAsync(4);
+
+    // The delivery thread is stuck in the callback, so the queue fills up
+    const uint64_t droppedBefore = Logger::droppedMessages();
+    constexpr int kMessages = 100;
+    for (int i = 0; i < kMessages; ++i) {
+        Logger::info("message");
+    }
+    const uint64_t dropped = Logger::droppedMessages() - droppedBefore;
+    ASSERT_TRUE(dropped >= kMessages - 5u);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        release = true;
+    }
+    released.notify_all();
+    // Disabling delivers whatever was queued
+    Logger::disableAsync();
+    EXPECT_EQ(static_cast<uint64_t>(delivered.load()) + dropped, static_cast<uint64_t>(kMessages));
+    Logger::setCallback(nullptr);
+}
+
+TEST_CASE(AsyncHonoursLevelChanges) {
+    Recorder recorder;
+    Logger::setCallback(recorder.callback());
+    Logger::setMinLevel(LogLevel::Error);
+    Logger::enableAsync();
+    Logger::enableAsync();  // no-op
+    Logger::warning("filtered before queueing");
+    Logger::error("queued");
+    Logger::flush();
+    EXPECT_EQ(recorder.size(), 1u);
+    EXPECT_EQ(recorder.messages[0].message, "queued");
+
+    Logger::setCallback(nullptr);
+    Logger::error("no callback");
+    Logger::disableAsync();
+    EXPECT_EQ(recorder.size(), 1u);
+    Logger::flush();  // no-op when synchronous
+    Logger::setMinLevel(LogLevel::Info);
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Logger Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file test_metrics.cpp
+ * @brief LatencyHistogram, PrometheusMetricsSink and HttpAgent run metrics
+ */
+
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "agent/http_agent.h"
+#include "core/metrics.h"
+#include "scripted_http_service.h"
+
+using namespace agui;
+using namespace std::chrono_literals;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+std::string sse(const std::string& json) {
+    return "data: " + json + "\n\n";
+}
+
+// Delivers scripted chunks with a pause before each, then completes with fixed timings
+std::shared_ptr<ScriptedHttpService> pacedService(std::vector<std::string> chunks, std::chrono::milliseconds pause) {
+    auto service = std::make_shared<ScriptedHttpService>(std::move(chunks));
+    service->pause = pause;
+    service->timings = ScriptedHttpService::sampleTimings();
+    return service;
+}
+
+class RecordingSink : public IMetricsSink {
+public:
+    void onRunCompleted(const RunMetrics& metrics) override { runs.push_back(metrics); }
+
+    std::vector<RunMetrics> runs;
+};
+
+bool contains(const std::string& text, const std::string& part) {
+    return text.find(part) != std::string::npos;
+}
+
+}  // namespace
+
+// LatencyHistogram
+
+TEST_CASE(HistogramBucketsAndQuantiles) {
+    LatencyHistogram histogram;
+    EXPECT_EQ(histogram.quantile(0.5), 0ns);
+    histogram.record(0ns);
+    histogram.record(10us);   // on the first bound
+    histogram.record(15us);   // second bucket (<= 20 us)
+    histogram.record(1ms);    // <= 1.28 ms
+    histogram.record(-5ns);   // clamped to 0
+    histogram.record(10min);  // overflow
+
+    EXPECT_EQ(histogram.count(), 6u);
+    EXPECT_EQ(histogram.bucketCount(0), 3u);
+    EXPECT_EQ(histogram.bucketCount(1), 1u);
+    EXPECT_EQ(histogram.bucketCount(7), 1u);
+    EXPECT_EQ(histogram.bucketCount(LatencyHistogram::kBounds), 1u);
+    EXPECT_EQ(histogram.max(), std::chrono::nanoseconds(10min));
+    EXPECT_EQ(histogram.quantile(0.5), 10us);
+    EXPECT_EQ(histogram.quantile(0.6), 20us);
+    EXPECT_EQ(histogram.quantile(0.8), LatencyHistogram::bucketBound(7));
+    EXPECT_EQ(histogram.quantile(1.0), std::chrono::nanoseconds(10min));
+
+    LatencyHistogram other;
+    other.record(15us);
+    histogram.merge(other);
+    EXPECT_EQ(histogram.count(), 7u);
+    EXPECT_EQ(histogram.bucketCount(1), 2u);
+    EXPECT_EQ(histogram.sum(), std::chrono::nanoseconds(10min) + 1ms + 40us);
+}
+
+// PrometheusMetricsSink
+
+TEST_CASE(PrometheusRendersCountersAndHistograms) {
+    PrometheusMetricsSink sink("test");
+    RunMetrics run;
+    run.agentId = "planner";
+    run.succeeded = true;
+    run.events = 12;
+    run.bytes = 3400;
+    run.timeToRunStarted = 15us;
+    run.eventGaps.record(5us);
+    run.eventGaps.record(30ms);
+    sink.onRunCompleted(run);
+    run.succeeded = false;
+    sink.onRunCompleted(run);
+    RunMetrics other;
+    other.agentId = "say \"hi\"\n";
+    sink.onRunCompleted(other);
+
+    const std::string text = sink.render();
+    ASSERT_TRUE(contains(text, "# TYPE test_runs_total counter\n"));
+    ASSERT_TRUE(contains(text, "test_runs_total{agent=\"planner\",outcome=\"success\"} 1\n"));
+    ASSERT_TRUE(contains(text, "test_runs_total{agent=\"planner\",outcome=\"failure\"} 1\n"));
+    ASSERT_TRUE(contains(text, "test_run_events_total{agent=\"planner\"} 24\n"));
+    ASSERT_TRUE(contains(text, "test_run_bytes_total{agent=\"planner\"} 6800\n"));
+    ASSERT_TRUE(contains(text, "test_runs_total{agent=\"say \\\"hi\\\"\\n\",outcome=\"failure\"} 1\n"));
+
+    // Buckets are cumulative and end with +Inf == _count
+    ASSERT_TRUE(contains(text, "# TYPE test_event_gap_seconds histogram\n"));
+    ASSERT_TRUE(contains(text, "test_event_gap_seconds_bucket{agent=\"planner\",le=\"1e-05\"} 2\n"));
+    ASSERT_TRUE(contains(text, "test_event_gap_seconds_bucket{agent=\"planner\",le=\"0.02048\"} 2\n"));
+    ASSERT_TRUE(contains(text, "test_event_gap_seconds_bucket{agent=\"planner\",le=\"0.04096\"} 4\n"));
+    ASSERT_TRUE(contains(text, "test_event_gap_seconds_bucket{agent=\"planner\",le=\"+Inf\"} 4\n"));
+    ASSERT_TRUE(contains(text, "test_event_gap_seconds_sum{agent=\"planner\"} 0.06001\n"));
+    ASSERT_TRUE(contains(text, "test_event_gap_seconds_count{agent=\"planner\"} 4\n"));
+    ASSERT_TRUE(contains(text, "test_run_started_seconds_count{agent=\"planner\"} 2\n"));
+    // Runs without HTTP timings or a RUN_STARTED are not recorded as zero
+    ASSERT_TRUE(contains(text, "test_http_first_byte_seconds_count{agent=\"planner\"} 0\n"));
+    ASSERT_TRUE(contains(text, "test_run_started_seconds_count{agent=\"say \\\"hi\\\"\\n\"} 0\n"));
+}
+
+// HttpAgent
+
+TEST_CASE(AgentReportsRunMetrics) {
+    auto sink = std::make_shared<RecordingSink>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withAgentId("writer").withMetricsSink(sink).build();
+    const std::vector<std::string> chunks = {
+        sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+        sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})") +
+            sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":"m1","delta":"Hi"})"),
+        sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":"m1","delta":" there"})"),
+        sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})") +
+            sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})")};
+    size_t bytes = 0;
+    for (const auto& chunk : chunks) {
+        bytes += chunk.size();
+    }
+    agent->setHttpService(pacedService(chunks, 5ms));
+    RunAgentParams params;
+    params.threadId = "thread-1";
+    params.runId = "run-1";
+    bool succeeded = false;
+    agent->runAgent(params, [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(sink->runs.size(), 1u);
+    const RunMetrics& metrics = sink->runs.front();
+    EXPECT_EQ(metrics.agentId, "writer");
+    EXPECT_EQ(metrics.threadId, "thread-1");
+    EXPECT_EQ(metrics.runId, "run-1");
+    ASSERT_TRUE(metrics.succeeded);
+    EXPECT_EQ(metrics.events, 6u);
+    EXPECT_EQ(metrics.chunks, 4u);
+    EXPECT_EQ(metrics.bytes, bytes);
+    EXPECT_EQ(metrics.eventGaps.count(), 5u);
+    // Three of the gaps span a paced read
+    ASSERT_TRUE(metrics.eventGaps.sum() >= 15ms);
+
+    ASSERT_TRUE(metrics.timeToFirstChunk && metrics.timeToRunStarted && metrics.timeToFirstContent);
+    ASSERT_TRUE(*metrics.timeToFirstChunk >= 5ms);
+    ASSERT_TRUE(*metrics.timeToRunStarted >= *metrics.timeToFirstChunk);
+    ASSERT_TRUE(*metrics.timeToFirstContent >= *metrics.timeToRunStarted + 5ms);
+    ASSERT_TRUE(metrics.duration >= *metrics.timeToFirstContent + 10ms);
+    ASSERT_TRUE(metrics.requestBuild > 0ns && metrics.requestBuild < *metrics.timeToFirstChunk);
+    ASSERT_TRUE(metrics.parseTime > 0ns && metrics.dispatchTime > 0ns);
+    ASSERT_TRUE(metrics.http.has_value());
+    EXPECT_EQ(metrics.http->firstByte, 2ms);
+    EXPECT_EQ(agent->lastRunMetrics().events, 6u);
+}
+
+TEST_CASE(PipelinedRunsSplitParseAndDispatch) {
+    auto sink = std::make_shared<RecordingSink>();
+    auto agent =
+        HttpAgent::builder().withUrl("http://localhost").withPipelinedProcessing().withMetricsSink(sink).build();
+    std::vector<std::string> chunks = {sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+                                       sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})")};
+    agent->setHttpService(pacedService(chunks, 1ms));
+    bool succeeded = false;
+    agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(sink->runs.size(), 1u);
+    EXPECT_EQ(sink->runs.front().events, 2u);
+    ASSERT_TRUE(sink->runs.front().parseTime > 0ns);
+    ASSERT_TRUE(sink->runs.front().dispatchTime > 0ns);
+}
+
+TEST_CASE(AgentReportsFailedRuns) {
+    auto sink = std::make_shared<RecordingSink>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").build();
+    auto service = std::make_shared<ScriptedHttpService>();
+    service->fail = true;
+    agent->setHttpService(service);
+
+    // No sink: nothing is collected
+    agent->runAgent(RunAgentParams(), nullptr, nullptr);
+    EXPECT_EQ(agent->lastRunMetrics().duration, 0ns);
+
+    agent->setMetricsSink(sink);
+    std::string error;
+    agent->runAgent(RunAgentParams(), nullptr, [&](const std::string& message) { error = message; });
+    ASSERT_FALSE(error.empty());
+    EXPECT_EQ(sink->runs.size(), 1u);
+    ASSERT_FALSE(sink->runs.front().succeeded);
+    EXPECT_EQ(sink->runs.front().events, 0u);
+    ASSERT_FALSE(sink->runs.front().http.has_value());
+    ASSERT_TRUE(sink->runs.front().duration > 0ns);
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Metrics Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,377 @@
+/**
+ * @file test_middleware_chain.cpp
+ * @brief MiddlewareChain event dispatch tests: hook ordering, hook flags and allocations,
+ *        plus the built-in request middlewares
+ */
+
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "core/logger.h"
+#include "middleware/history_compaction_middleware.h"
+#include "middleware/middleware.h"
+
+using namespace agui;
+
+// Counts global allocations so tests can assert the pass-through path is allocation-free
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t size) {
+    ++g_allocations;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+std::unique_ptr<Event> makeContent(const std::string& delta) {
+    auto event = std::make_unique<TextMessageContentEvent>();
+    event->messageId = "m1";
+    event->delta = delta;
+    return event;
+}
+
+std::string deltaOf(const Event& event) {
+    return static_cast<const TextMessageContentEvent&>(event).delta;
+}
+
+// Overrides onEvent only and says so
+class PassThroughMiddleware : public IMiddleware {
+public:
+    int seen = 0;
+
+    std::unique_ptr<Event> onEvent(std::unique_ptr<Event> event, MiddlewareContext&) override {
+        seen++;
+        return event;
+    }
+
+    uint32_t eventHooks() const override { return HookOnEvent; }
+};
+
+// Injects tagged events around every event and relies on the default hook flags
+class InjectingMiddleware : public IMiddleware {
+public:
+    explicit InjectingMiddleware(std::string tag) : m_tag(std::move(tag)) {}
+
+    std::vector<std::unique_ptr<Event>> beforeEvent(const Event&, MiddlewareContext&) override {
+        std::vector<std::unique_ptr<Event>> events;
+        events.push_back(makeContent(m_tag + "-before"));
+        return events;
+    }
+
+    std::vector<std::unique_ptr<Event>> afterEvent(const Event&, MiddlewareContext&) override {
+        std::vector<std::unique_ptr<Event>> events;
+        events.push_back(makeContent(m_tag + "-after"));
+        return events;
+    }
+
+private:
+    std::string m_tag;
+};
+
+// Declares no hooks, so its (throwing) overrides must never run
+class UndeclaredMiddleware : public IMiddleware {
+public:
+    bool shouldProcessEvent(const Event&, MiddlewareContext&) override {
+        throw std::runtime_error("shouldProcessEvent called");
+    }
+    std::unique_ptr<Event> onEvent(std::unique_ptr<Event>, MiddlewareContext&) override {
+        throw std::runtime_error("onEvent called");
+    }
+
+    uint32_t eventHooks() const override { return 0; }
+};
+
+std::vector<std::string> deltas(const std::vector<std::unique_ptr<Event>>& events) {
+    std::vector<std::string> result;
+    for (const auto& event : events) {
+        result.push_back(deltaOf(*event));
+    }
+    return result;
+}
+
+// System prompt, then per turn: user, assistant calling a tool, tool result, reasoning
+// and assistant answer
+RunAgentInput conversation(size_t turns, size_t toolResultSize) {
+    RunAgentInput input;
+    input.threadId = "thread";
+    input.runId = "run";
+    input.messages.push_back(Message::createWithId("sys", MessageRole::System, "be brief"));
+    for (size_t turn = 0; turn < turns; ++turn) {
+        const std::string id = std::to_string(turn);
+        input.messages.push_back(Message::createWithId("user-" + id, MessageRole::User, "question " + id));
+        Message call = Message::createWithId("call-" + id, MessageRole::Assistant);
+        ToolCall toolCall;
+        toolCall.id = "tc-" + id;
+        toolCall.function = FunctionCall("search", R"({"q":")" + id + R"("})");
+        call.addToolCall(toolCall);
+        input.messages.push_back(call);
+        std::string result = "r" + id + ":caf\xc3\xa9";
+        result.resize(toolResultSize, 'x');
+        input.messages.push_back(Message::createWithId("tool-" + id, MessageRole::Tool, result, "", toolCall.id));
+        input.messages.push_back(Message::createWithId("think-" + id, MessageRole::Reasoning, "thinking"));
+        input.messages.push_back(Message::createWithId("answer-" + id, MessageRole::Assistant, "answer " + id));
+    }
+    return input;
+}
+
+std::vector<std::string> ids(const RunAgentInput& input) {
+    std::vector<std::string> result;
+    for (const auto& message : input.messages) {
+        result.push_back(message.id());
+    }
+    return result;
+}
+
+}  // namespace
+
+TEST_CASE(PassThroughChainDoesNotAllocate) {
+    MiddlewareChain chain;
+    std::vector<std::shared_ptr<PassThroughMiddleware>> middlewares;
+    for (int i = 0; i < 5; ++i) {
+        middlewares.push_back(std::make_shared<PassThroughMiddleware>());
+        chain.addMiddleware(middlewares.back());
+    }
+    MiddlewareContext context(nullptr, nullptr);
+
+    std::vector<std::unique_ptr<Event>> out;
+    out.reserve(4);
+    std::vector<std::unique_ptr<Event>> inputs;
+    for (int i = 0; i < 100; ++i) {
+        inputs.push_back(makeContent("x"));
+    }
+
+    const size_t before = g_allocations.load();
+    for (auto& input : inputs) {
+        out.clear();
+        chain.processEvent(std::move(input), context, out);
+    }
+    const size_t allocations = g_allocations.load() - before;
+
+    EXPECT_EQ(allocations, 0u);
+    EXPECT_EQ(out.size(), 1u);
+    EXPECT_EQ(middlewares.front()->seen, 100);
+    EXPECT_EQ(middlewares.back()->seen, 100);
+}
+
+TEST_CASE(UndeclaredHooksAreSkipped) {
+    MiddlewareChain chain;
+    chain.addMiddleware(std::make_shared<UndeclaredMiddleware>());
+    MiddlewareContext context(nullptr, nullptr);
+
+    auto out = chain.processEvent(makeContent("x"), context);
+    EXPECT_EQ(deltas(out), (std::vector<std::string>{"x"}));
+}
+
+TEST_CASE(InjectionOrderIsPreserved) {
+    MiddlewareChain chain;
+    chain.addMiddleware(std::make_shared<InjectingMiddleware>("a"));
+    chain.addMiddleware(std::make_shared<PassThroughMiddleware>());
+    chain.addMiddleware(std::make_shared<InjectingMiddleware>("b"));
+    MiddlewareContext context(nullptr, nullptr);
+
+    auto out = chain.processEvent(makeContent("x"), context);
+    EXPECT_EQ(deltas(out), (std::vector<std::string>{"a-before", "b-before", "x", "b-after", "a-after"}));
+}
+
+TEST_CASE(RemoveMiddlewareKeepsHooksAligned) {
+    MiddlewareChain chain;
+    auto injecting = std::make_shared<InjectingMiddleware>("a");
+    chain.addMiddleware(injecting);
+    chain.addMiddleware(std::make_shared<UndeclaredMiddleware>());
+    chain.removeMiddleware(injecting);
+    MiddlewareContext context(nullptr, nullptr);
+
+    EXPECT_EQ(chain.size(), 1u);
+    auto out = chain.processEvent(makeContent("x"), context);
+    EXPECT_EQ(deltas(out), (std::vector<std::string>{"x"}));
+}
+
+// Logging
+
+TEST_CASE(LoggingCountsRegisteredAndPerRunTools) {
+    if (AGUI_LOG_MIN_LEVEL > 0) {
+        return;  // debug messages are compiled out
+    }
+    auto tool = [](const std::string& name) {
+        Tool definition;
+        definition.name = name;
+        return definition;
+    };
+    RunAgentInput input;
+    input.toolSchemas = std::make_shared<ToolSchemaSet>(std::vector<Tool>{tool("a"), tool("b")});
+    input.tools = {tool("a"), tool("c")};  // "a" replaces the registered one
+
+    std::vector<std::string> lines;
+    Logger::setMinLevel(LogLevel::Debug);
+    Logger::setCallback([&lines](LogLevel, const std::string& message) { lines.push_back(message); });
+    LoggingMiddleware logging;
+    MiddlewareContext context(&input, nullptr);
+    logging.onRequest(input, context);
+    Logger::setCallback(nullptr);
+    Logger::setMinLevel(LogLevel::Info);
+
+    bool found = false;
+    for (const auto& line : lines) {
+        found = found || line.find("Tools: 3 (1 registered)") != std::string::npos;
+    }
+    ASSERT_TRUE(found);
+}
+
+// History compaction
+
+TEST_CASE(CompactionCollapsesOldToolResults) {
+    HistoryCompactionMiddleware::Options options;
+    options.keepLastTurns = 1;
+    options.toolResultPreviewBytes = 7;  // inside the two-byte UTF-8 sequence
+    HistoryCompactionMiddleware compaction(options);
+    RunAgentInput input = conversation(2, 1000);
+    input.messages.push_back(Message::createWithId("activity", MessageRole::Activity, "{}"));
+    MiddlewareContext context(&input, nullptr);
+
+    RunAgentInput output = compaction.onRequest(input, context);
+    EXPECT_EQ(ids(output), (std::vector<std::string>{"sys", "user-0", "call-0", "tool-0", "answer-0", "user-1",
+                                                     "call-1", "tool-1", "answer-1"}));
+    EXPECT_EQ(output.messages[3].content(), "r0:caf\n[994 bytes of tool output omitted]");
+    EXPECT_EQ(output.messages[3].toolCallId(), "tc-0");
+    EXPECT_EQ(output.messages[7].content(), input.messages[8].content());
+    std::string body;
+    output.appendJson(body);  // still valid UTF-8
+
+    const auto& stats = compaction.stats();
+    EXPECT_EQ(stats.requestsCompacted, 1u);
+    EXPECT_EQ(stats.messagesDropped, 3u);
+    EXPECT_EQ(stats.toolResultsCollapsed, 1u);
+    EXPECT_EQ(stats.bytesSaved(), compaction.lastBytesSaved());
+    ASSERT_TRUE(compaction.lastBytesSaved() > 950);
+}
+
+TEST_CASE(CompactionDropsOldestTurnsOverBudget) {
+    HistoryCompactionMiddleware::Options options;
+    options.keepLastTurns = 2;
+    options.oldToolResults = HistoryCompactionMiddleware::ToolResultPolicy::Keep;
+    options.maxTokens = 800;  // 3200 bytes: the two recent turns and one more
+    HistoryCompactionMiddleware compaction(options);
+    RunAgentInput input = conversation(6, 1000);
+    MiddlewareContext context(&input, nullptr);
+
+    RunAgentInput output = compaction.onRequest(input, context);
+    EXPECT_EQ(ids(output), (std::vector<std::string>{"sys", "user-3", "call-3", "tool-3", "answer-3", "user-4",
+                                                     "call-4", "tool-4", "answer-4", "user-5", "call-5", "tool-5",
+                                                     "answer-5"}));
+    EXPECT_EQ(output.messages[3].content().size(), 1000u);
+
+    // The recent turns stay even when they alone exceed the budget
+    options.maxBytes = 100;
+    HistoryCompactionMiddleware strict(options);
+    output = strict.onRequest(input, context);
+    EXPECT_EQ(output.messages.size(), 9u);
+    EXPECT_EQ(output.messages.front().id(), "sys");
+    EXPECT_EQ(output.messages[1].id(), "user-4");
+}
+
+TEST_CASE(CompactedHistoryKeepsMessageCacheHits) {
+    HistoryCompactionMiddleware::Options options;
+    options.keepLastTurns = 1;
+    options.oldToolResults = HistoryCompactionMiddleware::ToolResultPolicy::Summarize;
+    options.summarizer = [](const Message& message) { return "summary of " + message.id(); };
+    HistoryCompactionMiddleware compaction(options);
+    RunAgentInput input = conversation(4, 500);
+    MiddlewareContext context(&input, nullptr);
+    MessageJsonCache cache;
+    std::string body;
+
+    RunAgentInput first = compaction.onRequest(input, context);
+    first.appendJson(body, &cache);
+    EXPECT_EQ(first.messages[3].content(), "summary of tool-0");
+    const uint64_t misses = cache.misses();
+
+    RunAgentInput second = compaction.onRequest(input, context);
+    EXPECT_EQ(second.messages[3].revision(), first.messages[3].revision());
+    body.clear();
+    second.appendJson(body, &cache);
+    EXPECT_EQ(cache.misses(), misses);
+
+    // Nothing to remove: the input is passed through
+    options.dropReasoningMessages = false;
+    options.oldToolResults = HistoryCompactionMiddleware::ToolResultPolicy::Keep;
+    HistoryCompactionMiddleware passThrough(options);
+    EXPECT_EQ(passThrough.onRequest(input, context).messages.size(), input.messages.size());
+    EXPECT_EQ(passThrough.stats().requestsCompacted, 0u);
+    EXPECT_EQ(passThrough.lastBytesSaved(), 0u);
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi MiddlewareChain Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,454 @@
+/**
+ * @file test_tool_executor.cpp
+ * @brief ToolRegistry, ToolExecutor and ToolRunner tests (scripted HTTP service, no network)
+ */
+
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "agent/tool_executor.h"
+#include "scripted_http_service.h"
+
+using namespace agui;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+
+namespace {
+
+std::string sse(const std::string& json) {
+    return "data: " + json + "\n\n";
+}
+
+// Serves one scripted response per request; the last one repeats
+std::shared_ptr<ScriptedHttpService> scriptedTurns(std::vector<std::vector<std::string>> turns) {
+    auto service = std::make_shared<ScriptedHttpService>();
+    service->turns = std::move(turns);
+    return service;
+}
+
+// Parsed body of the service's index-th request
+nlohmann::json requestBody(const ScriptedHttpService& service, size_t index) {
+    return nlohmann::json::parse(service.requests.at(index).body);
+}
+
+std::vector<std::string> toolTurn(const std::vector<std::pair<std::string, std::string>>& calls) {
+    std::vector<std::string> chunks;
+    chunks.push_back(sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"));
+    for (const auto& call : calls) {
+        const std::string id = call.first + "-call";
+        chunks.push_back(sse(nlohmann::json{{"type", "TOOL_CALL_START"}, {"toolCallId", id},
+                                            {"toolCallName", call.first}, {"parentMessageId", "a1"}}
+                                 .dump()));
+        chunks.push_back(
+            sse(nlohmann::json{{"type", "TOOL_CALL_ARGS"}, {"toolCallId", id}, {"delta", call.second}}.dump()));
+        chunks.push_back(sse(nlohmann::json{{"type", "TOOL_CALL_END"}, {"toolCallId", id}}.dump()));
+    }
+    chunks.push_back(sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})"));
+    return chunks;
+}
+
+std::vector<std::string> answerTurn() {
+    return {sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r2"})"),
+            sse(R"({"type":"TEXT_MESSAGE_START","messageId":"a2","role":"assistant"})"),
+            sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":"a2","delta":"done"})"),
+            sse(R"({"type":"TEXT_MESSAGE_END","messageId":"a2"})"),
+            sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r2"})")};
+}
+
+Tool tool(const std::string& name) {
+    Tool definition;
+    definition.name = name;
+    definition.description = name + " tool";
+    definition.parameters = {{"type", "object"}};
+    return definition;
+}
+
+ToolHandler sleepingTool(std::chrono::milliseconds delay, const std::string& output) {
+    return [delay, output](const nlohmann::json&) {
+        std::this_thread::sleep_for(delay);
+        return output;
+    };
+}
+
+std::unique_ptr<HttpAgent> makeAgent(std::shared_ptr<ScriptedHttpService> service) {
+    auto agent = HttpAgent::builder().withUrl("http://localhost/agent").build();
+    agent->setHttpService(std::move(service));
+    return agent;
+}
+
+}  // namespace
+
+// ToolExecutor
+
+TEST_CASE(ToolStartsOnToolCallEnd) {
+    auto registry = std::make_shared<ToolRegistry>();
+    std::atomic<bool> ran{false};
+    nlohmann::json received;
+    registry->add(tool("lookup"), [&](const nlohmann::json& args) {
+        received = args;
+        ran = true;
+        return std::string("found");
+    });
+    auto executor = std::make_shared<ToolExecutor>(registry, std::make_shared<WorkStealingExecutor>(1));
+
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(executor);
+    auto start = std::make_unique<ToolCallStartEvent>();
+    start->toolCallId = "c1";
+    start->toolCallName = "lookup";
+    handler.handleEvent(std::move(start));
+    auto args = std::make_unique<ToolCallArgsEvent>();
+    args->toolCallId = "c1";
+    args->delta = R"({"q":"x"})";
+    handler.handleEvent(std::move(args));
+    EXPECT_EQ(executor->startedTools(), 0u);
+
+    auto end = std::make_unique<ToolCallEndEvent>();
+    end->toolCallId = "c1";
+    handler.handleEvent(std::move(end));
+    EXPECT_EQ(executor->startedTools(), 1u);
+
+    std::vector<ToolResult> results = executor->collectResults();
+    ASSERT_TRUE(ran.load());
+    EXPECT_EQ(received["q"], "x");
+    EXPECT_EQ(results.size(), 1u);
+    EXPECT_EQ(results[0].toolCallId, "c1");
+    EXPECT_EQ(results[0].content, "found");
+    ASSERT_TRUE(results[0].succeeded);
+    EXPECT_EQ(results[0].toMessage().toolCallId(), "c1");
+    EXPECT_EQ(executor->startedTools(), 0u);
+}
+
+TEST_CASE(SpeculativeToolStartsOnRequiredFields) {
+    auto registry = std::make_shared<ToolRegistry>();
+    std::atomic<int> calls{0};
+    Tool weather = tool("weather");
+    weather.parameters["required"] = {"city"};
+    ToolRegistry::Options options;
+    options.speculative = true;
+    registry->add(weather, [&](const nlohmann::json& args) {
+        calls++;
+        return args.dump();
+    }, options);
+    auto executor = std::make_shared<ToolExecutor>(registry, std::make_shared<WorkStealingExecutor>(1));
+
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(executor);
+    auto start = std::make_unique<ToolCallStartEvent>();
+    start->toolCallId = "c1";
+    start->toolCallName = "weather";
+    handler.handleEvent(std::move(start));
+    for (const char* delta : {R"({"city":"Par)", R"(is")", "}"}) {
+        auto args = std::make_unique<ToolCallArgsEvent>();
+        args->toolCallId = "c1";
+        args->delta = delta;
+        handler.handleEvent(std::move(args));
+        // Started by the delta that completes "city", before TOOL_CALL_END
+        EXPECT_EQ(executor->speculationStats().started, std::string(delta) == R"({"city":"Par)" ? 0u : 1u);
+    }
+    EXPECT_EQ(executor->startedTools(), 0u);
+
+    auto end = std::make_unique<ToolCallEndEvent>();
+    end->toolCallId = "c1";
+    handler.handleEvent(std::move(end));
+    EXPECT_EQ(executor->startedTools(), 1u);
+
+    std::vector<ToolResult> results = executor->collectResults();
+    EXPECT_EQ(results.size(), 1u);
+    EXPECT_EQ(nlohmann::json::parse(results[0].content)["city"], "Paris");
+    EXPECT_EQ(calls.load(), 1);
+    SpeculationStats stats = executor->speculationStats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 0u);
+}
+
+TEST_CASE(SpeculationRerunsWhenArgumentsChange) {
+    auto registry = std::make_shared<ToolRegistry>();
+    std::atomic<int> calls{0};
+    ToolRegistry::Options options;
+    options.speculative = true;
+    options.requiredFields = {"city"};
+    registry->add(tool("weather"), [&](const nlohmann::json& args) {
+        calls++;
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        return args.dump();
+    }, options);
+    auto pool = std::make_shared<WorkStealingExecutor>(1);
+    auto executor = std::make_shared<ToolExecutor>(registry, pool);
+
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(executor);
+    auto start = std::make_unique<ToolCallStartEvent>();
+    start->toolCallId = "c1";
+    start->toolCallName = "weather";
+    handler.handleEvent(std::move(start));
+    for (const char* delta : {R"({"city":"Paris",)", R"("unit":"C"})"}) {
+        auto args = std::make_unique<ToolCallArgsEvent>();
+        args->toolCallId = "c1";
+        args->delta = delta;
+        handler.handleEvent(std::move(args));
+    }
+    auto end = std::make_unique<ToolCallEndEvent>();
+    end->toolCallId = "c1";
+    handler.handleEvent(std::move(end));
+
+    // The speculative result ({"city"} only) is discarded for the rerun with every field
+    std::vector<ToolResult> results = executor->collectResults();
+    EXPECT_EQ(results.size(), 1u);
+    EXPECT_EQ(nlohmann::json::parse(results[0].content)["unit"], "C");
+    EXPECT_EQ(calls.load(), 2);
+    SpeculationStats stats = executor->speculationStats();
+    EXPECT_EQ(stats.started, 1u);
+    EXPECT_EQ(stats.hits, 0u);
+    EXPECT_EQ(stats.misses, 1u);
+    // The discarded call may still be queued; its time counts once it has run
+    pool->shutdown();
+    ASSERT_TRUE(executor->speculationStats().wastedTime >= std::chrono::milliseconds(5));
+}
+
+TEST_CASE(UnconfirmedSpeculationIsDiscarded) {
+    auto registry = std::make_shared<ToolRegistry>();
+    ToolRegistry::Options options;
+    options.speculative = true;
+    registry->add(tool("lookup"), sleepingTool(std::chrono::milliseconds(0), "found"), options);
+    auto executor = std::make_shared<ToolExecutor>(registry, std::make_shared<WorkStealingExecutor>(1));
+
+    EventHandler handler({}, nlohmann::json::object());
+    handler.addSubscriber(executor);
+    auto start = std::make_unique<ToolCallStartEvent>();
+    start->toolCallId = "c1";
+    start->toolCallName = "lookup";
+    handler.handleEvent(std::move(start));
+    auto args = std::make_unique<ToolCallArgsEvent>();
+    args->toolCallId = "c1";
+    args->delta = R"({"q":"x"})";
+    handler.handleEvent(std::move(args));
+    // No required fields: started once the whole document parsed
+    EXPECT_EQ(executor->speculationStats().started, 1u);
+
+    // The stream ended without TOOL_CALL_END
+    EXPECT_EQ(executor->collectResults().size(), 0u);
+    EXPECT_EQ(executor->speculationStats().misses, 1u);
+}
+
+// ToolRunner
+
+TEST_CASE(RunnerExecutesToolsInParallelAndLoops) {
+    auto service = scriptedTurns(std::vector<std::vector<std::string>>{
+        toolTurn({{"weather", R"({"city":"Paris"})"}, {"news", "{}"}}), answerTurn()});
+    auto agent = makeAgent(service);
+    auto registry = std::make_shared<ToolRegistry>();
+    registry->add(tool("weather"), sleepingTool(std::chrono::milliseconds(150), "sunny"));
+    registry->add(tool("news"), sleepingTool(std::chrono::milliseconds(150), "quiet"));
+
+    ToolRunner runner(*agent, registry, std::make_shared<WorkStealingExecutor>(2));
+    RunAgentParams params;
+    params.addUserMessage("What is new?");
+    bool succeeded = false;
+    RunAgentResult final;
+    const auto start = std::chrono::steady_clock::now();
+    runner.run(params, [&](const RunAgentResult& result) {
+        succeeded = true;
+        final = result;
+    }, nullptr);
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(runner.turns(), 2u);
+    EXPECT_EQ(runner.results().size(), 2u);
+    // Serial execution would take at least 300 ms
+    ASSERT_TRUE(elapsed < std::chrono::milliseconds(290));
+
+    // The second request carries the history in order, ending with both tool results
+    EXPECT_EQ(service->requests.size(), 2u);
+    const nlohmann::json messages = requestBody(*service, 1)["messages"];
+    EXPECT_EQ(messages.size(), 4u);
+    EXPECT_EQ(messages[0]["role"], "user");
+    EXPECT_EQ(messages[1]["role"], "assistant");
+    EXPECT_EQ(messages[2]["role"], "tool");
+    EXPECT_EQ(messages[2]["toolCallId"], "weather-call");
+    EXPECT_EQ(messages[2]["content"], "sunny");
+    EXPECT_EQ(messages[3]["toolCallId"], "news-call");
+    EXPECT_EQ(requestBody(*service, 0)["tools"].size(), 2u);
+    EXPECT_EQ(requestBody(*service, 0)["threadId"], requestBody(*service, 1)["threadId"]);
+
+    // Assistant tool calls, both tool messages and the final answer
+    EXPECT_EQ(final.newMessages.size(), 4u);
+    EXPECT_EQ(final.newMessages.back().content(), "done");
+}
+
+TEST_CASE(RunnerReportsToolFailures) {
+    auto service = scriptedTurns(std::vector<std::vector<std::string>>{
+        toolTurn({{"slow", "{}"}, {"broken", "{}"}, {"strict", "not json"}}), answerTurn()});
+    auto agent = makeAgent(service);
+    auto registry = std::make_shared<ToolRegistry>();
+    registry->add(tool("slow"), sleepingTool(std::chrono::milliseconds(500), "late"), std::chrono::milliseconds(50));
+    registry->add(tool("broken"), [](const nlohmann::json&) -> std::string { throw std::runtime_error("db down"); });
+    registry->add(tool("strict"), sleepingTool(std::chrono::milliseconds(0), "unused"));
+
+    ToolRunner runner(*agent, registry, std::make_shared<WorkStealingExecutor>(2));
+    bool succeeded = false;
+    runner.run(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    const auto& results = runner.results();
+    EXPECT_EQ(results.size(), 3u);
+    ASSERT_TRUE(results[0].timedOut);
+    ASSERT_TRUE(results[0].content.find("timed out") != std::string::npos);
+    ASSERT_FALSE(results[1].succeeded);
+    EXPECT_EQ(nlohmann::json::parse(results[1].content)["error"], "db down");
+    ASSERT_FALSE(results[2].succeeded);
+    ASSERT_TRUE(results[2].content.find("Invalid tool arguments") != std::string::npos);
+}
+
+TEST_CASE(HungToolDoesNotBlockLaterWork) {
+    auto service = scriptedTurns(std::vector<std::vector<std::string>>{
+        toolTurn({{"hang", "{}"}}), toolTurn({{"quick", "{}"}}), answerTurn()});
+    auto agent = makeAgent(service);
+
+    // Blocks until released at the end of the test, long after its timeout
+    auto release = std::make_shared<std::atomic<bool>>(false);
+    auto registry = std::make_shared<ToolRegistry>();
+    registry->add(tool("hang"), [release](const nlohmann::json&) {
+        while (!release->load()) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return std::string("late");
+    }, std::chrono::milliseconds(50));
+    registry->add(tool("quick"), sleepingTool(std::chrono::milliseconds(0), "fast"), std::chrono::milliseconds(2000));
+
+    // Default executor: the hung handler must not hold up the next turn's tool
+    ToolRunner runner(*agent, registry);
+    bool succeeded = false;
+    runner.run(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    // Nor the executor shared with AsyncSubscriber
+    auto ran = std::make_shared<std::atomic<bool>>(false);
+    defaultExecutor()->submit([ran]() { ran->store(true); });
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(2);
+    while (!ran->load() && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    release->store(true);
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(runner.turns(), 3u);
+    const auto& results = runner.results();
+    EXPECT_EQ(results.size(), 2u);
+    ASSERT_TRUE(results[0].timedOut);
+    ASSERT_TRUE(results[1].succeeded);
+    EXPECT_EQ(results[1].content, "fast");
+    ASSERT_TRUE(ran->load());
+}
+
+TEST_CASE(RunnerIgnoresUnregisteredTools) {
+    auto service = scriptedTurns(
+        std::vector<std::vector<std::string>>{toolTurn({{"frontend_only", "{}"}})});
+    auto agent = makeAgent(service);
+    ToolRunner runner(*agent, std::make_shared<ToolRegistry>());
+    bool succeeded = false;
+    runner.run(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    EXPECT_EQ(runner.turns(), 1u);
+    EXPECT_EQ(runner.results().size(), 0u);
+}
+
+TEST_CASE(RunnerKeepsToolsRegisteredOnAgent) {
+    auto service = scriptedTurns(std::vector<std::vector<std::string>>{answerTurn()});
+    auto agent = makeAgent(service);
+    Tool preSerialized = tool("weather");
+    preSerialized.description = "registered on the agent";
+    agent->registerTool(preSerialized);
+    auto registry = std::make_shared<ToolRegistry>();
+    registry->add(tool("weather"), sleepingTool(std::chrono::milliseconds(0), "sunny"));
+    registry->add(tool("news"), sleepingTool(std::chrono::milliseconds(0), "quiet"));
+
+    ToolRunner runner(*agent, registry);
+    bool succeeded = false;
+    runner.run(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+
+    ASSERT_TRUE(succeeded);
+    const nlohmann::json tools = requestBody(*service, 0)["tools"];
+    EXPECT_EQ(tools.size(), 2u);
+    EXPECT_EQ(tools[0]["description"], "registered on the agent");
+    EXPECT_EQ(tools[1]["name"], "news");
+}
+
+TEST_CASE(RunnerStopsAfterMaxTurns) {
+    auto service = scriptedTurns(
+        std::vector<std::vector<std::string>>{toolTurn({{"again", "{}"}})});
+    auto agent = makeAgent(service);
+    auto registry = std::make_shared<ToolRegistry>();
+    registry->add(tool("again"), sleepingTool(std::chrono::milliseconds(0), "ok"));
+
+    ToolRunner runner(*agent, registry);
+    runner.withMaxTurns(3);
+    std::string error;
+    runner.run(RunAgentParams(), nullptr, [&](const std::string& message) { error = message; });
+
+    EXPECT_EQ(runner.turns(), 3u);
+    ASSERT_TRUE(error.find("3 turns") != std::string::npos);
+}
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Tool Executor Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,424 @@
+/**
+ * @file test_tracing.cpp
+ * @brief Span, OtlpJsonFileExporter and HttpAgent run tracing
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "agent/http_agent.h"
+#include "core/tracing.h"
+#include "scripted_http_service.h"
+
+using namespace agui;
+using namespace std::chrono_literals;
+
+// Simple test framework
+int g_test_count = 0;
+int g_test_passed = 0;
+int g_test_failed = 0;
+
+#define TEST_CASE(name) \
+    void test_##name(); \
+    struct TestRegistrar_##name { \
+        TestRegistrar_##name() { \
+            std::cout << "Running test: " << #name << std::endl; \
+            g_test_count++; \
+            try { \
+                test_##name(); \
+                g_test_passed++; \
+                std::cout << "   PASSED" << std::endl; \
+            } catch (const std::exception& e) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: " << e.what() << std::endl; \
+            } catch (...) { \
+                g_test_failed++; \
+                std::cout << "   FAILED: Unknown exception" << std::endl; \
+            } \
+        } \
+    } g_test_registrar_##name; \
+    void test_##name()
+
+#define ASSERT_TRUE(condition) \
+    if (!(condition)) { \
+        throw std::runtime_error("Assertion failed: " #condition); \
+    }
+
+#define ASSERT_FALSE(condition) \
+    if (condition) { \
+        throw std::runtime_error("Assertion failed: !" #condition); \
+    }
+
+#define EXPECT_EQ(a, b) \
+    if ((a) != (b)) { \
+        throw std::runtime_error(std::string("Expected equal: ") + #a + " != " + #b); \
+    }
+
+namespace {
+
+std::string sse(const std::string& json) {
+    return "data: " + json + "\n\n";
+}
+
+// Delivers scripted chunks, then completes with fixed timings
+std::shared_ptr<ScriptedHttpService> scriptedService(std::vector<std::string> chunks) {
+    auto service = std::make_shared<ScriptedHttpService>(std::move(chunks));
+    service->timings = ScriptedHttpService::sampleTimings();
+    return service;
+}
+
+class RecordingTraceSink : public ITraceSink {
+public:
+    void onSpanEnd(const SpanRecord& span) override {
+        std::lock_guard<std::mutex> lock(mutex);
+        spans.push_back(span);
+    }
+
+    std::vector<const SpanRecord*> named(const std::string& name) const {
+        std::vector<const SpanRecord*> found;
+        for (const auto& span : spans) {
+            if (span.name == name) {
+                found.push_back(&span);
+            }
+        }
+        return found;
+    }
+
+    const SpanRecord* byId(uint64_t spanId) const {
+        for (const auto& span : spans) {
+            if (span.context.spanId == spanId) {
+                return &span;
+            }
+        }
+        return nullptr;
+    }
+
+    std::mutex mutex;
+    std::vector<SpanRecord> spans;
+};
+
+std::string attribute(const SpanRecord& span, const std::string& key) {
+    for (const auto& entry : span.attributes) {
+        if (entry.key == key) {
+            return entry.isInt ? std::to_string(entry.intValue) : entry.stringValue;
+        }
+    }
+    return "";
+}
+
+class PassThroughMiddleware : public IMiddleware {
+public:
+    uint32_t eventHooks() const override { return HookOnEvent; }
+};
+
+class CountingSubscriber : public IAgentSubscriber {
+public:
+    AgentStateMutation onEvent(const Event&, const AgentSubscriberParams&) override {
+        tracedCallbacks += Span::tracing() ? 1 : 0;
+        return AgentStateMutation();
+    }
+
+    int tracedCallbacks = 0;
+};
+
+const std::vector<std::string> kRunChunks = {
+    sse(R"({"type":"RUN_STARTED","threadId":"t","runId":"r"})"),
+    sse(R"({"type":"TEXT_MESSAGE_START","messageId":"m1","role":"assistant"})") +
+        sse(R"({"type":"TEXT_MESSAGE_CONTENT","messageId":"m1","delta":"Hi"})"),
+    sse(R"({"type":"TEXT_MESSAGE_END","messageId":"m1"})") +
+        sse(R"({"type":"RUN_FINISHED","threadId":"t","runId":"r"})")};
+
+}  // namespace
+
+// Span
+
+TEST_CASE(SpansNestOnTheCallingThread) {
+    RecordingTraceSink sink;
+    {
+        Span orphan("orphan");
+        ASSERT_FALSE(orphan);
+        ASSERT_FALSE(Span::tracing());
+        Span disabled(nullptr, "disabled");
+        ASSERT_FALSE(disabled);
+        ASSERT_FALSE(disabled.context().valid());
+        disabled.setAttribute("ignored", int64_t{1});
+    }
+    EXPECT_EQ(sink.spans.size(), 0u);
+
+    SpanContext rootContext;
+    {
+        Span root(&sink, "root");
+        ASSERT_TRUE(root);
+        ASSERT_TRUE(Span::tracing());
+        rootContext = root.context();
+        {
+            Span child("child");
+            child.setAttribute("count", int64_t{3});
+            Span grandchild("grandchild");
+            grandchild.setError("failed");
+        }
+        Span sibling("sibling");
+        sibling.setAttribute("kind", "text");
+    }
+    ASSERT_FALSE(Span::tracing());
+
+    // Reported as they end: innermost first
+    EXPECT_EQ(sink.spans.size(), 4u);
+    EXPECT_EQ(sink.spans[0].name, "grandchild");
+    EXPECT_EQ(sink.spans[1].name, "child");
+    EXPECT_EQ(sink.spans[2].name, "sibling");
+    EXPECT_EQ(sink.spans[3].name, "root");
+    EXPECT_EQ(sink.spans[3].parentSpanId, 0u);
+    EXPECT_EQ(sink.spans[1].parentSpanId, rootContext.spanId);
+    EXPECT_EQ(sink.spans[0].parentSpanId, sink.spans[1].context.spanId);
+    EXPECT_EQ(sink.spans[2].parentSpanId, rootContext.spanId);
+    for (const auto& span : sink.spans) {
+        EXPECT_EQ(span.context.traceIdHigh, rootContext.traceIdHigh);
+        EXPECT_EQ(span.context.traceIdLow, rootContext.traceIdLow);
+        ASSERT_TRUE(span.end >= span.start);
+    }
+    ASSERT_TRUE(sink.spans[0].error);
+    EXPECT_EQ(sink.spans[0].statusMessage, "failed");
+    EXPECT_EQ(attribute(sink.spans[1], "count"), "3");
+    EXPECT_EQ(attribute(sink.spans[2], "kind"), "text");
+
+    // An explicit parent continues its trace on another stack
+    const auto start = std::chrono::system_clock::now();
+    Span::record(&sink, "recorded", rootContext, start, start + 5ms);
+    EXPECT_EQ(sink.spans.back().parentSpanId, rootContext.spanId);
+    EXPECT_EQ(sink.spans.back().context.traceIdLow, rootContext.traceIdLow);
+    ASSERT_TRUE(sink.spans.back().end - sink.spans.back().start == 5ms);
+}
+
+// OtlpJsonFileExporter
+
+TEST_CASE(ExporterWritesOtlpJsonLines) {
+    const std::string path = "test_tracing_spans.jsonl";
+    std::remove(path.c_str());
+    {
+        OtlpJsonFileExporter exporter(path, "tracing-test", 2);
+        {
+            Span root(&exporter, "root");
+            Span child("child");
+            child.setAttribute("agui.bytes", int64_t{42});
+            child.setAttribute("agui.event_type", "RUN_STARTED");
+            child.setError("boom");
+        }
+        EXPECT_EQ(exporter.spansExported(), 2u);
+        { Span single(&exporter, "single"); }
+        EXPECT_EQ(exporter.spansExported(), 2u);
+    }  // destructor flushes
+
+    std::ifstream file(path);
+    std::vector<nlohmann::json> lines;
+    for (std::string line; std::getline(file, line);) {
+        lines.push_back(nlohmann::json::parse(line));
+    }
+    std::remove(path.c_str());
+    EXPECT_EQ(lines.size(), 2u);
+
+    const nlohmann::json& resource = lines[0]["resourceSpans"][0];
+    EXPECT_EQ(resource["resource"]["attributes"][0]["key"], "service.name");
+    EXPECT_EQ(resource["resource"]["attributes"][0]["value"]["stringValue"], "tracing-test");
+    const nlohmann::json& spans = resource["scopeSpans"][0]["spans"];
+    EXPECT_EQ(spans.size(), 2u);
+    const nlohmann::json& child = spans[0];
+    const nlohmann::json& root = spans[1];
+    EXPECT_EQ(child["name"], "child");
+    EXPECT_EQ(child["traceId"].get<std::string>().size(), 32u);
+    EXPECT_EQ(child["traceId"], root["traceId"]);
+    EXPECT_EQ(child["spanId"].get<std::string>().size(), 16u);
+    EXPECT_EQ(child["parentSpanId"], root["spanId"]);
+    ASSERT_FALSE(root.contains("parentSpanId"));
+    ASSERT_TRUE(child["startTimeUnixNano"].is_string());
+    ASSERT_TRUE(std::stoull(child["endTimeUnixNano"].get<std::string>()) >=
+                std::stoull(child["startTimeUnixNano"].get<std::string>()));
+    EXPECT_EQ(child["attributes"][0]["key"], "agui.bytes");
+    EXPECT_EQ(child["attributes"][0]["value"]["intValue"], "42");
+    EXPECT_EQ(child["attributes"][1]["value"]["stringValue"], "RUN_STARTED");
+    EXPECT_EQ(child["status"]["code"], 2);
+    EXPECT_EQ(child["status"]["message"], "boom");
+    ASSERT_FALSE(root.contains("status"));
+    EXPECT_EQ(lines[1]["resourceSpans"][0]["scopeSpans"][0]["spans"][0]["name"], "single");
+
+    bool threw = false;
+    try {
+        OtlpJsonFileExporter missing("no-such-directory/spans.jsonl");
+    } catch (const AgentError&) {
+        threw = true;
+    }
+    ASSERT_TRUE(threw);
+}
+
+// HttpAgent
+
+TEST_CASE(AgentTracesEachStage) {
+    auto sink = std::make_shared<RecordingTraceSink>();
+    auto subscriber = std::make_shared<CountingSubscriber>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withAgentId("writer").withTraceSink(sink).build();
+    agent->setHttpService(scriptedService(kRunChunks));
+    agent->use(std::make_shared<PassThroughMiddleware>());
+    agent->subscribe(subscriber);
+    RunAgentParams params;
+    params.threadId = "thread-1";
+    params.runId = "run-1";
+    bool succeeded = false;
+    agent->runAgent(params, [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+    ASSERT_TRUE(succeeded);
+
+    const auto runs = sink->named("agui.run");
+    EXPECT_EQ(runs.size(), 1u);
+    const SpanRecord& run = *runs.front();
+    EXPECT_EQ(run.parentSpanId, 0u);
+    EXPECT_EQ(attribute(run, "agui.agent_id"), "writer");
+    EXPECT_EQ(attribute(run, "agui.run_id"), "run-1");
+    EXPECT_EQ(attribute(run, "agui.outcome"), "success");
+    ASSERT_FALSE(run.error);
+    for (const auto& span : sink->spans) {
+        EXPECT_EQ(span.context.traceIdLow, run.context.traceIdLow);
+    }
+
+    const auto parentName = [&](const SpanRecord* span) {
+        const SpanRecord* parent = sink->byId(span->parentSpanId);
+        return parent ? parent->name : std::string();
+    };
+    EXPECT_EQ(parentName(sink->named("agui.request.build").front()), "agui.run");
+    // The chain's span, with one span per middleware below it
+    const auto requestChain = sink->named("agui.middleware.request_chain");
+    EXPECT_EQ(requestChain.size(), 1u);
+    EXPECT_EQ(parentName(requestChain.front()), "agui.run");
+    const auto requestMiddleware = sink->named("agui.middleware.request");
+    EXPECT_EQ(requestMiddleware.size(), 1u);
+    EXPECT_EQ(parentName(requestMiddleware.front()), "agui.middleware.request_chain");
+    EXPECT_EQ(attribute(*requestMiddleware.front(), "agui.middleware"),
+              "(anonymous namespace)::PassThroughMiddleware");
+    const auto http = sink->named("agui.http");
+    EXPECT_EQ(http.size(), 1u);
+    EXPECT_EQ(parentName(http.front()), "agui.run");
+    EXPECT_EQ(attribute(*http.front(), "http.status_code"), "200");
+
+    // Connection phases are laid out from the transport's timings
+    const auto connect = sink->named("agui.http.connect");
+    const auto tls = sink->named("agui.http.tls");
+    const auto firstByte = sink->named("agui.http.first_byte");
+    EXPECT_EQ(connect.size(), 1u);
+    EXPECT_EQ(tls.size(), 1u);
+    EXPECT_EQ(sink->named("agui.http.dns").size(), 1u);
+    EXPECT_EQ(parentName(connect.front()), "agui.http");
+    ASSERT_TRUE(connect.front()->end - connect.front()->start == 200us);
+    ASSERT_TRUE(tls.front()->end - tls.front()->start == 600us);
+    ASSERT_TRUE(firstByte.front()->start == tls.front()->end);
+    ASSERT_TRUE(firstByte.front()->end - firstByte.front()->start == 1100us);
+
+    const auto chunks = sink->named("agui.sse.chunk");
+    EXPECT_EQ(chunks.size(), 3u);
+    EXPECT_EQ(parentName(chunks.front()), "agui.http");
+    EXPECT_EQ(attribute(*chunks.front(), "agui.bytes"), std::to_string(kRunChunks.front().size()));
+
+    const auto events = sink->named("agui.event");
+    EXPECT_EQ(events.size(), 5u);
+    EXPECT_EQ(attribute(*events.front(), "agui.event_type"), "RUN_STARTED");
+    EXPECT_EQ(parentName(events.front()), "agui.sse.chunk");
+    for (const char* stage : {"agui.event.parse", "agui.middleware.event", "agui.event.verify", "agui.event.handle"}) {
+        const auto stages = sink->named(stage);
+        ASSERT_TRUE(stages.size() >= 5u);
+        EXPECT_EQ(parentName(stages.front()), "agui.event");
+    }
+    EXPECT_EQ(attribute(*sink->named("agui.middleware.event").front(), "agui.middleware"),
+              "(anonymous namespace)::PassThroughMiddleware");
+
+    // One span per subscriber callback
+    EXPECT_EQ(subscriber->tracedCallbacks, 5);
+    const auto callbacks = sink->named("agui.subscriber");
+    ASSERT_TRUE(callbacks.size() >= 5u);
+    EXPECT_EQ(parentName(callbacks.front()), "agui.event.handle");
+    EXPECT_EQ(attribute(*callbacks.front(), "agui.subscriber"), "(anonymous namespace)::CountingSubscriber");
+    EXPECT_EQ(attribute(*callbacks.front(), "agui.callback"), "event notification");
+    bool messagesChanged = false;
+    for (const SpanRecord* callback : callbacks) {
+        messagesChanged |= attribute(*callback, "agui.callback") == "onMessagesChanged" &&
+                           parentName(callback) == "agui.event.handle";
+    }
+    ASSERT_TRUE(messagesChanged);
+
+    const auto responseChain = sink->named("agui.middleware.response_chain");
+    EXPECT_EQ(responseChain.size(), 1u);
+    // Response middleware runs in the completion callback, inside the HTTP span
+    EXPECT_EQ(parentName(responseChain.front()), "agui.http");
+    const auto responseMiddleware = sink->named("agui.middleware.response");
+    EXPECT_EQ(responseMiddleware.size(), 1u);
+    EXPECT_EQ(parentName(responseMiddleware.front()), "agui.middleware.response_chain");
+
+    // No sink: nothing is traced, not even implicitly
+    agent->setTraceSink(nullptr);
+    const size_t spansBefore = sink->spans.size();
+    agent->runAgent(params, nullptr, nullptr);
+    EXPECT_EQ(sink->spans.size(), spansBefore);
+    EXPECT_EQ(subscriber->tracedCallbacks, 5);
+}
+
+TEST_CASE(PipelinedEventsJoinTheRunTrace) {
+    auto sink = std::make_shared<RecordingTraceSink>();
+    auto agent =
+        HttpAgent::builder().withUrl("http://localhost").withPipelinedProcessing().withTraceSink(sink).build();
+    agent->setHttpService(scriptedService(kRunChunks));
+    bool succeeded = false;
+    agent->runAgent(RunAgentParams(), [&](const RunAgentResult&) { succeeded = true; }, nullptr);
+    ASSERT_TRUE(succeeded);
+
+    const SpanRecord& run = *sink->named("agui.run").front();
+    const auto events = sink->named("agui.event");
+    EXPECT_EQ(events.size(), 5u);
+    for (const SpanRecord* event : events) {
+        EXPECT_EQ(event->parentSpanId, run.context.spanId);
+        EXPECT_EQ(event->context.traceIdLow, run.context.traceIdLow);
+    }
+    // Parsing stays on the network thread, under its read
+    const SpanRecord* parse = sink->named("agui.event.parse").front();
+    EXPECT_EQ(sink->byId(parse->parentSpanId)->name, "agui.sse.chunk");
+    const SpanRecord* handle = sink->named("agui.event.handle").front();
+    EXPECT_EQ(sink->byId(handle->parentSpanId)->name, "agui.event");
+}
+
+TEST_CASE(FailedRunsHaveErrorStatus) {
+    auto sink = std::make_shared<RecordingTraceSink>();
+    auto agent = HttpAgent::builder().withUrl("http://localhost").withTraceSink(sink).build();
+    auto service = std::make_shared<ScriptedHttpService>();
+    service->fail = true;
+    agent->setHttpService(service);
+    agent->runAgent(RunAgentParams(), nullptr, nullptr);
+
+    const auto runs = sink->named("agui.run");
+    EXPECT_EQ(runs.size(), 1u);
+    ASSERT_TRUE(runs.front()->error);
+    ASSERT_TRUE(runs.front()->statusMessage.find("connection refused") != std::string::npos);
+    EXPECT_EQ(attribute(*runs.front(), "agui.outcome"), "failure");
+    ASSERT_TRUE(sink->named("agui.http.connect").empty());
+}
+
+// Main function
+
+int main() {
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "AgUi Tracing Test Suite" << std::endl;
+    std::cout << "========================================\n" << std::endl;
+
+    // Tests will run automatically when global objects are initialized
+
+    std::cout << "\n========================================" << std::endl;
+    std::cout << "Test Results:" << std::endl;
+    std::cout << "  Total:  " << g_test_count << std::endl;
+    std::cout << "  Passed: " << g_test_passed << std::endl;
+    std::cout << "  Failed: " << g_test_failed << std::endl;
+    std::cout << "========================================" << std::endl;
+
+    return g_test_failed > 0 ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file agui_logdecode.cpp
+ * @brief Prints a file written by BinaryLog as text, one line per record
+ *
+ * Usage: agui_logdecode <binary log> [output]   (default output: stdout)
+ */
+
+#include <fstream>
+#include <iostream>
+
+#include "core/binary_log.h"
+#include "core/error.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <binary log> [output]" << std::endl;
+        return 2;
+    }
+
+    std::ifstream in(argv[1], std::ios::binary);
+    if (!in) {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    std::ofstream file;
+    if (argc == 3) {
+        file.open(argv[2]);
+        if (!file) {
+            std::cerr << "Cannot open " << argv[2] << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = argc == 3 ? static_cast<std::ostream&>(file) : std::cout;
+
+    try {
+        const size_t records = agui::BinaryLog::decode(in, out);
+        std::cerr << records << " records" << std::endl;
+    } catch (const agui::AgentError& e) {
+        out.flush();
+        std::cerr << argv[1] << ": " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}